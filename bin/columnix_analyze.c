@@ -43,7 +43,7 @@ int main(int argc, char *argv[])
         printf(" - name: %s\n", cx_reader_column_name(reader, i));
         printf(" - type: %s\n", type_str(type));
         if (encoding)
-            printf(" - type: %s\n", encoding_str(encoding));
+            printf(" - encoding: %s\n", encoding_str(encoding));
         if (compression)
             printf(" - compression: %s (level %d)\n",
                    compression_str(compression), level);
@@ -77,6 +77,32 @@ static const char *type_str(enum cx_column_type type)
 
 static const char *encoding_str(enum cx_encoding_type type)
 {
+    switch (type) {
+        case CX_ENCODING_DICT:
+            return "DICT";
+        case CX_ENCODING_RLE:
+            return "RLE";
+        case CX_ENCODING_DELTA:
+            return "DELTA";
+        case CX_ENCODING_DELTA_OF_DELTA:
+            return "DELTA_OF_DELTA";
+        case CX_ENCODING_BITPACK:
+            return "BITPACK";
+        case CX_ENCODING_XOR:
+            return "XOR";
+        case CX_ENCODING_BYTE_STREAM_SPLIT:
+            return "BYTE_STREAM_SPLIT";
+        case CX_ENCODING_OFFSETS:
+            return "OFFSETS";
+        case CX_ENCODING_FSST:
+            return "FSST";
+        case CX_ENCODING_CONSTANT:
+            return "CONSTANT";
+        case CX_ENCODING_SPARSE:
+            return "SPARSE";
+        default:
+            break;
+    }
     return unknown_str;
 }
 
@@ -89,6 +115,8 @@ static const char *compression_str(enum cx_compression_type type)
             return "LZ4HC";
         case CX_COMPRESSION_ZSTD:
             return "ZSTD";
+        case CX_COMPRESSION_AUTO:
+            return "AUTO";
         default:
             break;
     }
@@ -0,0 +1,143 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "reader.h"
+#include "writer.h"
+
+#define ROW_GROUP_SIZE 100000
+
+struct bench_config {
+    const char *name;
+    enum cx_encoding_type encoding;
+    enum cx_compression_type compression;
+};
+
+static const struct bench_config configs[] = {
+    {"none", CX_ENCODING_NONE, CX_COMPRESSION_NONE},
+    {"zstd", CX_ENCODING_NONE, CX_COMPRESSION_ZSTD},
+    {"xor", CX_ENCODING_XOR, CX_COMPRESSION_NONE},
+    {"xor+lz4", CX_ENCODING_XOR, CX_COMPRESSION_LZ4},
+    {"xor+zstd", CX_ENCODING_XOR, CX_COMPRESSION_ZSTD},
+    {"bss+lz4", CX_ENCODING_BYTE_STREAM_SPLIT, CX_COMPRESSION_LZ4},
+    {"bss+zstd", CX_ENCODING_BYTE_STREAM_SPLIT, CX_COMPRESSION_ZSTD},
+};
+
+static double now(void);
+static double metric(size_t);
+static bool write_file(const char *, const struct bench_config *, size_t);
+static bool read_file(const char *, size_t, double *);
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s <dir> [rows]\n", argv[0]);
+        return 1;
+    }
+
+    const char *dir = argv[1];
+    size_t row_count = argc == 3 ? strtoul(argv[2], NULL, 10) : 10000000;
+
+    printf("%-10s %12s %8s %10s %10s\n", "config", "bytes", "ratio",
+           "write MB/s", "read MB/s");
+
+    double raw_mb = (double)row_count * sizeof(double) / (1 << 20);
+    for (size_t i = 0; i < sizeof(configs) / sizeof(*configs); i++) {
+        const struct bench_config *config = &configs[i];
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/bench-%s.cx", dir, config->name);
+
+        double start = now();
+        if (!write_file(path, config, row_count)) {
+            fprintf(stderr, "error: unable to write %s\n", path);
+            return 1;
+        }
+        double write_time = now() - start;
+
+        double read_time;
+        if (!read_file(path, row_count, &read_time)) {
+            fprintf(stderr, "error: unable to read %s\n", path);
+            return 1;
+        }
+
+        struct stat st;
+        if (stat(path, &st)) {
+            fprintf(stderr, "error: unable to stat %s\n", path);
+            return 1;
+        }
+        remove(path);
+
+        printf("%-10s %12lld %8.2f %10.1f %10.1f\n", config->name,
+               (long long)st.st_size,
+               (double)row_count * sizeof(double) / st.st_size,
+               raw_mb / write_time, raw_mb / read_time);
+    }
+
+    return 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// a slowly changing gauge, like a temperature or CPU load metric, sampled
+// with two decimal places of precision
+static double metric(size_t i)
+{
+    static long long level = 2000;
+    if (!i)
+        level = 2000;
+    unsigned long long x = i * 0x9E3779B97F4A7C15ULL;
+    x ^= x >> 29;
+    level += (long long)(x >> 32) % 7 - 3;
+    return level / 100.0;
+}
+
+static bool write_file(const char *path, const struct bench_config *config,
+                       size_t row_count)
+{
+    struct cx_writer *writer = cx_writer_new(path, ROW_GROUP_SIZE);
+    if (!writer)
+        return false;
+    if (!cx_writer_add_column(writer, "metric", CX_COLUMN_DBL,
+                              config->encoding, config->compression, 0))
+        goto error;
+    for (size_t i = 0; i < row_count; i++)
+        if (!cx_writer_put_dbl(writer, 0, metric(i)))
+            goto error;
+    if (!cx_writer_finish(writer, false))
+        goto error;
+    cx_writer_free(writer);
+    return true;
+error:
+    cx_writer_free(writer);
+    return false;
+}
+
+static bool read_file(const char *path, size_t row_count, double *elapsed)
+{
+    double start = now();
+    struct cx_reader *reader = cx_reader_new(path);
+    if (!reader)
+        return false;
+    size_t position = 0;
+    double value, sum = 0;
+    for (; cx_reader_next(reader); position++) {
+        if (!cx_reader_get_dbl(reader, 0, &value))
+            break;
+        sum += value;
+    }
+    bool ok = !cx_reader_error(reader) && position == row_count;
+    cx_reader_free(reader);
+    *elapsed = now() - start;
+    // make sure the values are used
+    if (sum != sum)
+        printf("nan\n");
+    return ok;
+}
@@ -68,6 +68,27 @@ cx_writer_add_column = lib.cx_writer_add_column
 cx_writer_add_column.argtypes = [
     c_void_p, c_char_p, c_int, c_int, c_int, c_int]
 
+# Writer 新增一个分页的列
+cx_writer_add_column_paged = lib.cx_writer_add_column_paged
+cx_writer_add_column_paged.argtypes = [
+    c_void_p, c_char_p, c_int, c_int, c_int, c_int, c_size_t]
+
+# Writer 设置压缩线程数
+cx_writer_set_threads = lib.cx_writer_set_threads
+cx_writer_set_threads.argtypes = [c_void_p, c_int]
+
+# Writer 在后台线程刷写行组
+cx_writer_set_async = lib.cx_writer_set_async
+cx_writer_set_async.argtypes = [c_void_p, c_size_t]
+
+# Writer 绕过页缓存写文件 (O_DIRECT)
+cx_writer_set_direct = lib.cx_writer_set_direct
+cx_writer_set_direct.argtypes = [c_void_p, c_bool]
+
+# Writer 为 ZSTD 列训练字典
+cx_writer_train_dictionaries = lib.cx_writer_train_dictionaries
+cx_writer_train_dictionaries.argtypes = [c_void_p, c_size_t]
+
 # Writer 添加 null 数据
 cx_writer_put_null = lib.cx_writer_put_null
 cx_writer_put_null.argtypes = [c_void_p, c_size_t]
@@ -111,24 +132,45 @@ STR = 5  # string
 LZ4 = 1
 LZ4HC = 2
 ZSTD = 3
+AUTO = 4  # 按列块自动选择编码和压缩, level 为解码速度权重 (0-100)
+# 编码
+DICT = 1  # 字典编码, 仅支持 STR
+RLE = 2  # 游程编码, 支持 BIT/I32/I64
+DELTA = 3  # 差分编码, 仅支持 I64
+DELTA_OF_DELTA = 4  # 二阶差分编码, 仅支持 I64, 适合时间戳
+BITPACK = 5  # 参考帧 + 位压缩, 支持 I32/I64
+XOR = 6  # 异或编码 (Gorilla), 支持 FLT/DBL, 适合缓慢变化的指标
+BYTE_STREAM_SPLIT = 7  # 按字节拆分为多个流, 支持 FLT/DBL, 提高后续压缩率
+OFFSETS = 8  # 字符串偏移量索引, 仅支持 STR, 跳过和读取无需扫描字符串
+FSST = 9  # 符号表压缩 (FSST), 仅支持 STR, 可单独解压每个字符串
+CONSTANT = 10  # 常量编码, 整个列块只有一个值时由 writer 自动选用
+SPARSE = 11  # 稀疏编码, 不支持 BIT, 只存储非空行的位置和值
 
 
 class Column(object):
     """ 列定义 """
 
-    def __init__(self, type, name, encoding=None, compression=None, level=1):
+    def __init__(self, type, name, encoding=None, compression=None, level=1,
+                 page_size=0):
         self.type = type
         self.name = name
         self.encoding = encoding or 0  # 0 表示无编码
         self.compression = compression or 0  # 0 表示无压缩
         self.level = level
+        self.page_size = page_size  # 每页的行数 (4096 的倍数), 0 表示不分页
 
 
 class Writer(object):
-    def __init__(self, path, columns, row_group_size=100000, sync=True):
+    def __init__(self, path, columns, row_group_size=100000, sync=True,
+                 dictionary_size=0, thread_count=1, in_flight=0,
+                 direct=False):
         self.path = path
         self.columns = columns
         self.row_group_size = row_group_size
+        self.dictionary_size = dictionary_size
+        self.thread_count = thread_count
+        self.in_flight = in_flight
+        self.direct = direct
         self.sync = sync
         put_fn = [self._put_bit, self._put_i32, self._put_i64, self._put_flt,
                   self._put_dbl, self._put_str]
@@ -142,12 +184,24 @@ class Writer(object):
         if not self.writer:
             raise RuntimeError("failed to create writer for %s" % self.path)
         for column in self.columns:
-            if not cx_writer_add_column(self.writer, column.name.encode('utf-8'),
-                                        ctypes.c_int(column.type),
-                                        ctypes.c_int(column.encoding),
-                                        ctypes.c_int(column.compression),
-                                        ctypes.c_int(column.level)):
+            if not cx_writer_add_column_paged(
+                    self.writer, column.name.encode('utf-8'),
+                    ctypes.c_int(column.type), ctypes.c_int(column.encoding),
+                    ctypes.c_int(column.compression),
+                    ctypes.c_int(column.level),
+                    ctypes.c_size_t(column.page_size)):
                 raise RuntimeError("failed to add column")
+        if self.dictionary_size and not cx_writer_train_dictionaries(
+                self.writer, ctypes.c_size_t(self.dictionary_size)):
+            raise RuntimeError("failed to enable dictionaries")
+        if self.thread_count != 1 and not cx_writer_set_threads(
+                self.writer, ctypes.c_int(self.thread_count)):
+            raise RuntimeError("failed to start compression threads")
+        if self.in_flight and not cx_writer_set_async(
+                self.writer, ctypes.c_size_t(self.in_flight)):
+            raise RuntimeError("failed to enable async flushing")
+        if self.direct and not cx_writer_set_direct(self.writer, True):
+            raise RuntimeError("failed to enable direct IO")
         return self
 
     def __exit__(self, err, value, traceback):
@@ -0,0 +1,302 @@
+#include "auto.h"
+
+#include <stdlib.h>
+
+#include "compress.h"
+#include "encode.h"
+#include "pool.h"
+
+// large chunks are sampled in slices of rows spread across the chunk. the
+// slices are a multiple of the batch size, so that they start on a batch
+#define CX_AUTO_SLICES 4
+#define CX_AUTO_SLICE_SIZE 1024
+
+// rough decode costs used to compare candidates, in ns per row for each
+// encoding and in ns per decompressed byte for each compression type. each
+// byte read from storage costs CX_AUTO_READ_COST
+#define CX_AUTO_READ_COST 0.25
+
+static const double cx_auto_encoding_costs[] = {
+    [CX_ENCODING_NONE] = 0,
+    [CX_ENCODING_DICT] = 1,
+    [CX_ENCODING_RLE] = 0.5,
+    [CX_ENCODING_DELTA] = 1.5,
+    [CX_ENCODING_DELTA_OF_DELTA] = 2,
+    [CX_ENCODING_BITPACK] = 1,
+    [CX_ENCODING_XOR] = 4,
+    [CX_ENCODING_BYTE_STREAM_SPLIT] = 0.5,
+    [CX_ENCODING_OFFSETS] = 0.2,
+    [CX_ENCODING_FSST] = 5,
+    [CX_ENCODING_CONSTANT] = 0,
+    [CX_ENCODING_SPARSE] = 1};
+
+// string offsets always add to the size of a chunk, and constant chunks
+// are detected by the writer, so neither is a candidate
+static const enum cx_encoding_type cx_auto_encodings[] = {
+    CX_ENCODING_NONE,    CX_ENCODING_DICT,
+    CX_ENCODING_RLE,     CX_ENCODING_DELTA,
+    CX_ENCODING_DELTA_OF_DELTA, CX_ENCODING_BITPACK,
+    CX_ENCODING_XOR,     CX_ENCODING_BYTE_STREAM_SPLIT,
+    CX_ENCODING_FSST,    CX_ENCODING_SPARSE};
+
+#define CX_AUTO_ENCODINGS \
+    (sizeof(cx_auto_encodings) / sizeof(*cx_auto_encodings))
+
+struct cx_auto_codec {
+    enum cx_compression_type type;
+    int level;
+    double cost;
+};
+
+static const struct cx_auto_codec cx_auto_codecs[] = {
+    {CX_COMPRESSION_NONE, 0, 0},    {CX_COMPRESSION_LZ4, 1, 0.2},
+    {CX_COMPRESSION_LZ4HC, 9, 0.2}, {CX_COMPRESSION_ZSTD, 3, 1},
+    {CX_COMPRESSION_ZSTD, 9, 1}};
+
+#define CX_AUTO_CODECS (sizeof(cx_auto_codecs) / sizeof(*cx_auto_codecs))
+
+struct cx_auto_candidate {
+    enum cx_encoding_type encoding;
+    const struct cx_auto_codec *codec;
+    double size;
+    double time;
+};
+
+static size_t cx_auto_skip(struct cx_column_cursor *cursor,
+                           enum cx_column_type type, size_t count)
+{
+    switch (type) {
+        case CX_COLUMN_BIT:
+            return cx_column_cursor_skip_bit(cursor, count);
+        case CX_COLUMN_I32:
+            return cx_column_cursor_skip_i32(cursor, count);
+        case CX_COLUMN_I64:
+            return cx_column_cursor_skip_i64(cursor, count);
+        case CX_COLUMN_FLT:
+            return cx_column_cursor_skip_flt(cursor, count);
+        case CX_COLUMN_DBL:
+            return cx_column_cursor_skip_dbl(cursor, count);
+        case CX_COLUMN_STR:
+            return cx_column_cursor_skip_str(cursor, count);
+    }
+    return 0;
+}
+
+static bool cx_auto_copy_batch(struct cx_column *sample,
+                               struct cx_column_cursor *cursor,
+                               size_t *count)
+{
+    size_t available = 0;
+    bool ok = true;
+    switch (cx_column_type(sample)) {
+        case CX_COLUMN_BIT: {
+            const uint64_t *bits =
+                cx_column_cursor_next_batch_bit(cursor, &available);
+            for (size_t i = 0; ok && i < available && i < *count; i++)
+                ok = cx_column_put_bit(
+                    sample, bits[i / 64] & ((uint64_t)1 << (i % 64)));
+        } break;
+        case CX_COLUMN_I32: {
+            const int32_t *values =
+                cx_column_cursor_next_batch_i32(cursor, &available);
+            for (size_t i = 0; ok && i < available && i < *count; i++)
+                ok = cx_column_put_i32(sample, values[i]);
+        } break;
+        case CX_COLUMN_I64: {
+            const int64_t *values =
+                cx_column_cursor_next_batch_i64(cursor, &available);
+            for (size_t i = 0; ok && i < available && i < *count; i++)
+                ok = cx_column_put_i64(sample, values[i]);
+        } break;
+        case CX_COLUMN_FLT: {
+            const float *values =
+                cx_column_cursor_next_batch_flt(cursor, &available);
+            for (size_t i = 0; ok && i < available && i < *count; i++)
+                ok = cx_column_put_flt(sample, values[i]);
+        } break;
+        case CX_COLUMN_DBL: {
+            const double *values =
+                cx_column_cursor_next_batch_dbl(cursor, &available);
+            for (size_t i = 0; ok && i < available && i < *count; i++)
+                ok = cx_column_put_dbl(sample, values[i]);
+        } break;
+        case CX_COLUMN_STR: {
+            const struct cx_string *strings =
+                cx_column_cursor_next_batch_str(cursor, &available);
+            for (size_t i = 0; ok && i < available && i < *count; i++)
+                ok = cx_column_put_str(sample, strings[i].ptr);
+        } break;
+    }
+    *count = available < *count ? *count - available : 0;
+    return ok && available;
+}
+
+static struct cx_column *cx_auto_sample(const struct cx_column *column)
+{
+    enum cx_column_type type = cx_column_type(column);
+    struct cx_column_cursor *cursor = NULL;
+    struct cx_column *sample = cx_column_new(type, CX_ENCODING_NONE);
+    if (!sample)
+        return NULL;
+    cursor = cx_column_cursor_new(column);
+    if (!cursor)
+        goto error;
+    size_t stride = cx_column_count(column) / CX_AUTO_SLICES / CX_BATCH_SIZE *
+                    CX_BATCH_SIZE;
+    size_t position = 0;
+    for (size_t i = 0; i < CX_AUTO_SLICES; i++) {
+        size_t start = i * stride;
+        if (cx_auto_skip(cursor, type, start - position) != start - position)
+            goto error;
+        size_t remaining = CX_AUTO_SLICE_SIZE;
+        while (remaining)
+            if (!cx_auto_copy_batch(sample, cursor, &remaining))
+                goto error;
+        position = start + CX_AUTO_SLICE_SIZE;
+    }
+    cx_column_cursor_free(cursor);
+    return sample;
+error:
+    if (cursor)
+        cx_column_cursor_free(cursor);
+    cx_column_free(sample);
+    return NULL;
+}
+
+static bool cx_auto_has_nulls(const struct cx_column *nulls)
+{
+    size_t size;
+    const uint64_t *words = cx_column_export(nulls, &size);
+    for (size_t i = 0; i < size / sizeof(uint64_t); i++)
+        if (words[i])
+            return true;
+    return false;
+}
+
+static bool cx_auto_try(const struct cx_column *sample,
+                        const struct cx_column *nulls,
+                        enum cx_encoding_type encoding,
+                        struct cx_auto_candidate *candidates, size_t *count)
+{
+    struct cx_column *encoded = NULL;
+    const struct cx_column *column = sample;
+    size_t plain_size, size;
+    cx_column_export(sample, &plain_size);
+    if (encoding == CX_ENCODING_SPARSE)
+        encoded = cx_encode_sparse(sample, nulls);
+    else if (encoding != CX_ENCODING_NONE)
+        encoded = cx_encode(sample, encoding, NULL);
+    if (encoding != CX_ENCODING_NONE) {
+        // the encoding doesn't apply to the values
+        if (!encoded)
+            return true;
+        column = encoded;
+    }
+    const void *buffer = cx_column_export(column, &size);
+    // the writer would fall back to the plain layout
+    if (size > plain_size)
+        goto done;
+    double decode_time = cx_column_count(sample) *
+                         cx_auto_encoding_costs[encoding];
+    for (size_t i = 0; i < CX_AUTO_CODECS; i++) {
+        const struct cx_auto_codec *codec = &cx_auto_codecs[i];
+        size_t compressed_size = size;
+        if (codec->type != CX_COMPRESSION_NONE) {
+            size_t capacity;
+            void *compressed =
+                cx_compress_pooled(codec->type, codec->level, NULL, buffer,
+                                   size, &compressed_size, &capacity);
+            if (!compressed)
+                goto error;
+            cx_pool_put(compressed, capacity);
+            // the writer would fall back to no compression
+            if (compressed_size >= size)
+                continue;
+        }
+        struct cx_auto_candidate *candidate = &candidates[(*count)++];
+        candidate->encoding = encoding;
+        candidate->codec = codec;
+        candidate->size = compressed_size;
+        candidate->time = compressed_size * CX_AUTO_READ_COST + decode_time +
+                          size * codec->cost;
+    }
+done:
+    if (encoded)
+        cx_column_free(encoded);
+    return true;
+error:
+    if (encoded)
+        cx_column_free(encoded);
+    return false;
+}
+
+bool cx_auto_choose(const struct cx_column *column,
+                    const struct cx_column *nulls, int weight,
+                    enum cx_encoding_type *encoding,
+                    enum cx_compression_type *compression, int *level)
+{
+    struct cx_column *sample = NULL, *nulls_sample = NULL;
+    struct cx_auto_candidate candidates[CX_AUTO_ENCODINGS * CX_AUTO_CODECS];
+    size_t candidate_count = 0;
+    enum cx_column_type type = cx_column_type(column);
+    if (cx_column_encoding(column) != CX_ENCODING_NONE || weight < 0 ||
+        weight > 100)
+        return false;
+    if (cx_column_count(column) > CX_AUTO_SLICES * CX_AUTO_SLICE_SIZE) {
+        sample = cx_auto_sample(column);
+        if (!sample)
+            goto error;
+        if (nulls) {
+            nulls_sample = cx_auto_sample(nulls);
+            if (!nulls_sample)
+                goto error;
+        }
+    }
+    const struct cx_column *values = sample ? sample : column;
+    const struct cx_column *bitset = nulls_sample ? nulls_sample : nulls;
+    for (size_t i = 0; i < CX_AUTO_ENCODINGS; i++) {
+        if (!cx_encoding_supported(type, cx_auto_encodings[i]))
+            continue;
+        if (cx_auto_encodings[i] == CX_ENCODING_SPARSE &&
+            (!bitset || !cx_auto_has_nulls(bitset)))
+            continue;
+        if (!cx_auto_try(values, bitset, cx_auto_encodings[i], candidates,
+                         &candidate_count))
+            goto error;
+    }
+    // the plain, uncompressed layout is always a candidate
+    if (!candidate_count)
+        goto error;
+
+    double min_size = candidates[0].size, min_time = candidates[0].time;
+    for (size_t i = 1; i < candidate_count; i++) {
+        if (candidates[i].size < min_size)
+            min_size = candidates[i].size;
+        if (candidates[i].time < min_time)
+            min_time = candidates[i].time;
+    }
+    const struct cx_auto_candidate *best = NULL;
+    double best_score = 0;
+    for (size_t i = 0; i < candidate_count; i++) {
+        double score = (100 - weight) * candidates[i].size / min_size +
+                       weight * candidates[i].time / min_time;
+        if (!best || score < best_score) {
+            best = &candidates[i];
+            best_score = score;
+        }
+    }
+    *encoding = best->encoding;
+    *compression = best->codec->type;
+    *level = best->codec->level;
+    if (sample)
+        cx_column_free(sample);
+    if (nulls_sample)
+        cx_column_free(nulls_sample);
+    return true;
+error:
+    if (sample)
+        cx_column_free(sample);
+    if (nulls_sample)
+        cx_column_free(nulls_sample);
+    return false;
+}
@@ -0,0 +1,23 @@
+#ifndef CX_AUTO_H_
+#define CX_AUTO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "column.h"
+
+// choose the encoding, compression type and compression level of a column
+// chunk (see CX_COMPRESSION_AUTO). candidates are tried on a sample of the
+// chunk and compared on their size and on an estimate of their decode time,
+// with weight (0-100) given to the decode time. the null bitmap of the chunk
+// is optional, and makes CX_ENCODING_SPARSE a candidate
+bool cx_auto_choose(const struct cx_column *, const struct cx_column *nulls,
+                    int weight, enum cx_encoding_type *,
+                    enum cx_compression_type *, int *level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -35,6 +35,21 @@ static inline int cx_simd_i32_gt(__m128i a, __m128i b)
     return cx_simd_i32_mask(_mm_cmpgt_epi32(b, a));
 }
 
+static inline __m128i cx_simd_i32_min(__m128i a, __m128i b)
+{
+    return _mm_min_epi32(a, b);
+}
+
+static inline __m128i cx_simd_i32_max(__m128i a, __m128i b)
+{
+    return _mm_max_epi32(a, b);
+}
+
+static inline void cx_simd_i32_store(int32_t *ptr, __m128i vec)
+{
+    _mm_storeu_si128((__m128i *)ptr, vec);
+}
+
 static inline __m128i cx_simd_i64_set(int64_t value)
 {
     return _mm_set1_epi64x(value);
@@ -65,6 +80,22 @@ static inline int cx_simd_i64_gt(__m128i a, __m128i b)
     return cx_simd_i64_mask(_mm_cmpgt_epi64(b, a));
 }
 
+// there's no 64-bit integer min or max before AVX-512
+static inline __m128i cx_simd_i64_min(__m128i a, __m128i b)
+{
+    return _mm_blendv_epi8(b, a, _mm_cmpgt_epi64(b, a));
+}
+
+static inline __m128i cx_simd_i64_max(__m128i a, __m128i b)
+{
+    return _mm_blendv_epi8(b, a, _mm_cmpgt_epi64(a, b));
+}
+
+static inline void cx_simd_i64_store(int64_t *ptr, __m128i vec)
+{
+    _mm_storeu_si128((__m128i *)ptr, vec);
+}
+
 static inline __m128 cx_simd_flt_set(float value)
 {
     return _mm_set1_ps(value);
@@ -95,6 +126,22 @@ static inline int cx_simd_flt_gt(__m128 a, __m128 b)
     return cx_simd_flt_mask(_mm_cmp_ps(b, a, _CMP_GT_OQ));
 }
 
+// like the comparisons, min and max return b where a is NaN
+static inline __m128 cx_simd_flt_min(__m128 a, __m128 b)
+{
+    return _mm_min_ps(a, b);
+}
+
+static inline __m128 cx_simd_flt_max(__m128 a, __m128 b)
+{
+    return _mm_max_ps(a, b);
+}
+
+static inline void cx_simd_flt_store(float *ptr, __m128 vec)
+{
+    _mm_storeu_ps(ptr, vec);
+}
+
 static inline __m128d cx_simd_dbl_set(double value)
 {
     return _mm_set1_pd(value);
@@ -124,3 +171,18 @@ static inline int cx_simd_dbl_gt(__m128d a, __m128d b)
 {
     return cx_simd_dbl_mask(_mm_cmp_pd(b, a, _CMP_GT_OQ));
 }
+
+static inline __m128d cx_simd_dbl_min(__m128d a, __m128d b)
+{
+    return _mm_min_pd(a, b);
+}
+
+static inline __m128d cx_simd_dbl_max(__m128d a, __m128d b)
+{
+    return _mm_max_pd(a, b);
+}
+
+static inline void cx_simd_dbl_store(double *ptr, __m128d vec)
+{
+    _mm_storeu_pd(ptr, vec);
+}
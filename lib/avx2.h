@@ -35,6 +35,21 @@ static inline int cx_simd_i32_gt(__m256i a, __m256i b)
     return cx_simd_i32_mask(_mm256_cmpgt_epi32(b, a));
 }
 
+static inline __m256i cx_simd_i32_min(__m256i a, __m256i b)
+{
+    return _mm256_min_epi32(a, b);
+}
+
+static inline __m256i cx_simd_i32_max(__m256i a, __m256i b)
+{
+    return _mm256_max_epi32(a, b);
+}
+
+static inline void cx_simd_i32_store(int32_t *ptr, __m256i vec)
+{
+    _mm256_storeu_si256((__m256i *)ptr, vec);
+}
+
 static inline __m256i cx_simd_i64_set(int64_t value)
 {
     return _mm256_set1_epi64x(value);
@@ -65,6 +80,22 @@ static inline int cx_simd_i64_gt(__m256i a, __m256i b)
     return cx_simd_i64_mask(_mm256_cmpgt_epi64(b, a));
 }
 
+// there's no 64-bit integer min or max before AVX-512
+static inline __m256i cx_simd_i64_min(__m256i a, __m256i b)
+{
+    return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(b, a));
+}
+
+static inline __m256i cx_simd_i64_max(__m256i a, __m256i b)
+{
+    return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+}
+
+static inline void cx_simd_i64_store(int64_t *ptr, __m256i vec)
+{
+    _mm256_storeu_si256((__m256i *)ptr, vec);
+}
+
 static inline __m256 cx_simd_flt_set(float value)
 {
     return _mm256_set1_ps(value);
@@ -95,6 +126,22 @@ static inline int cx_simd_flt_gt(__m256 a, __m256 b)
     return cx_simd_flt_mask(_mm256_cmp_ps(b, a, _CMP_GT_OQ));
 }
 
+// like the comparisons, min and max return b where a is NaN
+static inline __m256 cx_simd_flt_min(__m256 a, __m256 b)
+{
+    return _mm256_min_ps(a, b);
+}
+
+static inline __m256 cx_simd_flt_max(__m256 a, __m256 b)
+{
+    return _mm256_max_ps(a, b);
+}
+
+static inline void cx_simd_flt_store(float *ptr, __m256 vec)
+{
+    _mm256_storeu_ps(ptr, vec);
+}
+
 static inline __m256d cx_simd_dbl_set(double value)
 {
     return _mm256_set1_pd(value);
@@ -124,3 +171,57 @@ static inline int cx_simd_dbl_gt(__m256d a, __m256d b)
 {
     return cx_simd_dbl_mask(_mm256_cmp_pd(b, a, _CMP_GT_OQ));
 }
+
+static inline __m256d cx_simd_dbl_min(__m256d a, __m256d b)
+{
+    return _mm256_min_pd(a, b);
+}
+
+static inline __m256d cx_simd_dbl_max(__m256d a, __m256d b)
+{
+    return _mm256_max_pd(a, b);
+}
+
+static inline void cx_simd_dbl_store(double *ptr, __m256d vec)
+{
+    _mm256_storeu_pd(ptr, vec);
+}
+
+// unpack 64 bit-packed values from width bit planes (most significant
+// plane first). each 4 lane group is built up one plane at a time
+static inline void cx_simd_unpack(size_t width, const uint64_t *planes,
+                                  uint64_t values[64])
+{
+    __m256i lanes = _mm256_set_epi64x(3, 2, 1, 0);
+    __m256i one = _mm256_set1_epi64x(1);
+    for (size_t i = 0; i < 64; i += 4) {
+        __m256i v = _mm256_setzero_si256();
+        for (size_t j = 0; j < width; j++) {
+            __m256i plane = _mm256_set1_epi64x(planes[j] >> i);
+            __m256i bits =
+                _mm256_and_si256(_mm256_srlv_epi64(plane, lanes), one);
+            v = _mm256_or_si256(_mm256_slli_epi64(v, 1), bits);
+        }
+        _mm256_storeu_si256((__m256i *)&values[i], v);
+    }
+}
+
+// inclusive prefix sum of count values, 4 at a time. returns the number
+// of values that were summed (a multiple of 4)
+static inline size_t cx_simd_prefix_sum(size_t count, uint64_t values[])
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i carry = zero;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)&values[i]);
+        __m256i t = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 1, 0, 0));
+        x = _mm256_add_epi64(x, _mm256_blend_epi32(t, zero, 0x03));
+        t = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 0, 0));
+        x = _mm256_add_epi64(x, _mm256_blend_epi32(t, zero, 0x0F));
+        x = _mm256_add_epi64(x, carry);
+        _mm256_storeu_si256((__m256i *)&values[i], x);
+        carry = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    return i;
+}
@@ -22,7 +22,7 @@ static inline int cx_simd_i32_eq(__m512i a, __m512i b)
 
 static inline int cx_simd_i32_lt(__m512i a, __m512i b)
 {
-    return (int)_mm512_cmplt_epi32_mask(a, b);
+    return (int)_mm512_cmpgt_epi32_mask(a, b);
 }
 
 static inline int cx_simd_i32_gt(__m512i a, __m512i b)
@@ -30,6 +30,21 @@ static inline int cx_simd_i32_gt(__m512i a, __m512i b)
     return (int)_mm512_cmpgt_epi32_mask(b, a);
 }
 
+static inline __m512i cx_simd_i32_min(__m512i a, __m512i b)
+{
+    return _mm512_min_epi32(a, b);
+}
+
+static inline __m512i cx_simd_i32_max(__m512i a, __m512i b)
+{
+    return _mm512_max_epi32(a, b);
+}
+
+static inline void cx_simd_i32_store(int32_t *ptr, __m512i vec)
+{
+    _mm512_storeu_si512((void *)ptr, vec);
+}
+
 static inline __m512i cx_simd_i64_set(int64_t value)
 {
     return _mm512_set1_epi64(value);
@@ -47,7 +62,7 @@ static inline int cx_simd_i64_eq(__m512i a, __m512i b)
 
 static inline int cx_simd_i64_lt(__m512i a, __m512i b)
 {
-    return (int)_mm512_cmplt_epi64_mask(a, b);
+    return (int)_mm512_cmpgt_epi64_mask(a, b);
 }
 
 static inline int cx_simd_i64_gt(__m512i a, __m512i b)
@@ -55,6 +70,21 @@ static inline int cx_simd_i64_gt(__m512i a, __m512i b)
     return (int)_mm512_cmpgt_epi64_mask(b, a);
 }
 
+static inline __m512i cx_simd_i64_min(__m512i a, __m512i b)
+{
+    return _mm512_min_epi64(a, b);
+}
+
+static inline __m512i cx_simd_i64_max(__m512i a, __m512i b)
+{
+    return _mm512_max_epi64(a, b);
+}
+
+static inline void cx_simd_i64_store(int64_t *ptr, __m512i vec)
+{
+    _mm512_storeu_si512((void *)ptr, vec);
+}
+
 static inline __m512 cx_simd_flt_set(float value)
 {
     return _mm512_set1_ps(value);
@@ -80,6 +110,22 @@ static inline int cx_simd_flt_gt(__m512 a, __m512 b)
     return (int)_mm512_cmp_ps_mask(b, a, _CMP_GT_OQ);
 }
 
+// like the comparisons, min and max return b where a is NaN
+static inline __m512 cx_simd_flt_min(__m512 a, __m512 b)
+{
+    return _mm512_min_ps(a, b);
+}
+
+static inline __m512 cx_simd_flt_max(__m512 a, __m512 b)
+{
+    return _mm512_max_ps(a, b);
+}
+
+static inline void cx_simd_flt_store(float *ptr, __m512 vec)
+{
+    _mm512_storeu_ps(ptr, vec);
+}
+
 static inline __m512d cx_simd_dbl_set(double value)
 {
     return _mm512_set1_pd(value);
@@ -104,3 +150,54 @@ static inline int cx_simd_dbl_gt(__m512d a, __m512d b)
 {
     return (int)_mm512_cmp_pd_mask(b, a, _CMP_GT_OQ);
 }
+
+static inline __m512d cx_simd_dbl_min(__m512d a, __m512d b)
+{
+    return _mm512_min_pd(a, b);
+}
+
+static inline __m512d cx_simd_dbl_max(__m512d a, __m512d b)
+{
+    return _mm512_max_pd(a, b);
+}
+
+static inline void cx_simd_dbl_store(double *ptr, __m512d vec)
+{
+    _mm512_storeu_pd(ptr, vec);
+}
+
+// unpack 64 bit-packed values from width bit planes (most significant
+// plane first). each byte of a plane masks the lanes of an 8 lane group
+static inline void cx_simd_unpack(size_t width, const uint64_t *planes,
+                                  uint64_t values[64])
+{
+    __m512i one = _mm512_set1_epi64(1);
+    for (size_t i = 0; i < 64; i += 8) {
+        __m512i v = _mm512_setzero_si512();
+        for (size_t j = 0; j < width; j++) {
+            v = _mm512_slli_epi64(v, 1);
+            v = _mm512_mask_or_epi64(v, (__mmask8)(planes[j] >> i), v, one);
+        }
+        _mm512_storeu_si512((void *)&values[i], v);
+    }
+}
+
+// inclusive prefix sum of count values, 8 at a time. returns the number
+// of values that were summed (a multiple of 8)
+static inline size_t cx_simd_prefix_sum(size_t count, uint64_t values[])
+{
+    __m512i zero = _mm512_setzero_si512();
+    __m512i last = _mm512_set1_epi64(7);
+    __m512i carry = zero;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512i x = _mm512_loadu_si512((const void *)&values[i]);
+        x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 7));
+        x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 6));
+        x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 4));
+        x = _mm512_add_epi64(x, carry);
+        _mm512_storeu_si512((void *)&values[i], x);
+        carry = _mm512_permutexvar_epi64(last, x);
+    }
+    return i;
+}
@@ -0,0 +1,84 @@
+#include "bitpack.h"
+
+#include <assert.h>
+#include <string.h>
+
+#ifdef CX_AVX512
+#include "avx512.h"
+#define CX_SIMD_BITPACK 1
+#elif defined(CX_AVX2)
+#include "avx2.h"
+#define CX_SIMD_BITPACK 1
+#endif
+
+unsigned cx_bitpack_width(uint64_t max)
+{
+    return max ? 64 - __builtin_clzll(max) : 0;
+}
+
+size_t cx_bitpack_size(size_t count, unsigned width)
+{
+    assert(count <= 64);
+    return count ? width : 0;
+}
+
+void cx_bitpack_pack(size_t count, const uint64_t values[], unsigned width,
+                     uint64_t *planes)
+{
+    assert(count <= 64 && width <= 64);
+    if (!count)
+        return;
+    for (size_t j = 0; j < width; j++) {
+        unsigned shift = width - 1 - j;
+        uint64_t plane = 0;
+        for (size_t i = 0; i < count; i++)
+            plane |= ((values[i] >> shift) & 1) << i;
+        planes[j] = plane;
+    }
+}
+
+void cx_bitpack_unpack(size_t count, const uint64_t *planes, unsigned width,
+                       uint64_t values[])
+{
+    assert(count <= 64 && width <= 64);
+#ifdef CX_SIMD_BITPACK
+    if (count == 64) {
+        cx_simd_unpack(width, planes, values);
+    } else if (count) {
+        uint64_t buffer[64];
+        cx_simd_unpack(width, planes, buffer);
+        memcpy(values, buffer, count * sizeof(*values));
+    }
+#else
+    for (size_t i = 0; i < count; i++) {
+        uint64_t value = 0;
+        for (size_t j = 0; j < width; j++)
+            value = (value << 1) | ((planes[j] >> i) & 1);
+        values[i] = value;
+    }
+#endif
+}
+
+void cx_prefix_sum(size_t count, uint64_t values[])
+{
+    size_t i = 0;
+#ifdef CX_SIMD_BITPACK
+    i = cx_simd_prefix_sum(count, values);
+#endif
+    if (!i)
+        i = 1;
+    for (; i < count; i++)
+        values[i] += values[i - 1];
+}
+
+void cx_bitset_set_range(uint64_t *bitset, size_t offset, size_t length)
+{
+    while (length) {
+        size_t shift = offset % 64;
+        size_t bits = 64 - shift < length ? 64 - shift : length;
+        uint64_t mask = bits == 64 ? UINT64_MAX : ((uint64_t)1 << bits) - 1;
+        bitset[offset / 64] |= mask << shift;
+        offset += bits;
+        length -= bits;
+    }
+}
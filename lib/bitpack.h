@@ -0,0 +1,37 @@
+#ifndef CX_BITPACK_H_
+#define CX_BITPACK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "common.h"
+
+// values are bit-packed in blocks of up to 64. a block of values that are
+// each width bits wide is stored as width 64-bit planes, most significant
+// plane first, where bit i of plane j is bit (width - 1 - j) of value i
+
+// the number of bits required to represent every value <= max
+unsigned cx_bitpack_width(uint64_t max);
+
+// the number of words required to pack count values of the given width
+size_t cx_bitpack_size(size_t count, unsigned width);
+
+void cx_bitpack_pack(size_t count, const uint64_t values[], unsigned width,
+                     uint64_t *planes);
+
+void cx_bitpack_unpack(size_t count, const uint64_t *planes, unsigned width,
+                       uint64_t values[]);
+
+// replace each value with the (wrapping) sum of itself and all preceding
+// values
+void cx_prefix_sum(size_t count, uint64_t values[]);
+
+// set bits [offset, offset + length) of a bitset that spans several words
+void cx_bitset_set_range(uint64_t *bitset, size_t offset, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,6 +8,13 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include "bitpack.h"
+#include "file.h"
+#include "fsst.h"
+#include "index.h"
+#include "pool.h"
+#include "split.h"
+
 // when SSE4.2 optimizations are enabled, we make sure there are
 // at least 16 initialized bytes after each column value
 #if CX_SSE42
@@ -17,6 +24,10 @@
 
 static const size_t cx_column_initial_size = 64;
 
+// the tail of a growing buffer is initialized this many bytes at a time, so
+// that the unused part of the allocation isn't touched
+#define CX_COLUMN_INIT_SPAN 4096
+
 // 列定义
 struct cx_column {
     union {
@@ -25,10 +36,14 @@ struct cx_column {
     } buffer;
     size_t count;
     size_t offset;
-    size_t size;
+    size_t size;      // 已初始化的字节数
+    size_t capacity;  // 已分配的字节数
     enum cx_column_type type;
     enum cx_encoding_type encoding;
     bool mmapped;  // 是否 memory mmap
+    bool pooled;   // 缓冲区是否来自缓冲池
+    struct cx_index index;  // 追加值时维护的统计信息
+    bool indexed;           // index 是否覆盖所有值
 };
 
 // 列浮标
@@ -37,9 +52,32 @@ struct cx_column_cursor {
     const void *start;                 // 开始位置
     const void *end;                   // 结束位置
     const void *position;              // 当前位置
-    cx_value_t buffer[CX_BATCH_SIZE];  // 缓存
+    size_t batch_size;                 // 每批的行数
+    cx_value_t *buffer;                // 缓存
+    struct cx_string *dict;            // 字典编码列的字典
+    size_t dict_size;
+    size_t run_offset;                 // 当前 run 已读取的值数量
+    struct cx_run *runs;
+    const uint64_t *packed;            // 差分编码列的 bit-packed 数据
+    size_t packed_size;
+    size_t block_offset;               // 当前 block 已读取的值数量
+    int64_t base;                      // 位压缩列的参考值
+    unsigned width;                    // 位压缩列的位宽
+    const char *strings;               // 偏移量编码列的字符串
+    struct cx_fsst_table *fsst;        // FSST 编码列的符号表
+    struct cx_string *compressed;
+    char *decoded;                     // FSST 编码列解压后的字符串
+    size_t decoded_size;
+    const uint32_t *positions;         // 稀疏编码列非空行的位置
+    size_t position_count;
+    size_t position_offset;            // 下一个非空行的下标
+    const char *values;                // 稀疏编码列非空行的值
+    const char *value;                 // 当前字符串值
+    size_t value_index;                // value 对应的非空行下标
 };
 
+static const char cx_column_empty_string[16] = {0};
+
 static struct cx_column *cx_column_new_size(enum cx_column_type type,
                                             enum cx_encoding_type encoding,
                                             size_t size, size_t count)
@@ -59,6 +97,7 @@ static struct cx_column *cx_column_new_size(enum cx_column_type type,
         memset(column->buffer.mutable, 0, size);
 #endif
         column->size = size;
+        column->capacity = size;
     }
     column->type = type;
     column->encoding = encoding;
@@ -72,7 +111,13 @@ error:
 struct cx_column *cx_column_new(enum cx_column_type type,
                                 enum cx_encoding_type encoding)
 {
-    return cx_column_new_size(type, encoding, cx_column_initial_size, 0);
+    struct cx_column *column =
+        cx_column_new_size(type, encoding, cx_column_initial_size, 0);
+    if (column && encoding == CX_ENCODING_NONE) {
+        cx_index_init(&column->index, type);
+        column->indexed = true;
+    }
+    return column;
 }
 
 struct cx_column *cx_column_new_mmapped(enum cx_column_type type,
@@ -85,6 +130,7 @@ struct cx_column *cx_column_new_mmapped(enum cx_column_type type,
         return NULL;
     column->offset = size;
     column->size = size;
+    column->capacity = size;
     column->mmapped = true;
     column->buffer.mmapped = ptr;
     return column;
@@ -105,9 +151,41 @@ struct cx_column *cx_column_new_compressed(enum cx_column_type type,
     return column;
 }
 
+struct cx_column *cx_column_new_decompressed(enum cx_column_type type,
+                                             enum cx_encoding_type encoding,
+                                             void **ptr, size_t size,
+                                             size_t count)
+{
+    if (!size)
+        return NULL;
+    struct cx_column *column = cx_column_new_size(type, encoding, 0, count);
+    if (!column)
+        return NULL;
+    size_t buffer_size = size;
+#ifdef CX_COLUMN_OVER_ALLOC
+    buffer_size += CX_COLUMN_OVER_ALLOC;
+#endif
+    column->buffer.mutable = cx_pool_get(buffer_size, &column->capacity);
+    if (!column->buffer.mutable) {
+        free(column);
+        return NULL;
+    }
+#ifdef CX_COLUMN_OVER_ALLOC
+    // the caller fills the first size bytes
+    memset((char *)column->buffer.mutable + size, 0, CX_COLUMN_OVER_ALLOC);
+#endif
+    column->pooled = true;
+    column->size = buffer_size;
+    column->offset = size;
+    *ptr = column->buffer.mutable;
+    return column;
+}
+
 void cx_column_free(struct cx_column *column)
 {
-    if (!column->mmapped)
+    if (column->pooled)
+        cx_pool_put(column->buffer.mutable, column->capacity);
+    else if (!column->mmapped)
         free(column->buffer.mutable);
     free(column);
 }
@@ -153,40 +231,133 @@ size_t cx_column_count(const struct cx_column *column)
     return column->count;
 }
 
+const struct cx_index *cx_column_index(const struct cx_column *column)
+{
+    return column->indexed ? &column->index : NULL;
+}
+
+static void cx_column_index_values(struct cx_column *column,
+                                   const void *values, size_t count)
+{
+    switch (column->type) {
+        case CX_COLUMN_BIT:
+            cx_index_update_bit(&column->index, values, count);
+            break;
+        case CX_COLUMN_I32:
+            cx_index_update_i32(&column->index, values, count);
+            break;
+        case CX_COLUMN_I64:
+            cx_index_update_i64(&column->index, values, count);
+            break;
+        case CX_COLUMN_FLT:
+            cx_index_update_flt(&column->index, values, count);
+            break;
+        case CX_COLUMN_DBL:
+            cx_index_update_dbl(&column->index, values, count);
+            break;
+        case CX_COLUMN_STR: {
+            const char *strings = values;
+            for (size_t i = 0; i < count; i++) {
+                struct cx_string value = {strings, strlen(strings)};
+                cx_index_update_str(&column->index, &value, 1);
+                strings += value.len + 1;
+            }
+        } break;
+    }
+}
+
+static bool cx_column_grow(struct cx_column *column, size_t capacity)
+{
+    void *buffer = realloc(column->buffer.mutable, capacity);
+    if (!buffer)
+        return false;
+    column->buffer.mutable = buffer;
+    column->capacity = capacity;
+#ifndef CX_COLUMN_OVER_ALLOC
+    column->size = capacity;
+#endif
+    return true;
+}
+
 __attribute__((noinline)) static bool cx_column_resize(struct cx_column *column,
                                                        size_t alloc_size)
 {
-    size_t size = column->size;
     size_t required_size = column->offset + alloc_size;
 #ifdef CX_COLUMN_OVER_ALLOC
     required_size += CX_COLUMN_OVER_ALLOC;
 #endif
-    while (size < required_size) {
-        assert(size * 2 > size);
-        size *= 2;
+    if (required_size > column->capacity) {
+        size_t capacity = column->capacity;
+        while (capacity < required_size) {
+            assert(capacity * 2 > capacity);
+            capacity *= 2;
+        }
+        if (!cx_column_grow(column, capacity))
+            return false;
     }
-    void *buffer = realloc(column->buffer.mutable, size);
-    if (!buffer)
-        return false;
 #ifdef CX_COLUMN_OVER_ALLOC
-    memset((void *)((uintptr_t)buffer + column->offset), 0,
-           size - column->offset);
-#endif
-    column->buffer.mutable = buffer;
+    // only the bytes after the last value need to be initialized
+    size_t size = required_size + CX_COLUMN_INIT_SPAN;
+    if (size > column->capacity)
+        size = column->capacity;
+    memset((void *)((uintptr_t)column->buffer.mutable + column->size), 0,
+           size - column->size);
     column->size = size;
+#endif
     return true;
 }
 
+bool cx_column_reserve(struct cx_column *column, size_t count)
+{
+    if (column->mmapped || column->encoding != CX_ENCODING_NONE)
+        return false;
+    size_t size;
+    switch (column->type) {
+        case CX_COLUMN_BIT:
+            size = (count + 63) / 64 * sizeof(uint64_t);
+            break;
+        case CX_COLUMN_I32:
+        case CX_COLUMN_FLT:
+            size = count * sizeof(int32_t);
+            break;
+        case CX_COLUMN_I64:
+        case CX_COLUMN_DBL:
+            size = count * sizeof(int64_t);
+            break;
+        default:
+            return true;  // variable width
+    }
+    size += column->offset;
+#ifdef CX_COLUMN_OVER_ALLOC
+    size += CX_COLUMN_OVER_ALLOC;
+#endif
+    if (size <= column->capacity)
+        return true;
+    return cx_column_grow(column, size);
+}
+
+void cx_column_reset(struct cx_column *column)
+{
+    assert(!column->mmapped);
+    // the buffer is kept, and bytes that were written stay initialized
+    column->count = 0;
+    column->offset = 0;
+    cx_index_init(&column->index, column->type);
+    column->indexed = column->encoding == CX_ENCODING_NONE;
+}
+
 static bool cx_column_put(struct cx_column *column, enum cx_column_type type,
                           const void *value, size_t size)
 {
-    if (column->mmapped || column->type != type || !value)
+    if (column->mmapped || column->type != type ||
+        column->encoding != CX_ENCODING_NONE || !value)
         return false;
     if (column->offset + size > column->size)
         if (!cx_column_resize(column, size))
             return false;
     void *slot = (void *)cx_column_tail(column);
     memcpy(slot, value, size);
+    cx_column_index_values(column, slot, 1);
     column->count++;
     column->offset += size;
     return true;
@@ -197,13 +368,16 @@ bool cx_column_put_bit(struct cx_column *column, bool value)
     if (column->count % 64 == 0) {
         uint64_t bitset = value != 0;
         return cx_column_put(column, CX_COLUMN_BIT, &bitset, sizeof(uint64_t));
-    } else if (column->type != CX_COLUMN_BIT || column->mmapped)
+    } else if (column->type != CX_COLUMN_BIT || column->mmapped ||
+               column->encoding != CX_ENCODING_NONE)
         return false;
-    if (value) {
+    uint64_t bit = value != 0;
+    if (bit) {
         uint64_t *bitset = (uint64_t *)cx_column_offset(
             column, column->offset - sizeof(uint64_t));
-        *bitset |= (uint64_t)1 << column->count;
+        *bitset |= bit << (column->count % 64);
     }
+    cx_index_update_bit(&column->index, &bit, 1);
     column->count++;
     return true;
 }
@@ -252,6 +426,218 @@ bool cx_column_put_unit(struct cx_column *column)
     return false;
 }
 
+static bool cx_column_appendable(const struct cx_column *column,
+                                 enum cx_column_type type)
+{
+    return !column->mmapped && column->type == type &&
+           column->encoding == CX_ENCODING_NONE;
+}
+
+bool cx_column_put_bit_array(struct cx_column *column, const uint64_t *values,
+                             const uint64_t *nulls, size_t count)
+{
+    if (!cx_column_appendable(column, CX_COLUMN_BIT))
+        return false;
+    size_t words = (column->count + count + 63) / 64;
+    size_t size = words * sizeof(uint64_t) - column->offset;
+    if (column->offset + size > column->size)
+        if (!cx_column_resize(column, size))
+            return false;
+    uint64_t *bitset = (uint64_t *)cx_column_head(column);
+    size_t position = column->count;
+    for (size_t i = 0; i < count; i += 64) {
+        uint64_t word = values ? values[i / 64] : 0;
+        if (nulls)
+            word &= ~nulls[i / 64];
+        size_t bits = count - i < 64 ? count - i : 64;
+        if (bits < 64)
+            word &= ((uint64_t)1 << bits) - 1;
+        cx_index_update_bit(&column->index, &word, bits);
+        size_t index = position / 64, shift = position % 64;
+        if (!shift) {
+            bitset[index] = word;
+        } else {
+            bitset[index] |= word << shift;
+            if (bits > 64 - shift)
+                bitset[index + 1] = word >> (64 - shift);
+        }
+        position += bits;
+    }
+    column->count += count;
+    column->offset += size;
+    return true;
+}
+
+static bool cx_column_put_array(struct cx_column *column,
+                                enum cx_column_type type, const void *values,
+                                const uint64_t *nulls, size_t width,
+                                size_t count)
+{
+    if (!cx_column_appendable(column, type) || (count && !values))
+        return false;
+    size_t size = count * width;
+    if (column->offset + size > column->size)
+        if (!cx_column_resize(column, size))
+            return false;
+    char *tail = (char *)cx_column_tail(column);
+    memcpy(tail, values, size);
+    // null rows hold zero, as with cx_column_put_unit
+    for (size_t i = 0; nulls && i < count; i += 64) {
+        uint64_t word = nulls[i / 64];
+        if (count - i < 64)
+            word &= ((uint64_t)1 << (count - i)) - 1;
+        for (; word; word &= word - 1)
+            memset(tail + (i + __builtin_ctzll(word)) * width, 0, width);
+    }
+    cx_column_index_values(column, tail, count);
+    column->count += count;
+    column->offset += size;
+    return true;
+}
+
+bool cx_column_put_i32_array(struct cx_column *column, const int32_t *values,
+                             const uint64_t *nulls, size_t count)
+{
+    return cx_column_put_array(column, CX_COLUMN_I32, values, nulls,
+                               sizeof(int32_t), count);
+}
+
+bool cx_column_put_i64_array(struct cx_column *column, const int64_t *values,
+                             const uint64_t *nulls, size_t count)
+{
+    return cx_column_put_array(column, CX_COLUMN_I64, values, nulls,
+                               sizeof(int64_t), count);
+}
+
+bool cx_column_put_flt_array(struct cx_column *column, const float *values,
+                             const uint64_t *nulls, size_t count)
+{
+    return cx_column_put_array(column, CX_COLUMN_FLT, values, nulls,
+                               sizeof(float), count);
+}
+
+bool cx_column_put_dbl_array(struct cx_column *column, const double *values,
+                             const uint64_t *nulls, size_t count)
+{
+    return cx_column_put_array(column, CX_COLUMN_DBL, values, nulls,
+                               sizeof(double), count);
+}
+
+bool cx_column_put_str_array(struct cx_column *column, const uint32_t *offsets,
+                             const char *data, const uint64_t *nulls,
+                             size_t count)
+{
+    if (!cx_column_appendable(column, CX_COLUMN_STR) ||
+        (count && (!offsets || !data)))
+        return false;
+    // null rows are stored as "" whatever their offsets. strings are
+    // stored NUL-terminated, so they can't contain a NUL byte
+    size_t size = count;
+    for (size_t i = 0; i < count; i++) {
+        if (offsets[i + 1] < offsets[i])
+            return false;
+        if (nulls && nulls[i / 64] & ((uint64_t)1 << (i % 64)))
+            continue;
+        size_t length = offsets[i + 1] - offsets[i];
+        if (memchr(data + offsets[i], 0, length))
+            return false;
+        size += length;
+    }
+    if (column->offset + size > column->size)
+        if (!cx_column_resize(column, size))
+            return false;
+    char *tail = (char *)cx_column_tail(column);
+    for (size_t i = 0; i < count; i++) {
+        size_t length = offsets[i + 1] - offsets[i];
+        if (nulls && nulls[i / 64] & ((uint64_t)1 << (i % 64)))
+            length = 0;
+        memcpy(tail, data + offsets[i], length);
+        tail[length] = 0;
+        struct cx_string value = {tail, length};
+        cx_index_update_str(&column->index, &value, 1);
+        tail += length + 1;
+    }
+    column->count += count;
+    column->offset += size;
+    return true;
+}
+
+bool cx_column_split(struct cx_column *column, size_t start,
+                     struct cx_column *dest)
+{
+    if (!cx_column_appendable(column, column->type) ||
+        !cx_column_appendable(dest, column->type) || start > column->count)
+        return false;
+    size_t count = column->count - start;
+    size_t offset;
+    switch (column->type) {
+        case CX_COLUMN_BIT: {
+            // realign the bits that move to the start of a word
+            const uint64_t *bitset = cx_column_head(column);
+            size_t words = (column->count + 63) / 64;
+            uint64_t *moved = malloc((count + 63) / 64 * sizeof(uint64_t));
+            if (count && !moved)
+                return false;
+            for (size_t i = 0; i < count; i += 64) {
+                size_t index = (start + i) / 64, shift = (start + i) % 64;
+                uint64_t word = bitset[index] >> shift;
+                if (shift && index + 1 < words)
+                    word |= bitset[index + 1] << (64 - shift);
+                moved[i / 64] = word;
+            }
+            bool ok = cx_column_put_bit_array(dest, moved, NULL, count);
+            free(moved);
+            if (!ok)
+                return false;
+            offset = (start + 63) / 64 * sizeof(uint64_t);
+            // bits after the last value are expected to be clear
+            if (start % 64) {
+                uint64_t *last = (uint64_t *)cx_column_offset(
+                    column, offset - sizeof(uint64_t));
+                *last &= ((uint64_t)1 << (start % 64)) - 1;
+            }
+            break;
+        }
+        case CX_COLUMN_I32:
+        case CX_COLUMN_FLT:
+            offset = start * sizeof(int32_t);
+            break;
+        case CX_COLUMN_I64:
+        case CX_COLUMN_DBL:
+            offset = start * sizeof(int64_t);
+            break;
+        case CX_COLUMN_STR: {
+            const char *strings = cx_column_head(column);
+            offset = 0;
+            for (size_t i = 0; i < start; i++)
+                offset += strlen(strings + offset) + 1;
+            break;
+        }
+        default:
+            return false;
+    }
+    if (column->type != CX_COLUMN_BIT) {
+        size_t size = column->offset - offset;
+        if (dest->offset + size > dest->size)
+            if (!cx_column_resize(dest, size))
+                return false;
+        void *tail = (void *)cx_column_tail(dest);
+        memcpy(tail, cx_column_offset(column, offset), size);
+        cx_column_index_values(dest, tail, count);
+        dest->count += count;
+        dest->offset += size;
+    }
+    column->count = start;
+    column->offset = offset;
+    // the statistics of the values left would need another pass, which
+    // cx_index_new makes if asked
+    if (count && start)
+        column->indexed = false;
+    else if (count)
+        cx_column_reset(column);
+    return true;
+}
+
 static bool cx_column_madvise(const struct cx_column *column, int advice)
 {
     if (!column->mmapped || !column->size)
@@ -262,31 +648,498 @@ static bool cx_column_madvise(const struct cx_column *column, int advice)
     return !madvise((void *)(addr - offset), (column->size + offset), advice);
 }
 
+static bool cx_column_cursor_load_dict(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    if (column->type != CX_COLUMN_STR)
+        return false;
+    const struct cx_dict_header *header = cursor->start;
+    size_t size = column->offset;
+    if (size < sizeof(*header) || header->size > size - sizeof(*header))
+        return false;
+    const char *strings = (const char *)(header + 1);
+    const char *codes_ptr = strings + header->size;
+    size_t codes_size = size - sizeof(*header) - header->size;
+    if (codes_size != column->count * sizeof(int32_t))
+        return false;
+    if (header->count) {
+        cursor->dict = malloc(header->count * sizeof(*cursor->dict));
+        if (!cursor->dict)
+            return false;
+    }
+    const char *string = strings;
+    for (size_t i = 0; i < header->count; i++) {
+        size_t remaining = codes_ptr - string;
+        size_t len = strnlen(string, remaining);
+        if (len == remaining)
+            return false;
+        cursor->dict[i].ptr = string;
+        cursor->dict[i].len = len;
+        string += len + 1;
+    }
+    cursor->dict_size = header->count;
+    const int32_t *codes = (const int32_t *)codes_ptr;
+    for (size_t i = 0; i < column->count; i++)
+        if (codes[i] < 0 || (size_t)codes[i] >= cursor->dict_size)
+            return false;
+    cursor->start = codes;
+    return true;
+}
+
+static void cx_column_cursor_advance(struct cx_column_cursor *cursor,
+                                     size_t size)
+{
+    cursor->position = (void *)((uintptr_t)cursor->position + size);
+    assert(cursor->position <= cursor->end);
+}
+
+static size_t cx_column_run_size(enum cx_column_type type)
+{
+    return type == CX_COLUMN_I64 ? sizeof(struct cx_rle_run64)
+                                 : sizeof(struct cx_rle_run32);
+}
+
+static void cx_column_cursor_run(const struct cx_column_cursor *cursor,
+                                 cx_value_t *value, size_t *length)
+{
+    switch (cursor->column->type) {
+        case CX_COLUMN_BIT: {
+            const struct cx_rle_run32 *run = cursor->position;
+            value->bit = run->value != 0;
+            *length = run->length;
+        } break;
+        case CX_COLUMN_I32: {
+            const struct cx_rle_run32 *run = cursor->position;
+            value->i32 = run->value;
+            *length = run->length;
+        } break;
+        case CX_COLUMN_I64: {
+            const struct cx_rle_run64 *run = cursor->position;
+            value->i64 = run->value;
+            *length = run->length;
+        } break;
+        default:
+            assert(0);
+    }
+}
+
+static bool cx_column_cursor_check_runs(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    if (column->type != CX_COLUMN_BIT && column->type != CX_COLUMN_I32 &&
+        column->type != CX_COLUMN_I64)
+        return false;
+    size_t run_size = cx_column_run_size(column->type);
+    if (column->offset % run_size)
+        return false;
+    size_t count = 0;
+    for (cursor->position = cursor->start; cursor->position < cursor->end;
+         cx_column_cursor_advance(cursor, run_size)) {
+        cx_value_t value;
+        size_t length;
+        cx_column_cursor_run(cursor, &value, &length);
+        if (!length || count + length < count)
+            return false;
+        count += length;
+    }
+    return count == column->count;
+}
+
+// delta, bit-packed and XOR columns are split into fixed size blocks of rows
+static bool cx_column_blocked(const struct cx_column *column)
+{
+    return column->encoding == CX_ENCODING_DELTA ||
+           column->encoding == CX_ENCODING_DELTA_OF_DELTA ||
+           column->encoding == CX_ENCODING_BITPACK ||
+           column->encoding == CX_ENCODING_XOR;
+}
+
+static size_t cx_column_block_rows(const struct cx_column *column)
+{
+    switch (column->encoding) {
+        case CX_ENCODING_BITPACK:
+            return CX_BITPACK_BLOCK_SIZE;
+        case CX_ENCODING_XOR:
+            return CX_XOR_BLOCK_SIZE;
+        default:
+            return CX_DELTA_BLOCK_SIZE;
+    }
+}
+
+static size_t cx_column_block_count(const struct cx_column *column)
+{
+    size_t rows = cx_column_block_rows(column);
+    return (column->count + rows - 1) / rows;
+}
+
+static size_t cx_column_block_size(const struct cx_column *column,
+                                   size_t block_index)
+{
+    size_t rows = cx_column_block_rows(column);
+    size_t remaining = column->count - block_index * rows;
+    return remaining < rows ? remaining : rows;
+}
+
+// the number of values bit-packed in a block of the given size
+static size_t cx_column_block_packed_count(const struct cx_column *column,
+                                           size_t size)
+{
+    size_t unpacked = column->encoding == CX_ENCODING_DELTA ? 1 : 2;
+    return size > unpacked ? size - unpacked : 0;
+}
+
+static bool cx_column_cursor_check_blocks(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    if (column->type != CX_COLUMN_I64)
+        return false;
+    size_t block_count = cx_column_block_count(column);
+    size_t blocks_size = block_count * sizeof(struct cx_delta_block);
+    if (column->offset < blocks_size ||
+        (column->offset - blocks_size) % sizeof(uint64_t))
+        return false;
+    const struct cx_delta_block *blocks = cursor->start;
+    cursor->end = &blocks[block_count];
+    cursor->packed = cursor->end;
+    cursor->packed_size = (column->offset - blocks_size) / sizeof(uint64_t);
+    for (size_t i = 0; i < block_count; i++) {
+        if (blocks[i].width > 64)
+            return false;
+        size_t packed_count = cx_column_block_packed_count(
+            column, cx_column_block_size(column, i));
+        size_t size = cx_bitpack_size(packed_count, blocks[i].width);
+        if (blocks[i].offset > cursor->packed_size ||
+            size > cursor->packed_size - blocks[i].offset)
+            return false;
+    }
+    return true;
+}
+
+static bool cx_column_cursor_check_bitpack(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    if (column->type != CX_COLUMN_I32 && column->type != CX_COLUMN_I64)
+        return false;
+    if (column->offset < sizeof(struct cx_bitpack_header))
+        return false;
+    const struct cx_bitpack_header *header = cursor->start;
+    if (!header->width || header->width > 64)
+        return false;
+    if (column->type == CX_COLUMN_I32 &&
+        (header->width > 32 || header->base < INT32_MIN ||
+         header->base > INT32_MAX))
+        return false;
+    size_t block_count = cx_column_block_count(column);
+    if (column->offset != sizeof(*header) + block_count * header->width *
+                                                 sizeof(uint64_t))
+        return false;
+    cursor->base = header->base;
+    cursor->width = header->width;
+    cursor->start = header + 1;
+    return true;
+}
+
+static bool cx_column_cursor_check_xor(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    if (column->type != CX_COLUMN_FLT && column->type != CX_COLUMN_DBL)
+        return false;
+    size_t block_count = cx_column_block_count(column);
+    size_t blocks_size = block_count * sizeof(struct cx_xor_block);
+    if (column->offset < blocks_size ||
+        (column->offset - blocks_size) % sizeof(uint64_t))
+        return false;
+    const struct cx_xor_block *blocks = cursor->start;
+    cursor->end = &blocks[block_count];
+    cursor->packed = cursor->end;
+    cursor->packed_size = (column->offset - blocks_size) / sizeof(uint64_t);
+    for (size_t i = 0; i < block_count; i++)
+        if (blocks[i].offset > cursor->packed_size ||
+            blocks[i].size > cursor->packed_size - blocks[i].offset)
+            return false;
+    return true;
+}
+
+static bool cx_column_cursor_check_offsets(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    if (column->type != CX_COLUMN_STR)
+        return false;
+    size_t offsets_size = (column->count + 1) * sizeof(uint32_t);
+    if (column->offset < offsets_size)
+        return false;
+    const uint32_t *offsets = cursor->start;
+    const char *strings = (const char *)&offsets[column->count + 1];
+    if (offsets[0] || offsets[column->count] != column->offset - offsets_size)
+        return false;
+    // each string must be NUL-terminated
+    for (size_t i = 0; i < column->count; i++)
+        if (offsets[i + 1] <= offsets[i] || strings[offsets[i + 1] - 1])
+            return false;
+    cursor->strings = strings;
+    cursor->end = &offsets[column->count];
+    return true;
+}
+
+static bool cx_column_cursor_load_fsst(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    if (column->type != CX_COLUMN_STR)
+        return false;
+    const struct cx_fsst_header *header = cursor->start;
+    size_t size = column->offset;
+    if (size < sizeof(*header) || header->symbol_count > CX_FSST_SYMBOLS)
+        return false;
+    size_t symbol_count = header->symbol_count;
+    size_t table_size =
+        sizeof(*header) + symbol_count * 8 + (symbol_count + 7) / 8 * 8;
+    size_t offsets_size = (column->count + 1) * sizeof(uint32_t);
+    if (size < table_size || size - table_size < offsets_size)
+        return false;
+    const uint8_t(*symbols)[8] = (const uint8_t(*)[8])(header + 1);
+    const uint8_t *lengths = symbols[symbol_count];
+    const uint32_t *offsets =
+        (const uint32_t *)((const char *)header + table_size);
+    if (offsets[0] ||
+        offsets[column->count] != size - table_size - offsets_size)
+        return false;
+    for (size_t i = 0; i < column->count; i++)
+        if (offsets[i + 1] < offsets[i])
+            return false;
+    cursor->fsst = malloc(sizeof(*cursor->fsst));
+    if (!cursor->fsst ||
+        !cx_fsst_load(cursor->fsst, symbol_count, symbols, lengths))
+        return false;
+    cursor->start = offsets;
+    cursor->end = &offsets[column->count];
+    cursor->strings = (const char *)&offsets[column->count + 1];
+    return true;
+}
+
+static bool cx_column_cursor_check_split(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    if (column->type != CX_COLUMN_FLT && column->type != CX_COLUMN_DBL)
+        return false;
+    size_t width =
+        column->type == CX_COLUMN_DBL ? sizeof(double) : sizeof(float);
+    return column->offset == column->count * width;
+}
+
+static void cx_column_cursor_fill(struct cx_column_cursor *cursor,
+                                  const void *value, size_t width)
+{
+    for (size_t i = 0; i < cursor->batch_size; i++)
+        memcpy((char *)cursor->buffer + i * width, value, width);
+}
+
+// every batch of a constant column is served from the cursor buffer,
+// which is filled with the value up front
+static bool cx_column_cursor_load_constant(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    const void *value = cursor->start;
+    if (!column->count)
+        return false;
+    switch (column->type) {
+        case CX_COLUMN_BIT: {
+            if (column->offset != sizeof(uint64_t))
+                return false;
+            uint64_t word = *(const uint64_t *)value;
+            if (word && word != UINT64_MAX)
+                return false;
+            uint64_t *words = (uint64_t *)cursor->buffer;
+            for (size_t i = 0; i < cursor->batch_size / 64; i++)
+                words[i] = word;
+            break;
+        }
+        case CX_COLUMN_I32:
+        case CX_COLUMN_FLT:
+            if (column->offset != sizeof(int32_t))
+                return false;
+            cx_column_cursor_fill(cursor, value, sizeof(int32_t));
+            break;
+        case CX_COLUMN_I64:
+        case CX_COLUMN_DBL:
+            if (column->offset != sizeof(int64_t))
+                return false;
+            cx_column_cursor_fill(cursor, value, sizeof(int64_t));
+            break;
+        case CX_COLUMN_STR: {
+            const char *string = value;
+            if (!column->offset || string[column->offset - 1] ||
+                strlen(string) != column->offset - 1)
+                return false;
+            struct cx_string constant = {string, column->offset - 1};
+            cx_column_cursor_fill(cursor, &constant, sizeof(constant));
+            break;
+        }
+    }
+    return true;
+}
+
+static size_t cx_column_value_width(enum cx_column_type type)
+{
+    switch (type) {
+        case CX_COLUMN_I32:
+        case CX_COLUMN_FLT:
+            return sizeof(int32_t);
+        case CX_COLUMN_I64:
+        case CX_COLUMN_DBL:
+            return sizeof(int64_t);
+        default:
+            return 0;
+    }
+}
+
+static bool cx_column_cursor_load_sparse(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    if (column->type == CX_COLUMN_BIT || !column->count)
+        return false;
+    const struct cx_sparse_header *header = cursor->start;
+    size_t size = column->offset;
+    if (size < sizeof(*header) || header->count > column->count)
+        return false;
+    size_t positions_size = sizeof(*header) + header->count * sizeof(uint32_t);
+    size_t values_offset =
+        (positions_size + CX_WRITE_ALIGN - 1) / CX_WRITE_ALIGN * CX_WRITE_ALIGN;
+    if (size < values_offset)
+        return false;
+    const uint32_t *positions = (const uint32_t *)(header + 1);
+    for (size_t i = 0; i < header->count; i++)
+        if (positions[i] >= column->count ||
+            (i && positions[i] <= positions[i - 1]))
+            return false;
+    const char *values = (const char *)cursor->start + values_offset;
+    size_t values_size = size - values_offset;
+    if (column->type == CX_COLUMN_STR) {
+        // there must be a NUL-terminated string for each position
+        const char *end = values + values_size;
+        const char *value = values;
+        for (size_t i = 0; i < header->count; i++) {
+            const char *nul = memchr(value, 0, end - value);
+            if (!nul)
+                return false;
+            value = nul + 1;
+        }
+        if (value != end)
+            return false;
+    } else if (values_size != header->count * cx_column_value_width(
+                                                  column->type)) {
+        return false;
+    }
+    cursor->positions = positions;
+    cursor->position_count = header->count;
+    cursor->values = values;
+    return true;
+}
+
 struct cx_column_cursor *cx_column_cursor_new(const struct cx_column *column)
 {
-    struct cx_column_cursor *cursor = malloc(sizeof(*cursor));
+    return cx_column_cursor_new_batched(column, CX_BATCH_SIZE);
+}
+
+struct cx_column_cursor *cx_column_cursor_new_batched(
+    const struct cx_column *column, size_t batch_size)
+{
+    if (!batch_size || batch_size % CX_BATCH_SIZE ||
+        batch_size > CX_BATCH_SIZE_MAX)
+        return NULL;
+    struct cx_column_cursor *cursor = calloc(1, sizeof(*cursor));
     if (!cursor)
         return NULL;
     cursor->column = column;
+    cursor->batch_size = batch_size;
+    cursor->buffer = malloc(batch_size * sizeof(*cursor->buffer));
+    if (!cursor->buffer)
+        goto error;
+    if (column->encoding == CX_ENCODING_RLE) {
+        cursor->runs = malloc(batch_size * sizeof(*cursor->runs));
+        if (!cursor->runs)
+            goto error;
+    } else if (column->encoding == CX_ENCODING_FSST) {
+        cursor->compressed = malloc(batch_size * sizeof(*cursor->compressed));
+        if (!cursor->compressed)
+            goto error;
+    }
     cursor->start = cx_column_head(column);
     cursor->end = cx_column_tail(column);
     if (!cx_column_madvise(column, MADV_SEQUENTIAL))
         goto error;
+    switch (column->encoding) {
+        case CX_ENCODING_NONE:
+            break;
+        case CX_ENCODING_DICT:
+            if (!cx_column_cursor_load_dict(cursor))
+                goto error;
+            break;
+        case CX_ENCODING_RLE:
+            if (!cx_column_cursor_check_runs(cursor))
+                goto error;
+            break;
+        case CX_ENCODING_DELTA:
+        case CX_ENCODING_DELTA_OF_DELTA:
+            if (!cx_column_cursor_check_blocks(cursor))
+                goto error;
+            break;
+        case CX_ENCODING_BITPACK:
+            if (!cx_column_cursor_check_bitpack(cursor))
+                goto error;
+            break;
+        case CX_ENCODING_XOR:
+            if (!cx_column_cursor_check_xor(cursor))
+                goto error;
+            break;
+        case CX_ENCODING_BYTE_STREAM_SPLIT:
+            if (!cx_column_cursor_check_split(cursor))
+                goto error;
+            break;
+        case CX_ENCODING_OFFSETS:
+            if (!cx_column_cursor_check_offsets(cursor))
+                goto error;
+            break;
+        case CX_ENCODING_FSST:
+            if (!cx_column_cursor_load_fsst(cursor))
+                goto error;
+            break;
+        case CX_ENCODING_CONSTANT:
+            if (!cx_column_cursor_load_constant(cursor))
+                goto error;
+            break;
+        case CX_ENCODING_SPARSE:
+            if (!cx_column_cursor_load_sparse(cursor))
+                goto error;
+            break;
+        default:
+            goto error;
+    }
     cx_column_cursor_rewind(cursor);
     return cursor;
 error:
-    free(cursor);
+    cx_column_cursor_free(cursor);
     return NULL;
 }
 
 void cx_column_cursor_free(struct cx_column_cursor *cursor)
 {
+    free(cursor->buffer);
+    free(cursor->runs);
+    free(cursor->compressed);
+    free(cursor->dict);
+    free(cursor->fsst);
+    free(cursor->decoded);
     free(cursor);
 }
 
 void cx_column_cursor_rewind(struct cx_column_cursor *cursor)
 {
     cursor->position = cursor->start;
+    cursor->run_offset = 0;
+    cursor->block_offset = 0;
+    cursor->position_offset = 0;
+    cursor->value = cursor->values;
+    cursor->value_index = 0;
 }
 
 bool cx_column_cursor_valid(const struct cx_column_cursor *cursor)
@@ -294,11 +1147,331 @@ bool cx_column_cursor_valid(const struct cx_column_cursor *cursor)
     return cursor->position < cursor->end;
 }
 
-static void cx_column_cursor_advance(struct cx_column_cursor *cursor,
-                                     size_t size)
+static size_t cx_column_cursor_skip_runs(struct cx_column_cursor *cursor,
+                                         size_t count)
 {
-    cursor->position = (void *)((uintptr_t)cursor->position + size);
-    assert(cursor->position <= cursor->end);
+    size_t run_size = cx_column_run_size(cursor->column->type);
+    size_t skipped = 0;
+    while (skipped < count && cx_column_cursor_valid(cursor)) {
+        cx_value_t value;
+        size_t length;
+        cx_column_cursor_run(cursor, &value, &length);
+        size_t remaining = length - cursor->run_offset;
+        if (remaining > count - skipped) {
+            cursor->run_offset += count - skipped;
+            return count;
+        }
+        skipped += remaining;
+        cursor->run_offset = 0;
+        cx_column_cursor_advance(cursor, run_size);
+    }
+    return skipped;
+}
+
+static size_t cx_column_cursor_block_stride(
+    const struct cx_column_cursor *cursor)
+{
+    if (cursor->column->encoding == CX_ENCODING_BITPACK)
+        return cursor->width * sizeof(uint64_t);
+    if (cursor->column->encoding == CX_ENCODING_XOR)
+        return sizeof(struct cx_xor_block);
+    return sizeof(struct cx_delta_block);
+}
+
+static size_t cx_column_cursor_block_size(
+    const struct cx_column_cursor *cursor)
+{
+    size_t offset = (uintptr_t)cursor->position - (uintptr_t)cursor->start;
+    return cx_column_block_size(cursor->column,
+                                offset / cx_column_cursor_block_stride(cursor));
+}
+
+static size_t cx_column_cursor_skip_blocks(struct cx_column_cursor *cursor,
+                                           size_t count)
+{
+    size_t skipped = 0;
+    while (skipped < count && cx_column_cursor_valid(cursor)) {
+        size_t remaining =
+            cx_column_cursor_block_size(cursor) - cursor->block_offset;
+        if (remaining > count - skipped) {
+            cursor->block_offset += count - skipped;
+            return count;
+        }
+        skipped += remaining;
+        cursor->block_offset = 0;
+        cx_column_cursor_advance(cursor, cx_column_cursor_block_stride(cursor));
+    }
+    return skipped;
+}
+
+// the block decoders decode the whole block at the cursor position into
+// values, which must have room for the block
+static void cx_column_cursor_decode_delta_block(
+    const struct cx_column_cursor *cursor, uint64_t values[])
+{
+    const struct cx_delta_block *block = cursor->position;
+    size_t count = cx_column_cursor_block_size(cursor);
+    const uint64_t *packed = cursor->packed + block->offset;
+    size_t packed_count =
+        cx_column_block_packed_count(cursor->column, count);
+    uint64_t *deltas = &values[count - packed_count];
+    values[0] = block->first;
+    if (cursor->column->encoding == CX_ENCODING_DELTA_OF_DELTA && count > 1)
+        values[1] = block->delta;
+    cx_bitpack_unpack(packed_count, packed, block->width, deltas);
+    for (size_t i = 0; i < packed_count; i++)
+        deltas[i] += block->reference;
+    // the differences of differences sum to the differences, which in
+    // turn sum to the values
+    if (cursor->column->encoding == CX_ENCODING_DELTA_OF_DELTA && count > 1)
+        cx_prefix_sum(count - 1, &values[1]);
+    cx_prefix_sum(count, values);
+}
+
+static void cx_column_cursor_unpack(const struct cx_column_cursor *cursor,
+                                    size_t count, const uint64_t planes[],
+                                    void *values)
+{
+    assert(count <= CX_BITPACK_BLOCK_SIZE);
+    uint64_t base = cursor->base;
+    if (cursor->column->type == CX_COLUMN_I64) {
+        uint64_t *unpacked = values;
+        cx_bitpack_unpack(count, planes, cursor->width, unpacked);
+        for (size_t i = 0; i < count; i++)
+            unpacked[i] += base;
+        return;
+    }
+    // unpack into a block of words and then narrow the values
+    uint64_t unpacked[CX_BITPACK_BLOCK_SIZE];
+    int32_t *narrowed = values;
+    cx_bitpack_unpack(count, planes, cursor->width, unpacked);
+    for (size_t i = 0; i < count; i++)
+        narrowed[i] = (int32_t)(unpacked[i] + base);
+}
+
+// reads past the end of a block stream yield zero bits, so a corrupt
+// stream can't be used to read outside of the column
+struct cx_bit_reader {
+    const uint64_t *words;
+    size_t size;
+    size_t position;  // in bits
+};
+
+static uint64_t cx_bit_reader_get(struct cx_bit_reader *reader, unsigned bits)
+{
+    assert(bits <= 64);
+    if (!bits)
+        return 0;
+    size_t word = reader->position / 64, shift = reader->position % 64;
+    uint64_t value = word < reader->size ? reader->words[word] >> shift : 0;
+    if (shift && shift + bits > 64 && word + 1 < reader->size)
+        value |= reader->words[word + 1] << (64 - shift);
+    reader->position += bits;
+    return bits < 64 ? value & (((uint64_t)1 << bits) - 1) : value;
+}
+
+static void cx_xor_decode_block(struct cx_bit_reader *reader, size_t count,
+                                unsigned value_bits, uint64_t values[])
+{
+    unsigned field_bits = value_bits == 64 ? 6 : 5;
+    unsigned leading = 0, trailing = 0;
+    values[0] = cx_bit_reader_get(reader, value_bits);
+    for (size_t i = 1; i < count; i++) {
+        uint64_t xor = 0;
+        if (cx_bit_reader_get(reader, 1)) {
+            if (cx_bit_reader_get(reader, 1)) {
+                leading = cx_bit_reader_get(reader, field_bits);
+                unsigned length = cx_bit_reader_get(reader, field_bits) + 1;
+                if (leading >= value_bits)
+                    leading = value_bits - 1;
+                if (leading + length > value_bits)
+                    length = value_bits - leading;
+                trailing = value_bits - leading - length;
+            }
+            xor = cx_bit_reader_get(reader, value_bits - leading - trailing)
+                  << trailing;
+        }
+        values[i] = values[i - 1] ^ xor;
+    }
+}
+
+static void cx_column_cursor_decode_xor_block(
+    const struct cx_column_cursor *cursor, void *decoded)
+{
+    const struct cx_xor_block *block = cursor->position;
+    size_t count = cx_column_cursor_block_size(cursor);
+    struct cx_bit_reader reader = {cursor->packed + block->offset, block->size,
+                                   0};
+    uint64_t values[CX_XOR_BLOCK_SIZE];
+    if (cursor->column->type == CX_COLUMN_DBL) {
+        cx_xor_decode_block(&reader, count, 64, values);
+        memcpy(decoded, values, count * sizeof(double));
+        return;
+    }
+    float *floats = decoded;
+    cx_xor_decode_block(&reader, count, 32, values);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits = values[i];
+        memcpy(&floats[i], &bits, sizeof(float));
+    }
+}
+
+static void cx_column_cursor_decode_block(
+    const struct cx_column_cursor *cursor, void *values)
+{
+    if (cursor->column->encoding == CX_ENCODING_BITPACK)
+        cx_column_cursor_unpack(cursor, cx_column_cursor_block_size(cursor),
+                                cursor->position, values);
+    else if (cursor->column->encoding == CX_ENCODING_XOR)
+        cx_column_cursor_decode_xor_block(cursor, values);
+    else
+        cx_column_cursor_decode_delta_block(cursor, values);
+}
+
+// blocks are decoded into the cursor buffer until the batch is full. a
+// block that's only partly read (after a skip, or at the end of a batch)
+// is decoded into a scratch block first. every encoding uses blocks of 64
+// rows
+static const void *cx_column_cursor_next_blocks(
+    struct cx_column_cursor *cursor, size_t *available)
+{
+    size_t width = cx_column_value_width(cursor->column->type);
+    char *values = (char *)cursor->buffer;
+    size_t count = 0;
+    while (count < cursor->batch_size && cx_column_cursor_valid(cursor)) {
+        size_t size = cx_column_cursor_block_size(cursor);
+        size_t offset = cursor->block_offset;
+        size_t rows = size - offset;
+        if (rows > cursor->batch_size - count)
+            rows = cursor->batch_size - count;
+        if (rows == size) {
+            cx_column_cursor_decode_block(cursor, values + count * width);
+        } else {
+            uint64_t block[CX_DELTA_BLOCK_SIZE];
+            cx_column_cursor_decode_block(cursor, block);
+            memcpy(values + count * width, (char *)block + offset * width,
+                   rows * width);
+        }
+        count += rows;
+        if (offset + rows < size) {
+            cursor->block_offset = offset + rows;
+        } else {
+            cursor->block_offset = 0;
+            cx_column_cursor_advance(cursor,
+                                     cx_column_cursor_block_stride(cursor));
+        }
+    }
+    *available = count;
+    return values;
+}
+
+// byte stream split columns are skipped like plain columns, since each
+// value still takes the same number of bytes. the values of a batch are
+// then gathered from each of the streams
+static const void *cx_column_cursor_next_batch_split(
+    struct cx_column_cursor *cursor, size_t width, size_t *available)
+{
+    size_t row =
+        ((uintptr_t)cursor->position - (uintptr_t)cursor->start) / width;
+    size_t count = cursor->column->count - row;
+    if (count > cursor->batch_size)
+        count = cursor->batch_size;
+    cx_byte_merge(count, width, (const char *)cursor->start + row,
+                  cursor->column->count, cursor->buffer);
+    cx_column_cursor_advance(cursor, count * width);
+    *available = count;
+    return cursor->buffer;
+}
+
+// constant and sparse chunks don't have a position for each row. their
+// rows are counted as though the chunk was a single block, and the cursor
+// moves to the end after the last row
+static bool cx_column_row_counted(const struct cx_column *column)
+{
+    return column->encoding == CX_ENCODING_CONSTANT ||
+           column->encoding == CX_ENCODING_SPARSE;
+}
+
+static size_t cx_column_cursor_skip_rows(struct cx_column_cursor *cursor,
+                                         size_t count)
+{
+    if (!cx_column_cursor_valid(cursor))
+        return 0;
+    size_t remaining = cursor->column->count - cursor->block_offset;
+    if (count >= remaining) {
+        count = remaining;
+        cursor->position = cursor->end;
+    }
+    cursor->block_offset += count;
+    while (cursor->position_offset < cursor->position_count &&
+           cursor->positions[cursor->position_offset] < cursor->block_offset)
+        cursor->position_offset++;
+    return count;
+}
+
+size_t cx_column_cursor_skip_sparse(struct cx_column_cursor *cursor,
+                                    size_t count)
+{
+    assert(cursor->column->encoding == CX_ENCODING_SPARSE);
+    return cx_column_cursor_skip_rows(cursor, count);
+}
+
+// null rows of a sparse column read as 0 (or ""), as they would in the
+// plain layout
+static const void *cx_column_cursor_next_batch_rows(
+    struct cx_column_cursor *cursor, size_t *available)
+{
+    size_t row = cursor->block_offset;
+    size_t offset = cursor->position_offset;
+    *available = cx_column_cursor_skip_rows(cursor, cursor->batch_size);
+    if (cursor->column->encoding == CX_ENCODING_CONSTANT)
+        return cursor->buffer;
+    const uint32_t *positions = cursor->positions;
+    if (cursor->column->type == CX_COLUMN_STR) {
+        struct cx_string *strings = (struct cx_string *)cursor->buffer;
+        for (size_t i = 0; i < *available; i++) {
+            strings[i].ptr = cx_column_empty_string;
+            strings[i].len = 0;
+        }
+        // string values are only walked when a batch of them is read
+        for (; cursor->value_index < offset; cursor->value_index++)
+            cursor->value += strlen(cursor->value) + 1;
+        for (; cursor->value_index < cursor->position_offset;
+             cursor->value_index++) {
+            struct cx_string *string =
+                &strings[positions[cursor->value_index] - row];
+            string->ptr = cursor->value;
+            string->len = strlen(cursor->value);
+            cursor->value += string->len + 1;
+        }
+        return strings;
+    }
+    size_t width = cx_column_value_width(cursor->column->type);
+    char *values = (char *)cursor->buffer;
+    memset(values, 0, *available * width);
+    for (size_t i = offset; i < cursor->position_offset; i++)
+        memcpy(values + (positions[i] - row) * width,
+               cursor->values + i * width, width);
+    return values;
+}
+
+const uint64_t *cx_column_cursor_next_batch_nulls(
+    struct cx_column_cursor *cursor, size_t *available)
+{
+    assert(cursor->column->encoding == CX_ENCODING_SPARSE);
+    size_t row = cursor->block_offset;
+    size_t offset = cursor->position_offset;
+    *available = cx_column_cursor_skip_rows(cursor, cursor->batch_size);
+    uint64_t *nulls = (uint64_t *)cursor->buffer;
+    for (size_t i = 0; i < cursor->batch_size / 64; i++) {
+        size_t bits = *available > i * 64 ? *available - i * 64 : 0;
+        nulls[i] = bits >= 64 ? UINT64_MAX : ((uint64_t)1 << bits) - 1;
+    }
+    for (size_t i = offset; i < cursor->position_offset; i++) {
+        size_t bit = cursor->positions[i] - row;
+        nulls[bit / 64] &= ~((uint64_t)1 << (bit % 64));
+    }
+    return nulls;
 }
 
 static size_t cx_column_cursor_skip(struct cx_column_cursor *cursor,
@@ -317,6 +1490,12 @@ static size_t cx_column_cursor_skip(struct cx_column_cursor *cursor,
 size_t cx_column_cursor_skip_bit(struct cx_column_cursor *cursor, size_t count)
 {
     assert(count % 64 == 0);
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_skip_rows(cursor, count);
+    if (cursor->column->encoding == CX_ENCODING_RLE) {
+        assert(cursor->column->type == CX_COLUMN_BIT);
+        return cx_column_cursor_skip_runs(cursor, count);
+    }
     size_t skipped = cx_column_cursor_skip(cursor, CX_COLUMN_BIT,
                                            sizeof(uint64_t), count / 64);
     skipped *= 64;
@@ -330,21 +1509,53 @@ size_t cx_column_cursor_skip_bit(struct cx_column_cursor *cursor, size_t count)
 
 size_t cx_column_cursor_skip_i32(struct cx_column_cursor *cursor, size_t count)
 {
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_skip_rows(cursor, count);
+    if (cursor->column->encoding == CX_ENCODING_RLE) {
+        assert(cursor->column->type == CX_COLUMN_I32);
+        return cx_column_cursor_skip_runs(cursor, count);
+    }
+    if (cx_column_blocked(cursor->column)) {
+        assert(cursor->column->type == CX_COLUMN_I32);
+        return cx_column_cursor_skip_blocks(cursor, count);
+    }
     return cx_column_cursor_skip(cursor, CX_COLUMN_I32, sizeof(int32_t), count);
 }
 
 size_t cx_column_cursor_skip_i64(struct cx_column_cursor *cursor, size_t count)
 {
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_skip_rows(cursor, count);
+    if (cursor->column->encoding == CX_ENCODING_RLE) {
+        assert(cursor->column->type == CX_COLUMN_I64);
+        return cx_column_cursor_skip_runs(cursor, count);
+    }
+    if (cx_column_blocked(cursor->column)) {
+        assert(cursor->column->type == CX_COLUMN_I64);
+        return cx_column_cursor_skip_blocks(cursor, count);
+    }
     return cx_column_cursor_skip(cursor, CX_COLUMN_I64, sizeof(int64_t), count);
 }
 
 size_t cx_column_cursor_skip_flt(struct cx_column_cursor *cursor, size_t count)
 {
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_skip_rows(cursor, count);
+    if (cx_column_blocked(cursor->column)) {
+        assert(cursor->column->type == CX_COLUMN_FLT);
+        return cx_column_cursor_skip_blocks(cursor, count);
+    }
     return cx_column_cursor_skip(cursor, CX_COLUMN_FLT, sizeof(float), count);
 }
 
 size_t cx_column_cursor_skip_dbl(struct cx_column_cursor *cursor, size_t count)
 {
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_skip_rows(cursor, count);
+    if (cx_column_blocked(cursor->column)) {
+        assert(cursor->column->type == CX_COLUMN_DBL);
+        return cx_column_cursor_skip_blocks(cursor, count);
+    }
     return cx_column_cursor_skip(cursor, CX_COLUMN_DBL, sizeof(double), count);
 }
 
@@ -371,6 +1582,15 @@ static inline size_t cx_strlen(const char *string)
 size_t cx_column_cursor_skip_str(struct cx_column_cursor *cursor, size_t count)
 {
     assert(cursor->column->type == CX_COLUMN_STR);
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_skip_rows(cursor, count);
+    if (cursor->column->encoding == CX_ENCODING_DICT)
+        return cx_column_cursor_skip(cursor, CX_COLUMN_STR, sizeof(int32_t),
+                                     count);
+    if (cursor->column->encoding == CX_ENCODING_OFFSETS ||
+        cursor->column->encoding == CX_ENCODING_FSST)
+        return cx_column_cursor_skip(cursor, CX_COLUMN_STR, sizeof(uint32_t),
+                                     count);
     size_t skipped = 0;
     // TODO: vectorise this
     for (; skipped < count && cx_column_cursor_valid(cursor); skipped++)
@@ -381,40 +1601,86 @@ size_t cx_column_cursor_skip_str(struct cx_column_cursor *cursor, size_t count)
 const uint64_t *cx_column_cursor_next_batch_bit(struct cx_column_cursor *cursor,
                                                 size_t *available)
 {
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_next_batch_rows(cursor, available);
+    if (cursor->column->encoding == CX_ENCODING_RLE) {
+        size_t run_count;
+        const struct cx_run *runs =
+            cx_column_cursor_next_batch_runs(cursor, &run_count, available);
+        return cx_column_cursor_decode_runs(cursor, run_count, runs);
+    }
     const uint64_t *values = cursor->position;
-    *available = cx_column_cursor_skip_bit(cursor, CX_BATCH_SIZE);
+    *available = cx_column_cursor_skip_bit(cursor, cursor->batch_size);
     return values;
 }
 
 const int32_t *cx_column_cursor_next_batch_i32(struct cx_column_cursor *cursor,
                                                size_t *available)
 {
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_next_batch_rows(cursor, available);
+    if (cursor->column->encoding == CX_ENCODING_RLE) {
+        size_t run_count;
+        const struct cx_run *runs =
+            cx_column_cursor_next_batch_runs(cursor, &run_count, available);
+        return cx_column_cursor_decode_runs(cursor, run_count, runs);
+    }
+    if (cx_column_blocked(cursor->column))
+        return cx_column_cursor_next_blocks(cursor, available);
     const int32_t *values = cursor->position;
-    *available = cx_column_cursor_skip_i32(cursor, CX_BATCH_SIZE);
+    *available = cx_column_cursor_skip_i32(cursor, cursor->batch_size);
     return values;
 }
 
 const int64_t *cx_column_cursor_next_batch_i64(struct cx_column_cursor *cursor,
                                                size_t *available)
 {
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_next_batch_rows(cursor, available);
+    if (cursor->column->encoding == CX_ENCODING_RLE) {
+        size_t run_count;
+        const struct cx_run *runs =
+            cx_column_cursor_next_batch_runs(cursor, &run_count, available);
+        return cx_column_cursor_decode_runs(cursor, run_count, runs);
+    }
+    if (cx_column_blocked(cursor->column))
+        return cx_column_cursor_next_blocks(cursor, available);
     const int64_t *values = cursor->position;
-    *available = cx_column_cursor_skip_i64(cursor, CX_BATCH_SIZE);
+    *available = cx_column_cursor_skip_i64(cursor, cursor->batch_size);
     return values;
 }
 
 const float *cx_column_cursor_next_batch_flt(struct cx_column_cursor *cursor,
                                              size_t *available)
 {
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_next_batch_rows(cursor, available);
+    if (cx_column_blocked(cursor->column))
+        return cx_column_cursor_next_blocks(cursor, available);
+    if (cursor->column->encoding == CX_ENCODING_BYTE_STREAM_SPLIT) {
+        assert(cursor->column->type == CX_COLUMN_FLT);
+        return cx_column_cursor_next_batch_split(cursor, sizeof(float),
+                                                 available);
+    }
     const float *values = cursor->position;
-    *available = cx_column_cursor_skip_flt(cursor, CX_BATCH_SIZE);
+    *available = cx_column_cursor_skip_flt(cursor, cursor->batch_size);
     return values;
 }
 
 const double *cx_column_cursor_next_batch_dbl(struct cx_column_cursor *cursor,
                                               size_t *available)
 {
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_next_batch_rows(cursor, available);
+    if (cx_column_blocked(cursor->column))
+        return cx_column_cursor_next_blocks(cursor, available);
+    if (cursor->column->encoding == CX_ENCODING_BYTE_STREAM_SPLIT) {
+        assert(cursor->column->type == CX_COLUMN_DBL);
+        return cx_column_cursor_next_batch_split(cursor, sizeof(double),
+                                                 available);
+    }
     const double *values = cursor->position;
-    *available = cx_column_cursor_skip_dbl(cursor, CX_BATCH_SIZE);
+    *available = cx_column_cursor_skip_dbl(cursor, cursor->batch_size);
     return values;
 }
 
@@ -422,9 +1688,31 @@ const struct cx_string *cx_column_cursor_next_batch_str(
     struct cx_column_cursor *cursor, size_t *available)
 {
     assert(cursor->column->type == CX_COLUMN_STR);
-    size_t i = 0;
+    if (cx_column_row_counted(cursor->column))
+        return cx_column_cursor_next_batch_rows(cursor, available);
+    if (cursor->column->encoding == CX_ENCODING_DICT) {
+        const int32_t *codes =
+            cx_column_cursor_next_batch_codes(cursor, available);
+        return cx_column_cursor_decode_codes(cursor, *available, codes);
+    }
+    if (cursor->column->encoding == CX_ENCODING_FSST) {
+        const struct cx_string *compressed =
+            cx_column_cursor_next_batch_compressed(cursor, available);
+        return cx_column_cursor_decode_compressed(cursor, *available,
+                                                  compressed);
+    }
     struct cx_string *strings = (struct cx_string *)cursor->buffer;
-    for (; i < CX_BATCH_SIZE && cx_column_cursor_valid(cursor); i++) {
+    if (cursor->column->encoding == CX_ENCODING_OFFSETS) {
+        const uint32_t *offsets = cursor->position;
+        *available = cx_column_cursor_skip_str(cursor, cursor->batch_size);
+        for (size_t i = 0; i < *available; i++) {
+            strings[i].ptr = cursor->strings + offsets[i];
+            strings[i].len = offsets[i + 1] - offsets[i] - 1;
+        }
+        return strings;
+    }
+    size_t i = 0;
+    for (; i < cursor->batch_size && cx_column_cursor_valid(cursor); i++) {
         strings[i].ptr = cursor->position;
         strings[i].len = cx_strlen(cursor->position);
         cx_column_cursor_advance(cursor, strings[i].len + 1);
@@ -432,3 +1720,190 @@ const struct cx_string *cx_column_cursor_next_batch_str(
     *available = i;
     return strings;
 }
+
+const int32_t *cx_column_cursor_next_batch_codes(
+    struct cx_column_cursor *cursor, size_t *available)
+{
+    assert(cursor->column->encoding == CX_ENCODING_DICT);
+    const int32_t *codes = cursor->position;
+    *available = cx_column_cursor_skip(cursor, CX_COLUMN_STR, sizeof(int32_t),
+                                       cursor->batch_size);
+    return codes;
+}
+
+const struct cx_string *cx_column_cursor_dict(
+    const struct cx_column_cursor *cursor, size_t *size)
+{
+    assert(cursor->column->encoding == CX_ENCODING_DICT);
+    *size = cursor->dict_size;
+    return cursor->dict;
+}
+
+const struct cx_string *cx_column_cursor_decode_codes(
+    struct cx_column_cursor *cursor, size_t count, const int32_t codes[])
+{
+    assert(cursor->column->encoding == CX_ENCODING_DICT);
+    assert(count <= cursor->batch_size);
+    struct cx_string *strings = (struct cx_string *)cursor->buffer;
+    for (size_t i = 0; i < count; i++)
+        strings[i] = cursor->dict[codes[i]];
+    return strings;
+}
+
+const struct cx_run *cx_column_cursor_next_batch_runs(
+    struct cx_column_cursor *cursor, size_t *run_count, size_t *available)
+{
+    assert(cursor->column->encoding == CX_ENCODING_RLE);
+    size_t run_size = cx_column_run_size(cursor->column->type);
+    size_t count = 0, i = 0;
+    for (; count < cursor->batch_size && cx_column_cursor_valid(cursor); i++) {
+        struct cx_run *run = &cursor->runs[i];
+        size_t length;
+        cx_column_cursor_run(cursor, &run->value, &length);
+        size_t remaining = length - cursor->run_offset;
+        if (remaining > cursor->batch_size - count) {
+            run->length = cursor->batch_size - count;
+            cursor->run_offset += run->length;
+        } else {
+            run->length = remaining;
+            cursor->run_offset = 0;
+            cx_column_cursor_advance(cursor, run_size);
+        }
+        count += run->length;
+    }
+    *run_count = i;
+    *available = count;
+    return cursor->runs;
+}
+
+const void *cx_column_cursor_decode_runs(struct cx_column_cursor *cursor,
+                                         size_t run_count,
+                                         const struct cx_run runs[])
+{
+    assert(cursor->column->encoding == CX_ENCODING_RLE);
+    size_t offset = 0;
+    switch (cursor->column->type) {
+        case CX_COLUMN_BIT: {
+            uint64_t *bitset = (uint64_t *)cursor->buffer;
+            memset(bitset, 0, cursor->batch_size / 8);
+            for (size_t i = 0; i < run_count; i++) {
+                if (runs[i].value.bit)
+                    cx_bitset_set_range(bitset, offset, runs[i].length);
+                offset += runs[i].length;
+            }
+        } break;
+        case CX_COLUMN_I32: {
+            int32_t *values = (int32_t *)cursor->buffer;
+            for (size_t i = 0; i < run_count; i++)
+                for (size_t j = 0; j < runs[i].length; j++)
+                    values[offset++] = runs[i].value.i32;
+        } break;
+        case CX_COLUMN_I64: {
+            int64_t *values = (int64_t *)cursor->buffer;
+            for (size_t i = 0; i < run_count; i++)
+                for (size_t j = 0; j < runs[i].length; j++)
+                    values[offset++] = runs[i].value.i64;
+        } break;
+        default:
+            assert(0);
+    }
+    assert(offset <= cursor->batch_size);
+    return cursor->buffer;
+}
+
+const uint64_t *cx_column_cursor_next_batch_planes(
+    struct cx_column_cursor *cursor, size_t *available)
+{
+    assert(cursor->column->encoding == CX_ENCODING_BITPACK);
+    assert(!cursor->block_offset);
+    // the planes of consecutive blocks are stored back to back
+    const uint64_t *planes = cursor->position;
+    size_t count = 0;
+    while (count < cursor->batch_size && cx_column_cursor_valid(cursor)) {
+        count += cx_column_cursor_block_size(cursor);
+        cx_column_cursor_advance(cursor,
+                                 cx_column_cursor_block_stride(cursor));
+    }
+    *available = count;
+    return planes;
+}
+
+void cx_column_cursor_frame(const struct cx_column_cursor *cursor,
+                            int64_t *base, size_t *width)
+{
+    assert(cursor->column->encoding == CX_ENCODING_BITPACK);
+    *base = cursor->base;
+    *width = cursor->width;
+}
+
+const void *cx_column_cursor_decode_planes(struct cx_column_cursor *cursor,
+                                           size_t count,
+                                           const uint64_t planes[])
+{
+    assert(cursor->column->encoding == CX_ENCODING_BITPACK);
+    assert(count <= cursor->batch_size);
+    size_t width = cx_column_value_width(cursor->column->type);
+    char *values = (char *)cursor->buffer;
+    for (size_t i = 0; i < count; i += CX_BITPACK_BLOCK_SIZE) {
+        size_t rows = count - i < CX_BITPACK_BLOCK_SIZE
+                          ? count - i
+                          : CX_BITPACK_BLOCK_SIZE;
+        cx_column_cursor_unpack(
+            cursor, rows, planes + i / CX_BITPACK_BLOCK_SIZE * cursor->width,
+            values + i * width);
+    }
+    return values;
+}
+
+const struct cx_string *cx_column_cursor_next_batch_compressed(
+    struct cx_column_cursor *cursor, size_t *available)
+{
+    assert(cursor->column->encoding == CX_ENCODING_FSST);
+    const uint32_t *offsets = cursor->position;
+    *available = cx_column_cursor_skip_str(cursor, cursor->batch_size);
+    for (size_t i = 0; i < *available; i++) {
+        cursor->compressed[i].ptr = cursor->strings + offsets[i];
+        cursor->compressed[i].len = offsets[i + 1] - offsets[i];
+    }
+    return cursor->compressed;
+}
+
+const struct cx_fsst_table *cx_column_cursor_symbols(
+    const struct cx_column_cursor *cursor)
+{
+    assert(cursor->column->encoding == CX_ENCODING_FSST);
+    return cursor->fsst;
+}
+
+const struct cx_string *cx_column_cursor_decode_compressed(
+    struct cx_column_cursor *cursor, size_t count,
+    const struct cx_string compressed[])
+{
+    assert(cursor->column->encoding == CX_ENCODING_FSST);
+    assert(count <= cursor->batch_size);
+    // symbols are copied 8 bytes at a time, and the strings are followed
+    // by 16 bytes of padding for the SSE4.2 string matching functions
+    size_t size = 16;
+    for (size_t i = 0; i < count; i++)
+        size += 8 * (compressed[i].len + 1) + 1;
+    if (size > cursor->decoded_size) {
+        char *decoded = realloc(cursor->decoded, size);
+        if (!decoded)
+            return NULL;
+        cursor->decoded = decoded;
+        cursor->decoded_size = size;
+    }
+    struct cx_string *strings = (struct cx_string *)cursor->buffer;
+    char *dest = cursor->decoded;
+    for (size_t i = 0; i < count; i++) {
+        size_t len =
+            cx_fsst_decompress(cursor->fsst, (const uint8_t *)compressed[i].ptr,
+                               compressed[i].len, dest);
+        dest[len] = '\0';
+        strings[i].ptr = dest;
+        strings[i].len = len;
+        dest += len + 1;
+    }
+    memset(dest, 0, 16);
+    return strings;
+}
@@ -7,12 +7,25 @@ extern "C" {
 
 #include "common.h"
 
+// cursors read CX_BATCH_SIZE rows at a time unless they're created with a
+// larger batch size, which must be a multiple of CX_BATCH_SIZE of at most
+// CX_BATCH_SIZE_MAX. the bitsets (e.g. null bitmaps) of larger batches
+// span several words
 #define CX_BATCH_SIZE 64
+#define CX_BATCH_SIZE_MAX 4096
 
 struct cx_column;
 
 struct cx_column_cursor;
 
+struct cx_index;
+
+// a run of identical values within a batch of a CX_ENCODING_RLE column
+struct cx_run {
+    cx_value_t value;
+    size_t length;
+};
+
 struct cx_column *cx_column_new(enum cx_column_type, enum cx_encoding_type);
 
 struct cx_column *cx_column_new_mmapped(enum cx_column_type,
@@ -23,6 +36,14 @@ struct cx_column *cx_column_new_compressed(enum cx_column_type,
                                            enum cx_encoding_type, void **buffer,
                                            size_t size, size_t count);
 
+// like cx_column_new_compressed, for a buffer that's about to be filled by
+// decompressing a chunk. the buffer is taken from (and returned to) the
+// buffer pool of the thread (see pool.h), and isn't cleared
+struct cx_column *cx_column_new_decompressed(enum cx_column_type,
+                                             enum cx_encoding_type,
+                                             void **buffer, size_t size,
+                                             size_t count);
+
 void cx_column_free(struct cx_column *);
 
 const void *cx_column_export(const struct cx_column *, size_t *);
@@ -33,6 +54,17 @@ enum cx_encoding_type cx_column_encoding(const struct cx_column *);
 
 size_t cx_column_count(const struct cx_column *column);
 
+// the statistics of the values put into a column (see index.h), or NULL
+// where the column wasn't built by puts
+const struct cx_index *cx_column_index(const struct cx_column *);
+
+// make room for count more values without growing the buffer. the memory is
+// initialized as values are added
+bool cx_column_reserve(struct cx_column *, size_t count);
+
+// remove all values, keeping the buffer for reuse
+void cx_column_reset(struct cx_column *);
+
 bool cx_column_put_bit(struct cx_column *, bool);
 bool cx_column_put_i32(struct cx_column *, int32_t);
 bool cx_column_put_i64(struct cx_column *, int64_t);
@@ -42,7 +74,34 @@ bool cx_column_put_str(struct cx_column *, const char *);
 
 bool cx_column_put_unit(struct cx_column *);
 
+// append count values at once. rows set in the nulls bitset (if provided)
+// are stored as zero, false or "", as with cx_column_put_unit. a NULL bit
+// array appends false values
+bool cx_column_put_bit_array(struct cx_column *, const uint64_t *values,
+                             const uint64_t *nulls, size_t count);
+bool cx_column_put_i32_array(struct cx_column *, const int32_t *values,
+                             const uint64_t *nulls, size_t count);
+bool cx_column_put_i64_array(struct cx_column *, const int64_t *values,
+                             const uint64_t *nulls, size_t count);
+bool cx_column_put_flt_array(struct cx_column *, const float *values,
+                             const uint64_t *nulls, size_t count);
+bool cx_column_put_dbl_array(struct cx_column *, const double *values,
+                             const uint64_t *nulls, size_t count);
+
+// append count strings packed into data, where string i spans
+// data[offsets[i]] to data[offsets[i + 1]] (exclusive). fails if a string
+// that isn't null contains a NUL byte
+bool cx_column_put_str_array(struct cx_column *, const uint32_t *offsets,
+                             const char *data, const uint64_t *nulls,
+                             size_t count);
+
+// move the values from row start onwards to the end of another column of
+// the same type, leaving start values behind
+bool cx_column_split(struct cx_column *, size_t start, struct cx_column *dest);
+
 struct cx_column_cursor *cx_column_cursor_new(const struct cx_column *);
+struct cx_column_cursor *cx_column_cursor_new_batched(const struct cx_column *,
+                                                      size_t batch_size);
 
 void cx_column_cursor_free(struct cx_column_cursor *);
 
@@ -70,6 +129,52 @@ size_t cx_column_cursor_skip_flt(struct cx_column_cursor *, size_t);
 size_t cx_column_cursor_skip_dbl(struct cx_column_cursor *, size_t);
 size_t cx_column_cursor_skip_str(struct cx_column_cursor *, size_t);
 
+// dictionary encoded (CX_ENCODING_DICT) string columns expose their codes
+// and dictionary, so that values can be matched without decoding each row
+const int32_t *cx_column_cursor_next_batch_codes(struct cx_column_cursor *,
+                                                 size_t *);
+const struct cx_string *cx_column_cursor_dict(const struct cx_column_cursor *,
+                                              size_t *);
+const struct cx_string *cx_column_cursor_decode_codes(
+    struct cx_column_cursor *, size_t, const int32_t[]);
+
+// run-length encoded (CX_ENCODING_RLE) columns expose the runs that make
+// up each batch, so that a run can be matched with a single comparison
+const struct cx_run *cx_column_cursor_next_batch_runs(
+    struct cx_column_cursor *, size_t *run_count, size_t *available);
+const void *cx_column_cursor_decode_runs(struct cx_column_cursor *,
+                                         size_t run_count,
+                                         const struct cx_run[]);
+
+// bit-packed (CX_ENCODING_BITPACK) columns expose the bit planes of each
+// block of 64 values (see bitpack.h), so that values can be matched
+// without unpacking them. a batch holds the planes of consecutive blocks
+// back to back, and the cursor must be positioned at a block boundary.
+// values are stored relative to the frame of reference base
+const uint64_t *cx_column_cursor_next_batch_planes(struct cx_column_cursor *,
+                                                   size_t *available);
+void cx_column_cursor_frame(const struct cx_column_cursor *, int64_t *base,
+                            size_t *width);
+const void *cx_column_cursor_decode_planes(struct cx_column_cursor *,
+                                           size_t count, const uint64_t[]);
+
+// FSST compressed (CX_ENCODING_FSST) string columns expose the compressed
+// form of each string and the symbol table (see fsst.h), so that strings
+// can be compared without decompressing them
+struct cx_fsst_table;
+const struct cx_string *cx_column_cursor_next_batch_compressed(
+    struct cx_column_cursor *, size_t *available);
+const struct cx_fsst_table *cx_column_cursor_symbols(
+    const struct cx_column_cursor *);
+const struct cx_string *cx_column_cursor_decode_compressed(
+    struct cx_column_cursor *, size_t count, const struct cx_string[]);
+
+// sparse (CX_ENCODING_SPARSE) columns only store their non-null rows, and
+// the positions of those rows make up the null bitmap of each batch
+size_t cx_column_cursor_skip_sparse(struct cx_column_cursor *, size_t);
+const uint64_t *cx_column_cursor_next_batch_nulls(struct cx_column_cursor *,
+                                                  size_t *available);
+
 #ifdef __cplusplus
 }
 #endif
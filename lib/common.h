@@ -21,17 +21,36 @@ enum cx_column_type {
     CX_COLUMN_STR
 };
 
-// 编码类型，目前只有无编码
-enum cx_encoding_type { CX_ENCODING_NONE };
+// 编码类型
+enum cx_encoding_type {
+    CX_ENCODING_NONE,
+    CX_ENCODING_DICT,
+    CX_ENCODING_RLE,
+    CX_ENCODING_DELTA,
+    CX_ENCODING_DELTA_OF_DELTA,
+    CX_ENCODING_BITPACK,
+    CX_ENCODING_XOR,
+    CX_ENCODING_BYTE_STREAM_SPLIT,
+    CX_ENCODING_OFFSETS,
+    CX_ENCODING_FSST,
+    CX_ENCODING_CONSTANT,
+    CX_ENCODING_SPARSE
+};
 
 // 压缩类型
 enum cx_compression_type {
     CX_COMPRESSION_NONE,
     CX_COMPRESSION_LZ4,
     CX_COMPRESSION_LZ4HC,
-    CX_COMPRESSION_ZSTD
+    CX_COMPRESSION_ZSTD,
+    CX_COMPRESSION_AUTO
 };
 
+// 自动选择时, level 为解码速度的权重 (0-100)
+#define CX_AUTO_SMALLEST 0
+#define CX_AUTO_BALANCED 50
+#define CX_AUTO_FASTEST 100
+
 // 字符串
 struct cx_string {
     const char *ptr;
@@ -2,28 +2,100 @@
 
 #include <limits.h>
 #include <lz4hc.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <zdict.h>
 #include <zstd.h>
 
-static void *cx_compress_lz4(int level, const void *src, size_t src_size,
-                             size_t *dest_size)
+#include "pool.h"
+
+// 线程本地的压缩上下文, 避免每个列块都重新创建
+struct cx_codec_contexts {
+    ZSTD_CCtx *zstd_compress;
+    ZSTD_DCtx *zstd_decompress;
+    void *lz4;    // LZ4_compress_fast_extState 的状态
+    void *lz4hc;  // LZ4_compress_HC_extStateHC 的状态
+};
+
+// ZSTD 字典
+struct cx_zstd_dictionary {
+    ZSTD_CDict *compress;  // 仅用于训练得到的字典
+    ZSTD_DDict *decompress;
+    void *data;            // 仅用于训练得到的字典
+    size_t size;
+};
+
+static pthread_key_t cx_codec_key;
+static pthread_once_t cx_codec_once = PTHREAD_ONCE_INIT;
+static bool cx_codec_key_created;
+
+static void cx_codec_contexts_free(void *ptr)
 {
-    if (src_size > INT_MAX)
+    struct cx_codec_contexts *contexts = ptr;
+    ZSTD_freeCCtx(contexts->zstd_compress);
+    ZSTD_freeDCtx(contexts->zstd_decompress);
+    free(contexts->lz4);
+    free(contexts->lz4hc);
+    free(contexts);
+}
+
+static void cx_codec_init(void)
+{
+    // contexts are released when their thread exits
+    cx_codec_key_created =
+        !pthread_key_create(&cx_codec_key, cx_codec_contexts_free);
+}
+
+static struct cx_codec_contexts *cx_codec_contexts(void)
+{
+    if (pthread_once(&cx_codec_once, cx_codec_init) || !cx_codec_key_created)
         return NULL;
-    int max_size = LZ4_compressBound(src_size);
-    if (!max_size)
+    struct cx_codec_contexts *contexts = pthread_getspecific(cx_codec_key);
+    if (contexts)
+        return contexts;
+    contexts = calloc(1, sizeof(*contexts));
+    if (!contexts)
         return NULL;
-    void *compressed = malloc(max_size);
-    if (!compressed)
+    if (pthread_setspecific(cx_codec_key, contexts)) {
+        free(contexts);
         return NULL;
-    int result = LZ4_compress_fast(src, compressed, src_size, max_size, level);
+    }
+    return contexts;
+}
+
+size_t cx_compress_bound(enum cx_compression_type type, size_t size)
+{
+    if (type == CX_COMPRESSION_LZ4 || type == CX_COMPRESSION_LZ4HC) {
+        if (size > INT_MAX)
+            return 0;
+        return LZ4_compressBound(size);
+    } else if (type == CX_COMPRESSION_ZSTD) {
+        size_t bound = ZSTD_compressBound(size);
+        return ZSTD_isError(bound) ? 0 : bound;
+    } else {
+        return 0;
+    }
+}
+
+static bool cx_compress_lz4(int level, const void *src, size_t src_size,
+                            void *dest, size_t dest_capacity,
+                            size_t *dest_size)
+{
+    if (src_size > INT_MAX)
+        return false;
+    if (dest_capacity > INT_MAX)
+        dest_capacity = INT_MAX;
+    struct cx_codec_contexts *contexts = cx_codec_contexts();
+    if (!contexts)
+        return false;
+    if (!contexts->lz4 && !(contexts->lz4 = malloc(LZ4_sizeofState())))
+        return false;
+    int result = LZ4_compress_fast_extState(contexts->lz4, src, dest, src_size,
+                                            dest_capacity, level);
     if (!result)
-        goto error;
+        return false;
     *dest_size = result;
-    return compressed;
-error:
-    free(compressed);
-    return NULL;
+    return true;
 }
 
 static bool cx_decompress_lz4(const void *src, size_t src_size, void *dest,
@@ -33,73 +105,299 @@ static bool cx_decompress_lz4(const void *src, size_t src_size, void *dest,
     return result && (size_t)result == dest_size;
 }
 
-static void *cx_compress_lz4hc(int level, const void *src, size_t src_size,
-                               size_t *dest_size)
+static bool cx_compress_lz4hc(int level, const void *src, size_t src_size,
+                              void *dest, size_t dest_capacity,
+                              size_t *dest_size)
 {
     if (src_size > INT_MAX)
-        return NULL;
-    int max_size = LZ4_compressBound(src_size);
-    if (!max_size)
-        return NULL;
-    void *compressed = malloc(max_size);
-    if (!compressed)
-        return NULL;
-    int result = LZ4_compress_HC(src, compressed, src_size, max_size, level);
+        return false;
+    if (dest_capacity > INT_MAX)
+        dest_capacity = INT_MAX;
+    struct cx_codec_contexts *contexts = cx_codec_contexts();
+    if (!contexts)
+        return false;
+    if (!contexts->lz4hc &&
+        !(contexts->lz4hc = malloc(LZ4_sizeofStateHC())))
+        return false;
+    int result = LZ4_compress_HC_extStateHC(contexts->lz4hc, src, dest,
+                                            src_size, dest_capacity, level);
     if (!result)
-        goto error;
+        return false;
     *dest_size = result;
-    return compressed;
-error:
-    free(compressed);
-    return NULL;
+    return true;
 }
 
-static void *cx_compress_zstd(int level, const void *src, size_t src_size,
-                              size_t *dest_size)
+static bool cx_compress_zstd(int level,
+                             const struct cx_zstd_dictionary *dictionary,
+                             const void *src, size_t src_size, void *dest,
+                             size_t dest_capacity, size_t *dest_size)
 {
-    int max_size = ZSTD_compressBound(src_size);
-    if (!max_size)
-        return NULL;
-    void *compressed = malloc(max_size);
-    if (!compressed)
-        return NULL;
-    size_t result = ZSTD_compress(compressed, max_size, src, src_size, level);
+    struct cx_codec_contexts *contexts = cx_codec_contexts();
+    if (!contexts)
+        return false;
+    if (!contexts->zstd_compress &&
+        !(contexts->zstd_compress = ZSTD_createCCtx()))
+        return false;
+    size_t result;
+    // the level of a dictionary is fixed when it's trained
+    if (dictionary && dictionary->compress)
+        result = ZSTD_compress_usingCDict(contexts->zstd_compress, dest,
+                                          dest_capacity, src, src_size,
+                                          dictionary->compress);
+    else
+        result = ZSTD_compressCCtx(contexts->zstd_compress, dest,
+                                   dest_capacity, src, src_size, level);
     if (ZSTD_isError(result))
-        goto error;
+        return false;
     *dest_size = result;
-    return compressed;
-error:
-    free(compressed);
-    return NULL;
+    return true;
 }
 
-static bool cx_decompress_zstd(const void *src, size_t src_size, void *dest,
+static bool cx_decompress_zstd(const struct cx_zstd_dictionary *dictionary,
+                               const void *src, size_t src_size, void *dest,
                                size_t dest_size)
 {
-    size_t result = ZSTD_decompress(dest, dest_size, src, src_size);
+    struct cx_codec_contexts *contexts = cx_codec_contexts();
+    if (!contexts)
+        return false;
+    if (!contexts->zstd_decompress &&
+        !(contexts->zstd_decompress = ZSTD_createDCtx()))
+        return false;
+    size_t result;
+    if (dictionary)
+        result = ZSTD_decompress_usingDDict(contexts->zstd_decompress, dest,
+                                            dest_size, src, src_size,
+                                            dictionary->decompress);
+    else
+        result = ZSTD_decompressDCtx(contexts->zstd_decompress, dest,
+                                     dest_size, src, src_size);
     return !ZSTD_isError(result) && result == dest_size;
 }
 
-void *cx_compress(enum cx_compression_type type, int level, const void *src,
-                  size_t src_size, size_t *dest_size)
+static bool cx_compress_dict_into(enum cx_compression_type type, int level,
+                                  const struct cx_zstd_dictionary *dictionary,
+                                  const void *src, size_t src_size, void *dest,
+                                  size_t dest_capacity, size_t *dest_size)
 {
     if (type == CX_COMPRESSION_LZ4)
-        return cx_compress_lz4(level, src, src_size, dest_size);
+        return cx_compress_lz4(level, src, src_size, dest, dest_capacity,
+                               dest_size);
     else if (type == CX_COMPRESSION_LZ4HC)
-        return cx_compress_lz4hc(level, src, src_size, dest_size);
+        return cx_compress_lz4hc(level, src, src_size, dest, dest_capacity,
+                                 dest_size);
     else if (type == CX_COMPRESSION_ZSTD)
-        return cx_compress_zstd(level, src, src_size, dest_size);
+        return cx_compress_zstd(level, dictionary, src, src_size, dest,
+                                dest_capacity, dest_size);
     else
+        return false;
+}
+
+bool cx_compress_into(enum cx_compression_type type, int level,
+                      const void *src, size_t src_size, void *dest,
+                      size_t dest_capacity, size_t *dest_size)
+{
+    return cx_compress_dict_into(type, level, NULL, src, src_size, dest,
+                                 dest_capacity, dest_size);
+}
+
+void *cx_compress(enum cx_compression_type type, int level, const void *src,
+                  size_t src_size, size_t *dest_size)
+{
+    size_t max_size = cx_compress_bound(type, src_size);
+    if (!max_size)
         return NULL;
+    void *compressed = malloc(max_size);
+    if (!compressed)
+        return NULL;
+    if (!cx_compress_into(type, level, src, src_size, compressed, max_size,
+                          dest_size)) {
+        free(compressed);
+        return NULL;
+    }
+    return compressed;
 }
 
-bool cx_decompress(enum cx_compression_type type, const void *src,
-                   size_t src_size, void *dest, size_t dest_size)
+void *cx_compress_pooled(enum cx_compression_type type, int level,
+                         const struct cx_zstd_dictionary *dictionary,
+                         const void *src, size_t src_size, size_t *dest_size,
+                         size_t *capacity)
+{
+    size_t max_size = cx_compress_bound(type, src_size);
+    if (!max_size)
+        return NULL;
+    void *compressed = cx_pool_get(max_size, capacity);
+    if (!compressed)
+        return NULL;
+    if (!cx_compress_dict_into(type, level, dictionary, src, src_size,
+                               compressed, max_size, dest_size)) {
+        cx_pool_put(compressed, *capacity);
+        return NULL;
+    }
+    return compressed;
+}
+
+bool cx_decompress_dict(enum cx_compression_type type,
+                        const struct cx_zstd_dictionary *dictionary,
+                        const void *src, size_t src_size, void *dest,
+                        size_t dest_size)
 {
     if (type == CX_COMPRESSION_LZ4 || type == CX_COMPRESSION_LZ4HC)
         return cx_decompress_lz4(src, src_size, dest, dest_size);
     else if (type == CX_COMPRESSION_ZSTD)
-        return cx_decompress_zstd(src, src_size, dest, dest_size);
+        return cx_decompress_zstd(dictionary, src, src_size, dest, dest_size);
     else
         return false;
 }
+
+bool cx_decompress(enum cx_compression_type type, const void *src,
+                   size_t src_size, void *dest, size_t dest_size)
+{
+    return cx_decompress_dict(type, NULL, src, src_size, dest, dest_size);
+}
+
+struct cx_zstd_dictionary *cx_zstd_dictionary_train(const void *samples,
+                                                    const size_t *sample_sizes,
+                                                    size_t sample_count,
+                                                    size_t capacity, int level)
+{
+    if (sample_count > UINT_MAX)
+        return NULL;
+    struct cx_zstd_dictionary *dictionary = calloc(1, sizeof(*dictionary));
+    if (!dictionary)
+        return NULL;
+    dictionary->data = malloc(capacity);
+    if (!dictionary->data)
+        goto error;
+    size_t size = ZDICT_trainFromBuffer(dictionary->data, capacity, samples,
+                                        sample_sizes, sample_count);
+    if (ZDICT_isError(size))
+        goto error;
+    dictionary->size = size;
+    dictionary->compress =
+        ZSTD_createCDict(dictionary->data, dictionary->size, level);
+    if (!dictionary->compress)
+        goto error;
+    dictionary->decompress =
+        ZSTD_createDDict(dictionary->data, dictionary->size);
+    if (!dictionary->decompress)
+        goto error;
+    return dictionary;
+error:
+    cx_zstd_dictionary_free(dictionary);
+    return NULL;
+}
+
+struct cx_zstd_dictionary *cx_zstd_dictionary_new(const void *data,
+                                                  size_t size)
+{
+    struct cx_zstd_dictionary *dictionary = calloc(1, sizeof(*dictionary));
+    if (!dictionary)
+        return NULL;
+    dictionary->decompress = ZSTD_createDDict(data, size);
+    if (!dictionary->decompress) {
+        free(dictionary);
+        return NULL;
+    }
+    dictionary->size = size;
+    return dictionary;
+}
+
+const void *cx_zstd_dictionary_export(
+    const struct cx_zstd_dictionary *dictionary, size_t *size)
+{
+    *size = dictionary->size;
+    return dictionary->data;
+}
+
+void cx_zstd_dictionary_free(struct cx_zstd_dictionary *dictionary)
+{
+    ZSTD_freeCDict(dictionary->compress);
+    ZSTD_freeDDict(dictionary->decompress);
+    free(dictionary->data);
+    free(dictionary);
+}
+
+struct cx_decompressor {
+    ZSTD_DCtx *context;  // 打开期间从线程本地上下文借用
+    ZSTD_inBuffer input;
+};
+
+// streams borrow the decompression context of the calling thread, and
+// streams that are open alongside it get their own
+static ZSTD_DCtx *cx_decompress_context_take(void)
+{
+    struct cx_codec_contexts *contexts = cx_codec_contexts();
+    if (!contexts || !contexts->zstd_decompress)
+        return ZSTD_createDCtx();
+    ZSTD_DCtx *context = contexts->zstd_decompress;
+    contexts->zstd_decompress = NULL;
+    return context;
+}
+
+// a context that's handed back mustn't keep the dictionary of the stream,
+// since one-shot decompression would apply it to every chunk
+static void cx_decompress_context_put(ZSTD_DCtx *context)
+{
+    struct cx_codec_contexts *contexts = cx_codec_contexts();
+    if (contexts && !contexts->zstd_decompress &&
+        !ZSTD_isError(
+            ZSTD_DCtx_reset(context, ZSTD_reset_session_and_parameters)))
+        contexts->zstd_decompress = context;
+    else
+        ZSTD_freeDCtx(context);
+}
+
+struct cx_decompressor *cx_decompressor_new(
+    enum cx_compression_type type, const struct cx_zstd_dictionary *dictionary,
+    const void *src, size_t src_size)
+{
+    // LZ4 chunks are stored as a single block, which can't be decompressed
+    // without a buffer for the whole block
+    if (type != CX_COMPRESSION_ZSTD)
+        return NULL;
+    struct cx_decompressor *decompressor = malloc(sizeof(*decompressor));
+    if (!decompressor)
+        return NULL;
+    decompressor->context = cx_decompress_context_take();
+    if (!decompressor->context)
+        goto error;
+    if (ZSTD_isError(ZSTD_DCtx_reset(decompressor->context,
+                                     ZSTD_reset_session_and_parameters)))
+        goto error;
+    if (dictionary && ZSTD_isError(ZSTD_DCtx_refDDict(decompressor->context,
+                                                      dictionary->decompress)))
+        goto error;
+    decompressor->input.src = src;
+    decompressor->input.size = src_size;
+    decompressor->input.pos = 0;
+    return decompressor;
+error:
+    if (decompressor->context)
+        cx_decompress_context_put(decompressor->context);
+    free(decompressor);
+    return NULL;
+}
+
+void cx_decompressor_free(struct cx_decompressor *decompressor)
+{
+    cx_decompress_context_put(decompressor->context);
+    free(decompressor);
+}
+
+bool cx_decompressor_read(struct cx_decompressor *decompressor, void *dest,
+                          size_t size)
+{
+    ZSTD_outBuffer output = {dest, size, 0};
+    while (output.pos < output.size) {
+        size_t pos = output.pos;
+        size_t result = ZSTD_decompressStream(decompressor->context, &output,
+                                              &decompressor->input);
+        if (ZSTD_isError(result))
+            return false;
+        // the frame ended (or the input ran out) before the read was filled
+        if (output.pos == pos &&
+            (!result || decompressor->input.pos == decompressor->input.size))
+            return false;
+    }
+    return true;
+}
@@ -7,12 +7,69 @@ extern "C" {
 
 #include "common.h"
 
+// codecs use a context for each thread (see pool.h for buffers), which is
+// created on first use and released when the thread exits
+
+// the largest size a buffer of size bytes can compress to, or 0 if it can't
+// be compressed with the type
+size_t cx_compress_bound(enum cx_compression_type, size_t size);
+
+bool cx_compress_into(enum cx_compression_type, int level, const void *src,
+                      size_t src_size, void *dest, size_t dest_capacity,
+                      size_t *dest_size);
+
 void *cx_compress(enum cx_compression_type, int level, const void *src,
                   size_t src_size, size_t *dest_size);
 
+struct cx_zstd_dictionary;
+
+// compress into a buffer from the pool of the calling thread, which is
+// returned with cx_pool_put(buffer, *capacity). ZSTD uses the dictionary
+// (and its level) if one is provided
+void *cx_compress_pooled(enum cx_compression_type, int level,
+                         const struct cx_zstd_dictionary *, const void *src,
+                         size_t src_size, size_t *dest_size,
+                         size_t *capacity);
+
 bool cx_decompress(enum cx_compression_type, const void *src, size_t src_size,
                    void *dest, size_t dest_size);
 
+// decompress a chunk that may have been compressed with a ZSTD dictionary
+bool cx_decompress_dict(enum cx_compression_type,
+                        const struct cx_zstd_dictionary *, const void *src,
+                        size_t src_size, void *dest, size_t dest_size);
+
+// train a ZSTD dictionary of up to capacity bytes for compressing at the
+// level, from samples laid out one after the other
+struct cx_zstd_dictionary *cx_zstd_dictionary_train(const void *samples,
+                                                    const size_t *sample_sizes,
+                                                    size_t sample_count,
+                                                    size_t capacity, int level);
+
+// a trained dictionary read back from a file, which can only decompress
+struct cx_zstd_dictionary *cx_zstd_dictionary_new(const void *data,
+                                                  size_t size);
+
+// the dictionary as it's stored (trained dictionaries only)
+const void *cx_zstd_dictionary_export(const struct cx_zstd_dictionary *,
+                                      size_t *size);
+
+void cx_zstd_dictionary_free(struct cx_zstd_dictionary *);
+
+struct cx_decompressor;
+
+// decompress a buffer incrementally, so that only a small window of the
+// output is held at a time. only CX_COMPRESSION_ZSTD is supported, and
+// NULL is returned for other types
+struct cx_decompressor *cx_decompressor_new(enum cx_compression_type,
+                                            const struct cx_zstd_dictionary *,
+                                            const void *src, size_t src_size);
+
+void cx_decompressor_free(struct cx_decompressor *);
+
+// decompress the next size bytes of the output
+bool cx_decompressor_read(struct cx_decompressor *, void *dest, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1044 @@
+#include "encode.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitpack.h"
+#include "file.h"
+#include "fsst.h"
+#include "split.h"
+
+static const size_t cx_dict_initial_size = 64;
+
+struct cx_dict_entry {
+    struct cx_string string;
+    uint32_t id;
+};
+
+struct cx_dict {
+    struct cx_dict_entry *entries;
+    size_t count;
+    size_t size;
+    uint32_t *slots;
+    size_t slot_count;
+    size_t strings_size;
+};
+
+bool cx_encoding_supported(enum cx_column_type type,
+                           enum cx_encoding_type encoding)
+{
+    switch (encoding) {
+        case CX_ENCODING_NONE:
+            return true;
+        case CX_ENCODING_DICT:
+            return type == CX_COLUMN_STR;
+        case CX_ENCODING_RLE:
+            return type == CX_COLUMN_BIT || type == CX_COLUMN_I32 ||
+                   type == CX_COLUMN_I64;
+        case CX_ENCODING_DELTA:
+        case CX_ENCODING_DELTA_OF_DELTA:
+            return type == CX_COLUMN_I64;
+        case CX_ENCODING_BITPACK:
+            return type == CX_COLUMN_I32 || type == CX_COLUMN_I64;
+        case CX_ENCODING_OFFSETS:
+        case CX_ENCODING_FSST:
+            return type == CX_COLUMN_STR;
+        case CX_ENCODING_XOR:
+        case CX_ENCODING_BYTE_STREAM_SPLIT:
+            return type == CX_COLUMN_FLT || type == CX_COLUMN_DBL;
+        case CX_ENCODING_CONSTANT:
+            return true;
+        case CX_ENCODING_SPARSE:
+            return type != CX_COLUMN_BIT;
+    }
+    return false;
+}
+
+bool cx_column_constant(const struct cx_column *column)
+{
+    size_t count = cx_column_count(column);
+    if (cx_column_encoding(column) != CX_ENCODING_NONE || !count)
+        return false;
+    size_t size;
+    const void *buffer = cx_column_export(column, &size);
+    // values are compared bit for bit, so that e.g. 0.0 and -0.0 differ
+    switch (cx_column_type(column)) {
+        case CX_COLUMN_BIT: {
+            const uint64_t *words = buffer;
+            uint64_t word = words[0] & 1 ? UINT64_MAX : 0;
+            for (size_t i = 0; i < count / 64; i++)
+                if (words[i] != word)
+                    return false;
+            if (!(count % 64))
+                return true;
+            uint64_t trailing = ((uint64_t)1 << (count % 64)) - 1;
+            return !((words[count / 64] ^ word) & trailing);
+        }
+        case CX_COLUMN_I32:
+        case CX_COLUMN_FLT: {
+            const uint32_t *values = buffer;
+            for (size_t i = 1; i < count; i++)
+                if (values[i] != values[0])
+                    return false;
+            return true;
+        }
+        case CX_COLUMN_I64:
+        case CX_COLUMN_DBL: {
+            const uint64_t *values = buffer;
+            for (size_t i = 1; i < count; i++)
+                if (values[i] != values[0])
+                    return false;
+            return true;
+        }
+        case CX_COLUMN_STR: {
+            // the plain layout is the NUL-terminated strings back to back
+            const char *strings = buffer;
+            size_t length = strlen(strings) + 1;
+            if (size != count * length)
+                return false;
+            for (size_t offset = length; offset < size; offset += length)
+                if (memcmp(strings, strings + offset, length))
+                    return false;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct cx_column *cx_column_slice(const struct cx_column *column, size_t start,
+                                  size_t count, size_t *end)
+{
+    if (cx_column_encoding(column) != CX_ENCODING_NONE)
+        return NULL;
+    size_t size;
+    const char *buffer = cx_column_export(column, &size);
+    size_t slice_size = 0;
+    switch (cx_column_type(column)) {
+        case CX_COLUMN_BIT:
+            if (start % sizeof(uint64_t))
+                return NULL;
+            slice_size = (count + 63) / 64 * sizeof(uint64_t);
+            break;
+        case CX_COLUMN_I32:
+        case CX_COLUMN_FLT:
+            slice_size = count * sizeof(int32_t);
+            break;
+        case CX_COLUMN_I64:
+        case CX_COLUMN_DBL:
+            slice_size = count * sizeof(int64_t);
+            break;
+        case CX_COLUMN_STR:
+            for (size_t i = 0; i < count; i++) {
+                if (start + slice_size >= size)
+                    return NULL;
+                const char *string = buffer + start + slice_size;
+                const char *nul =
+                    memchr(string, 0, size - start - slice_size);
+                if (!nul)
+                    return NULL;
+                slice_size += nul - string + 1;
+            }
+            break;
+    }
+    if (start > size || slice_size > size - start)
+        return NULL;
+    struct cx_column *slice;
+    if (slice_size) {
+        void *dest;
+        slice = cx_column_new_compressed(cx_column_type(column),
+                                         CX_ENCODING_NONE, &dest, slice_size,
+                                         count);
+        if (slice)
+            memcpy(dest, buffer + start, slice_size);
+    } else {
+        slice = cx_column_new(cx_column_type(column), CX_ENCODING_NONE);
+    }
+    if (slice)
+        *end = start + slice_size;
+    return slice;
+}
+
+static size_t cx_encode_align(size_t size)
+{
+    size_t mod = size % CX_WRITE_ALIGN;
+    return mod ? size - mod + CX_WRITE_ALIGN : size;
+}
+
+static uint64_t cx_dict_hash(const struct cx_string *string)
+{
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < string->len; i++) {
+        hash ^= (unsigned char)string->ptr[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static bool cx_dict_init(struct cx_dict *dict)
+{
+    memset(dict, 0, sizeof(*dict));
+    dict->entries = malloc(cx_dict_initial_size * sizeof(*dict->entries));
+    if (!dict->entries)
+        return false;
+    dict->size = cx_dict_initial_size;
+    dict->slot_count = cx_dict_initial_size * 2;
+    dict->slots = calloc(dict->slot_count, sizeof(*dict->slots));
+    if (!dict->slots)
+        goto error;
+    return true;
+error:
+    free(dict->entries);
+    return false;
+}
+
+static void cx_dict_release(struct cx_dict *dict)
+{
+    free(dict->entries);
+    free(dict->slots);
+}
+
+static uint32_t *cx_dict_slot(const struct cx_dict *dict,
+                              const struct cx_string *string)
+{
+    // slots hold an entry index + 1, with zero marking an empty slot
+    size_t mask = dict->slot_count - 1;
+    size_t i = cx_dict_hash(string) & mask;
+    for (;; i = (i + 1) & mask) {
+        uint32_t *slot = &dict->slots[i];
+        if (!*slot)
+            return slot;
+        const struct cx_string *entry = &dict->entries[*slot - 1].string;
+        if (entry->len == string->len &&
+            !memcmp(entry->ptr, string->ptr, string->len))
+            return slot;
+    }
+}
+
+static bool cx_dict_grow(struct cx_dict *dict)
+{
+    size_t size = dict->size * 2;
+    assert(size > dict->size);
+    struct cx_dict_entry *entries =
+        realloc(dict->entries, size * sizeof(*entries));
+    if (!entries)
+        return false;
+    dict->entries = entries;
+    dict->size = size;
+    uint32_t *slots = calloc(size * 2, sizeof(*slots));
+    if (!slots)
+        return false;
+    free(dict->slots);
+    dict->slots = slots;
+    dict->slot_count = size * 2;
+    for (size_t i = 0; i < dict->count; i++)
+        *cx_dict_slot(dict, &dict->entries[i].string) = i + 1;
+    return true;
+}
+
+static bool cx_dict_put(struct cx_dict *dict, const struct cx_string *string,
+                        uint32_t *id)
+{
+    uint32_t *slot = cx_dict_slot(dict, string);
+    if (*slot) {
+        *id = *slot - 1;
+        return true;
+    }
+    if (dict->count == INT32_MAX)
+        return false;
+    if (dict->count == dict->size) {
+        if (!cx_dict_grow(dict))
+            return false;
+        slot = cx_dict_slot(dict, string);
+    }
+    struct cx_dict_entry *entry = &dict->entries[dict->count];
+    entry->string = *string;
+    entry->id = dict->count;
+    *id = dict->count++;
+    *slot = *id + 1;
+    dict->strings_size += string->len + 1;
+    return true;
+}
+
+static int cx_dict_entry_cmp(const void *a, const void *b)
+{
+    const struct cx_dict_entry *x = a, *y = b;
+    return strcmp(x->string.ptr, y->string.ptr);
+}
+
+static struct cx_column *cx_encode_dict(const struct cx_column *column)
+{
+    struct cx_column *encoded = NULL;
+    uint32_t *ids = NULL, *codes = NULL;
+    struct cx_dict dict;
+    if (!cx_dict_init(&dict))
+        return NULL;
+    struct cx_column_cursor *cursor = cx_column_cursor_new(column);
+    if (!cursor)
+        goto error;
+    size_t count = cx_column_count(column);
+    if (count) {
+        ids = malloc(count * sizeof(*ids));
+        if (!ids)
+            goto error;
+    }
+
+    // assign each distinct string an id in order of appearance
+    size_t position = 0;
+    while (cx_column_cursor_valid(cursor)) {
+        size_t batch_count;
+        const struct cx_string *strings =
+            cx_column_cursor_next_batch_str(cursor, &batch_count);
+        assert(position + batch_count <= count);
+        for (size_t i = 0; i < batch_count; i++)
+            if (!cx_dict_put(&dict, &strings[i], &ids[position + i]))
+                goto error;
+        position += batch_count;
+    }
+
+    // sort the dictionary so that codes preserve the order of the strings,
+    // and then map each id to its code
+    qsort(dict.entries, dict.count, sizeof(*dict.entries), cx_dict_entry_cmp);
+    if (dict.count) {
+        codes = malloc(dict.count * sizeof(*codes));
+        if (!codes)
+            goto error;
+    }
+    for (size_t i = 0; i < dict.count; i++)
+        codes[dict.entries[i].id] = i;
+
+    size_t strings_size = cx_encode_align(dict.strings_size);
+    size_t size = sizeof(struct cx_dict_header) + strings_size +
+                  count * sizeof(int32_t);
+    void *ptr;
+    encoded = cx_column_new_compressed(CX_COLUMN_STR, CX_ENCODING_DICT, &ptr,
+                                       size, count);
+    if (!encoded)
+        goto error;
+    struct cx_dict_header *header = ptr;
+    memset(header, 0, sizeof(*header));
+    header->size = strings_size;
+    header->count = dict.count;
+    char *string = (char *)(header + 1);
+    for (size_t i = 0; i < dict.count; i++) {
+        memcpy(string, dict.entries[i].string.ptr,
+               dict.entries[i].string.len + 1);
+        string += dict.entries[i].string.len + 1;
+    }
+    memset(string, 0, strings_size - dict.strings_size);
+    int32_t *column_codes = (int32_t *)((char *)(header + 1) + strings_size);
+    for (size_t i = 0; i < count; i++)
+        column_codes[i] = codes[ids[i]];
+
+    cx_column_cursor_free(cursor);
+    cx_dict_release(&dict);
+    free(codes);
+    free(ids);
+    return encoded;
+error:
+    if (cursor)
+        cx_column_cursor_free(cursor);
+    cx_dict_release(&dict);
+    free(codes);
+    free(ids);
+    return NULL;
+}
+
+struct cx_rle {
+    void *runs;
+    size_t count;
+    size_t size;
+    int64_t value;
+    uint64_t length;
+    uint64_t max_length;
+    size_t run_size;
+    enum cx_column_type type;
+};
+
+static bool cx_rle_flush(struct cx_rle *rle)
+{
+    if (!rle->length)
+        return true;
+    if (rle->count == rle->size) {
+        size_t size = rle->size ? rle->size * 2 : 64;
+        assert(size > rle->size);
+        void *runs = realloc(rle->runs, size * rle->run_size);
+        if (!runs)
+            return false;
+        rle->runs = runs;
+        rle->size = size;
+    }
+    if (rle->type == CX_COLUMN_I64) {
+        struct cx_rle_run64 *run = rle->runs;
+        run[rle->count].value = rle->value;
+        run[rle->count].length = rle->length;
+    } else {
+        struct cx_rle_run32 *run = rle->runs;
+        run[rle->count].value = rle->value;
+        run[rle->count].length = rle->length;
+    }
+    rle->count++;
+    rle->length = 0;
+    return true;
+}
+
+static bool cx_rle_put(struct cx_rle *rle, int64_t value)
+{
+    if (rle->length && (rle->value != value || rle->length == rle->max_length))
+        if (!cx_rle_flush(rle))
+            return false;
+    rle->value = value;
+    rle->length++;
+    return true;
+}
+
+static struct cx_column *cx_encode_rle(const struct cx_column *column)
+{
+    enum cx_column_type type = cx_column_type(column);
+    struct cx_rle rle = {.type = type};
+    if (type == CX_COLUMN_I64) {
+        rle.run_size = sizeof(struct cx_rle_run64);
+        rle.max_length = UINT64_MAX;
+    } else {
+        rle.run_size = sizeof(struct cx_rle_run32);
+        rle.max_length = UINT32_MAX;
+    }
+    struct cx_column *encoded = NULL;
+    struct cx_column_cursor *cursor = cx_column_cursor_new(column);
+    if (!cursor)
+        return NULL;
+    while (cx_column_cursor_valid(cursor)) {
+        size_t count;
+        switch (type) {
+            case CX_COLUMN_BIT: {
+                const uint64_t *bitset =
+                    cx_column_cursor_next_batch_bit(cursor, &count);
+                for (size_t i = 0; i < count; i++)
+                    if (!cx_rle_put(&rle, (*bitset >> i) & 1))
+                        goto error;
+            } break;
+            case CX_COLUMN_I32: {
+                const int32_t *values =
+                    cx_column_cursor_next_batch_i32(cursor, &count);
+                for (size_t i = 0; i < count; i++)
+                    if (!cx_rle_put(&rle, values[i]))
+                        goto error;
+            } break;
+            case CX_COLUMN_I64: {
+                const int64_t *values =
+                    cx_column_cursor_next_batch_i64(cursor, &count);
+                for (size_t i = 0; i < count; i++)
+                    if (!cx_rle_put(&rle, values[i]))
+                        goto error;
+            } break;
+            default:
+                goto error;
+        }
+    }
+    if (!cx_rle_flush(&rle))
+        goto error;
+    void *ptr;
+    size_t size = rle.count * rle.run_size;
+    encoded = cx_column_new_compressed(type, CX_ENCODING_RLE, &ptr, size,
+                                       cx_column_count(column));
+    if (!encoded)
+        goto error;
+    memcpy(ptr, rle.runs, size);
+    cx_column_cursor_free(cursor);
+    free(rle.runs);
+    return encoded;
+error:
+    cx_column_cursor_free(cursor);
+    free(rle.runs);
+    return NULL;
+}
+
+static size_t cx_delta_encode_block(enum cx_encoding_type encoding,
+                                    size_t count, const int64_t values[],
+                                    struct cx_delta_block *block,
+                                    uint64_t *packed)
+{
+    // differences are computed on unsigned values so that they wrap
+    const uint64_t *unsigned_values = (const uint64_t *)values;
+    uint64_t deltas[CX_DELTA_BLOCK_SIZE];
+    size_t delta_count = 0;
+    memset(block, 0, sizeof(*block));
+    block->first = values[0];
+    if (encoding == CX_ENCODING_DELTA) {
+        for (size_t i = 1; i < count; i++)
+            deltas[delta_count++] = unsigned_values[i] - unsigned_values[i - 1];
+    } else if (count > 1) {
+        uint64_t previous = unsigned_values[1] - unsigned_values[0];
+        block->delta = previous;
+        for (size_t i = 2; i < count; i++) {
+            uint64_t delta = unsigned_values[i] - unsigned_values[i - 1];
+            deltas[delta_count++] = delta - previous;
+            previous = delta;
+        }
+    }
+    if (!delta_count)
+        return 0;
+    int64_t reference = deltas[0];
+    for (size_t i = 1; i < delta_count; i++)
+        if ((int64_t)deltas[i] < reference)
+            reference = deltas[i];
+    uint64_t max = 0;
+    for (size_t i = 0; i < delta_count; i++) {
+        deltas[i] -= reference;
+        if (deltas[i] > max)
+            max = deltas[i];
+    }
+    block->reference = reference;
+    block->width = cx_bitpack_width(max);
+    cx_bitpack_pack(delta_count, deltas, block->width, packed);
+    return cx_bitpack_size(delta_count, block->width);
+}
+
+static struct cx_column *cx_encode_delta(const struct cx_column *column,
+                                         enum cx_encoding_type encoding)
+{
+    size_t count = cx_column_count(column);
+    size_t block_count =
+        (count + CX_DELTA_BLOCK_SIZE - 1) / CX_DELTA_BLOCK_SIZE;
+    struct cx_column *encoded = NULL;
+    struct cx_delta_block *blocks = NULL;
+    uint64_t *packed = NULL;
+    struct cx_column_cursor *cursor = cx_column_cursor_new(column);
+    if (!cursor)
+        return NULL;
+    if (block_count) {
+        blocks = malloc(block_count * sizeof(*blocks));
+        // a block never packs more than a word per row
+        packed = malloc(block_count * CX_DELTA_BLOCK_SIZE * sizeof(*packed));
+        if (!blocks || !packed)
+            goto error;
+    }
+    size_t block_index = 0, packed_count = 0;
+    while (cx_column_cursor_valid(cursor)) {
+        size_t batch_count;
+        const int64_t *values =
+            cx_column_cursor_next_batch_i64(cursor, &batch_count);
+        for (size_t i = 0; i < batch_count; i += CX_DELTA_BLOCK_SIZE) {
+            size_t block_size = batch_count - i;
+            if (block_size > CX_DELTA_BLOCK_SIZE)
+                block_size = CX_DELTA_BLOCK_SIZE;
+            assert(block_index < block_count);
+            if (packed_count > UINT32_MAX)
+                goto error;
+            struct cx_delta_block *block = &blocks[block_index++];
+            size_t size = cx_delta_encode_block(encoding, block_size,
+                                                &values[i], block,
+                                                &packed[packed_count]);
+            block->offset = packed_count;
+            packed_count += size;
+        }
+    }
+    assert(block_index == block_count);
+    void *ptr;
+    size_t blocks_size = block_count * sizeof(*blocks);
+    size_t packed_size = packed_count * sizeof(*packed);
+    encoded = cx_column_new_compressed(CX_COLUMN_I64, encoding, &ptr,
+                                       blocks_size + packed_size, count);
+    if (!encoded)
+        goto error;
+    if (block_count) {
+        memcpy(ptr, blocks, blocks_size);
+        memcpy((char *)ptr + blocks_size, packed, packed_size);
+    }
+    cx_column_cursor_free(cursor);
+    free(blocks);
+    free(packed);
+    return encoded;
+error:
+    cx_column_cursor_free(cursor);
+    free(blocks);
+    free(packed);
+    return NULL;
+}
+
+static struct cx_column *cx_encode_bitpack(const struct cx_column *column,
+                                           const struct cx_index *index)
+{
+    enum cx_column_type type = cx_column_type(column);
+    size_t count = cx_column_count(column);
+    if (!count)
+        return NULL;
+    struct cx_index *column_index = NULL;
+    if (!index) {
+        column_index = cx_index_new(column);
+        if (!column_index)
+            return NULL;
+        index = column_index;
+    }
+    int64_t base;
+    uint64_t range;
+    if (type == CX_COLUMN_I32) {
+        base = index->min.i32;
+        range = (uint64_t)index->max.i32 - (uint64_t)base;
+    } else {
+        base = index->min.i64;
+        range = (uint64_t)index->max.i64 - (uint64_t)base;
+    }
+    cx_index_free(column_index);
+
+    // constant chunks still use a bit per row
+    unsigned width = cx_bitpack_width(range);
+    if (!width)
+        width = 1;
+    size_t block_count =
+        (count + CX_BITPACK_BLOCK_SIZE - 1) / CX_BITPACK_BLOCK_SIZE;
+    size_t size = sizeof(struct cx_bitpack_header) +
+                  block_count * width * sizeof(uint64_t);
+    void *ptr;
+    struct cx_column *encoded =
+        cx_column_new_compressed(type, CX_ENCODING_BITPACK, &ptr, size, count);
+    if (!encoded)
+        return NULL;
+    struct cx_bitpack_header *header = ptr;
+    memset(header, 0, sizeof(*header));
+    header->base = base;
+    header->width = width;
+    uint64_t *planes = (uint64_t *)(header + 1);
+
+    struct cx_column_cursor *cursor = cx_column_cursor_new(column);
+    if (!cursor)
+        goto error;
+    uint64_t values[CX_BITPACK_BLOCK_SIZE];
+    size_t block_index = 0;
+    while (cx_column_cursor_valid(cursor)) {
+        size_t batch_count;
+        const int32_t *i32_batch = NULL;
+        const int64_t *i64_batch = NULL;
+        if (type == CX_COLUMN_I32)
+            i32_batch = cx_column_cursor_next_batch_i32(cursor, &batch_count);
+        else
+            i64_batch = cx_column_cursor_next_batch_i64(cursor, &batch_count);
+        for (size_t i = 0; i < batch_count; i += CX_BITPACK_BLOCK_SIZE) {
+            size_t block_size = batch_count - i;
+            if (block_size > CX_BITPACK_BLOCK_SIZE)
+                block_size = CX_BITPACK_BLOCK_SIZE;
+            for (size_t j = 0; j < block_size; j++)
+                values[j] = (i32_batch ? (uint64_t)i32_batch[i + j]
+                                       : (uint64_t)i64_batch[i + j]) -
+                            (uint64_t)base;
+            assert(block_index < block_count);
+            cx_bitpack_pack(block_size, values, width,
+                            &planes[block_index++ * width]);
+        }
+    }
+    assert(block_index == block_count);
+    cx_column_cursor_free(cursor);
+    return encoded;
+error:
+    cx_column_free(encoded);
+    return NULL;
+}
+
+struct cx_bit_writer {
+    uint64_t *words;
+    size_t size;
+    size_t position;  // in bits
+};
+
+static bool cx_bit_writer_put(struct cx_bit_writer *writer, uint64_t value,
+                              unsigned bits)
+{
+    assert(bits <= 64);
+    if (!bits)
+        return true;
+    size_t required = (writer->position + bits + 63) / 64;
+    if (required > writer->size) {
+        size_t size = writer->size ? writer->size * 2 : 64;
+        if (size < required)
+            size = required;
+        uint64_t *words = realloc(writer->words, size * sizeof(*words));
+        if (!words)
+            return false;
+        memset(&words[writer->size], 0,
+               (size - writer->size) * sizeof(*words));
+        writer->words = words;
+        writer->size = size;
+    }
+    if (bits < 64)
+        value &= ((uint64_t)1 << bits) - 1;
+    size_t word = writer->position / 64, shift = writer->position % 64;
+    writer->words[word] |= value << shift;
+    if (shift + bits > 64)
+        writer->words[word + 1] |= value >> (64 - shift);
+    writer->position += bits;
+    return true;
+}
+
+static bool cx_xor_encode_block(struct cx_bit_writer *writer, size_t count,
+                                const uint64_t values[], unsigned value_bits)
+{
+    unsigned field_bits = value_bits == 64 ? 6 : 5;
+    if (!cx_bit_writer_put(writer, values[0], value_bits))
+        return false;
+    bool window = false;
+    unsigned leading = 0, trailing = 0;
+    for (size_t i = 1; i < count; i++) {
+        uint64_t xor = values[i] ^ values[i - 1];
+        if (!xor) {
+            if (!cx_bit_writer_put(writer, 0, 1))
+                return false;
+            continue;
+        }
+        unsigned lz = __builtin_clzll(xor) - (64 - value_bits);
+        unsigned tz = __builtin_ctzll(xor);
+        if (window && lz >= leading && tz >= trailing) {
+            // 1 followed by 0, written least significant bit first
+            if (!cx_bit_writer_put(writer, 1, 2) ||
+                !cx_bit_writer_put(writer, xor >> trailing,
+                                   value_bits - leading - trailing))
+                return false;
+            continue;
+        }
+        unsigned length = value_bits - lz - tz;
+        if (!cx_bit_writer_put(writer, 3, 2) ||
+            !cx_bit_writer_put(writer, lz, field_bits) ||
+            !cx_bit_writer_put(writer, length - 1, field_bits) ||
+            !cx_bit_writer_put(writer, xor >> tz, length))
+            return false;
+        window = true;
+        leading = lz;
+        trailing = tz;
+    }
+    return true;
+}
+
+static struct cx_column *cx_encode_xor(const struct cx_column *column)
+{
+    enum cx_column_type type = cx_column_type(column);
+    size_t count = cx_column_count(column);
+    size_t block_count = (count + CX_XOR_BLOCK_SIZE - 1) / CX_XOR_BLOCK_SIZE;
+    unsigned value_bits = type == CX_COLUMN_DBL ? 64 : 32;
+    struct cx_column *encoded = NULL;
+    struct cx_xor_block *blocks = NULL;
+    struct cx_bit_writer writer = {NULL, 0, 0};
+    struct cx_column_cursor *cursor = cx_column_cursor_new(column);
+    if (!cursor)
+        return NULL;
+    if (block_count) {
+        blocks = malloc(block_count * sizeof(*blocks));
+        if (!blocks)
+            goto error;
+    }
+    uint64_t values[CX_XOR_BLOCK_SIZE];
+    size_t block_index = 0;
+    while (cx_column_cursor_valid(cursor)) {
+        size_t batch_count;
+        const void *batch;
+        if (type == CX_COLUMN_DBL)
+            batch = cx_column_cursor_next_batch_dbl(cursor, &batch_count);
+        else
+            batch = cx_column_cursor_next_batch_flt(cursor, &batch_count);
+        for (size_t i = 0; i < batch_count; i += CX_XOR_BLOCK_SIZE) {
+            size_t block_size = batch_count - i;
+            if (block_size > CX_XOR_BLOCK_SIZE)
+                block_size = CX_XOR_BLOCK_SIZE;
+            for (size_t j = 0; j < block_size; j++) {
+                if (type == CX_COLUMN_DBL) {
+                    memcpy(&values[j], (const double *)batch + i + j,
+                           sizeof(double));
+                } else {
+                    uint32_t bits;
+                    memcpy(&bits, (const float *)batch + i + j, sizeof(float));
+                    values[j] = bits;
+                }
+            }
+            // each block stream starts on a word boundary
+            writer.position = (writer.position + 63) / 64 * 64;
+            size_t offset = writer.position / 64;
+            if (offset > UINT32_MAX)
+                goto error;
+            if (!cx_xor_encode_block(&writer, block_size, values, value_bits))
+                goto error;
+            assert(block_index < block_count);
+            blocks[block_index].offset = offset;
+            blocks[block_index++].size = (writer.position + 63) / 64 - offset;
+        }
+    }
+    assert(block_index == block_count);
+    size_t blocks_size = block_count * sizeof(*blocks);
+    size_t stream_size = (writer.position + 63) / 64 * sizeof(uint64_t);
+    void *ptr;
+    encoded = cx_column_new_compressed(type, CX_ENCODING_XOR, &ptr,
+                                       blocks_size + stream_size, count);
+    if (!encoded)
+        goto error;
+    memcpy(ptr, blocks, blocks_size);
+    memcpy((char *)ptr + blocks_size, writer.words, stream_size);
+    cx_column_cursor_free(cursor);
+    free(blocks);
+    free(writer.words);
+    return encoded;
+error:
+    cx_column_cursor_free(cursor);
+    free(blocks);
+    free(writer.words);
+    return NULL;
+}
+
+static struct cx_column *cx_encode_byte_stream_split(
+    const struct cx_column *column)
+{
+    enum cx_column_type type = cx_column_type(column);
+    size_t count = cx_column_count(column);
+    size_t width = type == CX_COLUMN_DBL ? sizeof(double) : sizeof(float);
+    size_t size;
+    const void *values = cx_column_export(column, &size);
+    assert(size == count * width);
+    void *ptr;
+    struct cx_column *encoded = cx_column_new_compressed(
+        type, CX_ENCODING_BYTE_STREAM_SPLIT, &ptr, size, count);
+    if (!encoded)
+        return NULL;
+    cx_byte_split(count, width, values, ptr, count);
+    return encoded;
+}
+
+static struct cx_column *cx_encode_offsets(const struct cx_column *column)
+{
+    size_t count = cx_column_count(column);
+    size_t strings_size;
+    // the plain layout is the NUL-terminated strings back to back
+    const void *strings = cx_column_export(column, &strings_size);
+    if (strings_size > UINT32_MAX)
+        return NULL;
+    size_t offsets_size = (count + 1) * sizeof(uint32_t);
+    void *ptr;
+    struct cx_column *encoded =
+        cx_column_new_compressed(CX_COLUMN_STR, CX_ENCODING_OFFSETS, &ptr,
+                                 offsets_size + strings_size, count);
+    if (!encoded)
+        return NULL;
+    uint32_t *offsets = ptr;
+    struct cx_column_cursor *cursor = cx_column_cursor_new(column);
+    if (!cursor)
+        goto error;
+    size_t row = 0;
+    const char *start = strings;
+    while (cx_column_cursor_valid(cursor)) {
+        size_t batch_count;
+        const struct cx_string *batch =
+            cx_column_cursor_next_batch_str(cursor, &batch_count);
+        for (size_t i = 0; i < batch_count; i++)
+            offsets[row++] = batch[i].ptr - start;
+    }
+    assert(row == count);
+    offsets[count] = strings_size;
+    memcpy((char *)ptr + offsets_size, strings, strings_size);
+    cx_column_cursor_free(cursor);
+    return encoded;
+error:
+    cx_column_free(encoded);
+    return NULL;
+}
+
+static struct cx_column *cx_encode_fsst(const struct cx_column *column)
+{
+    size_t count = cx_column_count(column);
+    struct cx_column *encoded = NULL;
+    struct cx_string *strings = NULL;
+    uint32_t *offsets = NULL;
+    uint8_t *compressed = NULL;
+    struct cx_fsst_table *table = malloc(sizeof(*table));
+    struct cx_column_cursor *cursor = cx_column_cursor_new(column);
+    if (!table || !cursor)
+        goto error;
+    size_t strings_size;
+    cx_column_export(column, &strings_size);
+    strings = malloc((count ? count : 1) * sizeof(*strings));
+    offsets = malloc((count + 1) * sizeof(*offsets));
+    // escaping every byte doubles the size of a string
+    compressed = malloc(strings_size * 2 + 1);
+    if (!strings || !offsets || !compressed)
+        goto error;
+    size_t row = 0;
+    while (cx_column_cursor_valid(cursor)) {
+        size_t batch_count;
+        const struct cx_string *batch =
+            cx_column_cursor_next_batch_str(cursor, &batch_count);
+        memcpy(&strings[row], batch, batch_count * sizeof(*batch));
+        row += batch_count;
+    }
+    assert(row == count);
+    if (!cx_fsst_build(table, count, strings))
+        goto error;
+    size_t compressed_size = 0;
+    for (size_t i = 0; i < count; i++) {
+        offsets[i] = compressed_size;
+        compressed_size +=
+            cx_fsst_compress(table, strings[i].ptr, strings[i].len,
+                             compressed + compressed_size);
+        if (compressed_size > UINT32_MAX)
+            goto error;
+    }
+    offsets[count] = compressed_size;
+
+    struct cx_fsst_header header = {.symbol_count = table->symbol_count};
+    size_t symbols_size = table->symbol_count * 8;
+    size_t lengths_size = (table->symbol_count + 7) / 8 * 8;
+    size_t offsets_size = (count + 1) * sizeof(*offsets);
+    size_t size = sizeof(header) + symbols_size + lengths_size +
+                  offsets_size + compressed_size;
+    void *ptr;
+    encoded = cx_column_new_compressed(CX_COLUMN_STR, CX_ENCODING_FSST, &ptr,
+                                       size, count);
+    if (!encoded)
+        goto error;
+    char *dest = ptr;
+    memset(dest, 0, size);
+    memcpy(dest, &header, sizeof(header));
+    dest += sizeof(header);
+    memcpy(dest, table->symbols, symbols_size);
+    dest += symbols_size;
+    memcpy(dest, table->lengths, table->symbol_count);
+    dest += lengths_size;
+    memcpy(dest, offsets, offsets_size);
+    dest += offsets_size;
+    memcpy(dest, compressed, compressed_size);
+    cx_column_cursor_free(cursor);
+    free(table);
+    free(strings);
+    free(offsets);
+    free(compressed);
+    return encoded;
+error:
+    if (cursor)
+        cx_column_cursor_free(cursor);
+    free(table);
+    free(strings);
+    free(offsets);
+    free(compressed);
+    return NULL;
+}
+
+static struct cx_column *cx_encode_constant(const struct cx_column *column)
+{
+    if (!cx_column_constant(column))
+        return NULL;
+    enum cx_column_type type = cx_column_type(column);
+    size_t size;
+    const void *buffer = cx_column_export(column, &size);
+    uint64_t word;
+    switch (type) {
+        case CX_COLUMN_BIT:
+            word = *(const uint64_t *)buffer & 1 ? UINT64_MAX : 0;
+            buffer = &word;
+            size = sizeof(word);
+            break;
+        case CX_COLUMN_I32:
+        case CX_COLUMN_FLT:
+            size = sizeof(int32_t);
+            break;
+        case CX_COLUMN_I64:
+        case CX_COLUMN_DBL:
+            size = sizeof(int64_t);
+            break;
+        case CX_COLUMN_STR:
+            size = strlen(buffer) + 1;
+            break;
+    }
+    void *ptr;
+    struct cx_column *encoded = cx_column_new_compressed(
+        type, CX_ENCODING_CONSTANT, &ptr, size, cx_column_count(column));
+    if (!encoded)
+        return NULL;
+    memcpy(ptr, buffer, size);
+    return encoded;
+}
+
+struct cx_column *cx_encode_sparse(const struct cx_column *column,
+                                   const struct cx_column *nulls)
+{
+    enum cx_column_type type = cx_column_type(column);
+    size_t count = cx_column_count(column);
+    if (cx_column_encoding(column) != CX_ENCODING_NONE ||
+        !cx_encoding_supported(type, CX_ENCODING_SPARSE) || !count ||
+        count > UINT32_MAX || cx_column_type(nulls) != CX_COLUMN_BIT ||
+        cx_column_encoding(nulls) != CX_ENCODING_NONE ||
+        cx_column_count(nulls) != count)
+        return NULL;
+    size_t size, nulls_size;
+    const char *values = cx_column_export(column, &size);
+    const uint64_t *bitset = cx_column_export(nulls, &nulls_size);
+    size_t width = 0;
+    if (type != CX_COLUMN_STR)
+        width = size / count;
+
+    // find the size of the non-null values
+    size_t present = 0, values_size = 0;
+    const char *value = values;
+    for (size_t i = 0; i < count; i++) {
+        size_t value_size = width ? width : strlen(value) + 1;
+        if (!(bitset[i / 64] & ((uint64_t)1 << (i % 64)))) {
+            present++;
+            values_size += value_size;
+        }
+        value += value_size;
+    }
+
+    size_t positions_size = cx_encode_align(sizeof(struct cx_sparse_header) +
+                                            present * sizeof(uint32_t));
+    void *ptr;
+    struct cx_column *encoded =
+        cx_column_new_compressed(type, CX_ENCODING_SPARSE, &ptr,
+                                 positions_size + values_size, count);
+    if (!encoded)
+        return NULL;
+    memset(ptr, 0, positions_size);
+    struct cx_sparse_header *header = ptr;
+    header->count = present;
+    uint32_t *positions = (uint32_t *)(header + 1);
+    char *dest = (char *)ptr + positions_size;
+    value = values;
+    for (size_t i = 0; i < count; i++) {
+        size_t value_size = width ? width : strlen(value) + 1;
+        if (!(bitset[i / 64] & ((uint64_t)1 << (i % 64)))) {
+            *positions++ = i;
+            memcpy(dest, value, value_size);
+            dest += value_size;
+        }
+        value += value_size;
+    }
+    return encoded;
+}
+
+struct cx_column *cx_encode(const struct cx_column *column,
+                            enum cx_encoding_type encoding,
+                            const struct cx_index *index)
+{
+    enum cx_column_type type = cx_column_type(column);
+    if (cx_column_encoding(column) != CX_ENCODING_NONE ||
+        !cx_encoding_supported(type, encoding))
+        return NULL;
+    switch (encoding) {
+        case CX_ENCODING_NONE:
+            break;
+        case CX_ENCODING_DICT:
+            return cx_encode_dict(column);
+        case CX_ENCODING_RLE:
+            return cx_encode_rle(column);
+        case CX_ENCODING_DELTA:
+        case CX_ENCODING_DELTA_OF_DELTA:
+            return cx_encode_delta(column, encoding);
+        case CX_ENCODING_BITPACK:
+            return cx_encode_bitpack(column, index);
+        case CX_ENCODING_XOR:
+            return cx_encode_xor(column);
+        case CX_ENCODING_BYTE_STREAM_SPLIT:
+            return cx_encode_byte_stream_split(column);
+        case CX_ENCODING_OFFSETS:
+            return cx_encode_offsets(column);
+        case CX_ENCODING_FSST:
+            return cx_encode_fsst(column);
+        case CX_ENCODING_CONSTANT:
+            return cx_encode_constant(column);
+        case CX_ENCODING_SPARSE:
+            break;  // see cx_encode_sparse
+    }
+    return NULL;
+}
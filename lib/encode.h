@@ -0,0 +1,38 @@
+#ifndef CX_ENCODE_H_
+#define CX_ENCODE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "column.h"
+#include "index.h"
+
+bool cx_encoding_supported(enum cx_column_type, enum cx_encoding_type);
+
+// check whether every row of a (non-empty, unencoded) column holds the same
+// value, in which case it can be stored with CX_ENCODING_CONSTANT
+bool cx_column_constant(const struct cx_column *);
+
+// copy count values of an unencoded column into a new column, starting
+// with the value at byte offset start of the column (a multiple of 8 for
+// BIT columns). the byte offset of the value after the slice is stored in
+// end, so that consecutive slices can be taken without scanning strings
+struct cx_column *cx_column_slice(const struct cx_column *, size_t start,
+                                  size_t count, size_t *end);
+
+// encode a column. the index of the column can be provided if it's
+// already known, or NULL otherwise
+struct cx_column *cx_encode(const struct cx_column *, enum cx_encoding_type,
+                            const struct cx_index *);
+
+// encode a column with CX_ENCODING_SPARSE, which only stores the rows that
+// are clear in the null bitmap
+struct cx_column *cx_encode_sparse(const struct cx_column *,
+                                   const struct cx_column *nulls);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
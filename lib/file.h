@@ -32,13 +32,25 @@ struct cx_footer {
     uint64_t magic;
 };
 
+// a column with a page size splits the values of each chunk into pages of
+// that many rows (see cx_page_header)
 struct cx_column_descriptor {
     uint32_t name;
     uint32_t type;
     uint32_t encoding;
     uint32_t compression;
     int32_t compression_level;
-    uint32_t __padding;
+    uint32_t page_size;
+};
+
+// a file with ZSTD dictionaries has a header for each column between the
+// column descriptors and the footer, and the footer size includes them. a
+// header with a size of zero means the column has no dictionary. chunks of
+// a column with a dictionary are compressed with it, other than those
+// written before it was trained, which ZSTD decompresses without it
+struct cx_dictionary_header {
+    uint64_t offset;
+    uint64_t size;
 };
 
 struct cx_row_group_header {
@@ -46,6 +58,9 @@ struct cx_row_group_header {
     uint64_t offset;
 };
 
+// each column of a row group has a header for its values and a header for
+// its null bitmap. a column without nulls (where the max of the null index
+// is false) has no null bitmap chunk, and a size of zero in that header
 struct cx_column_header {
     uint64_t offset;
     uint64_t size;
@@ -55,6 +70,135 @@ struct cx_column_header {
     struct cx_index index;
 };
 
+// the values chunk of a column with a page size starts with a header for
+// each page, followed by the pages. each page holds page_size rows (the
+// last may hold fewer) encoded on their own with the encoding of the chunk
+// and compressed on their own, so that a page can be read without the
+// pages before it. the offset of a page is relative to the chunk, and its
+// index covers the rows of the page only
+struct cx_page_header {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t decompressed_size;
+    uint32_t compression;
+    uint32_t __padding;
+    struct cx_index index;
+};
+
+// a CX_ENCODING_DICT column chunk is laid out as the header, followed by
+// the sorted, NUL-terminated dictionary strings (padded to CX_WRITE_ALIGN),
+// followed by an int32_t dictionary code for each row
+struct cx_dict_header {
+    uint64_t size;
+    uint32_t count;
+    uint32_t __padding;
+};
+
+// a CX_ENCODING_FSST column chunk compresses each string on its own with
+// a table of up to CX_FSST_SYMBOLS symbols, each 1-8 bytes long. the chunk
+// is laid out as the header, followed by the symbols (8 bytes each, with
+// unused bytes zeroed), followed by the length of each symbol (a byte
+// each, padded to a multiple of 8 bytes), followed by a uint32_t offset
+// into the compressed strings for each row plus one, followed by the
+// compressed strings. a compressed string is a sequence of codes, where
+// code i < symbol_count stands for symbol i, and CX_FSST_ESCAPE is
+// followed by a byte that stands for itself
+#define CX_FSST_SYMBOLS 255
+#define CX_FSST_ESCAPE 255
+
+struct cx_fsst_header {
+    uint32_t symbol_count;
+    uint32_t __padding;
+};
+
+// a CX_ENCODING_OFFSETS column chunk is laid out as a uint32_t offset for
+// each row plus one, followed by the NUL-terminated strings. string i
+// starts offsets[i] bytes into the strings and is
+// offsets[i + 1] - offsets[i] - 1 bytes long, so rows can be skipped and
+// batches built without scanning the strings
+
+// a CX_ENCODING_RLE column chunk is a sequence of runs of identical
+// values. BIT and I32 columns use cx_rle_run32 and I64 columns use
+// cx_rle_run64. runs are never empty, and their lengths add up to the
+// row count
+struct cx_rle_run32 {
+    int32_t value;
+    uint32_t length;
+};
+
+struct cx_rle_run64 {
+    int64_t value;
+    uint64_t length;
+};
+
+// CX_ENCODING_DELTA and CX_ENCODING_DELTA_OF_DELTA column chunks are split
+// into blocks of CX_DELTA_BLOCK_SIZE rows. the chunk starts with a header
+// for each block, followed by the bit-packed words of every block.
+// DELTA blocks pack the difference between each value and the one before
+// it, minus the block reference. DELTA_OF_DELTA blocks store the first
+// difference in the header and pack the difference between consecutive
+// differences instead. all arithmetic wraps
+#define CX_DELTA_BLOCK_SIZE 64
+
+struct cx_delta_block {
+    int64_t first;
+    int64_t delta;
+    int64_t reference;
+    uint32_t offset;  // in words, relative to the first packed word
+    uint32_t width;   // in bits
+};
+
+// a CX_ENCODING_BITPACK column chunk stores each value minus the minimum
+// value of the chunk (frame of reference) in width bits. the header is
+// followed by a block of width bit planes (see bitpack.h) for every
+// CX_BITPACK_BLOCK_SIZE rows
+#define CX_BITPACK_BLOCK_SIZE 64
+
+struct cx_bitpack_header {
+    int64_t base;
+    uint32_t width;
+    uint32_t __padding;
+};
+
+// a CX_ENCODING_XOR (FLT/DBL) column chunk is split into blocks of
+// CX_XOR_BLOCK_SIZE rows. the chunk starts with a cx_xor_block for each
+// block, followed by the bit stream of every block. bits are written from
+// the least significant bit of each 64-bit word. a block stream starts
+// with the raw bits of its first value. each value after that is XORed
+// with the one before it and written as:
+//  - a 0 bit if the XOR is zero
+//  - 10 followed by the meaningful bits of the XOR, if they fit within the
+//    leading and trailing zero window of the previous non-zero XOR
+//  - 11 followed by the number of leading zeros and the number of
+//    meaningful bits minus one (5 bits each for FLT, 6 for DBL), followed
+//    by the meaningful bits
+#define CX_XOR_BLOCK_SIZE 64
+
+struct cx_xor_block {
+    uint32_t offset;  // in words, relative to the first stream word
+    uint32_t size;    // in words
+};
+
+// a CX_ENCODING_BYTE_STREAM_SPLIT (FLT/DBL) column chunk holds a stream
+// for each byte of the value type. stream k holds byte k of every value
+// and the streams are stored one after the other. the size of the chunk
+// doesn't change, but the streams (particularly those holding the sign,
+// exponent and high mantissa bytes) compress better than the values do
+
+// a CX_ENCODING_CONSTANT column chunk holds the same value in every row,
+// and stores that value once. BIT chunks store a uint64_t word with every
+// bit set to the value, STR chunks store the NUL-terminated string, and
+// other chunks store the value in its plain layout
+
+// a CX_ENCODING_SPARSE column chunk only stores the rows that aren't null.
+// it's laid out as the header, followed by the uint32_t position of each
+// non-null row in ascending order (padded to CX_WRITE_ALIGN), followed by
+// the values of those rows in the plain layout. null rows read as 0 or ""
+struct cx_sparse_header {
+    uint32_t count;
+    uint32_t __padding;
+};
+
 #ifdef __cplusplus
 }
 #endif
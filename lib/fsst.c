@@ -0,0 +1,231 @@
+#include "fsst.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// the table is built from (at most) this many bytes of the strings
+#define CX_FSST_SAMPLE_SIZE (1 << 14)
+
+#define CX_FSST_ROUNDS 5
+
+// while building the table, bytes without a symbol are counted with
+// pseudo codes, following the codes of the symbols
+#define CX_FSST_CODES (CX_FSST_SYMBOLS + 256)
+
+struct cx_fsst_candidate {
+    uint8_t symbol[8];
+    size_t length;
+    uint64_t gain;
+};
+
+static void cx_fsst_index(struct cx_fsst_table *table)
+{
+    uint16_t positions[257] = {0};
+    for (size_t i = 0; i < table->symbol_count; i++)
+        positions[table->symbols[i][0] + 1]++;
+    for (size_t b = 0; b < 256; b++)
+        positions[b + 1] += positions[b];
+    memcpy(table->first, positions, sizeof(positions));
+    for (size_t length = 8; length; length--)
+        for (size_t i = 0; i < table->symbol_count; i++)
+            if (table->lengths[i] == length)
+                table->order[positions[table->symbols[i][0]]++] = i;
+}
+
+// find the code of the longest symbol that prefixes the string, or -1
+static int cx_fsst_find(const struct cx_fsst_table *table, const uint8_t *src,
+                        size_t size)
+{
+    for (size_t i = table->first[src[0]]; i < table->first[src[0] + 1];
+         i++) {
+        int code = table->order[i];
+        size_t length = table->lengths[code];
+        if (length <= size && !memcmp(table->symbols[code], src, length))
+            return code;
+    }
+    return -1;
+}
+
+static size_t cx_fsst_symbol(const struct cx_fsst_table *table, size_t code,
+                             uint8_t symbol[8])
+{
+    memset(symbol, 0, 8);
+    if (code >= CX_FSST_SYMBOLS) {
+        symbol[0] = code - CX_FSST_SYMBOLS;
+        return 1;
+    }
+    memcpy(symbol, table->symbols[code], table->lengths[code]);
+    return table->lengths[code];
+}
+
+static int cx_fsst_candidate_symbol_cmp(const void *a, const void *b)
+{
+    const struct cx_fsst_candidate *x = a, *y = b;
+    if (x->length != y->length)
+        return x->length < y->length ? -1 : 1;
+    return memcmp(x->symbol, y->symbol, sizeof(x->symbol));
+}
+
+static int cx_fsst_candidate_gain_cmp(const void *a, const void *b)
+{
+    const struct cx_fsst_candidate *x = a, *y = b;
+    if (x->gain != y->gain)
+        return x->gain > y->gain ? -1 : 1;
+    return cx_fsst_candidate_symbol_cmp(a, b);
+}
+
+// compress the sample with the current table, and then replace the table
+// with the symbols and concatenations of adjacent symbols that would have
+// saved the most bytes
+static bool cx_fsst_round(struct cx_fsst_table *table, size_t count,
+                          const struct cx_string strings[], uint32_t *counts1,
+                          uint32_t *counts2,
+                          struct cx_fsst_candidate *candidates)
+{
+    memset(counts1, 0, CX_FSST_CODES * sizeof(*counts1));
+    memset(counts2, 0, CX_FSST_CODES * CX_FSST_CODES * sizeof(*counts2));
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *src = (const uint8_t *)strings[i].ptr;
+        size_t size = strings[i].len;
+        size_t previous = CX_FSST_CODES;
+        for (size_t position = 0; position < size;) {
+            int code = cx_fsst_find(table, src + position, size - position);
+            size_t current, length = 1;
+            if (code < 0) {
+                current = CX_FSST_SYMBOLS + src[position];
+            } else {
+                current = code;
+                length = table->lengths[code];
+                // give single bytes a chance to become symbols
+                if (length > 1)
+                    counts1[CX_FSST_SYMBOLS + src[position]]++;
+            }
+            counts1[current]++;
+            if (previous < CX_FSST_CODES)
+                counts2[previous * CX_FSST_CODES + current]++;
+            previous = current;
+            position += length;
+        }
+    }
+
+    size_t candidate_count = 0;
+    for (size_t i = 0; i < CX_FSST_CODES; i++) {
+        if (!counts1[i])
+            continue;
+        struct cx_fsst_candidate *candidate = &candidates[candidate_count++];
+        candidate->length = cx_fsst_symbol(table, i, candidate->symbol);
+        candidate->gain = (uint64_t)counts1[i] * candidate->length;
+        for (size_t j = 0; j < CX_FSST_CODES; j++) {
+            uint32_t pair_count = counts2[i * CX_FSST_CODES + j];
+            if (!pair_count || candidate->length == 8)
+                continue;
+            struct cx_fsst_candidate *pair = &candidates[candidate_count++];
+            uint8_t symbol[8];
+            size_t length = cx_fsst_symbol(table, j, symbol);
+            if (candidate->length + length > 8)
+                length = 8 - candidate->length;
+            memcpy(pair->symbol, candidate->symbol, 8);
+            memcpy(pair->symbol + candidate->length, symbol, length);
+            pair->length = candidate->length + length;
+            pair->gain = (uint64_t)pair_count * pair->length;
+        }
+    }
+
+    // merge duplicate candidates and keep those with the highest gain
+    qsort(candidates, candidate_count, sizeof(*candidates),
+          cx_fsst_candidate_symbol_cmp);
+    size_t unique = 0;
+    for (size_t i = 0; i < candidate_count; i++) {
+        if (unique &&
+            !cx_fsst_candidate_symbol_cmp(&candidates[unique - 1],
+                                          &candidates[i]))
+            candidates[unique - 1].gain += candidates[i].gain;
+        else
+            candidates[unique++] = candidates[i];
+    }
+    qsort(candidates, unique, sizeof(*candidates), cx_fsst_candidate_gain_cmp);
+    if (unique > CX_FSST_SYMBOLS)
+        unique = CX_FSST_SYMBOLS;
+    uint8_t symbols[CX_FSST_SYMBOLS][8];
+    uint8_t lengths[CX_FSST_SYMBOLS];
+    for (size_t i = 0; i < unique; i++) {
+        memcpy(symbols[i], candidates[i].symbol, 8);
+        lengths[i] = candidates[i].length;
+    }
+    return cx_fsst_load(table, unique, (const uint8_t(*)[8])symbols, lengths);
+}
+
+bool cx_fsst_build(struct cx_fsst_table *table, size_t count,
+                   const struct cx_string strings[])
+{
+    size_t sample_count = 0, sample_size = 0;
+    while (sample_count < count && sample_size < CX_FSST_SAMPLE_SIZE)
+        sample_size += strings[sample_count++].len;
+    table->symbol_count = 0;
+    cx_fsst_index(table);
+    // each position of the sample yields at most one pair
+    uint32_t *counts1 = malloc(CX_FSST_CODES * sizeof(*counts1));
+    uint32_t *counts2 =
+        malloc(CX_FSST_CODES * CX_FSST_CODES * sizeof(*counts2));
+    struct cx_fsst_candidate *candidates =
+        malloc((CX_FSST_CODES + sample_size) * sizeof(*candidates));
+    bool ok = counts1 && counts2 && candidates;
+    for (size_t i = 0; ok && i < CX_FSST_ROUNDS; i++)
+        ok = cx_fsst_round(table, sample_count, strings, counts1, counts2,
+                           candidates);
+    free(counts1);
+    free(counts2);
+    free(candidates);
+    return ok;
+}
+
+bool cx_fsst_load(struct cx_fsst_table *table, size_t symbol_count,
+                  const uint8_t symbols[][8], const uint8_t lengths[])
+{
+    if (symbol_count > CX_FSST_SYMBOLS)
+        return false;
+    for (size_t i = 0; i < symbol_count; i++)
+        if (!lengths[i] || lengths[i] > 8)
+            return false;
+    table->symbol_count = symbol_count;
+    memcpy(table->symbols, symbols, symbol_count * 8);
+    memcpy(table->lengths, lengths, symbol_count);
+    cx_fsst_index(table);
+    return true;
+}
+
+size_t cx_fsst_compress(const struct cx_fsst_table *table, const char *src,
+                        size_t size, uint8_t *dest)
+{
+    const uint8_t *bytes = (const uint8_t *)src;
+    size_t position = 0, written = 0;
+    while (position < size) {
+        int code = cx_fsst_find(table, bytes + position, size - position);
+        if (code < 0) {
+            dest[written++] = CX_FSST_ESCAPE;
+            dest[written++] = bytes[position++];
+        } else {
+            dest[written++] = code;
+            position += table->lengths[code];
+        }
+    }
+    return written;
+}
+
+size_t cx_fsst_decompress(const struct cx_fsst_table *table,
+                          const uint8_t *src, size_t size, char *dest)
+{
+    size_t written = 0;
+    for (size_t i = 0; i < size; i++) {
+        uint8_t code = src[i];
+        if (code == CX_FSST_ESCAPE) {
+            if (++i < size)
+                dest[written++] = src[i];
+        } else if (code < table->symbol_count) {
+            // copy the whole symbol and then skip the unused bytes
+            memcpy(dest + written, table->symbols[code], 8);
+            written += table->lengths[code];
+        }
+    }
+    return written;
+}
@@ -0,0 +1,47 @@
+#ifndef CX_FSST_H_
+#define CX_FSST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "file.h"
+
+// strings are compressed with a static table of symbols (FSST). the
+// longest symbol that matches at each position is replaced with its code,
+// and bytes without a symbol are escaped. the compressed form of a string
+// doesn't depend on the strings around it, so strings can be decompressed
+// individually, and two strings compressed with the same table are equal
+// only if their compressed forms are
+
+struct cx_fsst_table {
+    size_t symbol_count;
+    uint8_t symbols[CX_FSST_SYMBOLS][8];
+    uint8_t lengths[CX_FSST_SYMBOLS];
+    // codes ordered by their first byte and then by descending length,
+    // with the codes for first byte b in [first[b], first[b + 1])
+    uint8_t order[CX_FSST_SYMBOLS];
+    uint16_t first[257];
+};
+
+// build a table from a sample of the strings
+bool cx_fsst_build(struct cx_fsst_table *, size_t count,
+                   const struct cx_string strings[]);
+
+// load a table that was previously built
+bool cx_fsst_load(struct cx_fsst_table *, size_t symbol_count,
+                  const uint8_t symbols[][8], const uint8_t lengths[]);
+
+// compress a string. dest must have room for 2 * size bytes
+size_t cx_fsst_compress(const struct cx_fsst_table *, const char *src,
+                        size_t size, uint8_t *dest);
+
+// decompress a string. dest must have room for 8 * (size + 1) bytes
+size_t cx_fsst_decompress(const struct cx_fsst_table *, const uint8_t *src,
+                          size_t size, char *dest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -6,166 +6,245 @@
 #include <float.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
-static void cx_index_update_bit(struct cx_index *, struct cx_column_cursor *);
-static void cx_index_update_i32(struct cx_index *, struct cx_column_cursor *);
-static void cx_index_update_i64(struct cx_index *, struct cx_column_cursor *);
-static void cx_index_update_flt(struct cx_index *, struct cx_column_cursor *);
-static void cx_index_update_dbl(struct cx_index *, struct cx_column_cursor *);
-static void cx_index_update_str(struct cx_index *, struct cx_column_cursor *);
+#ifdef CX_AVX512
+#include "avx512.h"
+#define CX_SIMD_WIDTH 64
+#elif defined(CX_AVX2)
+#include "avx2.h"
+#define CX_SIMD_WIDTH 32
+#elif defined(CX_AVX)
+#include "avx.h"
+#define CX_SIMD_WIDTH 16
+#endif
+
+// the number of bitset words reduced between checks for an early exit
+#define CX_INDEX_BIT_BLOCK 16
+
+static void cx_index_scan(struct cx_index *, enum cx_column_type,
+                          struct cx_column_cursor *);
 
 struct cx_index *cx_index_new(const struct cx_column *column)
 {
-    struct cx_index *index = calloc(1, sizeof(*index));
+    struct cx_index *index = malloc(sizeof(*index));
     if (!index)
         return NULL;
+    // columns built by puts keep their statistics as values are appended
+    const struct cx_index *stats = cx_column_index(column);
+    if (stats) {
+        memcpy(index, stats, sizeof(*index));
+        return index;
+    }
     struct cx_column_cursor *cursor = cx_column_cursor_new(column);
     if (!cursor)
         goto error;
-    switch (cx_column_type(column)) {
+    cx_index_init(index, cx_column_type(column));
+    cx_index_scan(index, cx_column_type(column), cursor);
+    cx_column_cursor_free(cursor);
+    return index;
+error:
+    free(index);
+    return NULL;
+}
+
+void cx_index_free(struct cx_index *index)
+{
+    free(index);
+}
+
+void cx_index_init(struct cx_index *index, enum cx_column_type type)
+{
+    memset(index, 0, sizeof(*index));
+    switch (type) {
         case CX_COLUMN_BIT:
             index->min.bit = true;
-            cx_index_update_bit(index, cursor);
             break;
         case CX_COLUMN_I32:
             index->min.i32 = INT32_MAX;
-            cx_index_update_i32(index, cursor);
+            index->max.i32 = INT32_MIN;
             break;
         case CX_COLUMN_I64:
             index->min.i64 = INT64_MAX;
-            cx_index_update_i64(index, cursor);
+            index->max.i64 = INT64_MIN;
             break;
         case CX_COLUMN_FLT:
             index->min.flt = FLT_MAX;
-            cx_index_update_flt(index, cursor);
+            index->max.flt = -FLT_MAX;
             break;
         case CX_COLUMN_DBL:
             index->min.dbl = DBL_MAX;
-            cx_index_update_dbl(index, cursor);
+            index->max.dbl = -DBL_MAX;
             break;
         case CX_COLUMN_STR:
             index->min.len = UINT64_MAX;
-            cx_index_update_str(index, cursor);
             break;
     }
-    cx_column_cursor_free(cursor);
-    return index;
-error:
-    free(index);
-    return NULL;
 }
 
-void cx_index_free(struct cx_index *index)
-{
-    free(index);
-}
-
-static void cx_index_update_bit(struct cx_index *index,
-                                struct cx_column_cursor *cursor)
+static void cx_index_scan(struct cx_index *index, enum cx_column_type type,
+                          struct cx_column_cursor *cursor)
 {
     while (cx_column_cursor_valid(cursor)) {
-        size_t count;
-        const uint64_t *bitset =
-            cx_column_cursor_next_batch_bit(cursor, &count);
-        assert(count);
-        index->count += count;
-        for (size_t i = 0; i < count; i++) {
-            bool value = *bitset & ((uint64_t)1 << i);
-            index->min.bit = index->min.bit && value;
-            index->max.bit = index->max.bit || value;
+        size_t count = 0;
+        switch (type) {
+            case CX_COLUMN_BIT: {
+                const uint64_t *bitset =
+                    cx_column_cursor_next_batch_bit(cursor, &count);
+                cx_index_update_bit(index, bitset, count);
+            } break;
+            case CX_COLUMN_I32: {
+                const int32_t *values =
+                    cx_column_cursor_next_batch_i32(cursor, &count);
+                cx_index_update_i32(index, values, count);
+            } break;
+            case CX_COLUMN_I64: {
+                const int64_t *values =
+                    cx_column_cursor_next_batch_i64(cursor, &count);
+                cx_index_update_i64(index, values, count);
+            } break;
+            case CX_COLUMN_FLT: {
+                const float *values =
+                    cx_column_cursor_next_batch_flt(cursor, &count);
+                cx_index_update_flt(index, values, count);
+            } break;
+            case CX_COLUMN_DBL: {
+                const double *values =
+                    cx_column_cursor_next_batch_dbl(cursor, &count);
+                cx_index_update_dbl(index, values, count);
+            } break;
+            case CX_COLUMN_STR: {
+                const struct cx_string *values =
+                    cx_column_cursor_next_batch_str(cursor, &count);
+                cx_index_update_str(index, values, count);
+            } break;
         }
+        assert(count);
     }
 }
 
-static void cx_index_update_i32(struct cx_index *index,
-                                struct cx_column_cursor *cursor)
+void cx_index_update_bit(struct cx_index *index, const uint64_t *bitset,
+                         size_t count)
 {
-    while (cx_column_cursor_valid(cursor)) {
-        size_t count;
-        const int32_t *values = cx_column_cursor_next_batch_i32(cursor, &count);
-        assert(count);
-        index->count += count;
-        for (size_t i = 0; i < count; i++) {
-            int32_t value = values[i];
-            if (value > index->max.i32)
-                index->max.i32 = value;
-            if (value < index->min.i32)
-                index->min.i32 = value;
+    index->count += count;
+    if (!count)
+        return;
+    // 64 rows at a time: the rows are all set if the AND of the words is
+    // all ones, and any are set if the OR isn't zero. the words are read in
+    // blocks so that the compiler can vectorize the reduction, stopping
+    // once neither statistic can change
+    size_t words = count / 64;
+    uint64_t all = index->min.bit ? UINT64_MAX : 0;
+    uint64_t any = index->max.bit ? UINT64_MAX : 0;
+    for (size_t i = 0; i < words && (all || any != UINT64_MAX);) {
+        size_t end = words - i < CX_INDEX_BIT_BLOCK ? words
+                                                    : i + CX_INDEX_BIT_BLOCK;
+        uint64_t block_all = UINT64_MAX, block_any = 0;
+        for (; i < end; i++) {
+            block_all &= bitset[i];
+            block_any |= bitset[i];
         }
+        all = all == UINT64_MAX && block_all == UINT64_MAX ? UINT64_MAX : 0;
+        any = any || block_any ? UINT64_MAX : 0;
+    }
+    if (count % 64) {
+        uint64_t mask = ((uint64_t)1 << (count % 64)) - 1;
+        uint64_t word = bitset[words] & mask;
+        all = all && word == mask ? UINT64_MAX : 0;
+        any = any || word ? UINT64_MAX : 0;
     }
+    index->min.bit = all != 0;
+    index->max.bit = any != 0;
 }
 
-static void cx_index_update_i64(struct cx_index *index,
-                                struct cx_column_cursor *cursor)
-{
-    while (cx_column_cursor_valid(cursor)) {
-        size_t count;
-        const int64_t *values = cx_column_cursor_next_batch_i64(cursor, &count);
-        assert(count);
-        index->count += count;
-        for (size_t i = 0; i < count; i++) {
-            int64_t value = values[i];
-            if (value > index->max.i64)
-                index->max.i64 = value;
-            if (value < index->min.i64)
-                index->min.i64 = value;
-        }
+#define CX_SCALAR_MIN_MAX_DEFINITION(name, type)                        \
+    static void cx_index_min_max_##name##_scalar(                      \
+        const type *values, size_t count, type *min, type *max)        \
+    {                                                                  \
+        type lo = *min, hi = *max;                                     \
+        for (size_t i = 0; i < count; i++) {                           \
+            hi = values[i] > hi ? values[i] : hi;                      \
+            lo = values[i] < lo ? values[i] : lo;                      \
+        }                                                              \
+        *min = lo;                                                     \
+        *max = hi;                                                     \
     }
-}
 
-static void cx_index_update_flt(struct cx_index *index,
-                                struct cx_column_cursor *cursor)
-{
-    while (cx_column_cursor_valid(cursor)) {
-        size_t count;
-        const float *values = cx_column_cursor_next_batch_flt(cursor, &count);
-        assert(count);
-        index->count += count;
-        for (size_t i = 0; i < count; i++) {
-            float value = values[i];
-            if (value > index->max.flt)
-                index->max.flt = value;
-            if (value < index->min.flt)
-                index->min.flt = value;
-        }
+CX_SCALAR_MIN_MAX_DEFINITION(i32, int32_t)
+CX_SCALAR_MIN_MAX_DEFINITION(i64, int64_t)
+CX_SCALAR_MIN_MAX_DEFINITION(flt, float)
+CX_SCALAR_MIN_MAX_DEFINITION(dbl, double)
+
+#ifdef CX_SIMD_WIDTH
+
+// each lane keeps the min and max of every nth value, and the lanes are
+// reduced once at the end. values that are NaN are skipped, as they are by
+// the scalar loop. returns the number of values that were read
+#define CX_SIMD_MIN_MAX_DEFINITION(width, name, type)                    \
+    static size_t cx_index_min_max_##name##_simd(                       \
+        const type *values, size_t count, type *min, type *max)         \
+    {                                                                   \
+        enum { lanes = width / sizeof(type) };                          \
+        if (count < lanes)                                              \
+            return 0;                                                   \
+        cx_##name##_vec_t v_min = cx_simd_##name##_set(*min);           \
+        cx_##name##_vec_t v_max = cx_simd_##name##_set(*max);           \
+        size_t i = 0;                                                   \
+        for (; i + lanes <= count; i += lanes) {                        \
+            cx_##name##_vec_t chunk = cx_simd_##name##_load(&values[i]); \
+            v_min = cx_simd_##name##_min(chunk, v_min);                 \
+            v_max = cx_simd_##name##_max(chunk, v_max);                 \
+        }                                                               \
+        type lane_min[lanes], lane_max[lanes];                          \
+        cx_simd_##name##_store(lane_min, v_min);                        \
+        cx_simd_##name##_store(lane_max, v_max);                        \
+        for (size_t j = 0; j < lanes; j++) {                            \
+            *min = lane_min[j] < *min ? lane_min[j] : *min;             \
+            *max = lane_max[j] > *max ? lane_max[j] : *max;             \
+        }                                                               \
+        return i;                                                       \
     }
-}
 
-static void cx_index_update_dbl(struct cx_index *index,
-                                struct cx_column_cursor *cursor)
-{
-    while (cx_column_cursor_valid(cursor)) {
-        size_t count;
-        const double *values = cx_column_cursor_next_batch_dbl(cursor, &count);
-        assert(count);
-        index->count += count;
-        for (size_t i = 0; i < count; i++) {
-            double value = values[i];
-            if (value > index->max.dbl)
-                index->max.dbl = value;
-            if (value < index->min.dbl)
-                index->min.dbl = value;
-        }
+CX_SIMD_MIN_MAX_DEFINITION(CX_SIMD_WIDTH, i32, int32_t)
+CX_SIMD_MIN_MAX_DEFINITION(CX_SIMD_WIDTH, i64, int64_t)
+CX_SIMD_MIN_MAX_DEFINITION(CX_SIMD_WIDTH, flt, float)
+CX_SIMD_MIN_MAX_DEFINITION(CX_SIMD_WIDTH, dbl, double)
+
+#define CX_MIN_MAX_SIMD(name, values, count, min, max) \
+    cx_index_min_max_##name##_simd(values, count, min, max)
+#else
+#define CX_MIN_MAX_SIMD(name, values, count, min, max) 0
+#endif  // simd
+
+#define CX_INDEX_UPDATE_DEFINITION(name, type)                          \
+    void cx_index_update_##name(struct cx_index *index,                 \
+                                const type *values, size_t count)       \
+    {                                                                   \
+        index->count += count;                                          \
+        type min = index->min.name, max = index->max.name;              \
+        size_t done = CX_MIN_MAX_SIMD(name, values, count, &min, &max); \
+        cx_index_min_max_##name##_scalar(values + done, count - done,   \
+                                         &min, &max);                   \
+        index->min.name = min;                                          \
+        index->max.name = max;                                          \
     }
-}
 
-static void cx_index_update_str(struct cx_index *index,
-                                struct cx_column_cursor *cursor)
+CX_INDEX_UPDATE_DEFINITION(i32, int32_t)
+CX_INDEX_UPDATE_DEFINITION(i64, int64_t)
+CX_INDEX_UPDATE_DEFINITION(flt, float)
+CX_INDEX_UPDATE_DEFINITION(dbl, double)
+
+void cx_index_update_str(struct cx_index *index,
+                         const struct cx_string *values, size_t count)
 {
-    while (cx_column_cursor_valid(cursor)) {
-        size_t count;
-        const struct cx_string *values =
-            cx_column_cursor_next_batch_str(cursor, &count);
-        assert(count);
-        index->count += count;
-        for (size_t i = 0; i < count; i++) {
-            uint64_t value = values[i].len;
-            if (value > index->max.len)
-                index->max.len = value;
-            if (value < index->min.len)
-                index->min.len = value;
-        }
+    index->count += count;
+    uint64_t min = index->min.len, max = index->max.len;
+    for (size_t i = 0; i < count; i++) {
+        max = values[i].len > max ? values[i].len : max;
+        min = values[i].len < min ? values[i].len : min;
     }
+    index->min.len = min;
+    index->max.len = max;
 }
 
 enum cx_index_match cx_index_match_bit_eq(const struct cx_index *index,
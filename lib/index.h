@@ -27,6 +27,19 @@ struct cx_index *cx_index_new(const struct cx_column *);
 
 void cx_index_free(struct cx_index *);
 
+// the statistics of an empty column
+void cx_index_init(struct cx_index *, enum cx_column_type);
+
+// fold values into the statistics of an index. bits are read from the start
+// of the bitset
+void cx_index_update_bit(struct cx_index *, const uint64_t *, size_t count);
+void cx_index_update_i32(struct cx_index *, const int32_t *, size_t count);
+void cx_index_update_i64(struct cx_index *, const int64_t *, size_t count);
+void cx_index_update_flt(struct cx_index *, const float *, size_t count);
+void cx_index_update_dbl(struct cx_index *, const double *, size_t count);
+void cx_index_update_str(struct cx_index *, const struct cx_string *,
+                         size_t count);
+
 enum cx_index_match {
     CX_INDEX_MATCH_NONE = -1,
     CX_INDEX_MATCH_UNKNOWN = 0,
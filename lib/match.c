@@ -82,19 +82,87 @@ CX_SIMD_MATCH_SET(dbl, double)
 
 #endif  // simd
 
+#ifdef CX_SIMD_WIDTH
+#define CX_MATCH_WORD(name, match) cx_match_##name##_##match##_simd
+#else
+#define CX_MATCH_WORD(name, match) cx_match_##name##_##match##_naive
+#endif
+
+// batches larger than 64 values are matched a word of the bitmap at a
+// time, in a single loop
+#define CX_MATCH_BITMAP_DEFINITION(name, type, match)                       \
+    void cx_match_##name##_##match##_bitmap(size_t size, const type batch[], \
+                                            type cmp, uint64_t matches[])   \
+    {                                                                       \
+        size_t i = 0;                                                       \
+        for (; i + 64 <= size; i += 64)                                     \
+            matches[i / 64] = CX_MATCH_WORD(name, match)(64, &batch[i], cmp); \
+        if (i < size)                                                       \
+            matches[i / 64] =                                               \
+                cx_match_##name##_##match##_naive(size - i, &batch[i], cmp); \
+    }
+
 #define CX_MATCH_TYPE(name, type)                 \
     CX_NAIVE_MATCH_DEFINITION(name, type, eq, ==) \
     CX_MATCH_DEFINITION(name, type, eq)           \
+    CX_MATCH_BITMAP_DEFINITION(name, type, eq)    \
     CX_NAIVE_MATCH_DEFINITION(name, type, lt, <)  \
     CX_MATCH_DEFINITION(name, type, lt)           \
+    CX_MATCH_BITMAP_DEFINITION(name, type, lt)    \
     CX_NAIVE_MATCH_DEFINITION(name, type, gt, >)  \
-    CX_MATCH_DEFINITION(name, type, gt)
+    CX_MATCH_DEFINITION(name, type, gt)           \
+    CX_MATCH_BITMAP_DEFINITION(name, type, gt)
 
 CX_MATCH_TYPE(i32, int32_t)
 CX_MATCH_TYPE(i64, int64_t)
 CX_MATCH_TYPE(flt, float)
 CX_MATCH_TYPE(dbl, double)
 
+// BitWeaving/V style comparison of 64 codes packed into bit planes (see
+// bitpack.h). planes are visited most significant first while tracking
+// the rows that are equal to the code so far. a row is less (greater)
+// than the code at the first plane where its bit is 0 (1) and the code's
+// bit is 1 (0). the scan stops early once every row has been decided
+static inline uint64_t cx_match_packed(size_t width, const uint64_t planes[],
+                                       uint64_t code, uint64_t *lt,
+                                       uint64_t *gt)
+{
+    assert(width <= 64);
+    uint64_t eq = ~(uint64_t)0, lt_mask = 0, gt_mask = 0;
+    for (size_t j = 0; j < width && eq; j++) {
+        uint64_t bit = -((code >> (width - 1 - j)) & 1);
+        lt_mask |= eq & ~planes[j] & bit;
+        gt_mask |= eq & planes[j] & ~bit;
+        eq &= ~(planes[j] ^ bit);
+    }
+    *lt = lt_mask;
+    *gt = gt_mask;
+    return eq;
+}
+
+uint64_t cx_match_packed_eq(size_t width, const uint64_t planes[],
+                            uint64_t code)
+{
+    uint64_t lt, gt;
+    return cx_match_packed(width, planes, code, &lt, &gt);
+}
+
+uint64_t cx_match_packed_lt(size_t width, const uint64_t planes[],
+                            uint64_t code)
+{
+    uint64_t lt, gt;
+    cx_match_packed(width, planes, code, &lt, &gt);
+    return lt;
+}
+
+uint64_t cx_match_packed_gt(size_t width, const uint64_t planes[],
+                            uint64_t code)
+{
+    uint64_t lt, gt;
+    cx_match_packed(width, planes, code, &lt, &gt);
+    return gt;
+}
+
 static inline bool cx_str_eq(const struct cx_string *str,
                              const struct cx_string *cmp)
 {
@@ -261,3 +329,15 @@ uint64_t cx_match_str_contains(size_t size, const struct cx_string strings[],
     }
     return matches;
 }
+
+uint64_t cx_match_bytes_eq(size_t size, const struct cx_string strings[],
+                           const struct cx_string *cmp)
+{
+    assert(size <= 64);
+    uint64_t mask = 0;
+    for (size_t i = 0; i < size; i++)
+        if (strings[i].len == cmp->len &&
+            !memcmp(strings[i].ptr, cmp->ptr, cmp->len))
+            mask |= (uint64_t)1 << i;
+    return mask;
+}
@@ -23,6 +23,30 @@ uint64_t cx_match_dbl_eq(size_t, const double[], double);
 uint64_t cx_match_dbl_lt(size_t, const double[], double);
 uint64_t cx_match_dbl_gt(size_t, const double[], double);
 
+// match a batch of any size, setting bit i % 64 of word i / 64 of the
+// bitmap for each value i that matches
+void cx_match_i32_eq_bitmap(size_t, const int32_t[], int32_t, uint64_t[]);
+void cx_match_i32_lt_bitmap(size_t, const int32_t[], int32_t, uint64_t[]);
+void cx_match_i32_gt_bitmap(size_t, const int32_t[], int32_t, uint64_t[]);
+
+void cx_match_i64_eq_bitmap(size_t, const int64_t[], int64_t, uint64_t[]);
+void cx_match_i64_lt_bitmap(size_t, const int64_t[], int64_t, uint64_t[]);
+void cx_match_i64_gt_bitmap(size_t, const int64_t[], int64_t, uint64_t[]);
+
+void cx_match_flt_eq_bitmap(size_t, const float[], float, uint64_t[]);
+void cx_match_flt_lt_bitmap(size_t, const float[], float, uint64_t[]);
+void cx_match_flt_gt_bitmap(size_t, const float[], float, uint64_t[]);
+
+void cx_match_dbl_eq_bitmap(size_t, const double[], double, uint64_t[]);
+void cx_match_dbl_lt_bitmap(size_t, const double[], double, uint64_t[]);
+void cx_match_dbl_gt_bitmap(size_t, const double[], double, uint64_t[]);
+
+// match codes bit-packed into width planes (see bitpack.h). bits beyond
+// the number of packed values are undefined
+uint64_t cx_match_packed_eq(size_t width, const uint64_t planes[], uint64_t);
+uint64_t cx_match_packed_lt(size_t width, const uint64_t planes[], uint64_t);
+uint64_t cx_match_packed_gt(size_t width, const uint64_t planes[], uint64_t);
+
 uint64_t cx_match_str_eq(size_t, const struct cx_string[],
                          const struct cx_string *, bool);
 uint64_t cx_match_str_lt(size_t, const struct cx_string[],
@@ -33,6 +57,10 @@ uint64_t cx_match_str_contains(size_t, const struct cx_string[],
                                const struct cx_string *, bool,
                                enum cx_str_location);
 
+// match byte strings that may contain NULs (e.g. compressed strings)
+uint64_t cx_match_bytes_eq(size_t, const struct cx_string[],
+                           const struct cx_string *);
+
 #ifdef __cplusplus
 }
 #endif
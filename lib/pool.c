@@ -0,0 +1,130 @@
+#define _DEFAULT_SOURCE
+
+#include "pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+// each thread holds on to at most this many buffers, and this many bytes
+#define CX_POOL_SLOTS 8
+#define CX_POOL_MAX_BYTES (64 << 20)
+
+// with hugepages=1, large buffers are aligned and backed by transparent
+// huge pages where the kernel allows it
+#ifdef CX_HUGEPAGES
+#define CX_POOL_HUGEPAGE_SIZE (2 << 20)
+#endif
+
+struct cx_pool_buffer {
+    void *ptr;
+    size_t capacity;
+};
+
+// 线程本地的缓冲池
+struct cx_pool {
+    struct cx_pool_buffer buffers[CX_POOL_SLOTS];
+    size_t count;
+    size_t size;  // 缓存的总字节数
+};
+
+static pthread_key_t cx_pool_key;
+static pthread_once_t cx_pool_once = PTHREAD_ONCE_INIT;
+static bool cx_pool_key_created;
+
+static void cx_pool_free(void *ptr)
+{
+    struct cx_pool *pool = ptr;
+    for (size_t i = 0; i < pool->count; i++)
+        free(pool->buffers[i].ptr);
+    free(pool);
+}
+
+static void cx_pool_init(void)
+{
+    // buffers are released when their thread exits
+    cx_pool_key_created = !pthread_key_create(&cx_pool_key, cx_pool_free);
+}
+
+static struct cx_pool *cx_pool_local(void)
+{
+    if (pthread_once(&cx_pool_once, cx_pool_init) || !cx_pool_key_created)
+        return NULL;
+    struct cx_pool *pool = pthread_getspecific(cx_pool_key);
+    if (pool)
+        return pool;
+    pool = calloc(1, sizeof(*pool));
+    if (!pool)
+        return NULL;
+    if (pthread_setspecific(cx_pool_key, pool)) {
+        free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+static void *cx_pool_alloc(size_t size)
+{
+#ifdef CX_HUGEPAGES
+    if (size >= CX_POOL_HUGEPAGE_SIZE) {
+        void *ptr;
+        if (posix_memalign(&ptr, CX_POOL_HUGEPAGE_SIZE, size))
+            return NULL;
+        madvise(ptr, size, MADV_HUGEPAGE);  // a hint only
+        return ptr;
+    }
+#endif
+    return malloc(size);
+}
+
+void *cx_pool_get(size_t size, size_t *capacity)
+{
+    struct cx_pool *pool = cx_pool_local();
+    if (pool) {
+        // take the smallest buffer that fits, unless it's more than
+        // twice the size needed
+        size_t best = pool->count;
+        for (size_t i = 0; i < pool->count; i++) {
+            size_t buffer_capacity = pool->buffers[i].capacity;
+            if (buffer_capacity < size || buffer_capacity / 2 > size)
+                continue;
+            if (best == pool->count ||
+                buffer_capacity < pool->buffers[best].capacity)
+                best = i;
+        }
+        if (best < pool->count) {
+            void *ptr = pool->buffers[best].ptr;
+            *capacity = pool->buffers[best].capacity;
+            pool->size -= *capacity;
+            pool->buffers[best] = pool->buffers[--pool->count];
+            return ptr;
+        }
+    }
+    *capacity = size;
+    return cx_pool_alloc(size);
+}
+
+void cx_pool_put(void *buffer, size_t capacity)
+{
+    if (!buffer)
+        return;
+    struct cx_pool *pool = cx_pool_local();
+    if (!pool || capacity > CX_POOL_MAX_BYTES) {
+        free(buffer);
+        return;
+    }
+    // make room by releasing the oldest buffers
+    while (pool->count && (pool->count == CX_POOL_SLOTS ||
+                           pool->size + capacity > CX_POOL_MAX_BYTES)) {
+        free(pool->buffers[0].ptr);
+        pool->size -= pool->buffers[0].capacity;
+        pool->count--;
+        memmove(pool->buffers, pool->buffers + 1,
+                pool->count * sizeof(*pool->buffers));
+    }
+    pool->buffers[pool->count].ptr = buffer;
+    pool->buffers[pool->count].capacity = capacity;
+    pool->count++;
+    pool->size += capacity;
+}
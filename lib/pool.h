@@ -0,0 +1,26 @@
+#ifndef CX_POOL_H_
+#define CX_POOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "common.h"
+
+// a pool of buffers for each thread, so that the buffers chunks are
+// decompressed and compressed into are reused rather than allocated for
+// every chunk. a buffer can be returned to the pool of any thread
+
+// take a buffer of at least size bytes from the pool of the calling
+// thread, or allocate one. the size of the buffer is stored in capacity
+void *cx_pool_get(size_t size, size_t *capacity);
+
+// return a buffer to the pool of the calling thread, or release it if
+// the pool is full
+void cx_pool_put(void *buffer, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -6,6 +6,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "bitpack.h"
+#include "fsst.h"
 #include "match.h"
 
 enum cx_predicate_type {
@@ -21,6 +23,7 @@ enum cx_predicate_type {
 };
 
 struct cx_predicate {
+    uint64_t id;
     enum cx_predicate_type type;
     enum cx_column_type column_type;
     size_t column;
@@ -41,9 +44,17 @@ struct cx_predicate {
 
 static const uint64_t cx_full_mask = (uint64_t)-1;
 
+// predicates are assigned a unique id so that state derived from them
+// (e.g. dictionary matches) can be cached against a cursor
+static uint64_t cx_predicate_id;
+
 static struct cx_predicate *cx_predicate_new()
 {
-    return calloc(1, sizeof(struct cx_predicate));
+    struct cx_predicate *predicate = calloc(1, sizeof(struct cx_predicate));
+    if (!predicate)
+        return NULL;
+    predicate->id = __atomic_add_fetch(&cx_predicate_id, 1, __ATOMIC_RELAXED);
+    return predicate;
 }
 
 void cx_predicate_free(struct cx_predicate *predicate)
@@ -417,12 +428,86 @@ bool cx_predicate_valid(const struct cx_predicate *predicate,
     return true;
 }
 
-static inline uint64_t cx_mask_cap(uint64_t mask, size_t count)
+// row masks have a bit for each row of a batch, spread over
+// (count + 63) / 64 words. bits beyond the count of the batch are clear
+static inline size_t cx_mask_words(size_t count)
 {
-    assert(count <= 64);
-    if (count < 64)
-        mask &= ((uint64_t)1 << count) - 1;
-    return mask;
+    return (count + 63) / 64;
+}
+
+static inline void cx_mask_cap(uint64_t *mask, size_t count)
+{
+    if (count % 64)
+        mask[count / 64] &= ((uint64_t)1 << (count % 64)) - 1;
+}
+
+static void cx_mask_clear(uint64_t *mask, size_t count)
+{
+    memset(mask, 0, cx_mask_words(count) * sizeof(uint64_t));
+}
+
+static void cx_mask_fill(uint64_t *mask, size_t count)
+{
+    memset(mask, 0xFF, cx_mask_words(count) * sizeof(uint64_t));
+    cx_mask_cap(mask, count);
+}
+
+static void cx_mask_negate(uint64_t *mask, size_t count)
+{
+    for (size_t i = 0; i < cx_mask_words(count); i++)
+        mask[i] = ~mask[i];
+    cx_mask_cap(mask, count);
+}
+
+static bool cx_mask_empty(const uint64_t *mask, size_t count)
+{
+    for (size_t i = 0; i < cx_mask_words(count); i++)
+        if (mask[i])
+            return false;
+    return true;
+}
+
+static bool cx_mask_full(const uint64_t *mask, size_t count)
+{
+    size_t words = count / 64;
+    for (size_t i = 0; i < words; i++)
+        if (mask[i] != cx_full_mask)
+            return false;
+    return !(count % 64) ||
+           mask[words] == ((uint64_t)1 << (count % 64)) - 1;
+}
+
+static void cx_index_match_str(const struct cx_predicate *predicate,
+                               size_t count, const struct cx_string values[],
+                               uint64_t *matches)
+{
+    for (size_t i = 0; i < count; i += 64) {
+        size_t size = count - i < 64 ? count - i : 64;
+        const struct cx_string *strings = &values[i];
+        uint64_t mask = 0;
+        switch (predicate->type) {
+            case CX_PREDICATE_EQ:
+                mask = cx_match_str_eq(size, strings, &predicate->value.str,
+                                       predicate->case_sensitive);
+                break;
+            case CX_PREDICATE_LT:
+                mask = cx_match_str_lt(size, strings, &predicate->value.str,
+                                       predicate->case_sensitive);
+                break;
+            case CX_PREDICATE_GT:
+                mask = cx_match_str_gt(size, strings, &predicate->value.str,
+                                       predicate->case_sensitive);
+                break;
+            case CX_PREDICATE_CONTAINS:
+                mask = cx_match_str_contains(
+                    size, strings, &predicate->value.str,
+                    predicate->case_sensitive, predicate->location);
+                break;
+            default:
+                assert(0);
+        }
+        matches[i / 64] = mask;
+    }
 }
 
 static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
@@ -430,7 +515,6 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                                    enum cx_column_type type, uint64_t *matches,
                                    size_t *count)
 {
-    uint64_t mask = 0;
     switch (type) {
         case CX_COLUMN_BIT: {
             assert(predicate->column_type == CX_COLUMN_BIT);
@@ -438,12 +522,9 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_bit(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            if (*count) {
-                if (predicate->value.bit)
-                    mask = *values;
-                else
-                    mask = cx_mask_cap(~*values, *count);
-            }
+            for (size_t i = 0; i < cx_mask_words(*count); i++)
+                matches[i] = predicate->value.bit ? values[i] : ~values[i];
+            cx_mask_cap(matches, *count);
         } break;
         case CX_COLUMN_I32: {
             assert(predicate->column_type == CX_COLUMN_I32);
@@ -451,7 +532,8 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i32(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i32_eq(*count, values, predicate->value.i32);
+            cx_match_i32_eq_bitmap(*count, values, predicate->value.i32,
+                                   matches);
         } break;
         case CX_COLUMN_I64: {
             assert(predicate->column_type == CX_COLUMN_I64);
@@ -459,7 +541,8 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i64(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i64_eq(*count, values, predicate->value.i64);
+            cx_match_i64_eq_bitmap(*count, values, predicate->value.i64,
+                                   matches);
         } break;
         case CX_COLUMN_FLT: {
             assert(predicate->column_type == CX_COLUMN_FLT);
@@ -467,7 +550,8 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_flt(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_flt_eq(*count, values, predicate->value.flt);
+            cx_match_flt_eq_bitmap(*count, values, predicate->value.flt,
+                                   matches);
         } break;
         case CX_COLUMN_DBL: {
             assert(predicate->column_type == CX_COLUMN_DBL);
@@ -475,7 +559,8 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_dbl(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_dbl_eq(*count, values, predicate->value.dbl);
+            cx_match_dbl_eq_bitmap(*count, values, predicate->value.dbl,
+                                   matches);
         } break;
         case CX_COLUMN_STR: {
             assert(predicate->column_type == CX_COLUMN_STR);
@@ -483,11 +568,9 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_str(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_str_eq(*count, values, &predicate->value.str,
-                                   predicate->case_sensitive);
+            cx_index_match_str(predicate, *count, values, matches);
         } break;
     }
-    *matches = mask;
     return true;
 error:
     return false;
@@ -532,7 +615,6 @@ static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                                    enum cx_column_type type, uint64_t *matches,
                                    size_t *count)
 {
-    uint64_t mask = 0;
     switch (type) {
         case CX_COLUMN_BIT:
             goto error;  // unsupported
@@ -542,7 +624,8 @@ static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i32(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i32_lt(*count, values, predicate->value.i32);
+            cx_match_i32_lt_bitmap(*count, values, predicate->value.i32,
+                                   matches);
         } break;
         case CX_COLUMN_I64: {
             assert(predicate->column_type == CX_COLUMN_I64);
@@ -550,7 +633,8 @@ static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i64(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i64_lt(*count, values, predicate->value.i64);
+            cx_match_i64_lt_bitmap(*count, values, predicate->value.i64,
+                                   matches);
         } break;
         case CX_COLUMN_FLT: {
             assert(predicate->column_type == CX_COLUMN_FLT);
@@ -558,7 +642,8 @@ static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_flt(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_flt_lt(*count, values, predicate->value.flt);
+            cx_match_flt_lt_bitmap(*count, values, predicate->value.flt,
+                                   matches);
         } break;
         case CX_COLUMN_DBL: {
             assert(predicate->column_type == CX_COLUMN_DBL);
@@ -566,7 +651,8 @@ static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_dbl(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_dbl_lt(*count, values, predicate->value.dbl);
+            cx_match_dbl_lt_bitmap(*count, values, predicate->value.dbl,
+                                   matches);
         } break;
         case CX_COLUMN_STR: {
             assert(predicate->column_type == CX_COLUMN_STR);
@@ -574,11 +660,9 @@ static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_str(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_str_lt(*count, values, &predicate->value.str,
-                                   predicate->case_sensitive);
+            cx_index_match_str(predicate, *count, values, matches);
         } break;
     }
-    *matches = mask;
     return true;
 error:
     return false;
@@ -619,7 +703,6 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                                    enum cx_column_type type, uint64_t *matches,
                                    size_t *count)
 {
-    uint64_t mask = 0;
     switch (type) {
         case CX_COLUMN_BIT:
             goto error;  // unsupported
@@ -629,7 +712,8 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i32(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i32_gt(*count, values, predicate->value.i32);
+            cx_match_i32_gt_bitmap(*count, values, predicate->value.i32,
+                                   matches);
         } break;
         case CX_COLUMN_I64: {
             assert(predicate->column_type == CX_COLUMN_I64);
@@ -637,7 +721,8 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i64(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i64_gt(*count, values, predicate->value.i64);
+            cx_match_i64_gt_bitmap(*count, values, predicate->value.i64,
+                                   matches);
         } break;
         case CX_COLUMN_FLT: {
             assert(predicate->column_type == CX_COLUMN_FLT);
@@ -645,7 +730,8 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_flt(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_flt_gt(*count, values, predicate->value.flt);
+            cx_match_flt_gt_bitmap(*count, values, predicate->value.flt,
+                                   matches);
         } break;
         case CX_COLUMN_DBL: {
             assert(predicate->column_type == CX_COLUMN_DBL);
@@ -653,7 +739,8 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_dbl(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_dbl_gt(*count, values, predicate->value.dbl);
+            cx_match_dbl_gt_bitmap(*count, values, predicate->value.dbl,
+                                   matches);
         } break;
         case CX_COLUMN_STR: {
             assert(predicate->column_type == CX_COLUMN_STR);
@@ -661,11 +748,9 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_str(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_str_gt(*count, values, &predicate->value.str,
-                                   predicate->case_sensitive);
+            cx_index_match_str(predicate, *count, values, matches);
         } break;
     }
-    *matches = mask;
     return true;
 error:
     return false;
@@ -708,38 +793,360 @@ static bool cx_index_match_rows_custom(const struct cx_predicate *predicate,
 {
     size_t column = predicate->column;
     const void *values = NULL;
+    size_t stride = 0;  // bytes per 64 values
     switch (type) {
         case CX_COLUMN_BIT:
             assert(predicate->column_type == CX_COLUMN_BIT);
             values = cx_row_group_cursor_batch_bit(cursor, column, count);
+            stride = sizeof(uint64_t);
             break;
         case CX_COLUMN_I32:
             assert(predicate->column_type == CX_COLUMN_I32);
             values = cx_row_group_cursor_batch_i32(cursor, column, count);
+            stride = 64 * sizeof(int32_t);
             break;
         case CX_COLUMN_I64:
             assert(predicate->column_type == CX_COLUMN_I64);
             values = cx_row_group_cursor_batch_i64(cursor, column, count);
+            stride = 64 * sizeof(int64_t);
             break;
         case CX_COLUMN_FLT:
             assert(predicate->column_type == CX_COLUMN_FLT);
             values = cx_row_group_cursor_batch_flt(cursor, column, count);
+            stride = 64 * sizeof(float);
             break;
         case CX_COLUMN_DBL:
             assert(predicate->column_type == CX_COLUMN_DBL);
             values = cx_row_group_cursor_batch_dbl(cursor, column, count);
+            stride = 64 * sizeof(double);
             break;
         case CX_COLUMN_STR:
             assert(predicate->column_type == CX_COLUMN_STR);
             values = cx_row_group_cursor_batch_str(cursor, column, count);
+            stride = 64 * sizeof(struct cx_string);
             break;
     }
     if (!values)
         return false;
+    cx_mask_clear(matches, *count);
     if (!predicate->custom.match_rows)
         return true;
-    return predicate->custom.match_rows(type, *count, values, matches,
-                                        predicate->custom.data);
+    // custom predicates are given (up to) 64 rows at a time
+    for (size_t i = 0; i < *count; i += 64) {
+        size_t size = *count - i < 64 ? *count - i : 64;
+        if (!predicate->custom.match_rows(
+                type, size, (const char *)values + i / 64 * stride,
+                &matches[i / 64], predicate->custom.data))
+            return false;
+    }
+    return true;
+}
+
+// the result of matching a string predicate against a column dictionary.
+// codes that match are set in the bitset, and when they form a contiguous
+// range [start, end) the codes can be matched with the i32 kernels
+struct cx_dict_match {
+    size_t size;
+    int32_t start;
+    int32_t end;
+    bool contiguous;
+    uint64_t codes[];
+};
+
+static bool cx_predicate_matches_codes(const struct cx_predicate *predicate,
+                                       const struct cx_row_group *row_group)
+{
+    switch (predicate->type) {
+        case CX_PREDICATE_EQ:
+        case CX_PREDICATE_LT:
+        case CX_PREDICATE_GT:
+        case CX_PREDICATE_CONTAINS:
+            break;
+        default:
+            return false;
+    }
+    return predicate->column_type == CX_COLUMN_STR &&
+           cx_row_group_column_encoding(row_group, predicate->column) ==
+               CX_ENCODING_DICT;
+}
+
+static const struct cx_dict_match *cx_index_match_dict(
+    const struct cx_predicate *predicate, struct cx_row_group_cursor *cursor)
+{
+    // the dictionary is matched once per row group cursor
+    const struct cx_dict_match *cached =
+        cx_row_group_cursor_cache(cursor, predicate->column, predicate->id);
+    if (cached)
+        return cached;
+    size_t size;
+    const struct cx_string *dict =
+        cx_row_group_cursor_dict(cursor, predicate->column, &size);
+    if (!dict)
+        return NULL;
+    size_t words = cx_mask_words(size);
+    struct cx_dict_match *match =
+        calloc(1, sizeof(*match) + words * sizeof(uint64_t));
+    if (!match)
+        return NULL;
+    match->size = size;
+    cx_index_match_str(predicate, size, dict, match->codes);
+    size_t matched = 0;
+    int32_t first = -1, last = -1;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t mask = match->codes[i];
+        if (!mask)
+            continue;
+        if (first < 0)
+            first = i * 64 + __builtin_ctzll(mask);
+        last = i * 64 + 63 - __builtin_clzll(mask);
+        matched += __builtin_popcountll(mask);
+    }
+    match->start = first < 0 ? 0 : first;
+    match->end = first < 0 ? 0 : last + 1;
+    match->contiguous = matched == (size_t)(match->end - match->start);
+    if (!cx_row_group_cursor_cache_put(cursor, predicate->column,
+                                       predicate->id, match)) {
+        free(match);
+        return NULL;
+    }
+    return match;
+}
+
+static bool cx_index_match_rows_dict(const struct cx_predicate *predicate,
+                                     struct cx_row_group_cursor *cursor,
+                                     uint64_t *matches, size_t *count)
+{
+    const struct cx_dict_match *match = cx_index_match_dict(predicate, cursor);
+    if (!match)
+        return false;
+    const int32_t *codes =
+        cx_row_group_cursor_batch_codes(cursor, predicate->column, count);
+    if (!codes)
+        return false;
+    if (match->start == match->end) {
+        // no codes match
+        cx_mask_clear(matches, *count);
+    } else if (match->contiguous) {
+        if (match->end - match->start == 1) {
+            cx_match_i32_eq_bitmap(*count, codes, match->start, matches);
+        } else {
+            uint64_t bound[CX_BATCH_SIZE_MAX / 64];
+            cx_mask_fill(matches, *count);
+            if (match->start > 0) {
+                cx_match_i32_gt_bitmap(*count, codes, match->start - 1,
+                                       bound);
+                for (size_t i = 0; i < cx_mask_words(*count); i++)
+                    matches[i] &= bound[i];
+            }
+            if ((size_t)match->end < match->size) {
+                cx_match_i32_lt_bitmap(*count, codes, match->end, bound);
+                for (size_t i = 0; i < cx_mask_words(*count); i++)
+                    matches[i] &= bound[i];
+            }
+        }
+    } else {
+        cx_mask_clear(matches, *count);
+        for (size_t i = 0; i < *count; i++) {
+            int32_t code = codes[i];
+            if (match->codes[code / 64] & ((uint64_t)1 << (code % 64)))
+                matches[i / 64] |= (uint64_t)1 << (i % 64);
+        }
+    }
+    return true;
+}
+
+static bool cx_predicate_matches_compressed(
+    const struct cx_predicate *predicate, const struct cx_row_group *row_group)
+{
+    // strings compressed with the same symbol table are equal only if their
+    // compressed forms are. other comparisons depend on where the symbol
+    // boundaries fall, so they're made against the decompressed strings
+    return predicate->type == CX_PREDICATE_EQ && predicate->case_sensitive &&
+           predicate->column_type == CX_COLUMN_STR &&
+           cx_row_group_column_encoding(row_group, predicate->column) ==
+               CX_ENCODING_FSST;
+}
+
+struct cx_compressed_literal {
+    struct cx_string string;
+    uint8_t bytes[];
+};
+
+static const struct cx_string *cx_index_compress_literal(
+    const struct cx_predicate *predicate, struct cx_row_group_cursor *cursor)
+{
+    // the literal is compressed once per row group cursor
+    const struct cx_compressed_literal *cached =
+        cx_row_group_cursor_cache(cursor, predicate->column, predicate->id);
+    if (cached)
+        return &cached->string;
+    const struct cx_fsst_table *table =
+        cx_row_group_cursor_symbols(cursor, predicate->column);
+    if (!table)
+        return NULL;
+    const struct cx_string *str = &predicate->value.str;
+    struct cx_compressed_literal *literal =
+        malloc(sizeof(*literal) + 2 * str->len + 1);
+    if (!literal)
+        return NULL;
+    literal->string.ptr = (const char *)literal->bytes;
+    literal->string.len =
+        cx_fsst_compress(table, str->ptr, str->len, literal->bytes);
+    if (!cx_row_group_cursor_cache_put(cursor, predicate->column,
+                                       predicate->id, literal)) {
+        free(literal);
+        return NULL;
+    }
+    return &literal->string;
+}
+
+static bool cx_index_match_rows_compressed(
+    const struct cx_predicate *predicate, struct cx_row_group_cursor *cursor,
+    uint64_t *matches, size_t *count)
+{
+    const struct cx_string *literal =
+        cx_index_compress_literal(predicate, cursor);
+    if (!literal)
+        return false;
+    const struct cx_string *strings = cx_row_group_cursor_batch_compressed(
+        cursor, predicate->column, count);
+    if (!strings)
+        return false;
+    for (size_t i = 0; i < *count; i += 64) {
+        size_t size = *count - i < 64 ? *count - i : 64;
+        matches[i / 64] = cx_match_bytes_eq(size, &strings[i], literal);
+    }
+    return true;
+}
+
+static bool cx_predicate_matches_runs(const struct cx_predicate *predicate,
+                                      const struct cx_row_group *row_group)
+{
+    switch (predicate->type) {
+        case CX_PREDICATE_EQ:
+        case CX_PREDICATE_LT:
+        case CX_PREDICATE_GT:
+            break;
+        default:
+            return false;
+    }
+    switch (predicate->column_type) {
+        case CX_COLUMN_BIT:
+        case CX_COLUMN_I32:
+        case CX_COLUMN_I64:
+            break;
+        default:
+            return false;
+    }
+    return cx_row_group_column_encoding(row_group, predicate->column) ==
+           CX_ENCODING_RLE;
+}
+
+static bool cx_predicate_match_value(const struct cx_predicate *predicate,
+                                     const cx_value_t *value)
+{
+    switch (predicate->column_type) {
+        case CX_COLUMN_BIT:
+            assert(predicate->type == CX_PREDICATE_EQ);
+            return value->bit == predicate->value.bit;
+        case CX_COLUMN_I32:
+            if (predicate->type == CX_PREDICATE_EQ)
+                return value->i32 == predicate->value.i32;
+            else if (predicate->type == CX_PREDICATE_LT)
+                return value->i32 < predicate->value.i32;
+            return value->i32 > predicate->value.i32;
+        case CX_COLUMN_I64:
+            if (predicate->type == CX_PREDICATE_EQ)
+                return value->i64 == predicate->value.i64;
+            else if (predicate->type == CX_PREDICATE_LT)
+                return value->i64 < predicate->value.i64;
+            return value->i64 > predicate->value.i64;
+        default:
+            assert(0);
+    }
+    return false;
+}
+
+static bool cx_index_match_rows_runs(const struct cx_predicate *predicate,
+                                     struct cx_row_group_cursor *cursor,
+                                     uint64_t *matches, size_t *count)
+{
+    size_t run_count;
+    const struct cx_run *runs = cx_row_group_cursor_batch_runs(
+        cursor, predicate->column, &run_count, count);
+    if (!runs)
+        return false;
+    // each run is matched with a single comparison
+    cx_mask_clear(matches, *count);
+    size_t offset = 0;
+    for (size_t i = 0; i < run_count; i++) {
+        if (cx_predicate_match_value(predicate, &runs[i].value))
+            cx_bitset_set_range(matches, offset, runs[i].length);
+        offset += runs[i].length;
+    }
+    return true;
+}
+
+static bool cx_predicate_matches_planes(const struct cx_predicate *predicate,
+                                        const struct cx_row_group *row_group)
+{
+    switch (predicate->type) {
+        case CX_PREDICATE_EQ:
+        case CX_PREDICATE_LT:
+        case CX_PREDICATE_GT:
+            break;
+        default:
+            return false;
+    }
+    if (predicate->column_type != CX_COLUMN_I32 &&
+        predicate->column_type != CX_COLUMN_I64)
+        return false;
+    return cx_row_group_column_encoding(row_group, predicate->column) ==
+           CX_ENCODING_BITPACK;
+}
+
+static bool cx_index_match_rows_planes(const struct cx_predicate *predicate,
+                                       struct cx_row_group_cursor *cursor,
+                                       uint64_t *matches, size_t *count)
+{
+    int64_t base;
+    size_t width;
+    const uint64_t *planes = cx_row_group_cursor_batch_planes(
+        cursor, predicate->column, &base, &width, count);
+    if (!planes)
+        return false;
+    int64_t value = predicate->column_type == CX_COLUMN_I32
+                        ? predicate->value.i32
+                        : predicate->value.i64;
+    uint64_t max_code =
+        width == 64 ? cx_full_mask : ((uint64_t)1 << width) - 1;
+    // translate the value into the frame of reference of the chunk. values
+    // outside of the range of codes match all rows or none
+    if (value < base) {
+        if (predicate->type == CX_PREDICATE_GT)
+            cx_mask_fill(matches, *count);
+        else
+            cx_mask_clear(matches, *count);
+    } else if ((uint64_t)value - (uint64_t)base > max_code) {
+        if (predicate->type == CX_PREDICATE_LT)
+            cx_mask_fill(matches, *count);
+        else
+            cx_mask_clear(matches, *count);
+    } else {
+        // each block of 64 rows has width planes
+        uint64_t code = (uint64_t)value - (uint64_t)base;
+        for (size_t i = 0; i < cx_mask_words(*count); i++) {
+            const uint64_t *block = &planes[i * width];
+            if (predicate->type == CX_PREDICATE_EQ)
+                matches[i] = cx_match_packed_eq(width, block, code);
+            else if (predicate->type == CX_PREDICATE_LT)
+                matches[i] = cx_match_packed_lt(width, block, code);
+            else
+                matches[i] = cx_match_packed_gt(width, block, code);
+        }
+        cx_mask_cap(matches, *count);
+    }
+    return true;
 }
 
 bool cx_index_match_rows(const struct cx_predicate *predicate,
@@ -749,32 +1156,51 @@ bool cx_index_match_rows(const struct cx_predicate *predicate,
 {
     enum cx_column_type column_type =
         cx_row_group_column_type(row_group, predicate->column);
-    uint64_t mask = 0;
+    if (cx_predicate_matches_codes(predicate, row_group)) {
+        // string predicates on dictionary encoded columns are evaluated
+        // against the dictionary and then against the codes of each row
+        if (!cx_index_match_rows_dict(predicate, cursor, matches, count))
+            goto error;
+        goto done;
+    } else if (cx_predicate_matches_compressed(predicate, row_group)) {
+        if (!cx_index_match_rows_compressed(predicate, cursor, matches, count))
+            goto error;
+        goto done;
+    } else if (cx_predicate_matches_runs(predicate, row_group)) {
+        if (!cx_index_match_rows_runs(predicate, cursor, matches, count))
+            goto error;
+        goto done;
+    } else if (cx_predicate_matches_planes(predicate, row_group)) {
+        // bit-packed integers are compared without unpacking them
+        if (!cx_index_match_rows_planes(predicate, cursor, matches, count))
+            goto error;
+        goto done;
+    }
     switch (predicate->type) {
         case CX_PREDICATE_TRUE:
             *count = cx_row_group_cursor_batch_count(cursor);
-            mask = cx_mask_cap(cx_full_mask, *count);
+            cx_mask_fill(matches, *count);
             break;
         case CX_PREDICATE_NULL: {
             const uint64_t *nulls = cx_row_group_cursor_batch_nulls(
                 cursor, predicate->column, count);
             if (!nulls)
                 goto error;
-            mask = *count ? *nulls : 0;
+            memcpy(matches, nulls, cx_mask_words(*count) * sizeof(uint64_t));
         } break;
         case CX_PREDICATE_EQ:
-            if (!cx_index_match_rows_eq(predicate, cursor, column_type, &mask,
-                                        count))
+            if (!cx_index_match_rows_eq(predicate, cursor, column_type,
+                                        matches, count))
                 goto error;
             break;
         case CX_PREDICATE_LT:
-            if (!cx_index_match_rows_lt(predicate, cursor, column_type, &mask,
-                                        count))
+            if (!cx_index_match_rows_lt(predicate, cursor, column_type,
+                                        matches, count))
                 goto error;
             break;
         case CX_PREDICATE_GT:
-            if (!cx_index_match_rows_gt(predicate, cursor, column_type, &mask,
-                                        count))
+            if (!cx_index_match_rows_gt(predicate, cursor, column_type,
+                                        matches, count))
                 goto error;
             break;
         case CX_PREDICATE_CONTAINS:
@@ -784,54 +1210,65 @@ bool cx_index_match_rows(const struct cx_predicate *predicate,
                     cursor, predicate->column, count);
                 if (!values)
                     goto error;
-                mask = cx_match_str_contains(
-                    *count, values, &predicate->value.str,
-                    predicate->case_sensitive, predicate->location);
+                cx_index_match_str(predicate, *count, values, matches);
             }
             break;
         case CX_PREDICATE_CUSTOM:
             if (!cx_index_match_rows_custom(predicate, cursor, column_type,
-                                            &mask, count))
+                                            matches, count))
                 goto error;
             break;
-        case CX_PREDICATE_AND:
-            mask = cx_full_mask;
+        case CX_PREDICATE_AND: {
+            uint64_t operand_matches[CX_BATCH_SIZE_MAX / 64];
+            *count = cx_row_group_cursor_batch_count(cursor);
+            cx_mask_fill(matches, *count);
             // short-circuit the remaining predicates once the mask is empty
-            for (size_t i = 0; mask && i < predicate->operand_count; i++) {
-                uint64_t operand_mask;
+            for (size_t i = 0; i < predicate->operand_count; i++) {
+                if (cx_mask_empty(matches, *count))
+                    break;
                 if (!cx_index_match_rows(predicate->operands[i], row_group,
-                                         cursor, &operand_mask, count))
+                                         cursor, operand_matches, count))
                     goto error;
-                mask &= operand_mask;
+                for (size_t j = 0; j < cx_mask_words(*count); j++)
+                    matches[j] &= operand_matches[j];
             }
-            break;
-        case CX_PREDICATE_OR:
-            mask = 0;
+        } break;
+        case CX_PREDICATE_OR: {
+            uint64_t operand_matches[CX_BATCH_SIZE_MAX / 64];
+            *count = cx_row_group_cursor_batch_count(cursor);
+            cx_mask_clear(matches, *count);
             // short-circuit the remaining predicates once the mask is full
-            for (size_t i = 0;
-                 mask != cx_full_mask && i < predicate->operand_count; i++) {
-                uint64_t operand_mask;
+            for (size_t i = 0; i < predicate->operand_count; i++) {
+                if (cx_mask_full(matches, *count))
+                    break;
                 if (!cx_index_match_rows(predicate->operands[i], row_group,
-                                         cursor, &operand_mask, count))
+                                         cursor, operand_matches, count))
                     goto error;
-                mask |= operand_mask;
+                for (size_t j = 0; j < cx_mask_words(*count); j++)
+                    matches[j] |= operand_matches[j];
             }
-            break;
+        } break;
     }
-    *matches = predicate->negate ? cx_mask_cap(~mask, *count) : mask;
+done:
+    if (predicate->negate)
+        cx_mask_negate(matches, *count);
     return true;
 error:
     return false;
 }
 
-enum cx_index_match cx_index_match_indexes(const struct cx_predicate *predicate,
-                                           const struct cx_row_group *row_group)
+static enum cx_index_match cx_index_match_indexes_at(
+    const struct cx_predicate *predicate, const struct cx_row_group *row_group,
+    bool paged, size_t row)
 {
-    if (!cx_row_group_row_count(row_group))
-        return CX_INDEX_MATCH_NONE;
-
+    // null bitmaps aren't split into pages, so their index always covers
+    // the whole row group
     const struct cx_index *index =
-        cx_row_group_column_index(row_group, predicate->column);
+        paged ? cx_row_group_column_page_index(row_group, predicate->column,
+                                               row)
+              : cx_row_group_column_index(row_group, predicate->column);
+    if (!index)
+        return CX_INDEX_MATCH_UNKNOWN;
     enum cx_column_type type =
         cx_row_group_column_type(row_group, predicate->column);
     enum cx_index_match result = CX_INDEX_MATCH_UNKNOWN;
@@ -861,7 +1298,8 @@ enum cx_index_match cx_index_match_indexes(const struct cx_predicate *predicate,
                  result != CX_INDEX_MATCH_NONE && i < predicate->operand_count;
                  i++) {
                 enum cx_index_match operand_match =
-                    cx_index_match_indexes(predicate->operands[i], row_group);
+                    cx_index_match_indexes_at(predicate->operands[i],
+                                              row_group, paged, row);
                 if (operand_match < result)
                     result = operand_match;
             }
@@ -872,23 +1310,38 @@ enum cx_index_match cx_index_match_indexes(const struct cx_predicate *predicate,
                  result != CX_INDEX_MATCH_ALL && i < predicate->operand_count;
                  i++) {
                 enum cx_index_match operand_match =
-                    cx_index_match_indexes(predicate->operands[i], row_group);
+                    cx_index_match_indexes_at(predicate->operands[i],
+                                              row_group, paged, row);
                 if (operand_match > result)
                     result = operand_match;
             }
             break;
         case CX_PREDICATE_CUSTOM:
-            if (predicate->custom.match_index) {
-                const struct cx_index *index =
-                    cx_row_group_column_index(row_group, predicate->column);
+            if (predicate->custom.match_index)
                 result = predicate->custom.match_index(type, index,
                                                        predicate->custom.data);
-            }
             break;
     }
     return predicate->negate ? -result : result;
 }
 
+enum cx_index_match cx_index_match_indexes(const struct cx_predicate *predicate,
+                                           const struct cx_row_group *row_group)
+{
+    if (!cx_row_group_row_count(row_group))
+        return CX_INDEX_MATCH_NONE;
+    return cx_index_match_indexes_at(predicate, row_group, false, 0);
+}
+
+enum cx_index_match cx_index_match_page_indexes(
+    const struct cx_predicate *predicate, const struct cx_row_group *row_group,
+    size_t row)
+{
+    if (row >= cx_row_group_row_count(row_group))
+        return CX_INDEX_MATCH_NONE;
+    return cx_index_match_indexes_at(predicate, row_group, true, row);
+}
+
 static int cx_column_cost(enum cx_column_type type)
 {
     int cost = 0;
@@ -929,8 +1382,21 @@ static int cx_predicate_cost(const struct cx_predicate *predicate,
         case CX_PREDICATE_LT:
         case CX_PREDICATE_GT:
         case CX_PREDICATE_CONTAINS:
-            cost = cx_column_cost(
-                cx_row_group_column_type(row_group, predicate->column));
+            // dictionary encoded strings are matched as i32 codes,
+            // compressed strings are matched without decompressing them,
+            // run-length encoded columns are matched a run at a time, and
+            // bit-packed columns only touch the bits each value occupies
+            if (cx_predicate_matches_codes(predicate, row_group))
+                cost = cx_column_cost(CX_COLUMN_I32);
+            else if (cx_predicate_matches_compressed(predicate, row_group))
+                cost = cx_column_cost(CX_COLUMN_STR) / 4;
+            else if (cx_predicate_matches_runs(predicate, row_group))
+                cost = cx_column_cost(CX_COLUMN_BIT);
+            else if (cx_predicate_matches_planes(predicate, row_group))
+                cost = cx_column_cost(predicate->column_type) / 2;
+            else
+                cost = cx_column_cost(
+                    cx_row_group_column_type(row_group, predicate->column));
             break;
         case CX_PREDICATE_AND:
         case CX_PREDICATE_OR:
@@ -66,6 +66,15 @@ const struct cx_predicate **cx_predicate_operands(const struct cx_predicate *,
 enum cx_index_match cx_index_match_indexes(const struct cx_predicate *,
                                            const struct cx_row_group *);
 
+// match against the indexes of the pages that hold a row (see
+// cx_row_group_column_page_index), so that batches can be skipped within
+// a row group that can't be skipped as a whole
+enum cx_index_match cx_index_match_page_indexes(const struct cx_predicate *,
+                                                const struct cx_row_group *,
+                                                size_t row);
+
+// match the rows of the current batch of the cursor, setting a bit in matches
+// (a word for each 64 rows of the batch) for each matching row
 bool cx_index_match_rows(const struct cx_predicate *predicate,
                          const struct cx_row_group *row_group,
                          struct cx_row_group_cursor *cursor, uint64_t *matches,
@@ -75,6 +84,7 @@ typedef enum cx_index_match (*cx_index_match_index_t)(enum cx_column_type,
                                                       const struct cx_index *,
                                                       void *data);
 
+// custom predicates match up to 64 rows at a time
 typedef bool (*cx_index_match_rows_t)(enum cx_column_type, size_t count,
                                       const void *values, uint64_t *matches,
                                       void *data);
@@ -21,6 +21,7 @@ struct cx_reader {
     struct cx_row_cursor *row_cursor;
     size_t row_group_count;
     size_t position;
+    size_t batch_size;
     bool match_all_rows;
     bool error;
 };
@@ -31,6 +32,7 @@ struct cx_row_group_reader {
     size_t file_size;
     size_t row_count;
     struct cx_column *strings;
+    struct cx_zstd_dictionary **dictionaries;
     struct {
         const struct cx_column_descriptor *descriptors;
         size_t count;
@@ -47,6 +49,7 @@ struct cx_reader_query_context {
     struct cx_predicate *predicate;
     size_t position;
     size_t row_group_count;
+    size_t batch_size;
     void (*iter)(struct cx_row_cursor *, pthread_mutex_t *, void *);
     void *data;
     bool error;
@@ -55,13 +58,16 @@ struct cx_reader_query_context {
 
 static struct cx_reader *cx_reader_new_impl(const char *path,
                                             struct cx_predicate *predicate,
-                                            bool match_all_rows)
+                                            bool match_all_rows,
+                                            size_t batch_size)
 {
-    if (!predicate)
+    if (!predicate || !batch_size || batch_size % 64 ||
+        batch_size > CX_BATCH_SIZE_MAX)
         return NULL;
     struct cx_reader *reader = calloc(1, sizeof(*reader));
     if (!reader)
         return NULL;
+    reader->batch_size = batch_size;
     reader->reader = cx_row_group_reader_new(path);
     if (!reader->reader)
         goto error;
@@ -90,13 +96,24 @@ error:
 
 struct cx_reader *cx_reader_new(const char *path)
 {
-    return cx_reader_new_impl(path, cx_predicate_new_true(), true);
+    return cx_reader_new_impl(path, cx_predicate_new_true(), true,
+                              CX_READER_BATCH_SIZE);
 }
 
 struct cx_reader *cx_reader_new_matching(const char *path,
                                          struct cx_predicate *predicate)
 {
-    return cx_reader_new_impl(path, predicate, false);
+    return cx_reader_new_impl(path, predicate, false, CX_READER_BATCH_SIZE);
+}
+
+struct cx_reader *cx_reader_new_batched(const char *path,
+                                        struct cx_predicate *predicate,
+                                        size_t batch_size)
+{
+    if (!predicate)
+        return cx_reader_new_impl(path, cx_predicate_new_true(), true,
+                                  batch_size);
+    return cx_reader_new_impl(path, predicate, false, batch_size);
 }
 
 void cx_reader_free(struct cx_reader *reader)
@@ -134,7 +151,8 @@ static bool cx_reader_load_cursor(struct cx_reader *reader)
     if (!reader->row_group)
         goto error;
     reader->row_cursor =
-        cx_row_cursor_new(reader->row_group, reader->predicate);
+        cx_row_cursor_new_batched(reader->row_group, reader->predicate,
+                                  reader->batch_size);
     if (!reader->row_cursor)
         goto error;
     return true;
@@ -221,7 +239,8 @@ static void *cx_reader_query_thread(void *ptr)
         row_group = cx_row_group_reader_get(context->reader, position);
         if (!row_group)
             goto error;
-        cursor = cx_row_cursor_new(row_group, context->predicate);
+        cursor = cx_row_cursor_new_batched(row_group, context->predicate,
+                                           context->batch_size);
         if (!cursor)
             goto error;
         context->iter(cursor, &context->mutex, context->data);
@@ -258,6 +277,7 @@ bool cx_reader_query(struct cx_reader *reader, int thread_count, void *data,
         .predicate = reader->predicate,
         .position = 0,
         .row_group_count = reader->row_group_count,
+        .batch_size = reader->batch_size,
         .iter = iter,
         .data = data,
         .error = false};
@@ -372,6 +392,17 @@ static const void *cx_row_group_reader_at(
     return (const void *)((uintptr_t)reader->mmap_ptr + offset);
 }
 
+static void cx_row_group_reader_dictionaries_free(
+    struct cx_row_group_reader *reader)
+{
+    if (!reader->dictionaries)
+        return;
+    for (size_t i = 0; i < reader->columns.count; i++)
+        if (reader->dictionaries[i])
+            cx_zstd_dictionary_free(reader->dictionaries[i]);
+    free(reader->dictionaries);
+}
+
 struct cx_row_group_reader *cx_row_group_reader_new(const char *path)
 {
     struct cx_row_group_reader *reader = calloc(1, sizeof(*reader));
@@ -440,6 +471,31 @@ struct cx_row_group_reader *cx_row_group_reader_new(const char *path)
         cx_row_group_reader_at(reader, file_size - headers_size);
     reader->metadata = footer->metadata;
 
+    // load the ZSTD dictionaries, which old writers didn't write
+    size_t dictionaries_size =
+        footer->column_count * sizeof(struct cx_dictionary_header);
+    if (footer->column_count &&
+        footer->size >= sizeof(*footer) + dictionaries_size) {
+        const struct cx_dictionary_header *dictionaries =
+            cx_row_group_reader_at(
+                reader, file_size - sizeof(*footer) - dictionaries_size);
+        reader->dictionaries =
+            calloc(footer->column_count, sizeof(*reader->dictionaries));
+        if (!reader->dictionaries)
+            goto error;
+        for (size_t i = 0; i < footer->column_count; i++) {
+            const struct cx_dictionary_header *header = &dictionaries[i];
+            if (!header->size)
+                continue;
+            if (header->offset + header->size > file_size)
+                goto error;
+            reader->dictionaries[i] = cx_zstd_dictionary_new(
+                cx_row_group_reader_at(reader, header->offset), header->size);
+            if (!reader->dictionaries[i])
+                goto error;
+        }
+    }
+
     return reader;
 error:
     if (reader->mmap_ptr)
@@ -448,6 +504,7 @@ error:
         fclose(reader->file);
     if (reader->strings)
         cx_column_free(reader->strings);
+    cx_row_group_reader_dictionaries_free(reader);
     free(reader);
     return NULL;
 }
@@ -564,7 +621,10 @@ struct cx_row_group *cx_row_group_reader_get(
             .index = &header->index,
             .ptr = cx_row_group_reader_at(reader, header->offset),
             .size = header->size,
-            .decompressed_size = header->decompressed_size};
+            .decompressed_size = header->decompressed_size,
+            .page_size = descriptor->page_size,
+            .dictionary =
+                reader->dictionaries ? reader->dictionaries[i] : NULL};
 
         struct cx_lazy_column nulls = {
             .type = CX_COLUMN_BIT,
@@ -590,5 +650,6 @@ void cx_row_group_reader_free(struct cx_row_group_reader *reader)
         munmap(reader->mmap_ptr, reader->file_size);
     fclose(reader->file);
     cx_column_free(reader->strings);
+    cx_row_group_reader_dictionaries_free(reader);
     free(reader);
 }
@@ -9,6 +9,9 @@ extern "C" {
 
 #include "row.h"
 
+// rows are matched in batches of CX_READER_BATCH_SIZE rows by default
+#define CX_READER_BATCH_SIZE 1024
+
 struct cx_reader;
 
 CX_EXPORT struct cx_reader *cx_reader_new(const char *);
@@ -16,6 +19,13 @@ CX_EXPORT struct cx_reader *cx_reader_new(const char *);
 CX_EXPORT struct cx_reader *cx_reader_new_matching(const char *,
                                                    struct cx_predicate *);
 
+// create a reader that matches rows in batches of batch_size rows, which
+// must be a multiple of 64 up to CX_BATCH_SIZE_MAX. the predicate is
+// optional, and all rows match without one
+CX_EXPORT struct cx_reader *cx_reader_new_batched(const char *,
+                                                  struct cx_predicate *,
+                                                  size_t batch_size);
+
 CX_EXPORT bool cx_reader_metadata(const struct cx_reader *, const char **);
 
 CX_EXPORT void cx_reader_free(struct cx_reader *);
@@ -2,32 +2,48 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 struct cx_row_cursor {
     struct cx_row_group *row_group;
     struct cx_row_group_cursor *cursor;
     const struct cx_predicate *predicate;
     size_t column_count;
-    uint64_t row_mask;
+    size_t batch_count;  // 当前批的行数
     size_t position;
     enum cx_index_match index_match;
+    bool paged;  // 是否有分页的列
     bool implicit_predicate;
     bool error;
+    uint64_t row_mask[];  // 每 64 行一个字
 };
 
 struct cx_row_cursor *cx_row_cursor_new(struct cx_row_group *row_group,
                                         const struct cx_predicate *predicate)
 {
-    struct cx_row_cursor *cursor = calloc(1, sizeof(*cursor));
+    return cx_row_cursor_new_batched(row_group, predicate, CX_BATCH_SIZE);
+}
+
+struct cx_row_cursor *cx_row_cursor_new_batched(
+    struct cx_row_group *row_group, const struct cx_predicate *predicate,
+    size_t batch_size)
+{
+    if (!batch_size || batch_size % 64 || batch_size > CX_BATCH_SIZE_MAX)
+        return NULL;
+    struct cx_row_cursor *cursor =
+        calloc(1, sizeof(*cursor) + batch_size / 64 * sizeof(uint64_t));
     if (!cursor)
         return NULL;
     cursor->row_group = row_group;
-    cursor->cursor = cx_row_group_cursor_new(row_group);
+    cursor->cursor = cx_row_group_cursor_new_batched(row_group, batch_size);
     if (!cursor->cursor)
         goto error;
     cursor->predicate = predicate;
     cursor->index_match =
         cx_index_match_indexes(cursor->predicate, cursor->row_group);
+    for (size_t i = 0; i < cx_row_group_column_count(row_group); i++)
+        if (cx_row_group_column_page_size(row_group, i))
+            cursor->paged = true;
     cx_row_cursor_rewind(cursor);
     return cursor;
 error:
@@ -43,46 +59,77 @@ void cx_row_cursor_free(struct cx_row_cursor *cursor)
 
 void cx_row_cursor_rewind(struct cx_row_cursor *cursor)
 {
-    cursor->row_mask = 0;
-    cursor->position = 64;
+    cursor->batch_count = 0;
+    cursor->position = 0;
     cx_row_group_cursor_rewind(cursor->cursor);
     cursor->error = false;
 }
 
-static uint64_t cx_row_cursor_load_row_mask(struct cx_row_cursor *cursor)
+static inline size_t cx_row_cursor_words(const struct cx_row_cursor *cursor)
+{
+    return (cursor->batch_count + 63) / 64;
+}
+
+// load the row mask of the next batch with at least one matching row
+static bool cx_row_cursor_load_row_mask(struct cx_row_cursor *cursor)
 {
-    uint64_t row_mask = 0;
-    while (!row_mask && cx_row_group_cursor_next(cursor->cursor)) {
+    while (cx_row_group_cursor_next(cursor->cursor)) {
         size_t count;
-        if (cursor->index_match == CX_INDEX_MATCH_ALL) {
+        // the pages of a batch may rule it out (or in) when the row group
+        // as a whole can't be
+        enum cx_index_match index_match = cursor->index_match;
+        if (index_match == CX_INDEX_MATCH_UNKNOWN && cursor->paged)
+            index_match = cx_index_match_page_indexes(
+                cursor->predicate, cursor->row_group,
+                cx_row_group_cursor_position(cursor->cursor));
+        if (index_match == CX_INDEX_MATCH_NONE)
+            continue;
+        if (index_match == CX_INDEX_MATCH_ALL) {
             count = cx_row_group_cursor_batch_count(cursor->cursor);
-            row_mask = (uint64_t)-1;
-            if (count < 64)
-                row_mask &= ((uint64_t)1 << count) - 1;
+            memset(cursor->row_mask, 0xFF,
+                   (count + 63) / 64 * sizeof(uint64_t));
+            if (count % 64)
+                cursor->row_mask[count / 64] =
+                    ((uint64_t)1 << (count % 64)) - 1;
         } else if (!cx_index_match_rows(cursor->predicate, cursor->row_group,
-                                        cursor->cursor, &row_mask, &count))
+                                        cursor->cursor, cursor->row_mask,
+                                        &count))
             goto error;
+        cursor->batch_count = count;
+        for (size_t i = 0; i < cx_row_cursor_words(cursor); i++)
+            if (cursor->row_mask[i])
+                return true;
     }
-    return row_mask;
+    cursor->batch_count = 0;
+    return false;
 error:
+    cursor->batch_count = 0;
     cursor->error = true;
-    return 0;
+    return false;
 }
 
-bool cx_row_cursor_next(struct cx_row_cursor *cursor)
+// move to the first matching row at or after the position
+static bool cx_row_cursor_seek(struct cx_row_cursor *cursor, size_t position)
 {
-    if (cursor->position < 63) {
-        uint64_t mask = cursor->row_mask >> (cursor->position + 1);
+    for (size_t i = position / 64; i < cx_row_cursor_words(cursor); i++) {
+        uint64_t mask = cursor->row_mask[i];
+        if (i == position / 64)
+            mask &= (uint64_t)-1 << (position % 64);
         if (mask) {
-            cursor->position += __builtin_ctzll(mask) + 1;
+            cursor->position = i * 64 + __builtin_ctzll(mask);
             return true;
         }
     }
-    cursor->row_mask = cx_row_cursor_load_row_mask(cursor);
-    if (!cursor->row_mask)
+    return false;
+}
+
+bool cx_row_cursor_next(struct cx_row_cursor *cursor)
+{
+    if (cursor->batch_count && cx_row_cursor_seek(cursor, cursor->position + 1))
+        return true;
+    if (!cx_row_cursor_load_row_mask(cursor))
         return false;
-    cursor->position = __builtin_ctzll(cursor->row_mask);
-    return true;
+    return cx_row_cursor_seek(cursor, 0);
 }
 
 bool cx_row_cursor_error(const struct cx_row_cursor *cursor)
@@ -98,47 +145,44 @@ size_t cx_row_cursor_count(struct cx_row_cursor *cursor)
         return cx_row_group_row_count(cursor->row_group);
     cx_row_cursor_rewind(cursor);
     size_t count = 0;
-    for (;;) {
-        uint64_t row_mask = cx_row_cursor_load_row_mask(cursor);
-        if (!row_mask)
-            break;
-        count += __builtin_popcountll(row_mask);
-    }
+    while (cx_row_cursor_load_row_mask(cursor))
+        for (size_t i = 0; i < cx_row_cursor_words(cursor); i++)
+            count += __builtin_popcountll(cursor->row_mask[i]);
     return count;
 }
 
 bool cx_row_cursor_get_null(const struct cx_row_cursor *cursor,
                             size_t column_index, bool *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->batch_count);
     size_t count;
     const uint64_t *nulls =
         cx_row_group_cursor_batch_nulls(cursor->cursor, column_index, &count);
-    uint64_t row_bit = (uint64_t)1 << cursor->position;
+    uint64_t row_bit = (uint64_t)1 << (cursor->position % 64);
     if (!count || !nulls)
         return false;
-    *value = *nulls & row_bit;
+    *value = nulls[cursor->position / 64] & row_bit;
     return true;
 }
 
 bool cx_row_cursor_get_bit(const struct cx_row_cursor *cursor,
                            size_t column_index, bool *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->batch_count);
     size_t count;
     const uint64_t *bitset =
         cx_row_group_cursor_batch_bit(cursor->cursor, column_index, &count);
-    uint64_t row_bit = (uint64_t)1 << cursor->position;
+    uint64_t row_bit = (uint64_t)1 << (cursor->position % 64);
     if (!count || !bitset)
         return false;
-    *value = *bitset & row_bit;
+    *value = bitset[cursor->position / 64] & row_bit;
     return true;
 }
 
 bool cx_row_cursor_get_i32(const struct cx_row_cursor *cursor,
                            size_t column_index, int32_t *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->batch_count);
     size_t count;
     const int32_t *batch =
         cx_row_group_cursor_batch_i32(cursor->cursor, column_index, &count);
@@ -151,7 +195,7 @@ bool cx_row_cursor_get_i32(const struct cx_row_cursor *cursor,
 bool cx_row_cursor_get_i64(const struct cx_row_cursor *cursor,
                            size_t column_index, int64_t *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->batch_count);
     size_t count;
     const int64_t *batch =
         cx_row_group_cursor_batch_i64(cursor->cursor, column_index, &count);
@@ -164,7 +208,7 @@ bool cx_row_cursor_get_i64(const struct cx_row_cursor *cursor,
 bool cx_row_cursor_get_flt(const struct cx_row_cursor *cursor,
                            size_t column_index, float *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->batch_count);
     size_t count;
     const float *batch =
         cx_row_group_cursor_batch_flt(cursor->cursor, column_index, &count);
@@ -177,7 +221,7 @@ bool cx_row_cursor_get_flt(const struct cx_row_cursor *cursor,
 bool cx_row_cursor_get_dbl(const struct cx_row_cursor *cursor,
                            size_t column_index, double *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->batch_count);
     size_t count;
     const double *batch =
         cx_row_group_cursor_batch_dbl(cursor->cursor, column_index, &count);
@@ -190,7 +234,7 @@ bool cx_row_cursor_get_dbl(const struct cx_row_cursor *cursor,
 bool cx_row_cursor_get_str(const struct cx_row_cursor *cursor,
                            size_t column_index, struct cx_string *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->batch_count);
     size_t count;
     const struct cx_string *batch =
         cx_row_group_cursor_batch_str(cursor->cursor, column_index, &count);
@@ -12,6 +12,11 @@ struct cx_row_cursor;
 CX_EXPORT struct cx_row_cursor *cx_row_cursor_new(struct cx_row_group *,
                                                   const struct cx_predicate *);
 
+// create a cursor that matches rows in batches of batch_size rows, which
+// must be a multiple of 64 up to CX_BATCH_SIZE_MAX
+CX_EXPORT struct cx_row_cursor *cx_row_cursor_new_batched(
+    struct cx_row_group *, const struct cx_predicate *, size_t batch_size);
+
 CX_EXPORT void cx_row_cursor_free(struct cx_row_cursor *);
 
 CX_EXPORT void cx_row_cursor_rewind(struct cx_row_cursor *);
@@ -5,13 +5,24 @@
 #include <string.h>
 
 #include "compress.h"
+#include "file.h"
 
 static const size_t cx_row_group_column_initial_size = 8;
 
+// chunks that decompress to at least this many bytes are streamed by
+// cursors, a batch at a time, rather than decompressed up front
+static const size_t cx_row_group_stream_min_size = 1 << 20;
+
+// the null bitmap of every batch of a column without nulls
+static const uint64_t cx_row_group_no_nulls[CX_BATCH_SIZE_MAX / 64];
+
 struct cx_row_group_physical_column {
     struct cx_index *index;
     struct cx_column *column;
     struct cx_lazy_column lazy_column;
+    const struct cx_page_header *pages;  // 分页列块的页头
+    struct cx_column **page_columns;     // 已读取的页
+    size_t page_count;
 };
 
 struct cx_row_group_column {
@@ -20,6 +31,7 @@ struct cx_row_group_column {
     struct cx_row_group_physical_column values;
     struct cx_row_group_physical_column nulls;
     bool lazy;
+    bool has_nulls;
 };
 
 struct cx_row_group {
@@ -31,20 +43,36 @@ struct cx_row_group {
 
 struct cx_row_group_cursor_physical_column {
     struct cx_column_cursor *cursor;
+    enum cx_encoding_type encoding;
+    size_t start;  // 当前页的第一行
+    size_t end;    // 当前页之后的第一行
     size_t position;
+    struct cx_decompressor *stream;  // 流式解压的列块
+    void *buffer;                    // 流式解压的当前批
     const void *batch;
+    const void *decoded;
     size_t count;
+    size_t run_count;
+};
+
+struct cx_row_group_cursor_cache {
+    uint64_t key;
+    void *value;
+    struct cx_row_group_cursor_cache *next;
 };
 
 struct cx_row_group_cursor_column {
     struct cx_row_group_cursor_physical_column values;
     struct cx_row_group_cursor_physical_column nulls;
+    struct cx_row_group_cursor_cache *cache;
+    size_t cache_start;  // 缓存所属页的第一行
 };
 
 struct cx_row_group_cursor {
     struct cx_row_group *row_group;
     size_t column_count;
     size_t row_count;
+    size_t batch_size;
     size_t position;
     bool initialized;
     struct cx_row_group_cursor_column columns[];
@@ -76,6 +104,14 @@ void cx_row_group_free(struct cx_row_group *row_group)
                 cx_column_free(row_group_column->values.column);
             if (row_group_column->nulls.column)
                 cx_column_free(row_group_column->nulls.column);
+            struct cx_row_group_physical_column *values =
+                &row_group_column->values;
+            if (values->page_columns) {
+                for (size_t j = 0; j < values->page_count; j++)
+                    if (values->page_columns[j])
+                        cx_column_free(values->page_columns[j]);
+                free(values->page_columns);
+            }
         } else {
             cx_index_free(row_group_column->values.index);
             cx_index_free(row_group_column->nulls.index);
@@ -123,9 +159,11 @@ bool cx_row_group_add_column(struct cx_row_group *row_group,
     row_group_column->encoding = cx_column_encoding(column);
     row_group_column->values.column = column;
     row_group_column->values.index = index;
+    row_group_column->values.page_columns = NULL;
     row_group_column->lazy = false;
     row_group_column->nulls.column = nulls;
     row_group_column->nulls.index = nulls_index;
+    row_group_column->has_nulls = nulls_index->max.bit;
     row_group->row_count = row_count;
     return true;
 error:
@@ -153,11 +191,17 @@ bool cx_row_group_add_lazy_column(struct cx_row_group *row_group,
     row_group_column->encoding = column->encoding;
     row_group_column->values.index = (struct cx_index *)column->index;
     row_group_column->values.column = NULL;
+    row_group_column->values.pages = NULL;
+    row_group_column->values.page_columns = NULL;
+    row_group_column->values.page_count = 0;
     memcpy(&row_group_column->values.lazy_column, column, sizeof(*column));
     row_group_column->lazy = true;
     row_group_column->nulls.column = NULL;
+    row_group_column->nulls.page_columns = NULL;
     row_group_column->nulls.index = (struct cx_index *)nulls->index;
     memcpy(&row_group_column->nulls.lazy_column, nulls, sizeof(*nulls));
+    // the writer doesn't store the null bitmap of a column without nulls
+    row_group_column->has_nulls = nulls->size || nulls->index->max.bit;
     row_group->row_count = row_count;
     return true;
 }
@@ -203,34 +247,92 @@ const struct cx_index *cx_row_group_null_index(
     return row_group->columns[index].nulls.index;
 }
 
-static bool cx_row_group_lazy_column_init(
-    struct cx_row_group_physical_column *row_group_column)
+static struct cx_column *cx_row_group_lazy_load(
+    enum cx_column_type type, enum cx_encoding_type encoding,
+    enum cx_compression_type compression,
+    const struct cx_zstd_dictionary *dictionary, const void *ptr, size_t size,
+    size_t decompressed_size, size_t count)
 {
-    struct cx_lazy_column *lazy = &row_group_column->lazy_column;
     struct cx_column *column = NULL;
-    if (lazy->compression && lazy->size) {
+    if (type == CX_COLUMN_BIT && !size && count) {
+        // a null bitmap that wasn't stored is all-false
+        void *dest;
+        column = cx_column_new_compressed(CX_COLUMN_BIT, CX_ENCODING_CONSTANT,
+                                          &dest, sizeof(uint64_t), count);
+        if (!column)
+            goto error;
+        memset(dest, 0, sizeof(uint64_t));
+    } else if (compression && size) {
         void *dest;
-        column = cx_column_new_compressed(lazy->type, lazy->encoding, &dest,
-                                          lazy->decompressed_size,
-                                          row_group_column->index->count);
+        column = cx_column_new_decompressed(type, encoding, &dest,
+                                            decompressed_size, count);
         if (!column)
             goto error;
-        if (!cx_decompress(lazy->compression, lazy->ptr, lazy->size, dest,
-                           lazy->decompressed_size))
+        if (!cx_decompress_dict(compression, dictionary, ptr, size, dest,
+                                decompressed_size))
             goto error;
     } else {
-        column =
-            cx_column_new_mmapped(lazy->type, lazy->encoding, lazy->ptr,
-                                  lazy->size, row_group_column->index->count);
+        column = cx_column_new_mmapped(type, encoding, ptr, size, count);
         if (!column)
             goto error;
     }
-    row_group_column->column = column;
-    return true;
+    return column;
 error:
     if (column)
         cx_column_free(column);
-    return false;
+    return NULL;
+}
+
+static bool cx_row_group_lazy_column_init(
+    struct cx_row_group_physical_column *row_group_column)
+{
+    struct cx_lazy_column *lazy = &row_group_column->lazy_column;
+    row_group_column->column = cx_row_group_lazy_load(
+        lazy->type, lazy->encoding, lazy->compression, lazy->dictionary,
+        lazy->ptr, lazy->size, lazy->decompressed_size,
+        row_group_column->index->count);
+    return row_group_column->column != NULL;
+}
+
+static bool cx_row_group_lazy_pages_init(
+    struct cx_row_group_physical_column *row_group_column)
+{
+    struct cx_lazy_column *lazy = &row_group_column->lazy_column;
+    size_t row_count = row_group_column->index->count;
+    size_t page_count = (row_count + lazy->page_size - 1) / lazy->page_size;
+    const struct cx_page_header *pages = lazy->ptr;
+    if (page_count > lazy->size / sizeof(*pages))
+        return false;
+    // check the pages before any are read
+    for (size_t i = 0; i < page_count; i++) {
+        size_t count = row_count - i * lazy->page_size < lazy->page_size
+                           ? row_count - i * lazy->page_size
+                           : lazy->page_size;
+        if (pages[i].index.count != count || pages[i].offset > lazy->size ||
+            pages[i].size > lazy->size - pages[i].offset)
+            return false;
+    }
+    if (page_count) {
+        row_group_column->page_columns =
+            calloc(page_count, sizeof(*row_group_column->page_columns));
+        if (!row_group_column->page_columns)
+            return false;
+    }
+    row_group_column->pages = pages;
+    row_group_column->page_count = page_count;
+    return true;
+}
+
+static bool cx_row_group_lazy_page_init(
+    struct cx_row_group_physical_column *row_group_column, size_t page)
+{
+    struct cx_lazy_column *lazy = &row_group_column->lazy_column;
+    const struct cx_page_header *header = &row_group_column->pages[page];
+    row_group_column->page_columns[page] = cx_row_group_lazy_load(
+        lazy->type, lazy->encoding, header->compression, lazy->dictionary,
+        (const char *)lazy->ptr + header->offset, header->size,
+        header->decompressed_size, header->index.count);
+    return row_group_column->page_columns[page] != NULL;
 }
 
 const struct cx_column *cx_row_group_column(
@@ -238,12 +340,67 @@ const struct cx_column *cx_row_group_column(
 {
     assert(index < row_group->count);
     struct cx_row_group_column *row_group_column = &row_group->columns[index];
+    if (cx_row_group_column_page_size(row_group, index))
+        return NULL;
     if (row_group_column->lazy && !row_group_column->values.column)
         if (!cx_row_group_lazy_column_init(&row_group_column->values))
             return NULL;
     return row_group_column->values.column;
 }
 
+size_t cx_row_group_column_page_size(const struct cx_row_group *row_group,
+                                     size_t index)
+{
+    assert(index < row_group->count);
+    const struct cx_row_group_column *row_group_column =
+        &row_group->columns[index];
+    if (!row_group_column->lazy)
+        return 0;
+    return row_group_column->values.lazy_column.page_size;
+}
+
+const struct cx_column *cx_row_group_column_page(
+    const struct cx_row_group *row_group, size_t index, size_t row,
+    size_t *start, size_t *count)
+{
+    size_t page_size = cx_row_group_column_page_size(row_group, index);
+    if (!page_size) {
+        *start = 0;
+        *count = cx_row_group_row_count(row_group);
+        return cx_row_group_column(row_group, index);
+    }
+    struct cx_row_group_physical_column *values =
+        &row_group->columns[index].values;
+    if (!values->pages && !cx_row_group_lazy_pages_init(values))
+        return NULL;
+    if (row >= values->index->count)
+        return NULL;
+    size_t page = row / page_size;
+    // pages are decompressed on first access only
+    if (!values->page_columns[page] &&
+        !cx_row_group_lazy_page_init(values, page))
+        return NULL;
+    *start = page * page_size;
+    *count = values->pages[page].index.count;
+    return values->page_columns[page];
+}
+
+const struct cx_index *cx_row_group_column_page_index(
+    const struct cx_row_group *row_group, size_t index, size_t row)
+{
+    size_t page_size = cx_row_group_column_page_size(row_group, index);
+    if (!page_size)
+        return cx_row_group_column_index(row_group, index);
+    struct cx_row_group_physical_column *values =
+        &row_group->columns[index].values;
+    if (!values->pages && !cx_row_group_lazy_pages_init(values))
+        return NULL;
+    if (row >= values->index->count)
+        return NULL;
+    size_t page = row / page_size;
+    return &values->pages[page].index;
+}
+
 const struct cx_column *cx_row_group_nulls(const struct cx_row_group *row_group,
                                            size_t index)
 {
@@ -258,7 +415,20 @@ const struct cx_column *cx_row_group_nulls(const struct cx_row_group *row_group,
 struct cx_row_group_cursor *cx_row_group_cursor_new(
     struct cx_row_group *row_group)
 {
+    return cx_row_group_cursor_new_batched(row_group, CX_BATCH_SIZE);
+}
+
+struct cx_row_group_cursor *cx_row_group_cursor_new_batched(
+    struct cx_row_group *row_group, size_t batch_size)
+{
+    if (!batch_size || batch_size % CX_BATCH_SIZE ||
+        batch_size > CX_BATCH_SIZE_MAX)
+        return NULL;
     size_t column_count = cx_row_group_column_count(row_group);
+    // a batch can't straddle two pages
+    for (size_t i = 0; i < column_count; i++)
+        if (cx_row_group_column_page_size(row_group, i) % batch_size)
+            return NULL;
     size_t size = sizeof(struct cx_row_group_cursor) +
                   column_count * sizeof(struct cx_row_group_cursor_column);
     struct cx_row_group_cursor *cursor = calloc(1, size);
@@ -267,12 +437,30 @@ struct cx_row_group_cursor *cx_row_group_cursor_new(
     cursor->row_group = row_group;
     cursor->column_count = column_count;
     cursor->row_count = cx_row_group_row_count(row_group);
+    cursor->batch_size = batch_size;
     return cursor;
 }
 
+static void cx_row_group_cursor_cache_clear(
+    struct cx_row_group_cursor_column *column)
+{
+    struct cx_row_group_cursor_cache *cache = column->cache;
+    while (cache) {
+        struct cx_row_group_cursor_cache *next = cache->next;
+        free(cache->value);
+        free(cache);
+        cache = next;
+    }
+    column->cache = NULL;
+}
+
 void cx_row_group_cursor_free(struct cx_row_group_cursor *cursor)
 {
     cx_row_group_cursor_rewind(cursor);
+    for (size_t i = 0; i < cursor->column_count; i++) {
+        cx_row_group_cursor_cache_clear(&cursor->columns[i]);
+        free(cursor->columns[i].values.buffer);
+    }
     free(cursor);
 }
 
@@ -282,7 +470,11 @@ static void cx_row_group_cursor_rewind_columns(
     if (column->cursor)
         cx_column_cursor_free(column->cursor);
     column->cursor = NULL;
+    if (column->stream)
+        cx_decompressor_free(column->stream);
+    column->stream = NULL;
     column->position = 0;
+    column->decoded = NULL;
 }
 
 void cx_row_group_cursor_rewind(struct cx_row_group_cursor *cursor)
@@ -300,7 +492,7 @@ bool cx_row_group_cursor_next(struct cx_row_group_cursor *cursor)
     if (!cursor->initialized)
         cursor->initialized = true;
     else
-        cursor->position += CX_BATCH_SIZE;
+        cursor->position += cursor->batch_size;
     return cursor->position < cursor->row_count;
 }
 
@@ -309,7 +501,97 @@ size_t cx_row_group_cursor_batch_count(const struct cx_row_group_cursor *cursor)
     if (cursor->position >= cursor->row_count)
         return 0;
     size_t remaining = cursor->row_count - cursor->position;
-    return remaining < CX_BATCH_SIZE ? remaining : CX_BATCH_SIZE;
+    return remaining < cursor->batch_size ? remaining : cursor->batch_size;
+}
+
+size_t cx_row_group_cursor_batch_size(const struct cx_row_group_cursor *cursor)
+{
+    return cursor->batch_size;
+}
+
+size_t cx_row_group_cursor_position(const struct cx_row_group_cursor *cursor)
+{
+    return cursor->position;
+}
+
+static bool cx_row_group_cursor_physical_open(
+    struct cx_row_group_cursor *cursor,
+    struct cx_row_group_cursor_physical_column *column,
+    const struct cx_column *values, size_t start, size_t count)
+{
+    if (column->cursor)
+        cx_column_cursor_free(column->cursor);
+    column->cursor = cx_column_cursor_new_batched(values, cursor->batch_size);
+    column->encoding = cx_column_encoding(values);
+    column->start = start;
+    column->end = start + count;
+    column->position = start;
+    column->decoded = NULL;
+    return column->cursor != NULL;
+}
+
+static size_t cx_row_group_stream_size(enum cx_column_type type, size_t count)
+{
+    switch (type) {
+        case CX_COLUMN_BIT:
+            return (count + 63) / 64 * sizeof(uint64_t);
+        case CX_COLUMN_I32:
+        case CX_COLUMN_FLT:
+            return count * sizeof(int32_t);
+        case CX_COLUMN_I64:
+        case CX_COLUMN_DBL:
+            return count * sizeof(int64_t);
+        default:
+            return 0;
+    }
+}
+
+static bool cx_row_group_column_streamable(
+    const struct cx_row_group_column *row_group_column)
+{
+    // only fixed-width values without an encoding can be read in order
+    // straight from the decompressed bytes
+    const struct cx_lazy_column *lazy = &row_group_column->values.lazy_column;
+    return row_group_column->lazy && !row_group_column->values.column &&
+           !lazy->page_size && lazy->encoding == CX_ENCODING_NONE &&
+           lazy->compression == CX_COMPRESSION_ZSTD && lazy->size &&
+           lazy->decompressed_size >= cx_row_group_stream_min_size &&
+           lazy->decompressed_size ==
+               cx_row_group_stream_size(lazy->type,
+                                        row_group_column->values.index->count);
+}
+
+bool cx_row_group_column_streamed(const struct cx_row_group *row_group,
+                                  size_t index)
+{
+    assert(index < row_group->count);
+    return cx_row_group_column_streamable(&row_group->columns[index]);
+}
+
+static bool cx_row_group_cursor_stream_init(struct cx_row_group_cursor *cursor,
+                                            size_t column_index)
+{
+    const struct cx_row_group_column *row_group_column =
+        &cursor->row_group->columns[column_index];
+    if (!cx_row_group_column_streamable(row_group_column))
+        return false;
+    struct cx_row_group_cursor_physical_column *column =
+        &cursor->columns[column_index].values;
+    if (!column->buffer)
+        column->buffer = malloc(cursor->batch_size * sizeof(uint64_t));
+    if (!column->buffer)
+        return false;
+    const struct cx_lazy_column *lazy = &row_group_column->values.lazy_column;
+    column->stream = cx_decompressor_new(lazy->compression, lazy->dictionary,
+                                         lazy->ptr, lazy->size);
+    if (!column->stream)
+        return false;
+    column->encoding = CX_ENCODING_NONE;
+    column->start = 0;
+    column->end = cursor->row_count;
+    column->position = 0;
+    column->decoded = NULL;
+    return true;
 }
 
 static bool cx_row_group_cursor_lazy_column_init(
@@ -317,14 +599,28 @@ static bool cx_row_group_cursor_lazy_column_init(
 {
     if (column_index >= cursor->column_count)
         return false;
-    if (cursor->columns[column_index].values.cursor)
+    struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.stream)
         return true;
-    const struct cx_column *column =
-        cx_row_group_column(cursor->row_group, column_index);
-    if (!column)
+    // move on to the next page once the current one has been read
+    if (column->values.cursor && (cursor->position < column->values.end ||
+                                  column->values.end >= cursor->row_count))
+        return true;
+    // large chunks are streamed, falling back to decompressing them whole
+    if (!column->values.cursor &&
+        cx_row_group_cursor_stream_init(cursor, column_index))
+        return true;
+    size_t start, count;
+    const struct cx_column *values = cx_row_group_column_page(
+        cursor->row_group, column_index, cursor->position, &start, &count);
+    if (!values)
         return false;
-    cursor->columns[column_index].values.cursor = cx_column_cursor_new(column);
-    return cursor->columns[column_index].values.cursor != NULL;
+    // cached values (e.g. dictionary matches) belong to a single page
+    if (column->cache && column->cache_start != start)
+        cx_row_group_cursor_cache_clear(column);
+    column->cache_start = start;
+    return cx_row_group_cursor_physical_open(cursor, &column->values, values,
+                                             start, count);
 }
 
 static bool cx_row_group_cursor_lazy_nulls_init(
@@ -332,23 +628,177 @@ static bool cx_row_group_cursor_lazy_nulls_init(
 {
     if (column_index >= cursor->column_count)
         return false;
-    if (cursor->columns[column_index].nulls.cursor)
+    struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->nulls.cursor && (cursor->position < column->nulls.end ||
+                                 column->nulls.end >= cursor->row_count))
         return true;
-    const struct cx_column *column =
-        cx_row_group_nulls(cursor->row_group, column_index);
-    if (!column)
+    // the nulls of a sparse column come from the positions of its rows,
+    // rather than from the null bitmap (which is never split into pages)
+    size_t start = 0, count = cursor->row_count;
+    const struct cx_column *nulls =
+        cx_row_group_column_encoding(cursor->row_group, column_index) ==
+                CX_ENCODING_SPARSE
+            ? cx_row_group_column_page(cursor->row_group, column_index,
+                                       cursor->position, &start, &count)
+            : cx_row_group_nulls(cursor->row_group, column_index);
+    if (!nulls)
         return false;
-    cursor->columns[column_index].nulls.cursor = cx_column_cursor_new(column);
-    return cursor->columns[column_index].nulls.cursor != NULL;
+    return cx_row_group_cursor_physical_open(cursor, &column->nulls, nulls,
+                                             start, count);
+}
+
+static const void *cx_row_group_cursor_physical_stream(
+    struct cx_row_group_cursor *cursor,
+    struct cx_row_group_cursor_physical_column *column,
+    enum cx_column_type type, size_t *count)
+{
+    if (column->position <= cursor->position) {
+        // rows can only be skipped by decompressing them
+        size_t position = cursor->position < cursor->row_count
+                              ? cursor->position
+                              : cursor->row_count;
+        while (column->position < position) {
+            size_t skip = position - column->position;
+            if (skip > cursor->batch_size)
+                skip = cursor->batch_size;
+            if (!cx_decompressor_read(column->stream, column->buffer,
+                                      cx_row_group_stream_size(type, skip)))
+                return NULL;
+            column->position += skip;
+        }
+        column->count = cx_row_group_cursor_batch_count(cursor);
+        if (!cx_decompressor_read(column->stream, column->buffer,
+                                  cx_row_group_stream_size(type,
+                                                           column->count)))
+            return NULL;
+        column->batch = column->buffer;
+        column->position += column->count;
+    }
+    *count = column->count;
+    return column->batch;
+}
+
+static const struct cx_run *cx_row_group_cursor_physical_runs(
+    struct cx_row_group_cursor *cursor,
+    struct cx_row_group_cursor_physical_column *column,
+    enum cx_column_type type, size_t *run_count, size_t *count)
+{
+    assert(column->encoding == CX_ENCODING_RLE);
+    if (column->position <= cursor->position) {
+        size_t offset = cursor->position - column->position;
+        size_t skipped = 0;
+        switch (type) {
+            case CX_COLUMN_BIT:
+                skipped = cx_column_cursor_skip_bit(column->cursor, offset);
+                break;
+            case CX_COLUMN_I32:
+                skipped = cx_column_cursor_skip_i32(column->cursor, offset);
+                break;
+            case CX_COLUMN_I64:
+                skipped = cx_column_cursor_skip_i64(column->cursor, offset);
+                break;
+            default:
+                return NULL;
+        }
+        column->position += skipped;
+        column->batch = cx_column_cursor_next_batch_runs(
+            column->cursor, &column->run_count, &column->count);
+        column->decoded = NULL;
+        column->position += column->count;
+    }
+    *run_count = column->run_count;
+    *count = column->count;
+    return column->batch;
+}
+
+static const void *cx_row_group_cursor_physical_decode_runs(
+    struct cx_row_group_cursor *cursor,
+    struct cx_row_group_cursor_physical_column *column,
+    enum cx_column_type type, size_t *count)
+{
+    // runs are expanded on first access only, so that predicates can
+    // match whole runs without materializing each value
+    size_t run_count;
+    const struct cx_run *runs = cx_row_group_cursor_physical_runs(
+        cursor, column, type, &run_count, count);
+    if (!runs)
+        return NULL;
+    if (!column->decoded)
+        column->decoded =
+            cx_column_cursor_decode_runs(column->cursor, run_count, runs);
+    return column->decoded;
+}
+
+static const uint64_t *cx_row_group_cursor_physical_planes(
+    struct cx_row_group_cursor *cursor,
+    struct cx_row_group_cursor_physical_column *column,
+    enum cx_column_type type, size_t *count)
+{
+    assert(column->encoding == CX_ENCODING_BITPACK);
+    if (column->position <= cursor->position) {
+        size_t offset = cursor->position - column->position;
+        size_t skipped = 0;
+        switch (type) {
+            case CX_COLUMN_I32:
+                skipped = cx_column_cursor_skip_i32(column->cursor, offset);
+                break;
+            case CX_COLUMN_I64:
+                skipped = cx_column_cursor_skip_i64(column->cursor, offset);
+                break;
+            default:
+                return NULL;
+        }
+        column->position += skipped;
+        column->batch = cx_column_cursor_next_batch_planes(column->cursor,
+                                                           &column->count);
+        column->decoded = NULL;
+        column->position += column->count;
+    }
+    *count = column->count;
+    return column->batch;
+}
+
+static const void *cx_row_group_cursor_physical_decode_planes(
+    struct cx_row_group_cursor *cursor,
+    struct cx_row_group_cursor_physical_column *column,
+    enum cx_column_type type, size_t *count)
+{
+    // blocks are unpacked on first access only, so that predicates can
+    // match against the packed bit planes
+    const uint64_t *planes =
+        cx_row_group_cursor_physical_planes(cursor, column, type, count);
+    if (!planes)
+        return NULL;
+    if (!column->decoded)
+        column->decoded =
+            cx_column_cursor_decode_planes(column->cursor, *count, planes);
+    return column->decoded;
 }
 
 const uint64_t *cx_row_group_cursor_batch_nulls(
     struct cx_row_group_cursor *cursor, size_t column_index, size_t *count)
 {
+    if (column_index < cursor->column_count &&
+        !cursor->row_group->columns[column_index].has_nulls) {
+        *count = cx_row_group_cursor_batch_count(cursor);
+        return cx_row_group_no_nulls;
+    }
     if (!cx_row_group_cursor_lazy_nulls_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
-    if (column->nulls.position <= cursor->position) {
+    if (column->nulls.encoding == CX_ENCODING_RLE)
+        return cx_row_group_cursor_physical_decode_runs(
+            cursor, &column->nulls, CX_COLUMN_BIT, count);
+    if (column->nulls.encoding == CX_ENCODING_SPARSE) {
+        if (column->nulls.position <= cursor->position) {
+            column->nulls.position += cx_column_cursor_skip_sparse(
+                column->nulls.cursor,
+                cursor->position - column->nulls.position);
+            column->nulls.batch = cx_column_cursor_next_batch_nulls(
+                column->nulls.cursor, &column->nulls.count);
+            column->nulls.position += column->nulls.count;
+        }
+    } else if (column->nulls.position <= cursor->position) {
         size_t skipped = cx_column_cursor_skip_bit(
             column->nulls.cursor, cursor->position - column->nulls.position);
         column->nulls.position += skipped;
@@ -366,6 +816,12 @@ const uint64_t *cx_row_group_cursor_batch_bit(
     if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.encoding == CX_ENCODING_RLE)
+        return cx_row_group_cursor_physical_decode_runs(
+            cursor, &column->values, CX_COLUMN_BIT, count);
+    if (column->values.stream)
+        return cx_row_group_cursor_physical_stream(cursor, &column->values,
+                                                   CX_COLUMN_BIT, count);
     if (column->values.position <= cursor->position) {
         size_t skipped = cx_column_cursor_skip_bit(
             column->values.cursor, cursor->position - column->values.position);
@@ -384,6 +840,15 @@ const int32_t *cx_row_group_cursor_batch_i32(struct cx_row_group_cursor *cursor,
     if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.encoding == CX_ENCODING_RLE)
+        return cx_row_group_cursor_physical_decode_runs(
+            cursor, &column->values, CX_COLUMN_I32, count);
+    if (column->values.encoding == CX_ENCODING_BITPACK)
+        return cx_row_group_cursor_physical_decode_planes(
+            cursor, &column->values, CX_COLUMN_I32, count);
+    if (column->values.stream)
+        return cx_row_group_cursor_physical_stream(cursor, &column->values,
+                                                   CX_COLUMN_I32, count);
     if (column->values.position <= cursor->position) {
         size_t skipped = cx_column_cursor_skip_i32(
             column->values.cursor, cursor->position - column->values.position);
@@ -402,6 +867,15 @@ const int64_t *cx_row_group_cursor_batch_i64(struct cx_row_group_cursor *cursor,
     if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.encoding == CX_ENCODING_RLE)
+        return cx_row_group_cursor_physical_decode_runs(
+            cursor, &column->values, CX_COLUMN_I64, count);
+    if (column->values.encoding == CX_ENCODING_BITPACK)
+        return cx_row_group_cursor_physical_decode_planes(
+            cursor, &column->values, CX_COLUMN_I64, count);
+    if (column->values.stream)
+        return cx_row_group_cursor_physical_stream(cursor, &column->values,
+                                                   CX_COLUMN_I64, count);
     if (column->values.position <= cursor->position) {
         size_t skipped = cx_column_cursor_skip_i64(
             column->values.cursor, cursor->position - column->values.position);
@@ -420,6 +894,9 @@ const float *cx_row_group_cursor_batch_flt(struct cx_row_group_cursor *cursor,
     if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.stream)
+        return cx_row_group_cursor_physical_stream(cursor, &column->values,
+                                                   CX_COLUMN_FLT, count);
     if (column->values.position <= cursor->position) {
         size_t skipped = cx_column_cursor_skip_flt(
             column->values.cursor, cursor->position - column->values.position);
@@ -438,6 +915,9 @@ const double *cx_row_group_cursor_batch_dbl(struct cx_row_group_cursor *cursor,
     if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.stream)
+        return cx_row_group_cursor_physical_stream(cursor, &column->values,
+                                                   CX_COLUMN_DBL, count);
     if (column->values.position <= cursor->position) {
         size_t skipped = cx_column_cursor_skip_dbl(
             column->values.cursor, cursor->position - column->values.position);
@@ -456,6 +936,32 @@ const struct cx_string *cx_row_group_cursor_batch_str(
     if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.stream)
+        return NULL;  // only fixed-width columns are streamed
+    if (cx_row_group_column_encoding(cursor->row_group, column_index) ==
+        CX_ENCODING_DICT) {
+        // decode the batch on first access only, so that predicates can
+        // match the codes without materializing strings
+        const int32_t *codes =
+            cx_row_group_cursor_batch_codes(cursor, column_index, count);
+        if (!codes)
+            return NULL;
+        if (!column->values.decoded)
+            column->values.decoded = cx_column_cursor_decode_codes(
+                column->values.cursor, *count, codes);
+        return column->values.decoded;
+    }
+    if (column->values.encoding == CX_ENCODING_FSST) {
+        // likewise, strings are only decompressed on first access
+        const struct cx_string *compressed =
+            cx_row_group_cursor_batch_compressed(cursor, column_index, count);
+        if (!compressed)
+            return NULL;
+        if (!column->values.decoded)
+            column->values.decoded = cx_column_cursor_decode_compressed(
+                column->values.cursor, *count, compressed);
+        return column->values.decoded;
+    }
     if (column->values.position <= cursor->position) {
         size_t skipped = cx_column_cursor_skip_str(
             column->values.cursor, cursor->position - column->values.position);
@@ -467,3 +973,131 @@ const struct cx_string *cx_row_group_cursor_batch_str(
     *count = column->values.count;
     return column->values.batch;
 }
+
+const int32_t *cx_row_group_cursor_batch_codes(
+    struct cx_row_group_cursor *cursor, size_t column_index, size_t *count)
+{
+    if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
+        return NULL;
+    if (cx_row_group_column_encoding(cursor->row_group, column_index) !=
+        CX_ENCODING_DICT)
+        return NULL;
+    struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.position <= cursor->position) {
+        size_t skipped = cx_column_cursor_skip_str(
+            column->values.cursor, cursor->position - column->values.position);
+        column->values.position += skipped;
+        column->values.batch = cx_column_cursor_next_batch_codes(
+            column->values.cursor, &column->values.count);
+        column->values.decoded = NULL;
+        column->values.position += column->values.count;
+    }
+    *count = column->values.count;
+    return column->values.batch;
+}
+
+const struct cx_string *cx_row_group_cursor_batch_compressed(
+    struct cx_row_group_cursor *cursor, size_t column_index, size_t *count)
+{
+    if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
+        return NULL;
+    struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.encoding != CX_ENCODING_FSST)
+        return NULL;
+    if (column->values.position <= cursor->position) {
+        size_t skipped = cx_column_cursor_skip_str(
+            column->values.cursor, cursor->position - column->values.position);
+        column->values.position += skipped;
+        column->values.batch = cx_column_cursor_next_batch_compressed(
+            column->values.cursor, &column->values.count);
+        column->values.decoded = NULL;
+        column->values.position += column->values.count;
+    }
+    *count = column->values.count;
+    return column->values.batch;
+}
+
+const struct cx_fsst_table *cx_row_group_cursor_symbols(
+    struct cx_row_group_cursor *cursor, size_t column_index)
+{
+    if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
+        return NULL;
+    struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.encoding != CX_ENCODING_FSST)
+        return NULL;
+    return cx_column_cursor_symbols(column->values.cursor);
+}
+
+const struct cx_string *cx_row_group_cursor_dict(
+    struct cx_row_group_cursor *cursor, size_t column_index, size_t *size)
+{
+    if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
+        return NULL;
+    if (cx_row_group_column_encoding(cursor->row_group, column_index) !=
+        CX_ENCODING_DICT)
+        return NULL;
+    return cx_column_cursor_dict(cursor->columns[column_index].values.cursor,
+                                 size);
+}
+
+const struct cx_run *cx_row_group_cursor_batch_runs(
+    struct cx_row_group_cursor *cursor, size_t column_index,
+    size_t *run_count, size_t *count)
+{
+    if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
+        return NULL;
+    struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.encoding != CX_ENCODING_RLE)
+        return NULL;
+    return cx_row_group_cursor_physical_runs(
+        cursor, &column->values,
+        cx_row_group_column_type(cursor->row_group, column_index), run_count,
+        count);
+}
+
+const uint64_t *cx_row_group_cursor_batch_planes(
+    struct cx_row_group_cursor *cursor, size_t column_index, int64_t *base,
+    size_t *width, size_t *count)
+{
+    if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
+        return NULL;
+    struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.encoding != CX_ENCODING_BITPACK)
+        return NULL;
+    cx_column_cursor_frame(column->values.cursor, base, width);
+    return cx_row_group_cursor_physical_planes(
+        cursor, &column->values,
+        cx_row_group_column_type(cursor->row_group, column_index), count);
+}
+
+void *cx_row_group_cursor_cache(struct cx_row_group_cursor *cursor,
+                                size_t column_index, uint64_t key)
+{
+    assert(column_index < cursor->column_count);
+    // move on to the page of the current batch before looking up values
+    // cached against the page
+    if (cx_row_group_column_page_size(cursor->row_group, column_index) &&
+        !cx_row_group_cursor_lazy_column_init(cursor, column_index))
+        return NULL;
+    struct cx_row_group_cursor_cache *cache =
+        cursor->columns[column_index].cache;
+    for (; cache; cache = cache->next)
+        if (cache->key == key)
+            return cache->value;
+    return NULL;
+}
+
+bool cx_row_group_cursor_cache_put(struct cx_row_group_cursor *cursor,
+                                   size_t column_index, uint64_t key,
+                                   void *value)
+{
+    assert(column_index < cursor->column_count);
+    struct cx_row_group_cursor_cache *cache = malloc(sizeof(*cache));
+    if (!cache)
+        return false;
+    cache->key = key;
+    cache->value = value;
+    cache->next = cursor->columns[column_index].cache;
+    cursor->columns[column_index].cache = cache;
+    return true;
+}
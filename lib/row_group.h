@@ -12,6 +12,8 @@ struct cx_row_group;
 
 struct cx_row_group_cursor;
 
+struct cx_zstd_dictionary;
+
 struct cx_row_group *cx_row_group_new(void);
 
 void cx_row_group_free(struct cx_row_group *);
@@ -27,6 +29,8 @@ struct cx_lazy_column {
     const void *ptr;
     size_t size;
     size_t decompressed_size;
+    size_t page_size;  // 每页的行数, 0 表示不分页
+    const struct cx_zstd_dictionary *dictionary;  // 可选的 ZSTD 字典
 };
 
 bool cx_row_group_add_lazy_column(struct cx_row_group *,
@@ -46,9 +50,29 @@ enum cx_encoding_type cx_row_group_column_encoding(const struct cx_row_group *,
 const struct cx_index *cx_row_group_column_index(const struct cx_row_group *,
                                                  size_t);
 
+// the values of a paged column (see cx_page_header) are only available
+// a page at a time, and this returns NULL for them
 const struct cx_column *cx_row_group_column(const struct cx_row_group *,
                                             size_t);
 
+// the number of rows in each page of a column, or zero if the column isn't
+// split into pages
+size_t cx_row_group_column_page_size(const struct cx_row_group *, size_t);
+
+// the values of the page that holds a row, along with the first row of the
+// page and its row count. a column without pages is a single page
+const struct cx_column *cx_row_group_column_page(const struct cx_row_group *,
+                                                 size_t, size_t row,
+                                                 size_t *start, size_t *count);
+
+// the index of the page that holds a row
+const struct cx_index *cx_row_group_column_page_index(
+    const struct cx_row_group *, size_t, size_t row);
+
+// whether cursors decompress the values of a column a batch at a time,
+// rather than the whole chunk up front
+bool cx_row_group_column_streamed(const struct cx_row_group *, size_t);
+
 const struct cx_index *cx_row_group_null_index(const struct cx_row_group *,
                                                size_t);
 
@@ -56,6 +80,11 @@ const struct cx_column *cx_row_group_nulls(const struct cx_row_group *, size_t);
 
 struct cx_row_group_cursor *cx_row_group_cursor_new(struct cx_row_group *);
 
+// a cursor that reads batch_size rows at a time (see CX_BATCH_SIZE). the
+// null bitmaps and bit columns of each batch span batch_size / 64 words
+struct cx_row_group_cursor *cx_row_group_cursor_new_batched(
+    struct cx_row_group *, size_t batch_size);
+
 void cx_row_group_cursor_free(struct cx_row_group_cursor *);
 
 void cx_row_group_cursor_rewind(struct cx_row_group_cursor *);
@@ -64,6 +93,11 @@ bool cx_row_group_cursor_next(struct cx_row_group_cursor *);
 
 size_t cx_row_group_cursor_batch_count(const struct cx_row_group_cursor *);
 
+size_t cx_row_group_cursor_batch_size(const struct cx_row_group_cursor *);
+
+// the first row of the current batch
+size_t cx_row_group_cursor_position(const struct cx_row_group_cursor *);
+
 const uint64_t *cx_row_group_cursor_batch_nulls(struct cx_row_group_cursor *,
                                                 size_t column_index,
                                                 size_t *count);
@@ -83,6 +117,41 @@ const double *cx_row_group_cursor_batch_dbl(struct cx_row_group_cursor *,
 const struct cx_string *cx_row_group_cursor_batch_str(
     struct cx_row_group_cursor *, size_t column_index, size_t *count);
 
+// dictionary codes and dictionary of a CX_ENCODING_DICT string column
+const int32_t *cx_row_group_cursor_batch_codes(struct cx_row_group_cursor *,
+                                               size_t column_index,
+                                               size_t *count);
+const struct cx_string *cx_row_group_cursor_dict(struct cx_row_group_cursor *,
+                                                 size_t column_index,
+                                                 size_t *size);
+
+// compressed strings of a CX_ENCODING_FSST string column, and the symbol
+// table they were compressed with
+const struct cx_string *cx_row_group_cursor_batch_compressed(
+    struct cx_row_group_cursor *, size_t column_index, size_t *count);
+const struct cx_fsst_table *cx_row_group_cursor_symbols(
+    struct cx_row_group_cursor *, size_t column_index);
+
+// runs that make up the current batch of a CX_ENCODING_RLE column
+const struct cx_run *cx_row_group_cursor_batch_runs(
+    struct cx_row_group_cursor *, size_t column_index, size_t *run_count,
+    size_t *count);
+
+// bit planes that make up the current batch of a CX_ENCODING_BITPACK
+// column, along with the frame of reference of the chunk
+const uint64_t *cx_row_group_cursor_batch_planes(
+    struct cx_row_group_cursor *, size_t column_index, int64_t *base,
+    size_t *width, size_t *count);
+
+// values cached against a column for the lifetime of the cursor (they're
+// kept across rewinds). the cursor takes ownership of the value and
+// releases it with free()
+void *cx_row_group_cursor_cache(struct cx_row_group_cursor *,
+                                size_t column_index, uint64_t key);
+bool cx_row_group_cursor_cache_put(struct cx_row_group_cursor *,
+                                   size_t column_index, uint64_t key,
+                                   void *value);
+
 #ifdef __cplusplus
 }
 #endif
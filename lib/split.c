@@ -0,0 +1,89 @@
+#include "split.h"
+
+#ifdef CX_SSE42
+#include <emmintrin.h>
+#endif
+
+void cx_byte_split(size_t count, size_t width, const void *values,
+                   void *streams, size_t stream_size)
+{
+    const uint8_t *src = values;
+    uint8_t *dest = streams;
+    for (size_t k = 0; k < width; k++)
+        for (size_t i = 0; i < count; i++)
+            dest[k * stream_size + i] = src[i * width + k];
+}
+
+#ifdef CX_SSE42
+
+// transpose 16 values at a time. each round interleaves pairs of vectors,
+// doubling the number of bytes of each value that are adjacent
+static size_t cx_byte_merge_sse(size_t count, size_t width,
+                                const uint8_t *src, size_t stream_size,
+                                uint8_t *dest)
+{
+    size_t i = 0;
+    if (width == 4) {
+        for (; i + 16 <= count; i += 16) {
+            __m128i s0 = _mm_loadu_si128((__m128i *)(src + i));
+            __m128i s1 = _mm_loadu_si128((__m128i *)(src + stream_size + i));
+            __m128i s2 =
+                _mm_loadu_si128((__m128i *)(src + 2 * stream_size + i));
+            __m128i s3 =
+                _mm_loadu_si128((__m128i *)(src + 3 * stream_size + i));
+            __m128i a0 = _mm_unpacklo_epi8(s0, s1);
+            __m128i a1 = _mm_unpackhi_epi8(s0, s1);
+            __m128i a2 = _mm_unpacklo_epi8(s2, s3);
+            __m128i a3 = _mm_unpackhi_epi8(s2, s3);
+            __m128i *out = (__m128i *)(dest + i * 4);
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(a0, a2));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(a0, a2));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(a1, a3));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(a1, a3));
+        }
+    } else if (width == 8) {
+        for (; i + 16 <= count; i += 16) {
+            __m128i s[8], a[8], b[8];
+            for (size_t k = 0; k < 8; k++)
+                s[k] = _mm_loadu_si128(
+                    (__m128i *)(src + k * stream_size + i));
+            for (size_t k = 0; k < 4; k++) {
+                a[k] = _mm_unpacklo_epi8(s[2 * k], s[2 * k + 1]);
+                a[k + 4] = _mm_unpackhi_epi8(s[2 * k], s[2 * k + 1]);
+            }
+            // a[0..3] hold values 0-7, a[4..7] values 8-15
+            for (size_t h = 0; h < 8; h += 4) {
+                b[h] = _mm_unpacklo_epi16(a[h], a[h + 1]);
+                b[h + 1] = _mm_unpackhi_epi16(a[h], a[h + 1]);
+                b[h + 2] = _mm_unpacklo_epi16(a[h + 2], a[h + 3]);
+                b[h + 3] = _mm_unpackhi_epi16(a[h + 2], a[h + 3]);
+            }
+            __m128i *out = (__m128i *)(dest + i * 8);
+            for (size_t h = 0; h < 8; h += 4) {
+                _mm_storeu_si128(out++, _mm_unpacklo_epi32(b[h], b[h + 2]));
+                _mm_storeu_si128(out++, _mm_unpackhi_epi32(b[h], b[h + 2]));
+                _mm_storeu_si128(out++,
+                                 _mm_unpacklo_epi32(b[h + 1], b[h + 3]));
+                _mm_storeu_si128(out++,
+                                 _mm_unpackhi_epi32(b[h + 1], b[h + 3]));
+            }
+        }
+    }
+    return i;
+}
+
+#endif
+
+void cx_byte_merge(size_t count, size_t width, const void *streams,
+                   size_t stream_size, void *values)
+{
+    const uint8_t *src = streams;
+    uint8_t *dest = values;
+    size_t i = 0;
+#ifdef CX_SSE42
+    i = cx_byte_merge_sse(count, width, src, stream_size, dest);
+#endif
+    for (; i < count; i++)
+        for (size_t k = 0; k < width; k++)
+            dest[i * width + k] = src[k * stream_size + i];
+}
@@ -0,0 +1,24 @@
+#ifndef CX_SPLIT_H_
+#define CX_SPLIT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "common.h"
+
+// values that are width bytes wide are split into width byte streams,
+// where byte k of value i is byte i of stream k. streams are stream_size
+// bytes apart
+
+void cx_byte_split(size_t count, size_t width, const void *values,
+                   void *streams, size_t stream_size);
+
+void cx_byte_merge(size_t count, size_t width, const void *streams,
+                   size_t stream_size, void *values);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,38 +1,148 @@
 #define _GNU_SOURCE
 #define _FILE_OFFSET_BITS 64
-#define _LARGEFILE_SOURCE
 
 #include "writer.h"
 
 #include <assert.h>
+#include <errno.h>
 #include <fcntl.h>
-#include <stdio.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
+#include "auto.h"
 #include "compress.h"
+#include "encode.h"
 #include "file.h"
+#include "pool.h"
 
+#define CX_NULL_ENCODING_TYPE CX_ENCODING_RLE
 #define CX_NULL_COMPRESSION_TYPE CX_COMPRESSION_LZ4
 #define CX_NULL_COMPRESSION_LEVEL 0
 
+// the file is written through a buffer of this size. with direct IO,
+// writes are whole blocks of CX_WRITER_BLOCK_SIZE at block offsets
+#define CX_WRITER_BUFFER_SIZE (1 << 20)
+#define CX_WRITER_BLOCK_SIZE 4096
+
+// buffers of fixed width columns are reserved for up to this many rows
+#define CX_WRITER_RESERVE_MAX (1 << 20)
+
+// ZSTD dictionaries are trained from samples of up to this size, cut from
+// the chunks (and pages) compressed before the dictionary is
+#define CX_DICTIONARY_SAMPLE_SIZE (4 << 10)
+
+// dictionaries are trained once the samples reach this many times the size
+// of the dictionary, or after this many row groups
+#define CX_DICTIONARY_SAMPLE_RATIO 100
+#define CX_DICTIONARY_ROW_GROUPS 8
+
+// ZDICT doesn't train dictionaries smaller than this
+#define CX_DICTIONARY_SIZE_MIN 256
+
+// 列的 ZSTD 字典训练状态
+struct cx_writer_dictionary {
+    struct cx_zstd_dictionary *dictionary;
+    char *samples;
+    size_t samples_size;
+    size_t *sample_sizes;
+    size_t sample_count;
+    size_t row_groups;  // 已采样的行组数
+    bool done;          // 已训练 (或训练失败)
+    bool used;          // 有数据块用字典压缩过
+};
+
+// 等待写入的数据, 以及持有它的列或压缩缓冲区
+struct cx_writer_buffer {
+    const void *ptr;
+    size_t size;
+    struct cx_column *column;
+    void *compressed;  // 来自缓冲池
+    size_t capacity;
+};
+
+// 行组中一列的值或 null 位图
+struct cx_writer_chunk {
+    const struct cx_column *column;  // NULL 表示不存储
+    const struct cx_column *nulls;
+    const struct cx_index *index;
+    struct cx_column_header *header;
+    enum cx_encoding_type encoding;
+    enum cx_compression_type compression;
+    int compression_level;
+    size_t page_size;
+    struct cx_writer_dictionary *trainer;
+    struct cx_writer_buffer *buffers;  // 每页一个, 不分页时只有一个
+    struct cx_page_header *page_headers;
+    size_t buffer_count;
+    pthread_t thread;  // 压缩该列块的线程
+    bool done;         // 已压缩
+    bool error;
+};
+
+// 压缩列块的工作线程
+struct cx_writer_workers {
+    pthread_t *threads;
+    size_t count;
+    pthread_mutex_t mutex;
+    pthread_cond_t ready;  // 有新的列块
+    pthread_cond_t done;   // 有列块压缩完成
+    const struct cx_row_group_writer *writer;
+    struct cx_writer_chunk *chunks;
+    size_t chunk_count;
+    size_t position;    // 下一个待压缩的列块
+    size_t written;     // 已写入的列块数
+    size_t pending;     // 尚未释放的列块
+    size_t generation;  // 每批列块递增
+    bool stop;
+};
+
 // 列物理表示
 struct cx_writer_physical_column {
     struct cx_column *values;
     struct cx_column *nulls;
 };
 
+// 在后台刷写行组的线程, 刷写后的列集合留作复用
+struct cx_writer_flusher {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t ready;  // 有待刷写的列集合
+    pthread_cond_t done;   // 有列集合刷写完成
+    struct cx_row_group_writer *writer;
+    size_t column_count;
+    struct cx_writer_physical_column **queue;  // 环形队列
+    size_t head;
+    size_t count;    // 排队中的列集合
+    size_t pending;  // 排队中和正在刷写的列集合
+    struct cx_writer_physical_column **spares;
+    size_t spare_count;
+    size_t capacity;  // 最多同时刷写的行组数
+    bool error;
+    bool stop;
+};
+
 struct cx_writer {
     struct cx_row_group_writer *writer;
+    struct cx_writer_flusher *flusher;
     struct cx_writer_physical_column *columns;
     size_t row_group_size;
     size_t column_count;
     size_t position;
+    size_t in_flight;  // 最多同时刷写的行组数, 0 表示同步刷写
+};
+
+struct cx_writer_file {
+    int fd;
+    char *buffer;  // 按块对齐的写缓冲区
+    size_t start;  // 缓冲区在文件中的偏移量
+    size_t size;   // 缓冲区中的字节数
+    bool direct;   // 是否绕过页缓存 (O_DIRECT)
 };
 
 struct cx_row_group_writer {
-    FILE *file;
+    struct cx_writer_file file;
     struct {
         struct cx_column_descriptor *descriptors;
         size_t count;
@@ -48,6 +158,11 @@ struct cx_row_group_writer {
         size_t count;
         char *metadata;
     } strings;
+    struct {
+        struct cx_writer_dictionary *columns;
+        size_t size;  // 字典大小, 0 表示不训练字典
+    } dictionaries;
+    struct cx_writer_workers *workers;
     size_t row_count;
     bool header_written;
     bool footer_written;
@@ -68,100 +183,447 @@ error:
     return NULL;
 }
 
-void cx_writer_free(struct cx_writer *writer)
+static void cx_writer_free_column_set(
+    struct cx_writer_physical_column *columns, size_t column_count)
 {
-    if (writer->columns) {
-        for (size_t i = 0; i < writer->column_count; i++) {
-            cx_column_free(writer->columns[i].values);
-            cx_column_free(writer->columns[i].nulls);
-        }
-        free(writer->columns);
+    for (size_t i = 0; i < column_count; i++) {
+        if (columns[i].values)
+            cx_column_free(columns[i].values);
+        if (columns[i].nulls)
+            cx_column_free(columns[i].nulls);
+    }
+    free(columns);
+}
+
+static void cx_writer_free_columns(struct cx_writer *writer)
+{
+    cx_writer_free_column_set(writer->columns, writer->column_count);
+    writer->columns = NULL;
+}
+
+static bool cx_writer_put_column_set(struct cx_row_group_writer *writer,
+                                     struct cx_writer_physical_column *columns,
+                                     size_t column_count)
+{
+    struct cx_row_group *row_group = cx_row_group_new();
+    if (!row_group)
+        return false;
+    for (size_t i = 0; i < column_count; i++)
+        if (!cx_row_group_add_column(row_group, columns[i].values,
+                                     columns[i].nulls))
+            goto error;
+    if (!cx_row_group_writer_put(writer, row_group))
+        goto error;
+    cx_row_group_free(row_group);
+    // the buffers are reused by the next row group
+    for (size_t i = 0; i < column_count; i++) {
+        cx_column_reset(columns[i].values);
+        cx_column_reset(columns[i].nulls);
+    }
+    return true;
+error:
+    cx_row_group_free(row_group);
+    return false;
+}
+
+static void *cx_writer_flusher_thread(void *ptr)
+{
+    struct cx_writer_flusher *flusher = ptr;
+    pthread_mutex_lock(&flusher->mutex);
+    for (;;) {
+        while (!flusher->stop && !flusher->count)
+            pthread_cond_wait(&flusher->ready, &flusher->mutex);
+        if (!flusher->count)
+            break;
+        struct cx_writer_physical_column *columns =
+            flusher->queue[flusher->head];
+        flusher->head = (flusher->head + 1) % flusher->capacity;
+        flusher->count--;
+        bool error = flusher->error;
+        pthread_mutex_unlock(&flusher->mutex);
+        // row groups that follow a failed row group are dropped, since the
+        // writer has lost rows
+        if (!error && !cx_writer_put_column_set(flusher->writer, columns,
+                                                flusher->column_count))
+            error = true;
+        pthread_mutex_lock(&flusher->mutex);
+        if (error)
+            __atomic_store_n(&flusher->error, true, __ATOMIC_RELEASE);
+        // sets beyond those in flight (see cx_writer_flush_full_row_groups)
+        // aren't kept
+        if (flusher->spare_count < flusher->capacity)
+            flusher->spares[flusher->spare_count++] = columns;
+        else
+            cx_writer_free_column_set(columns, flusher->column_count);
+        flusher->pending--;
+        pthread_cond_broadcast(&flusher->done);
+    }
+    pthread_mutex_unlock(&flusher->mutex);
+    return NULL;
+}
+
+// wait for the row groups in flight to be written
+static bool cx_writer_flusher_drain(struct cx_writer_flusher *flusher)
+{
+    pthread_mutex_lock(&flusher->mutex);
+    while (flusher->pending)
+        pthread_cond_wait(&flusher->done, &flusher->mutex);
+    bool error = flusher->error;
+    pthread_mutex_unlock(&flusher->mutex);
+    return !error;
+}
+
+static void cx_writer_flusher_free(struct cx_writer_flusher *flusher)
+{
+    pthread_mutex_lock(&flusher->mutex);
+    flusher->stop = true;
+    pthread_cond_broadcast(&flusher->ready);
+    pthread_mutex_unlock(&flusher->mutex);
+    // the row groups in flight are written before the thread exits
+    pthread_join(flusher->thread, NULL);
+    for (size_t i = 0; i < flusher->spare_count; i++)
+        cx_writer_free_column_set(flusher->spares[i], flusher->column_count);
+    pthread_cond_destroy(&flusher->done);
+    pthread_cond_destroy(&flusher->ready);
+    pthread_mutex_destroy(&flusher->mutex);
+    free(flusher->spares);
+    free(flusher->queue);
+    free(flusher);
+}
+
+static struct cx_writer_flusher *cx_writer_flusher_new(
+    struct cx_row_group_writer *writer, size_t column_count, size_t capacity)
+{
+    struct cx_writer_flusher *flusher = calloc(1, sizeof(*flusher));
+    if (!flusher)
+        return NULL;
+    flusher->writer = writer;
+    flusher->column_count = column_count;
+    flusher->capacity = capacity;
+    flusher->queue = malloc(capacity * sizeof(*flusher->queue));
+    flusher->spares = malloc(capacity * sizeof(*flusher->spares));
+    if (!flusher->queue || !flusher->spares)
+        goto error;
+    if (pthread_mutex_init(&flusher->mutex, NULL))
+        goto error;
+    if (pthread_cond_init(&flusher->ready, NULL)) {
+        pthread_mutex_destroy(&flusher->mutex);
+        goto error;
+    }
+    if (pthread_cond_init(&flusher->done, NULL)) {
+        pthread_cond_destroy(&flusher->ready);
+        pthread_mutex_destroy(&flusher->mutex);
+        goto error;
+    }
+    if (pthread_create(&flusher->thread, NULL, cx_writer_flusher_thread,
+                       flusher)) {
+        pthread_cond_destroy(&flusher->done);
+        pthread_cond_destroy(&flusher->ready);
+        pthread_mutex_destroy(&flusher->mutex);
+        goto error;
     }
+    return flusher;
+error:
+    free(flusher->spares);
+    free(flusher->queue);
+    free(flusher);
+    return NULL;
+}
+
+// wait for the row groups in flight and stop the flusher, so that the row
+// group writer can be used from this thread
+static bool cx_writer_stop_flusher(struct cx_writer *writer)
+{
+    if (!writer->flusher)
+        return true;
+    bool ok = cx_writer_flusher_drain(writer->flusher);
+    cx_writer_flusher_free(writer->flusher);
+    writer->flusher = NULL;
+    return ok;
+}
+
+static bool cx_writer_buffered(const struct cx_writer *writer)
+{
+    if (!writer->columns)
+        return false;
+    for (size_t i = 0; i < writer->column_count; i++)
+        if (cx_column_count(writer->columns[i].nulls))
+            return true;
+    return false;
+}
+
+void cx_writer_free(struct cx_writer *writer)
+{
+    if (writer->flusher)
+        cx_writer_flusher_free(writer->flusher);
+    if (writer->columns)
+        cx_writer_free_columns(writer);
     cx_row_group_writer_free(writer->writer);
     free(writer);
 }
 
 bool cx_writer_metadata(struct cx_writer *writer, const char *metadata)
 {
+    if (writer->flusher && !cx_writer_flusher_drain(writer->flusher))
+        return false;
     return cx_row_group_writer_metadata(writer->writer, metadata);
 }
 
+bool cx_writer_set_threads(struct cx_writer *writer, int thread_count)
+{
+    if (writer->flusher && !cx_writer_flusher_drain(writer->flusher))
+        return false;
+    return cx_row_group_writer_set_threads(writer->writer, thread_count);
+}
+
+bool cx_writer_set_async(struct cx_writer *writer, size_t in_flight)
+{
+    if (!cx_writer_stop_flusher(writer))
+        return false;
+    // the flusher is started by the first row group that's flushed
+    writer->in_flight = in_flight;
+    return true;
+}
+
+bool cx_writer_set_direct(struct cx_writer *writer, bool direct)
+{
+    if (writer->flusher && !cx_writer_flusher_drain(writer->flusher))
+        return false;
+    return cx_row_group_writer_set_direct(writer->writer, direct);
+}
+
+bool cx_writer_train_dictionaries(struct cx_writer *writer, size_t size)
+{
+    if (writer->flusher && !cx_writer_flusher_drain(writer->flusher))
+        return false;
+    return cx_row_group_writer_train_dictionaries(writer->writer, size);
+}
+
 bool cx_writer_add_column(struct cx_writer *writer, const char *name,
                           enum cx_column_type type,
                           enum cx_encoding_type encoding,
                           enum cx_compression_type compression, int level)
 {
-    if (!cx_row_group_writer_add_column(writer->writer, name, type, encoding,
-                                        compression, level))
+    return cx_writer_add_column_paged(writer, name, type, encoding,
+                                      compression, level, 0);
+}
+
+bool cx_writer_add_column_paged(struct cx_writer *writer, const char *name,
+                                enum cx_column_type type,
+                                enum cx_encoding_type encoding,
+                                enum cx_compression_type compression,
+                                int level, size_t page_size)
+{
+    if (cx_writer_buffered(writer))
+        return false;
+    // the flusher holds on to buffers of the old set of columns
+    if (!cx_writer_stop_flusher(writer))
+        return false;
+    // buffers are allocated again for the new set of columns
+    if (writer->columns)
+        cx_writer_free_columns(writer);
+    if (!cx_row_group_writer_add_column_paged(writer->writer, name, type,
+                                              encoding, compression, level,
+                                              page_size))
         return false;
     writer->column_count++;
     return true;
 }
 
-static bool cx_writer_flush_row_group(struct cx_writer *writer)
+// hand the buffered row group to the flusher, and carry on with a spare set
+// of buffers. this waits while the flusher has as many row groups in
+// flight as it allows
+static bool cx_writer_flush_async(struct cx_writer *writer)
 {
-    if (!writer->columns)
-        return true;
-    struct cx_row_group *row_group = cx_row_group_new();
-    if (!row_group)
+    if (!writer->flusher) {
+        writer->flusher = cx_writer_flusher_new(
+            writer->writer, writer->column_count, writer->in_flight);
+        if (!writer->flusher)
+            return false;
+    }
+    struct cx_writer_flusher *flusher = writer->flusher;
+    pthread_mutex_lock(&flusher->mutex);
+    while (flusher->pending == flusher->capacity)
+        pthread_cond_wait(&flusher->done, &flusher->mutex);
+    if (flusher->error) {
+        pthread_mutex_unlock(&flusher->mutex);
         return false;
-    for (size_t i = 0; i < writer->column_count; i++)
-        if (!cx_row_group_add_column(row_group, writer->columns[i].values,
-                                     writer->columns[i].nulls))
-            goto error;
-    if (!cx_row_group_writer_put(writer->writer, row_group))
-        goto error;
-    cx_row_group_free(row_group);
-    for (size_t i = 0; i < writer->column_count; i++) {
-        cx_column_free(writer->columns[i].values);
-        cx_column_free(writer->columns[i].nulls);
     }
-    free(writer->columns);
-    writer->columns = NULL;
+    size_t tail = (flusher->head + flusher->count) % flusher->capacity;
+    flusher->queue[tail] = writer->columns;
+    flusher->count++;
+    flusher->pending++;
+    pthread_cond_signal(&flusher->ready);
+    // buffers are allocated on the next put if there's no spare set
+    struct cx_writer_physical_column *spare = NULL;
+    if (flusher->spare_count)
+        spare = flusher->spares[--flusher->spare_count];
+    pthread_mutex_unlock(&flusher->mutex);
+    writer->columns = spare;
     writer->position = 0;
     return true;
-error:
-    cx_row_group_free(row_group);
-    return false;
 }
 
-static bool cx_writer_ensure_columns(struct cx_writer *writer)
+static bool cx_writer_flush_row_group(struct cx_writer *writer)
 {
-    assert(!writer->columns && writer->column_count);
-    writer->columns = calloc(writer->column_count, sizeof(*writer->columns));
-    if (!writer->columns)
+    if (!cx_writer_buffered(writer))
+        return true;
+    if (writer->in_flight)
+        return cx_writer_flush_async(writer);
+    if (!cx_writer_put_column_set(writer->writer, writer->columns,
+                                  writer->column_count))
         return false;
+    writer->position = 0;
+    return true;
+}
+
+static struct cx_writer_physical_column *cx_writer_new_column_set(
+    const struct cx_writer *writer)
+{
+    assert(writer->column_count);
+    struct cx_writer_physical_column *columns =
+        calloc(writer->column_count, sizeof(*columns));
+    if (!columns)
+        return NULL;
+    size_t reserve = writer->row_group_size < CX_WRITER_RESERVE_MAX
+                         ? writer->row_group_size
+                         : CX_WRITER_RESERVE_MAX;
     for (size_t i = 0; i < writer->column_count; i++) {
         struct cx_column_descriptor *descriptor =
             &writer->writer->columns.descriptors[i];
-        writer->columns[i].values =
-            cx_column_new(descriptor->type, descriptor->encoding);
-        if (!writer->columns[i].values)
+        // values are buffered unencoded, and then encoded per chunk
+        columns[i].values = cx_column_new(descriptor->type, CX_ENCODING_NONE);
+        if (!columns[i].values)
+            goto error;
+        columns[i].nulls = cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+        if (!columns[i].nulls)
             goto error;
-        writer->columns[i].nulls =
-            cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
-        if (!writer->columns[i].nulls)
+        if (!cx_column_reserve(columns[i].values, reserve) ||
+            !cx_column_reserve(columns[i].nulls, reserve))
             goto error;
     }
-    return true;
+    return columns;
 error:
-    for (size_t i = 0; i < writer->column_count; i++) {
-        if (writer->columns[i].values)
-            cx_column_free(writer->columns[i].values);
-        if (writer->columns[i].nulls)
-            cx_column_free(writer->columns[i].nulls);
+    cx_writer_free_column_set(columns, writer->column_count);
+    return NULL;
+}
+
+static bool cx_writer_ensure_columns(struct cx_writer *writer)
+{
+    assert(!writer->columns);
+    writer->columns = cx_writer_new_column_set(writer);
+    return writer->columns != NULL;
+}
+
+// take a spare set of buffers from the flusher, or allocate one
+static struct cx_writer_physical_column *cx_writer_take_column_set(
+    struct cx_writer *writer)
+{
+    struct cx_writer_flusher *flusher = writer->flusher;
+    struct cx_writer_physical_column *columns = NULL;
+    if (flusher) {
+        // spares are only emptied by row groups that flush successfully
+        pthread_mutex_lock(&flusher->mutex);
+        if (flusher->spare_count && !flusher->error)
+            columns = flusher->spares[--flusher->spare_count];
+        pthread_mutex_unlock(&flusher->mutex);
     }
-    free(writer->columns);
-    writer->columns = NULL;
-    return false;
+    return columns ? columns : cx_writer_new_column_set(writer);
+}
+
+// hand an empty set of buffers back to the flusher, or free it if there's
+// no room for another spare
+static void cx_writer_give_column_set(
+    struct cx_writer *writer, struct cx_writer_physical_column *columns)
+{
+    struct cx_writer_flusher *flusher = writer->flusher;
+    if (flusher) {
+        pthread_mutex_lock(&flusher->mutex);
+        if (flusher->spare_count < flusher->capacity) {
+            flusher->spares[flusher->spare_count++] = columns;
+            columns = NULL;
+        }
+        pthread_mutex_unlock(&flusher->mutex);
+    }
+    if (columns)
+        cx_writer_free_column_set(columns, writer->column_count);
+}
+
+// move the buffered rows from row start onwards to a spare set of buffers
+static struct cx_writer_physical_column *cx_writer_split_columns(
+    struct cx_writer *writer, size_t start)
+{
+    struct cx_writer_physical_column *columns =
+        cx_writer_take_column_set(writer);
+    if (!columns)
+        return NULL;
+    for (size_t i = 0; i < writer->column_count; i++)
+        if (!cx_column_split(writer->columns[i].values, start,
+                             columns[i].values) ||
+            !cx_column_split(writer->columns[i].nulls, start,
+                             columns[i].nulls)) {
+            cx_writer_free_column_set(columns, writer->column_count);
+            return NULL;
+        }
+    return columns;
+}
+
+// flush the full row groups that are buffered. array puts can buffer more
+// rows than a row group holds, in which case the rows are cut into row
+// groups from the end, so that each row is moved once. the rows that don't
+// fill a row group are carried over to the next one
+static bool cx_writer_flush_full_row_groups(struct cx_writer *writer)
+{
+    size_t row_group_size = writer->row_group_size;
+    size_t row_group_count = writer->position / row_group_size;
+    if (writer->position == row_group_size)
+        return cx_writer_flush_row_group(writer);
+    struct cx_writer_physical_column **sets =
+        calloc(row_group_count, sizeof(*sets));
+    if (!sets)
+        return false;
+    size_t carried = writer->position - row_group_count * row_group_size;
+    bool ok = true;
+    for (size_t i = row_group_count; ok && i > 0; i--) {
+        sets[i - 1] = cx_writer_split_columns(writer, i * row_group_size);
+        ok = sets[i - 1] != NULL;
+    }
+    // the first row group is left in the current buffers
+    for (size_t i = 0; ok && i < row_group_count; i++) {
+        writer->position = row_group_size;
+        ok = cx_writer_flush_row_group(writer);
+        if (!ok)
+            break;
+        // the flushed set (or the spare that replaced it) is empty, and is
+        // kept for the splits of the array puts that follow
+        if (writer->columns)
+            cx_writer_give_column_set(writer, writer->columns);
+        writer->columns = sets[i];
+        sets[i] = NULL;
+    }
+    // rows that couldn't be flushed are dropped along with the rows that
+    // follow them
+    if (!ok && writer->columns)
+        cx_writer_free_columns(writer);
+    for (size_t i = 0; i < row_group_count; i++)
+        if (sets[i])
+            cx_writer_free_column_set(sets[i], writer->column_count);
+    free(sets);
+    writer->position = ok ? carried : 0;
+    return ok;
 }
 
 static bool cx_writer_put_check(struct cx_writer *writer, size_t column_index)
 {
     if (column_index >= writer->column_count)
         return false;
-    if (column_index == 0 && writer->position == writer->row_group_size)
-        if (!cx_writer_flush_row_group(writer))
+    // a row group that failed to flush in the background fails the puts
+    // that follow
+    if (writer->flusher &&
+        __atomic_load_n(&writer->flusher->error, __ATOMIC_ACQUIRE))
+        return false;
+    if (column_index == 0 && writer->position >= writer->row_group_size)
+        if (!cx_writer_flush_full_row_groups(writer))
             return false;
     if (!writer->columns)
         if (!cx_writer_ensure_columns(writer))
@@ -259,13 +721,224 @@ bool cx_writer_put_null(struct cx_writer *writer, size_t column_index)
     return true;
 }
 
+static bool cx_writer_put_array_nulls(struct cx_writer *writer,
+                                      size_t column_index,
+                                      const uint64_t *nulls, size_t count)
+{
+    if (!cx_column_put_bit_array(writer->columns[column_index].nulls, nulls,
+                                 NULL, count))
+        return false;
+    writer->position += (column_index == 0) * count;
+    return true;
+}
+
+bool cx_writer_put_bit_array(struct cx_writer *writer, size_t column_index,
+                             const uint64_t *values, const uint64_t *nulls,
+                             size_t count)
+{
+    if (!values || !cx_writer_put_check(writer, column_index))
+        return false;
+    if (!cx_column_put_bit_array(writer->columns[column_index].values, values,
+                                 nulls, count))
+        return false;
+    return cx_writer_put_array_nulls(writer, column_index, nulls, count);
+}
+
+bool cx_writer_put_i32_array(struct cx_writer *writer, size_t column_index,
+                             const int32_t *values, const uint64_t *nulls,
+                             size_t count)
+{
+    if (!cx_writer_put_check(writer, column_index))
+        return false;
+    if (!cx_column_put_i32_array(writer->columns[column_index].values, values,
+                                 nulls, count))
+        return false;
+    return cx_writer_put_array_nulls(writer, column_index, nulls, count);
+}
+
+bool cx_writer_put_i64_array(struct cx_writer *writer, size_t column_index,
+                             const int64_t *values, const uint64_t *nulls,
+                             size_t count)
+{
+    if (!cx_writer_put_check(writer, column_index))
+        return false;
+    if (!cx_column_put_i64_array(writer->columns[column_index].values, values,
+                                 nulls, count))
+        return false;
+    return cx_writer_put_array_nulls(writer, column_index, nulls, count);
+}
+
+bool cx_writer_put_flt_array(struct cx_writer *writer, size_t column_index,
+                             const float *values, const uint64_t *nulls,
+                             size_t count)
+{
+    if (!cx_writer_put_check(writer, column_index))
+        return false;
+    if (!cx_column_put_flt_array(writer->columns[column_index].values, values,
+                                 nulls, count))
+        return false;
+    return cx_writer_put_array_nulls(writer, column_index, nulls, count);
+}
+
+bool cx_writer_put_dbl_array(struct cx_writer *writer, size_t column_index,
+                             const double *values, const uint64_t *nulls,
+                             size_t count)
+{
+    if (!cx_writer_put_check(writer, column_index))
+        return false;
+    if (!cx_column_put_dbl_array(writer->columns[column_index].values, values,
+                                 nulls, count))
+        return false;
+    return cx_writer_put_array_nulls(writer, column_index, nulls, count);
+}
+
+bool cx_writer_put_str_array(struct cx_writer *writer, size_t column_index,
+                             const uint32_t *offsets, const char *data,
+                             const uint64_t *nulls, size_t count)
+{
+    if (!cx_writer_put_check(writer, column_index))
+        return false;
+    if (!cx_column_put_str_array(writer->columns[column_index].values,
+                                 offsets, data, nulls, count))
+        return false;
+    return cx_writer_put_array_nulls(writer, column_index, nulls, count);
+}
+
 bool cx_writer_finish(struct cx_writer *writer, bool sync)
 {
+    if (writer->position >= writer->row_group_size &&
+        !cx_writer_flush_full_row_groups(writer))
+        return false;
     if (!cx_writer_flush_row_group(writer))
         return false;
+    if (!cx_writer_stop_flusher(writer))
+        return false;
     return cx_row_group_writer_finish(writer->writer, sync);
 }
 
+static bool cx_writer_file_open(struct cx_writer_file *file,
+                                const char *path)
+{
+    // the file is opened for reading too, so that direct IO can read back
+    // the start of a block when a failed write is rolled back
+    file->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (file->fd < 0)
+        return false;
+    if (posix_memalign((void **)&file->buffer, CX_WRITER_BLOCK_SIZE,
+                       CX_WRITER_BUFFER_SIZE)) {
+        close(file->fd);
+        return false;
+    }
+    file->start = 0;
+    file->size = 0;
+    file->direct = false;
+    return true;
+}
+
+static bool cx_writer_pwrite(int fd, const void *buf, size_t size,
+                             size_t offset)
+{
+    while (size) {
+        ssize_t written = pwrite(fd, buf, size, offset);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        buf = (const char *)buf + written;
+        size -= written;
+        offset += written;
+    }
+    return true;
+}
+
+// write out the buffer. with direct IO, only whole blocks are written
+// unless all is set, in which case the last block is padded with zeros
+// and stays in the buffer, so that writes can carry on after it
+static bool cx_writer_file_flush(struct cx_writer_file *file, bool all)
+{
+    size_t size = file->size;
+    if (file->direct) {
+        size = size / CX_WRITER_BLOCK_SIZE * CX_WRITER_BLOCK_SIZE;
+        if (all && size < file->size) {
+            size += CX_WRITER_BLOCK_SIZE;
+            memset(file->buffer + file->size, 0, size - file->size);
+        }
+    }
+    if (!size)
+        return true;
+    if (!cx_writer_pwrite(file->fd, file->buffer, size, file->start))
+        return false;
+    if (size > file->size)
+        return true;
+    memmove(file->buffer, file->buffer + size, file->size - size);
+    file->start += size;
+    file->size -= size;
+    return true;
+}
+
+static size_t cx_writer_file_offset(const struct cx_writer_file *file)
+{
+    return file->start + file->size;
+}
+
+static bool cx_writer_file_write(struct cx_writer_file *file,
+                                 const void *buf, size_t size)
+{
+    while (size) {
+        // large chunks are written from the caller's buffer, unless the
+        // writes have to be aligned
+        if (!file->direct && !file->size && size >= CX_WRITER_BUFFER_SIZE) {
+            if (!cx_writer_pwrite(file->fd, buf, size, file->start))
+                return false;
+            file->start += size;
+            return true;
+        }
+        size_t count = CX_WRITER_BUFFER_SIZE - file->size;
+        if (count > size)
+            count = size;
+        memcpy(file->buffer + file->size, buf, count);
+        file->size += count;
+        buf = (const char *)buf + count;
+        size -= count;
+        if (file->size == CX_WRITER_BUFFER_SIZE &&
+            !cx_writer_file_flush(file, false))
+            return false;
+    }
+    return true;
+}
+
+// discard everything written after offset
+static bool cx_writer_file_truncate(struct cx_writer_file *file,
+                                    size_t offset)
+{
+    if (offset >= file->start) {
+        if (offset > cx_writer_file_offset(file))
+            return false;
+        file->size = offset - file->start;
+        return true;
+    }
+    // the data was already written out. with direct IO the start of the
+    // block that offset falls in is read back into the buffer
+    size_t start = offset;
+    if (file->direct)
+        start = offset / CX_WRITER_BLOCK_SIZE * CX_WRITER_BLOCK_SIZE;
+    if (offset > start &&
+        pread(file->fd, file->buffer, CX_WRITER_BLOCK_SIZE, start) <
+            (ssize_t)(offset - start))
+        return false;
+    file->start = start;
+    file->size = offset - start;
+    return true;
+}
+
+// write out the buffer and cut the file at the end of the data, dropping
+// the padding of the last block and anything left by a failed write
+static bool cx_writer_file_finish(struct cx_writer_file *file)
+{
+    return cx_writer_file_flush(file, true) &&
+           !ftruncate(file->fd, cx_writer_file_offset(file));
+}
+
 struct cx_row_group_writer *cx_row_group_writer_new(const char *path)
 {
     struct cx_row_group_writer *writer = calloc(1, sizeof(*writer));
@@ -274,8 +947,7 @@ struct cx_row_group_writer *cx_row_group_writer_new(const char *path)
     writer->strings.column = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
     if (!writer->strings.column)
         goto error;
-    writer->file = fopen(path, "wb");
-    if (!writer->file)
+    if (!cx_writer_file_open(&writer->file, path))
         goto error;
     return writer;
 error:
@@ -285,6 +957,31 @@ error:
     return NULL;
 }
 
+bool cx_row_group_writer_set_direct(struct cx_row_group_writer *writer,
+                                    bool direct)
+{
+    // blocks are written from the start of the file
+    if (writer->header_written)
+        return false;
+    int fd = writer->file.fd;
+#ifdef O_DIRECT
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0)
+        return false;
+    flags = direct ? flags | O_DIRECT : flags & ~O_DIRECT;
+    if (fcntl(fd, F_SETFL, flags))
+        return false;
+#elif defined(__APPLE__)
+    if (fcntl(fd, F_NOCACHE, direct))
+        return false;
+#else
+    if (direct)
+        return false;
+#endif
+    writer->file.direct = direct;
+    return true;
+}
+
 bool cx_row_group_writer_metadata(struct cx_row_group_writer *writer,
                                   const char *metadata)
 {
@@ -317,7 +1014,20 @@ bool cx_row_group_writer_add_column(struct cx_row_group_writer *writer,
                                     enum cx_compression_type compression,
                                     int level)
 {
-    if (writer->header_written)
+    return cx_row_group_writer_add_column_paged(writer, name, type, encoding,
+                                                compression, level, 0);
+}
+
+bool cx_row_group_writer_add_column_paged(
+    struct cx_row_group_writer *writer, const char *name,
+    enum cx_column_type type, enum cx_encoding_type encoding,
+    enum cx_compression_type compression, int level, size_t page_size)
+{
+    if (writer->header_written || !cx_encoding_supported(type, encoding))
+        return false;
+    if (page_size % CX_BATCH_SIZE_MAX || page_size > UINT32_MAX)
+        return false;
+    if (compression == CX_COMPRESSION_AUTO && (level < 0 || level > 100))
         return false;
 
     if (!writer->columns.count) {
@@ -344,10 +1054,92 @@ bool cx_row_group_writer_add_column(struct cx_row_group_writer *writer,
     descriptor->encoding = encoding;
     descriptor->compression = compression;
     descriptor->compression_level = level;
+    descriptor->page_size = page_size;
 
     return cx_row_group_writer_add_string(writer, name, &descriptor->name);
 }
 
+bool cx_row_group_writer_train_dictionaries(struct cx_row_group_writer *writer,
+                                            size_t size)
+{
+    if (writer->header_written || size < CX_DICTIONARY_SIZE_MIN ||
+        size > UINT32_MAX)
+        return false;
+    writer->dictionaries.size = size;
+    return true;
+}
+
+static bool cx_writer_dictionary_sample(struct cx_writer_dictionary *dictionary,
+                                        size_t limit, const void *buffer,
+                                        size_t size)
+{
+    if (dictionary->samples_size + size > limit)
+        size = limit - dictionary->samples_size;
+    if (!size)
+        return true;
+    size_t count = (size + CX_DICTIONARY_SAMPLE_SIZE - 1) /
+                   CX_DICTIONARY_SAMPLE_SIZE;
+    char *samples =
+        realloc(dictionary->samples, dictionary->samples_size + size);
+    if (!samples)
+        return false;
+    dictionary->samples = samples;
+    size_t *sample_sizes =
+        realloc(dictionary->sample_sizes,
+                (dictionary->sample_count + count) * sizeof(*sample_sizes));
+    if (!sample_sizes)
+        return false;
+    dictionary->sample_sizes = sample_sizes;
+    memcpy(samples + dictionary->samples_size, buffer, size);
+    dictionary->samples_size += size;
+    for (size_t offset = 0; offset < size;
+         offset += CX_DICTIONARY_SAMPLE_SIZE) {
+        size_t sample_size = size - offset < CX_DICTIONARY_SAMPLE_SIZE
+                                 ? size - offset
+                                 : CX_DICTIONARY_SAMPLE_SIZE;
+        sample_sizes[dictionary->sample_count++] = sample_size;
+    }
+    return true;
+}
+
+static void cx_writer_dictionary_train(struct cx_writer_dictionary *dictionary,
+                                       size_t size, int level)
+{
+    // a column that ZDICT can't train a dictionary for (e.g. one with too
+    // few samples) is compressed without one
+    if (dictionary->sample_count)
+        dictionary->dictionary = cx_zstd_dictionary_train(
+            dictionary->samples, dictionary->sample_sizes,
+            dictionary->sample_count, size, level);
+    free(dictionary->samples);
+    free(dictionary->sample_sizes);
+    dictionary->samples = NULL;
+    dictionary->sample_sizes = NULL;
+    dictionary->samples_size = 0;
+    dictionary->sample_count = 0;
+    dictionary->done = true;
+}
+
+// the dictionary to compress a chunk with, if the column has one. the
+// chunk is sampled if the dictionary hasn't been trained yet
+static bool cx_row_group_writer_dictionary(
+    const struct cx_row_group_writer *writer,
+    struct cx_writer_dictionary *dictionary, const void *buffer, size_t size,
+    const struct cx_zstd_dictionary **result)
+{
+    *result = NULL;
+    if (!dictionary)
+        return true;
+    if (dictionary->done) {
+        *result = dictionary->dictionary;
+        dictionary->used = dictionary->dictionary != NULL;
+        return true;
+    }
+    return cx_writer_dictionary_sample(
+        dictionary, writer->dictionaries.size * CX_DICTIONARY_SAMPLE_RATIO,
+        buffer, size);
+}
+
 static size_t cx_write_align(size_t offset)
 {
     size_t mod = offset % CX_WRITE_ALIGN;
@@ -357,26 +1149,27 @@ static size_t cx_write_align(size_t offset)
 static size_t cx_row_group_writer_offset(
     const struct cx_row_group_writer *writer)
 {
-    return ftello(writer->file);
+    return cx_writer_file_offset(&writer->file);
 }
 
-static bool cx_row_group_writer_seek(const struct cx_row_group_writer *writer,
+static bool cx_row_group_writer_seek(struct cx_row_group_writer *writer,
                                      size_t offset)
 {
-    return fseeko(writer->file, offset, SEEK_SET) == 0;
+    return cx_writer_file_truncate(&writer->file, offset);
 }
 
-static bool cx_row_group_writer_write(const struct cx_row_group_writer *writer,
+static bool cx_row_group_writer_write(struct cx_row_group_writer *writer,
                                       const void *buf, size_t size)
 {
+    static const char padding[CX_WRITE_ALIGN] = {0};
     if (!size)
         return true;
     size_t offset = cx_row_group_writer_offset(writer);
     size_t aligned_offset = cx_write_align(offset);
-    if (offset != aligned_offset &&
-        !cx_row_group_writer_seek(writer, aligned_offset))
+    if (!cx_writer_file_write(&writer->file, padding,
+                              aligned_offset - offset))
         return false;
-    return fwrite(buf, size, 1, writer->file) == 1;
+    return cx_writer_file_write(&writer->file, buf, size);
 }
 
 static bool cx_row_group_writer_ensure_header(
@@ -390,51 +1183,485 @@ static bool cx_row_group_writer_ensure_header(
     writer->header_written = true;
     return true;
 error:
-    rewind(writer->file);
+    cx_row_group_writer_seek(writer, 0);
     return false;
 }
 
-static bool cx_row_group_writer_put_column(struct cx_row_group_writer *writer,
-                                           const struct cx_column *column,
-                                           const struct cx_index *index,
-                                           struct cx_column_header *header,
-                                           enum cx_compression_type compression,
-                                           int compression_level)
+static bool cx_row_group_writer_choose(const struct cx_column *column,
+                                       const struct cx_column *nulls,
+                                       enum cx_encoding_type *encoding,
+                                       enum cx_compression_type *compression,
+                                       int *compression_level)
 {
+    size_t column_size;
+    cx_column_export(column, &column_size);
+    // the level is the weight given to decode speed when the encoding and
+    // compression are chosen per chunk
+    if (*compression == CX_COMPRESSION_AUTO) {
+        if (!column_size || cx_column_encoding(column)) {
+            *encoding = CX_ENCODING_NONE;
+            *compression = CX_COMPRESSION_NONE;
+        } else if (!cx_auto_choose(column, nulls, *compression_level,
+                                   encoding, compression,
+                                   compression_level)) {
+            return false;
+        }
+    }
+    // a chunk that holds a single value stores it once, whatever the
+    // requested encoding. a column that asks for the constant encoding
+    // stores the chunks that don't hold a single value in the plain layout
+    if (cx_column_constant(column))
+        *encoding = CX_ENCODING_CONSTANT;
+    else if (*encoding == CX_ENCODING_CONSTANT)
+        *encoding = CX_ENCODING_NONE;
+    return true;
+}
+
+static bool cx_row_group_writer_compress_column(
+    const struct cx_row_group_writer *writer, struct cx_writer_chunk *chunk)
+{
+    const struct cx_column *column = chunk->column;
+    struct cx_column_header *header = chunk->header;
+    enum cx_encoding_type encoding = chunk->encoding;
+    enum cx_compression_type compression = chunk->compression;
+    int compression_level = chunk->compression_level;
+    struct cx_writer_buffer *output = NULL;
+    struct cx_column *encoded = NULL;
     size_t column_size;
     const void *buffer = cx_column_export(column, &column_size);
+    bool automatic = compression == CX_COMPRESSION_AUTO;
+    if (!cx_row_group_writer_choose(column, chunk->nulls, &encoding,
+                                    &compression, &compression_level))
+        return false;
+    output = calloc(1, sizeof(*output));
+    if (!output)
+        return false;
+    chunk->buffers = output;
+    chunk->buffer_count = 1;
+    if (encoding && !cx_column_encoding(column) && column_size) {
+        if (encoding == CX_ENCODING_SPARSE && chunk->nulls)
+            encoded = cx_encode_sparse(column, chunk->nulls);
+        else
+            encoded = cx_encode(column, encoding, chunk->index);
+        // an encoding chosen from a sample may not apply to the whole
+        // chunk, in which case it's stored in the plain layout
+        if (!encoded && !automatic)
+            return false;
+    }
+    if (encoded) {
+        // fallback if the encoding leads to an increase in size. some
+        // encodings (e.g. byte stream split) don't change the size but
+        // improve the compression ratio. string offsets always add to the
+        // size, and are there to speed up reads
+        size_t encoded_size;
+        const void *encoded_buffer = cx_column_export(encoded, &encoded_size);
+        if (encoded_size <= column_size ||
+            encoding == CX_ENCODING_OFFSETS) {
+            buffer = encoded_buffer;
+            column_size = encoded_size;
+            column = encoded;
+            output->column = encoded;
+        } else {
+            cx_column_free(encoded);
+        }
+    }
     header->decompressed_size = column_size;
-    header->offset = cx_write_align(cx_row_group_writer_offset(writer));
     header->encoding = cx_column_encoding(column);
-    memcpy(&header->index, index, sizeof(*index));
-    size_t compressed_size = 0;
-    void *compressed = NULL;
+    memcpy(&header->index, chunk->index, sizeof(*chunk->index));
     if (compression && column_size) {
-        compressed = cx_compress(compression, compression_level, buffer,
-                                 column_size, &compressed_size);
-        if (!compressed)
-            goto error;
+        const struct cx_zstd_dictionary *dictionary;
+        if (!cx_row_group_writer_dictionary(writer, chunk->trainer, buffer,
+                                            column_size, &dictionary))
+            return false;
+        size_t compressed_size;
+        output->compressed = cx_compress_pooled(
+            compression, compression_level, dictionary, buffer, column_size,
+            &compressed_size, &output->capacity);
+        if (!output->compressed)
+            return false;
         // fallback if the compression leads to an increase in size
         if (compressed_size >= column_size) {
             header->compression = CX_COMPRESSION_NONE;
         } else {
             header->compression = compression;
-            buffer = compressed;
+            buffer = output->compressed;
             column_size = compressed_size;
         }
     }
     header->size = column_size;
-    if (!cx_row_group_writer_write(writer, buffer, column_size))
-        goto error;
-    if (compressed)
-        free(compressed);
+    output->ptr = buffer;
+    output->size = column_size;
+    return true;
+}
+
+// encode the pages of a chunk, and check whether the encoding applies to
+// all of them. pages are returned in the plain layout if not
+static bool cx_row_group_writer_encode_pages(
+    const struct cx_column *column, const struct cx_column *nulls,
+    size_t page_size, enum cx_encoding_type *encoding, bool automatic,
+    struct cx_column **pages, struct cx_page_header *page_headers,
+    size_t page_count)
+{
+    size_t start = 0, nulls_start = 0, plain_size = 0, encoded_size = 0;
+    size_t row_count = cx_column_count(column);
+    bool fallback = false;
+    for (size_t i = 0; i < page_count; i++) {
+        size_t count = row_count - i * page_size < page_size
+                           ? row_count - i * page_size
+                           : page_size;
+        struct cx_column *page = cx_column_slice(column, start, count, &start);
+        if (!page)
+            return false;
+        pages[i] = page;
+        struct cx_index *index = cx_index_new(page);
+        if (!index)
+            return false;
+        memcpy(&page_headers[i].index, index, sizeof(*index));
+        size_t size;
+        cx_column_export(page, &size);
+        plain_size += size;
+        if (!*encoding || fallback) {
+            cx_index_free(index);
+            continue;
+        }
+        struct cx_column *encoded = NULL;
+        if (*encoding == CX_ENCODING_SPARSE && nulls) {
+            struct cx_column *nulls_page =
+                cx_column_slice(nulls, nulls_start, count, &nulls_start);
+            if (nulls_page) {
+                encoded = cx_encode_sparse(page, nulls_page);
+                cx_column_free(nulls_page);
+            }
+        } else {
+            encoded = cx_encode(page, *encoding, index);
+        }
+        cx_index_free(index);
+        if (!encoded) {
+            // see cx_row_group_writer_put_column
+            if (!automatic)
+                return false;
+            fallback = true;
+            continue;
+        }
+        cx_column_export(encoded, &size);
+        encoded_size += size;
+        // the plain page is cut again if the chunk falls back
+        pages[i] = encoded;
+        cx_column_free(page);
+    }
+    if (!*encoding)
+        return true;
+    if (!fallback &&
+        (encoded_size <= plain_size || *encoding == CX_ENCODING_OFFSETS))
+        return true;
+    // every page of a chunk has the same encoding, so the chunk falls back
+    // to the plain layout as a whole
+    *encoding = CX_ENCODING_NONE;
+    start = 0;
+    for (size_t i = 0; i < page_count; i++) {
+        size_t count = row_count - i * page_size < page_size
+                           ? row_count - i * page_size
+                           : page_size;
+        struct cx_column *page = cx_column_slice(column, start, count, &start);
+        if (!page)
+            return false;
+        if (cx_column_encoding(pages[i])) {
+            cx_column_free(pages[i]);
+            pages[i] = page;
+        } else {
+            cx_column_free(page);
+        }
+    }
+    return true;
+}
+
+static bool cx_row_group_writer_compress_pages(
+    const struct cx_row_group_writer *writer, struct cx_writer_chunk *chunk)
+{
+    const struct cx_column *column = chunk->column;
+    struct cx_column_header *header = chunk->header;
+    enum cx_encoding_type encoding = chunk->encoding;
+    enum cx_compression_type compression = chunk->compression;
+    int compression_level = chunk->compression_level;
+    size_t row_count = cx_column_count(column);
+    size_t page_count =
+        (row_count + chunk->page_size - 1) / chunk->page_size;
+    struct cx_column **pages = NULL;
+    // pages are cut from the plain layout
+    if (cx_column_encoding(column))
+        return false;
+    bool automatic = compression == CX_COMPRESSION_AUTO;
+    if (!cx_row_group_writer_choose(column, chunk->nulls, &encoding,
+                                    &compression, &compression_level))
+        return false;
+    if (page_count) {
+        pages = calloc(page_count, sizeof(*pages));
+        chunk->page_headers =
+            calloc(page_count, sizeof(*chunk->page_headers));
+        chunk->buffers = calloc(page_count, sizeof(*chunk->buffers));
+        if (!pages || !chunk->page_headers || !chunk->buffers)
+            goto error;
+        chunk->buffer_count = page_count;
+        if (!cx_row_group_writer_encode_pages(
+                column, chunk->nulls, chunk->page_size, &encoding, automatic,
+                pages, chunk->page_headers, page_count))
+            goto error;
+    }
+    header->encoding = encoding;
+    header->compression = compression;
+    header->decompressed_size = page_count * sizeof(*chunk->page_headers);
+    memcpy(&header->index, chunk->index, sizeof(*chunk->index));
+    for (size_t i = 0; i < page_count; i++) {
+        struct cx_writer_buffer *output = &chunk->buffers[i];
+        size_t size;
+        const void *buffer = cx_column_export(pages[i], &size);
+        struct cx_page_header *page_header = &chunk->page_headers[i];
+        // the buffer holds on to the page until it's written
+        output->column = pages[i];
+        pages[i] = NULL;
+        page_header->decompressed_size = size;
+        page_header->compression = CX_COMPRESSION_NONE;
+        header->decompressed_size += size;
+        if (compression && size) {
+            const struct cx_zstd_dictionary *dictionary;
+            if (!cx_row_group_writer_dictionary(writer, chunk->trainer,
+                                                buffer, size, &dictionary))
+                goto error;
+            size_t compressed_size;
+            output->compressed = cx_compress_pooled(
+                compression, compression_level, dictionary, buffer, size,
+                &compressed_size, &output->capacity);
+            if (!output->compressed)
+                goto error;
+            // fallback if the compression leads to an increase in size
+            if (compressed_size < size) {
+                page_header->compression = compression;
+                buffer = output->compressed;
+                size = compressed_size;
+            }
+        }
+        page_header->size = size;
+        output->ptr = buffer;
+        output->size = size;
+    }
+    free(pages);
     return true;
 error:
-    if (compressed)
-        free(compressed);
+    if (pages) {
+        for (size_t i = 0; i < page_count; i++)
+            if (pages[i])
+                cx_column_free(pages[i]);
+        free(pages);
+    }
     return false;
 }
 
+static bool cx_row_group_writer_compress(
+    const struct cx_row_group_writer *writer, struct cx_writer_chunk *chunk)
+{
+    // the null bitmap of a column without nulls isn't stored
+    if (!chunk->column) {
+        memcpy(&chunk->header->index, chunk->index, sizeof(*chunk->index));
+        return true;
+    }
+    if (chunk->page_size)
+        return cx_row_group_writer_compress_pages(writer, chunk);
+    return cx_row_group_writer_compress_column(writer, chunk);
+}
+
+static void cx_writer_chunk_release(struct cx_writer_chunk *chunk)
+{
+    for (size_t i = 0; i < chunk->buffer_count; i++) {
+        struct cx_writer_buffer *buffer = &chunk->buffers[i];
+        cx_pool_put(buffer->compressed, buffer->capacity);
+        if (buffer->column)
+            cx_column_free(buffer->column);
+    }
+    free(chunk->buffers);
+    free(chunk->page_headers);
+    chunk->buffers = NULL;
+    chunk->page_headers = NULL;
+    chunk->buffer_count = 0;
+}
+
+static bool cx_row_group_writer_write_chunk(
+    struct cx_row_group_writer *writer, struct cx_writer_chunk *chunk)
+{
+    struct cx_column_header *header = chunk->header;
+    header->offset = cx_write_align(cx_row_group_writer_offset(writer));
+    if (!chunk->page_size || !chunk->column) {
+        for (size_t i = 0; i < chunk->buffer_count; i++)
+            if (!cx_row_group_writer_write(writer, chunk->buffers[i].ptr,
+                                           chunk->buffers[i].size))
+                return false;
+        return true;
+    }
+    // the offsets of the pages are worked out up front, so that the page
+    // headers can be written ahead of them
+    size_t headers_size = chunk->buffer_count * sizeof(*chunk->page_headers);
+    size_t end = header->offset + headers_size;
+    for (size_t i = 0; i < chunk->buffer_count; i++) {
+        end = cx_write_align(end);
+        chunk->page_headers[i].offset = end - header->offset;
+        end += chunk->buffers[i].size;
+    }
+    header->size = end - header->offset;
+    if (!cx_row_group_writer_write(writer, chunk->page_headers, headers_size))
+        return false;
+    for (size_t i = 0; i < chunk->buffer_count; i++)
+        if (!cx_row_group_writer_write(writer, chunk->buffers[i].ptr,
+                                       chunk->buffers[i].size))
+            return false;
+    return true;
+}
+
+static void *cx_writer_workers_thread(void *ptr)
+{
+    struct cx_writer_workers *workers = ptr;
+    pthread_t self = pthread_self();
+    size_t generation = 0, released = 0;
+    pthread_mutex_lock(&workers->mutex);
+    for (;;) {
+        if (generation != workers->generation) {
+            generation = workers->generation;
+            released = 0;
+        }
+        // chunks are released by the thread that compressed them once
+        // they're written, so that their buffers go back to its pool
+        if (released < workers->written) {
+            struct cx_writer_chunk *chunk = &workers->chunks[released++];
+            if (!pthread_equal(chunk->thread, self))
+                continue;
+            pthread_mutex_unlock(&workers->mutex);
+            cx_writer_chunk_release(chunk);
+            pthread_mutex_lock(&workers->mutex);
+            workers->pending--;
+            pthread_cond_broadcast(&workers->done);
+            continue;
+        }
+        if (workers->stop)
+            break;
+        if (workers->position >= workers->chunk_count) {
+            pthread_cond_wait(&workers->ready, &workers->mutex);
+            continue;
+        }
+        struct cx_writer_chunk *chunk = &workers->chunks[workers->position++];
+        chunk->thread = self;
+        pthread_mutex_unlock(&workers->mutex);
+        bool compressed = cx_row_group_writer_compress(workers->writer, chunk);
+        pthread_mutex_lock(&workers->mutex);
+        chunk->error = !compressed;
+        chunk->done = true;
+        pthread_cond_broadcast(&workers->done);
+    }
+    pthread_mutex_unlock(&workers->mutex);
+    return NULL;
+}
+
+static void cx_writer_workers_free(struct cx_writer_workers *workers)
+{
+    pthread_mutex_lock(&workers->mutex);
+    workers->stop = true;
+    pthread_cond_broadcast(&workers->ready);
+    pthread_mutex_unlock(&workers->mutex);
+    for (size_t i = 0; i < workers->count; i++)
+        pthread_join(workers->threads[i], NULL);
+    pthread_cond_destroy(&workers->done);
+    pthread_cond_destroy(&workers->ready);
+    pthread_mutex_destroy(&workers->mutex);
+    free(workers->threads);
+    free(workers);
+}
+
+static struct cx_writer_workers *cx_writer_workers_new(
+    const struct cx_row_group_writer *writer, size_t thread_count)
+{
+    struct cx_writer_workers *workers = calloc(1, sizeof(*workers));
+    if (!workers)
+        return NULL;
+    workers->writer = writer;
+    workers->threads = malloc(thread_count * sizeof(*workers->threads));
+    if (!workers->threads)
+        goto error;
+    if (pthread_mutex_init(&workers->mutex, NULL))
+        goto error;
+    if (pthread_cond_init(&workers->ready, NULL)) {
+        pthread_mutex_destroy(&workers->mutex);
+        goto error;
+    }
+    if (pthread_cond_init(&workers->done, NULL)) {
+        pthread_cond_destroy(&workers->ready);
+        pthread_mutex_destroy(&workers->mutex);
+        goto error;
+    }
+    for (; workers->count < thread_count; workers->count++)
+        if (pthread_create(&workers->threads[workers->count], NULL,
+                           cx_writer_workers_thread, workers)) {
+            cx_writer_workers_free(workers);
+            return NULL;
+        }
+    return workers;
+error:
+    free(workers->threads);
+    free(workers);
+    return NULL;
+}
+
+// compress the chunks on the workers, and write them in order as they're
+// compressed
+static bool cx_row_group_writer_put_parallel(
+    struct cx_row_group_writer *writer, struct cx_writer_chunk *chunks,
+    size_t chunk_count)
+{
+    struct cx_writer_workers *workers = writer->workers;
+    bool error = false;
+    pthread_mutex_lock(&workers->mutex);
+    workers->chunks = chunks;
+    workers->chunk_count = chunk_count;
+    workers->position = 0;
+    workers->written = 0;
+    workers->pending = chunk_count;
+    workers->generation++;
+    pthread_cond_broadcast(&workers->ready);
+    for (size_t i = 0; i < chunk_count && !error; i++) {
+        while (!chunks[i].done)
+            pthread_cond_wait(&workers->done, &workers->mutex);
+        pthread_mutex_unlock(&workers->mutex);
+        error = chunks[i].error ||
+                !cx_row_group_writer_write_chunk(writer, &chunks[i]);
+        pthread_mutex_lock(&workers->mutex);
+        workers->written = i + 1;
+        pthread_cond_broadcast(&workers->ready);
+    }
+    // chunks that no worker has picked up are dropped, and the workers
+    // release the rest whether they've been written or not
+    workers->pending -= workers->chunk_count - workers->position;
+    workers->chunk_count = workers->position;
+    workers->written = workers->position;
+    pthread_cond_broadcast(&workers->ready);
+    while (workers->pending)
+        pthread_cond_wait(&workers->done, &workers->mutex);
+    workers->chunks = NULL;
+    workers->chunk_count = 0;
+    workers->written = 0;
+    pthread_mutex_unlock(&workers->mutex);
+    return !error;
+}
+
+bool cx_row_group_writer_set_threads(struct cx_row_group_writer *writer,
+                                     int thread_count)
+{
+    if (thread_count <= 0)
+        return false;
+    if (writer->workers)
+        cx_writer_workers_free(writer->workers);
+    writer->workers = NULL;
+    if (thread_count == 1)
+        return true;
+    writer->workers = cx_writer_workers_new(writer, thread_count);
+    return writer->workers != NULL;
+}
+
 bool cx_row_group_writer_put(struct cx_row_group_writer *writer,
                              struct cx_row_group *row_group)
 {
@@ -476,14 +1703,24 @@ bool cx_row_group_writer_put(struct cx_row_group_writer *writer,
     if (!cx_row_group_writer_ensure_header(writer))
         return false;
 
+    if (writer->dictionaries.size && !writer->dictionaries.columns) {
+        writer->dictionaries.columns =
+            calloc(column_count, sizeof(*writer->dictionaries.columns));
+        if (!writer->dictionaries.columns)
+            return false;
+    }
+
     size_t row_group_offset = cx_row_group_writer_offset(writer);
 
     size_t headers_size = 2 * column_count * sizeof(struct cx_column_header);
     struct cx_column_header *headers = calloc(column_count, headers_size);
-    if (!headers)
+    struct cx_writer_chunk *chunks =
+        calloc(2 * column_count, sizeof(*chunks));
+    if (!headers || !chunks)
         goto error;
 
-    // write columns
+    // a chunk for the values and null bitmap of each column, in the order
+    // they're written
     for (size_t i = 0; i < column_count; i++) {
         const struct cx_column_descriptor *descriptor =
             &writer->columns.descriptors[i];
@@ -491,17 +1728,41 @@ bool cx_row_group_writer_put(struct cx_row_group_writer *writer,
         const struct cx_column *nulls = cx_row_group_nulls(row_group, i);
         if (!column || !nulls)
             goto error;
-        const struct cx_index *index = cx_row_group_column_index(row_group, i);
-        const struct cx_index *nulls_index =
-            cx_row_group_column_index(row_group, i);
-        if (!cx_row_group_writer_put_column(
-                writer, column, index, &headers[i * 2], descriptor->compression,
-                descriptor->compression_level))
-            goto error;
-        if (!cx_row_group_writer_put_column(
-                writer, nulls, nulls_index, &headers[i * 2 + 1],
-                CX_NULL_COMPRESSION_TYPE, CX_NULL_COMPRESSION_LEVEL))
+        struct cx_writer_chunk *chunk = &chunks[i * 2];
+        chunk->column = column;
+        chunk->nulls = nulls;
+        chunk->index = cx_row_group_column_index(row_group, i);
+        chunk->header = &headers[i * 2];
+        chunk->encoding = descriptor->encoding;
+        chunk->compression = descriptor->compression;
+        chunk->compression_level = descriptor->compression_level;
+        chunk->page_size = descriptor->page_size;
+        if (writer->dictionaries.columns &&
+            descriptor->compression == CX_COMPRESSION_ZSTD)
+            chunk->trainer = &writer->dictionaries.columns[i];
+        struct cx_writer_chunk *nulls_chunk = &chunks[i * 2 + 1];
+        nulls_chunk->index = cx_row_group_null_index(row_group, i);
+        nulls_chunk->header = &headers[i * 2 + 1];
+        nulls_chunk->encoding = CX_NULL_ENCODING_TYPE;
+        nulls_chunk->compression = CX_NULL_COMPRESSION_TYPE;
+        nulls_chunk->compression_level = CX_NULL_COMPRESSION_LEVEL;
+        // the null bitmap of a column without nulls isn't stored
+        if (nulls_chunk->index->max.bit)
+            nulls_chunk->column = nulls;
+    }
+
+    // write columns
+    if (writer->workers) {
+        if (!cx_row_group_writer_put_parallel(writer, chunks,
+                                              2 * column_count))
             goto error;
+    } else {
+        for (size_t i = 0; i < 2 * column_count; i++) {
+            if (!cx_row_group_writer_compress(writer, &chunks[i]) ||
+                !cx_row_group_writer_write_chunk(writer, &chunks[i]))
+                goto error;
+            cx_writer_chunk_release(&chunks[i]);
+        }
     }
 
     // update the row group header
@@ -517,10 +1778,33 @@ bool cx_row_group_writer_put(struct cx_row_group_writer *writer,
 
     writer->row_count += cx_row_group_row_count(row_group);
 
+    // train the dictionaries once there are enough samples
+    for (size_t i = 0; writer->dictionaries.columns && i < column_count;
+         i++) {
+        const struct cx_column_descriptor *descriptor =
+            &writer->columns.descriptors[i];
+        struct cx_writer_dictionary *dictionary =
+            &writer->dictionaries.columns[i];
+        if (descriptor->compression != CX_COMPRESSION_ZSTD ||
+            dictionary->done)
+            continue;
+        dictionary->row_groups++;
+        if (dictionary->samples_size >=
+                writer->dictionaries.size * CX_DICTIONARY_SAMPLE_RATIO ||
+            dictionary->row_groups >= CX_DICTIONARY_ROW_GROUPS)
+            cx_writer_dictionary_train(dictionary, writer->dictionaries.size,
+                                       descriptor->compression_level);
+    }
+
+    free(chunks);
     free(headers);
     return true;
 error:
     cx_row_group_writer_seek(writer, row_group_offset);
+    if (chunks)
+        for (size_t i = 0; i < 2 * column_count; i++)
+            cx_writer_chunk_release(&chunks[i]);
+    free(chunks);
     free(headers);
     return false;
 }
@@ -534,6 +1818,7 @@ bool cx_row_group_writer_finish(struct cx_row_group_writer *writer, bool sync)
 
     int32_t metadata_id = -1;
     size_t offset = cx_row_group_writer_offset(writer);
+    struct cx_dictionary_header *dictionaries = NULL;
 
     // write metadata to the string repository
     if (writer->strings.metadata) {
@@ -544,7 +1829,32 @@ bool cx_row_group_writer_finish(struct cx_row_group_writer *writer, bool sync)
         metadata_id = id;
     }
 
+    // write dictionaries
+    size_t column_count = writer->columns.count;
+    for (size_t i = 0; writer->dictionaries.columns && i < column_count; i++) {
+        // a dictionary trained after the last chunk isn't stored
+        const struct cx_writer_dictionary *trainer =
+            &writer->dictionaries.columns[i];
+        if (!trainer->used)
+            continue;
+        if (!dictionaries) {
+            dictionaries = calloc(column_count, sizeof(*dictionaries));
+            if (!dictionaries)
+                goto error;
+        }
+        size_t size;
+        const void *data =
+            cx_zstd_dictionary_export(trainer->dictionary, &size);
+        dictionaries[i].offset =
+            cx_write_align(cx_row_group_writer_offset(writer));
+        dictionaries[i].size = size;
+        if (!cx_row_group_writer_write(writer, data, size))
+            goto error;
+    }
+
     // write strings
+    size_t strings_offset =
+        cx_write_align(cx_row_group_writer_offset(writer));
     size_t strings_size;
     const void *strings =
         cx_column_export(writer->strings.column, &strings_size);
@@ -565,24 +1875,30 @@ bool cx_row_group_writer_finish(struct cx_row_group_writer *writer, bool sync)
                                    column_descriptors_size))
         goto error;
 
+    // write dictionary headers
+    size_t dictionaries_size =
+        dictionaries ? column_count * sizeof(*dictionaries) : 0;
+    if (!cx_row_group_writer_write(writer, dictionaries, dictionaries_size))
+        goto error;
+
     // write the footer
-    struct cx_footer footer = {offset,
+    struct cx_footer footer = {strings_offset,
                                strings_size,
                                metadata_id,
                                0,
                                writer->row_groups.count,
                                writer->columns.count,
                                writer->row_count,
-                               sizeof(footer),
+                               sizeof(footer) + dictionaries_size,
                                CX_FILE_VERSION,
                                CX_FILE_MAGIC};
     if (!cx_row_group_writer_write(writer, &footer, sizeof(footer)))
         goto error;
 
-    // set the file size
-    int fd = fileno(writer->file);
-    if (ftruncate(fd, cx_row_group_writer_offset(writer)))
+    // write out the buffer and set the file size
+    if (!cx_writer_file_finish(&writer->file))
         goto error;
+    int fd = writer->file.fd;
 
     // sync the file
     if (sync) {
@@ -596,14 +1912,18 @@ bool cx_row_group_writer_finish(struct cx_row_group_writer *writer, bool sync)
     }
 
     writer->footer_written = true;
+    free(dictionaries);
     return true;
 error:
     cx_row_group_writer_seek(writer, offset);
+    free(dictionaries);
     return false;
 }
 
 void cx_row_group_writer_free(struct cx_row_group_writer *writer)
 {
+    if (writer->workers)
+        cx_writer_workers_free(writer->workers);
     if (writer->strings.metadata)
         free(writer->strings.metadata);
     cx_column_free(writer->strings.column);
@@ -611,6 +1931,22 @@ void cx_row_group_writer_free(struct cx_row_group_writer *writer)
         free(writer->columns.descriptors);
     if (writer->row_groups.headers)
         free(writer->row_groups.headers);
-    fclose(writer->file);
+    if (writer->dictionaries.columns) {
+        for (size_t i = 0; i < writer->columns.count; i++) {
+            struct cx_writer_dictionary *dictionary =
+                &writer->dictionaries.columns[i];
+            if (dictionary->dictionary)
+                cx_zstd_dictionary_free(dictionary->dictionary);
+            free(dictionary->samples);
+            free(dictionary->sample_sizes);
+        }
+        free(writer->dictionaries.columns);
+    }
+    // as with stdio, what was written is kept even if the file wasn't
+    // finished
+    if (!writer->footer_written)
+        cx_writer_file_finish(&writer->file);
+    close(writer->file.fd);
+    free(writer->file.buffer);
     free(writer);
 }
@@ -19,6 +19,40 @@ CX_EXPORT bool cx_writer_add_column(struct cx_writer *, const char *name,
                                     enum cx_column_type, enum cx_encoding_type,
                                     enum cx_compression_type, int level);
 
+// add a column whose chunks are split into pages of page_size rows (a
+// multiple of CX_BATCH_SIZE_MAX), each compressed on its own so that
+// readers only decompress the pages they need
+CX_EXPORT bool cx_writer_add_column_paged(struct cx_writer *,
+                                          const char *name,
+                                          enum cx_column_type,
+                                          enum cx_encoding_type,
+                                          enum cx_compression_type, int level,
+                                          size_t page_size);
+
+// compress the column chunks of each row group on thread_count threads.
+// chunks are still written in column order, so the file is the same as one
+// written on a single thread (the default)
+CX_EXPORT bool cx_writer_set_threads(struct cx_writer *, int thread_count);
+
+// flush full row groups on a background thread, so that puts carry on into
+// a fresh set of buffers. up to in_flight row groups are buffered for the
+// flusher before puts wait for it (zero flushes row groups synchronously,
+// the default). a row group that fails to flush fails the next put, or
+// cx_writer_finish
+CX_EXPORT bool cx_writer_set_async(struct cx_writer *, size_t in_flight);
+
+// write the file with direct IO (O_DIRECT, or F_NOCACHE on macOS), so
+// that it bypasses the page cache. suits files that won't be read back on
+// the same host. fails where the file system doesn't support direct IO.
+// must be called before the first row group is written
+CX_EXPORT bool cx_writer_set_direct(struct cx_writer *, bool direct);
+
+// train a ZSTD dictionary of up to size bytes for each CX_COMPRESSION_ZSTD
+// column, from the first row groups written. the dictionary is stored once
+// in the file and the chunks written after it's trained are compressed
+// with it. must be called before the first row group is written
+CX_EXPORT bool cx_writer_train_dictionaries(struct cx_writer *, size_t size);
+
 CX_EXPORT bool cx_writer_put_bit(struct cx_writer *, size_t, bool);
 CX_EXPORT bool cx_writer_put_i32(struct cx_writer *, size_t, int32_t);
 CX_EXPORT bool cx_writer_put_i64(struct cx_writer *, size_t, int64_t);
@@ -27,6 +61,33 @@ CX_EXPORT bool cx_writer_put_dbl(struct cx_writer *, size_t, double);
 CX_EXPORT bool cx_writer_put_str(struct cx_writer *, size_t, const char *);
 CX_EXPORT bool cx_writer_put_null(struct cx_writer *, size_t);
 
+// put count rows of a column at once. as with the puts above, a put to the
+// first column starts the rows, and the other columns are expected to
+// follow with the same number of rows. rows set in the nulls bitset (if
+// provided) are null. string i of a packed string array spans
+// data[offsets[i]] to data[offsets[i + 1]], and can't contain a NUL byte
+// (as with cx_writer_put_str, strings are stored NUL-terminated). rows are
+// split across row groups as needed
+CX_EXPORT bool cx_writer_put_bit_array(struct cx_writer *, size_t,
+                                       const uint64_t *values,
+                                       const uint64_t *nulls, size_t count);
+CX_EXPORT bool cx_writer_put_i32_array(struct cx_writer *, size_t,
+                                       const int32_t *values,
+                                       const uint64_t *nulls, size_t count);
+CX_EXPORT bool cx_writer_put_i64_array(struct cx_writer *, size_t,
+                                       const int64_t *values,
+                                       const uint64_t *nulls, size_t count);
+CX_EXPORT bool cx_writer_put_flt_array(struct cx_writer *, size_t,
+                                       const float *values,
+                                       const uint64_t *nulls, size_t count);
+CX_EXPORT bool cx_writer_put_dbl_array(struct cx_writer *, size_t,
+                                       const double *values,
+                                       const uint64_t *nulls, size_t count);
+CX_EXPORT bool cx_writer_put_str_array(struct cx_writer *, size_t,
+                                       const uint32_t *offsets,
+                                       const char *data,
+                                       const uint64_t *nulls, size_t count);
+
 CX_EXPORT bool cx_writer_finish(struct cx_writer *, bool sync);
 
 struct cx_row_group_writer;
@@ -42,6 +103,23 @@ CX_EXPORT bool cx_row_group_writer_add_column(
     struct cx_row_group_writer *, const char *name, enum cx_column_type,
     enum cx_encoding_type, enum cx_compression_type, int level);
 
+CX_EXPORT bool cx_row_group_writer_add_column_paged(
+    struct cx_row_group_writer *, const char *name, enum cx_column_type,
+    enum cx_encoding_type, enum cx_compression_type, int level,
+    size_t page_size);
+
+// see cx_writer_set_threads
+CX_EXPORT bool cx_row_group_writer_set_threads(struct cx_row_group_writer *,
+                                               int thread_count);
+
+// see cx_writer_set_direct
+CX_EXPORT bool cx_row_group_writer_set_direct(struct cx_row_group_writer *,
+                                              bool direct);
+
+// see cx_writer_train_dictionaries
+CX_EXPORT bool cx_row_group_writer_train_dictionaries(
+    struct cx_row_group_writer *, size_t size);
+
 CX_EXPORT bool cx_row_group_writer_put(struct cx_row_group_writer *,
                                        struct cx_row_group *);
 
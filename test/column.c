@@ -360,6 +360,231 @@ static MunitResult test_str_cursor(const MunitParameter params[], void *fixture)
     return MUNIT_OK;
 }
 
+static MunitResult test_reset(const MunitParameter params[], void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    size_t size;
+    const void *buffer = cx_column_export(col, &size);
+    cx_column_reset(col);
+    assert_size(cx_column_count(col), ==, 0);
+    cx_column_export(col, &size);
+    assert_size(size, ==, 0);
+
+    // the buffer is reused without growing
+    assert_true(cx_column_reserve(col, COUNT));
+    for (int32_t i = 0; i < COUNT; i++)
+        assert_true(cx_column_put_i32(col, COUNT - i));
+    assert_ptr_equal(cx_column_export(col, &size), buffer);
+    assert_size(size, ==, sizeof(int32_t) * COUNT);
+
+    struct cx_column_cursor *cursor = cx_column_cursor_new(col);
+    assert_not_null(cursor);
+    size_t position = 0, count;
+    while (cx_column_cursor_valid(cursor)) {
+        const int32_t *values = cx_column_cursor_next_batch_i32(cursor, &count);
+        for (size_t i = 0; i < count; i++, position++)
+            assert_int32(values[i], ==, COUNT - position);
+    }
+    assert_size(position, ==, COUNT);
+    cx_column_cursor_free(cursor);
+
+    // bits of the previous values aren't carried over
+    struct cx_column *bits = cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+    assert_not_null(bits);
+    assert_true(cx_column_reserve(bits, COUNT));
+    for (size_t i = 0; i < 100; i++)
+        assert_true(cx_column_put_bit(bits, true));
+    cx_column_reset(bits);
+    for (size_t i = 0; i < 100; i++)
+        assert_true(cx_column_put_bit(bits, i % 2));
+    const uint64_t *words = cx_column_export(bits, &size);
+    assert_size(size, ==, 2 * sizeof(uint64_t));
+    assert_uint64(words[0], ==, 0xAAAAAAAAAAAAAAAAULL);
+    assert_uint64(words[1], ==, 0xAAAAAAAAAULL);
+    cx_column_free(bits);
+    return MUNIT_OK;
+}
+
+static void assert_columns_equal(const struct cx_column *a,
+                                 const struct cx_column *b)
+{
+    size_t a_size, b_size;
+    const void *a_buffer = cx_column_export(a, &a_size);
+    const void *b_buffer = cx_column_export(b, &b_size);
+    assert_size(cx_column_count(a), ==, cx_column_count(b));
+    assert_size(a_size, ==, b_size);
+    assert_memory_equal(a_size, a_buffer, b_buffer);
+}
+
+static MunitResult test_put_arrays(const MunitParameter params[],
+                                   void *fixture)
+{
+    // puts are split so that they start part way through a bitset word
+    const size_t pieces[] = {1, 63, 100, 947};
+    uint64_t bits[(COUNT + 63) / 64] = {0};
+    uint64_t nulls[(COUNT + 63) / 64] = {0};
+    int64_t i64s[COUNT];
+    uint32_t offsets[COUNT + 1] = {0};
+    char data[COUNT * 8];
+    char string[8];
+    for (size_t i = 0; i < COUNT; i++) {
+        if (i % 3 == 0)
+            bits[i / 64] |= (uint64_t)1 << (i % 64);
+        if (i % 7 == 0)
+            nulls[i / 64] |= (uint64_t)1 << (i % 64);
+        i64s[i] = i * 1000;
+        sprintf(string, "s%zu", i);
+        memcpy(data + offsets[i], string, strlen(string));
+        offsets[i + 1] = offsets[i] + strlen(string);
+    }
+
+    struct cx_column *bit = cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+    struct cx_column *i64 = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    struct cx_column *str = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_true(bit && i64 && str);
+    for (size_t i = 0; i < COUNT; i++) {
+        if (i % 7 == 0) {
+            assert_true(cx_column_put_unit(bit));
+            assert_true(cx_column_put_unit(i64));
+            assert_true(cx_column_put_unit(str));
+            continue;
+        }
+        assert_true(cx_column_put_bit(bit, i % 3 == 0));
+        assert_true(cx_column_put_i64(i64, i * 1000));
+        sprintf(string, "s%zu", i);
+        assert_true(cx_column_put_str(str, string));
+    }
+
+    struct cx_column *bit_array =
+        cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+    struct cx_column *i64_array =
+        cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    struct cx_column *str_array =
+        cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_true(bit_array && i64_array && str_array);
+    size_t start = 0;
+    for (size_t i = 0; i < sizeof(pieces) / sizeof(*pieces); i++) {
+        // the bitsets of a piece start at the start of a word
+        uint64_t piece_bits[(COUNT + 63) / 64] = {0};
+        uint64_t piece_nulls[(COUNT + 63) / 64] = {0};
+        for (size_t j = 0; j < pieces[i]; j++) {
+            size_t row = start + j;
+            if (bits[row / 64] & ((uint64_t)1 << (row % 64)))
+                piece_bits[j / 64] |= (uint64_t)1 << (j % 64);
+            if (nulls[row / 64] & ((uint64_t)1 << (row % 64)))
+                piece_nulls[j / 64] |= (uint64_t)1 << (j % 64);
+        }
+        assert_true(cx_column_put_bit_array(bit_array, piece_bits,
+                                            piece_nulls, pieces[i]));
+        assert_true(cx_column_put_i64_array(i64_array, i64s + start,
+                                            piece_nulls, pieces[i]));
+        assert_true(cx_column_put_str_array(str_array, offsets + start, data,
+                                            piece_nulls, pieces[i]));
+        start += pieces[i];
+    }
+    assert_size(start, ==, COUNT);
+    assert_columns_equal(bit_array, bit);
+    assert_columns_equal(i64_array, i64);
+    assert_columns_equal(str_array, str);
+
+    // a NULL bit array appends false values
+    assert_true(cx_column_put_bit_array(bit_array, NULL, NULL, 100));
+    for (size_t i = 0; i < 100; i++)
+        assert_true(cx_column_put_bit(bit, false));
+    assert_columns_equal(bit_array, bit);
+
+    // strings are stored NUL-terminated, so they can't contain a NUL
+    const uint32_t nul_offsets[] = {0, 2, 7};
+    const char nul_data[] = "abcd\0ef";
+    const uint64_t nul_null = 0x2;
+    size_t str_size;
+    cx_column_export(str_array, &str_size);
+    assert_false(
+        cx_column_put_str_array(str_array, nul_offsets, nul_data, NULL, 2));
+    assert_size(cx_column_count(str_array), ==, COUNT);
+    size_t size;
+    cx_column_export(str_array, &size);
+    assert_size(size, ==, str_size);
+    // unless the row is null
+    assert_true(cx_column_put_str_array(str_array, nul_offsets, nul_data,
+                                        &nul_null, 2));
+    assert_true(cx_column_put_str(str, "ab"));
+    assert_true(cx_column_put_unit(str));
+    assert_columns_equal(str_array, str);
+
+    assert_false(cx_column_put_i32_array(i64_array, NULL, NULL, 1));
+    assert_false(cx_column_put_i64_array(str_array, i64s, NULL, 1));
+
+    cx_column_free(bit);
+    cx_column_free(i64);
+    cx_column_free(str);
+    cx_column_free(bit_array);
+    cx_column_free(i64_array);
+    cx_column_free(str_array);
+    return MUNIT_OK;
+}
+
+static MunitResult test_split(const MunitParameter params[], void *fixture)
+{
+    const size_t starts[] = {0, 64, 100, COUNT};
+    for (size_t i = 0; i < sizeof(starts) / sizeof(*starts); i++) {
+        struct cx_column *bit = setup_bit(params, NULL);
+        struct cx_column *str = setup_str(params, NULL);
+        struct cx_column *bit_rest =
+            cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+        struct cx_column *str_rest =
+            cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+        assert_true(bit_rest && str_rest);
+        // the values are appended to those already in the column
+        assert_true(cx_column_put_bit(bit_rest, true));
+        assert_true(cx_column_put_str(str_rest, "x"));
+        assert_true(cx_column_split(bit, starts[i], bit_rest));
+        assert_true(cx_column_split(str, starts[i], str_rest));
+
+        struct cx_column *bit_expected =
+            cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+        struct cx_column *str_expected =
+            cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+        struct cx_column *bit_rest_expected =
+            cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+        struct cx_column *str_rest_expected =
+            cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+        assert_true(cx_column_put_bit(bit_rest_expected, true));
+        assert_true(cx_column_put_str(str_rest_expected, "x"));
+        char buffer[16];
+        for (size_t j = 0; j < COUNT; j++) {
+            sprintf(buffer, "cx %zu", j);
+            bool value = j % 5 == 0;
+            if (j < starts[i]) {
+                assert_true(cx_column_put_bit(bit_expected, value));
+                assert_true(cx_column_put_str(str_expected, buffer));
+            } else {
+                assert_true(cx_column_put_bit(bit_rest_expected, value));
+                assert_true(cx_column_put_str(str_rest_expected, buffer));
+            }
+        }
+        assert_columns_equal(bit, bit_expected);
+        assert_columns_equal(str, str_expected);
+        assert_columns_equal(bit_rest, bit_rest_expected);
+        assert_columns_equal(str_rest, str_rest_expected);
+
+        // values put after the split follow on from the values left
+        assert_true(cx_column_put_bit(bit, true));
+        assert_true(cx_column_put_bit(bit_expected, true));
+        assert_columns_equal(bit, bit_expected);
+
+        cx_column_free(bit);
+        cx_column_free(str);
+        cx_column_free(bit_rest);
+        cx_column_free(str_rest);
+        cx_column_free(bit_expected);
+        cx_column_free(str_expected);
+        cx_column_free(bit_rest_expected);
+        cx_column_free(str_rest_expected);
+    }
+    return MUNIT_OK;
+}
+
 MunitTest column_tests[] = {
     {"/export", test_export, setup_i32, teardown, MUNIT_TEST_OPTION_NONE, NULL},
     {"/import-mmapped", test_import_mmapped, setup_i32, teardown,
@@ -390,4 +615,8 @@ MunitTest column_tests[] = {
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/str-cursor", test_str_cursor, setup_str, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
+    {"/reset", test_reset, setup_i32, teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/put-arrays", test_put_arrays, NULL, NULL, MUNIT_TEST_OPTION_NONE,
+     NULL},
+    {"/split", test_split, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
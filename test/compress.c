@@ -1,6 +1,10 @@
 #include "compress.h"
 
+#include <pthread.h>
+#include <string.h>
+
 #include "helpers.h"
+#include "pool.h"
 
 #define BUFFER_SIZE 11111
 
@@ -44,7 +48,90 @@ static MunitResult test_zstd(const MunitParameter params[], void *buffer)
     return MUNIT_OK;
 }
 
+static MunitResult test_lz4hc(const MunitParameter params[], void *buffer)
+{
+    test_compression(buffer, CX_COMPRESSION_LZ4HC, 1);
+    test_compression(buffer, CX_COMPRESSION_LZ4HC, 9);
+    return MUNIT_OK;
+}
+
+static MunitResult test_pool(const MunitParameter params[], void *buffer)
+{
+    size_t capacity;
+    void *pooled = cx_pool_get(1000, &capacity);
+    assert_not_null(pooled);
+    assert_size(capacity, ==, 1000);
+    cx_pool_put(pooled, capacity);
+
+    // a released buffer is reused when it fits, and isn't wastefully large
+    void *small = cx_pool_get(100, &capacity);
+    assert_not_null(small);
+    assert_ptr_not_equal(small, pooled);
+    void *reused = cx_pool_get(900, &capacity);
+    assert_ptr_equal(reused, pooled);
+    assert_size(capacity, ==, 1000);
+    cx_pool_put(reused, capacity);
+    cx_pool_put(small, 100);
+
+    // pooled compression buffers
+    size_t compressed_size;
+    void *compressed =
+        cx_compress_pooled(CX_COMPRESSION_ZSTD, 1, NULL, buffer, BUFFER_SIZE,
+                           &compressed_size, &capacity);
+    assert_not_null(compressed);
+    assert_size(capacity, >=, compressed_size);
+    unsigned char *decompressed = malloc(BUFFER_SIZE);
+    assert_not_null(decompressed);
+    assert_true(cx_decompress(CX_COMPRESSION_ZSTD, compressed,
+                              compressed_size, decompressed, BUFFER_SIZE));
+    assert_memory_equal(BUFFER_SIZE, decompressed, buffer);
+    free(decompressed);
+    cx_pool_put(compressed, capacity);
+    return MUNIT_OK;
+}
+
+static void *compress_thread(void *buffer)
+{
+    // each thread has its own codec contexts
+    enum cx_compression_type types[] = {
+        CX_COMPRESSION_LZ4, CX_COMPRESSION_LZ4HC, CX_COMPRESSION_ZSTD};
+    unsigned char decompressed[BUFFER_SIZE];
+    for (size_t i = 0; i < 50; i++) {
+        enum cx_compression_type type = types[i % 3];
+        size_t compressed_size, capacity;
+        void *compressed =
+            cx_compress_pooled(type, 1, NULL, buffer, BUFFER_SIZE,
+                               &compressed_size, &capacity);
+        if (!compressed)
+            return NULL;
+        bool ok = cx_decompress(type, compressed, compressed_size,
+                                decompressed, BUFFER_SIZE) &&
+                  !memcmp(decompressed, buffer, BUFFER_SIZE);
+        cx_pool_put(compressed, capacity);
+        if (!ok)
+            return NULL;
+    }
+    return buffer;
+}
+
+static MunitResult test_threads(const MunitParameter params[], void *buffer)
+{
+    pthread_t threads[4];
+    for (size_t i = 0; i < 4; i++)
+        assert_int(pthread_create(&threads[i], NULL, compress_thread, buffer),
+                   ==, 0);
+    for (size_t i = 0; i < 4; i++) {
+        void *result;
+        assert_int(pthread_join(threads[i], &result), ==, 0);
+        assert_ptr_equal(result, buffer);
+    }
+    return MUNIT_OK;
+}
+
 MunitTest compress_tests[] = {
     {"/lz4", test_lz4, setup, free, MUNIT_TEST_OPTION_NONE, NULL},
     {"/zstd", test_zstd, setup, free, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/lz4hc", test_lz4hc, setup, free, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/pool", test_pool, setup, free, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/threads", test_threads, setup, free, MUNIT_TEST_OPTION_NONE, NULL},
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
@@ -0,0 +1,1386 @@
+#include "encode.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "file.h"
+#include "fsst.h"
+#include "helpers.h"
+
+#define COUNT 1000
+#define CARDINALITY 7
+
+static void *setup(const MunitParameter params[], void *data)
+{
+    struct cx_column *col = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(col);
+    char buffer[64];
+    for (size_t i = 0; i < COUNT; i++) {
+        sprintf(buffer, "cx %zu", (i * 3) % CARDINALITY);
+        assert_true(cx_column_put_str(col, buffer));
+    }
+    return col;
+}
+
+static void teardown(void *fixture)
+{
+    cx_column_free((struct cx_column *)fixture);
+}
+
+static MunitResult test_supported(const MunitParameter params[], void *fixture)
+{
+    assert_true(cx_encoding_supported(CX_COLUMN_I32, CX_ENCODING_NONE));
+    assert_true(cx_encoding_supported(CX_COLUMN_STR, CX_ENCODING_NONE));
+    assert_true(cx_encoding_supported(CX_COLUMN_STR, CX_ENCODING_DICT));
+    assert_false(cx_encoding_supported(CX_COLUMN_BIT, CX_ENCODING_DICT));
+    assert_false(cx_encoding_supported(CX_COLUMN_I32, CX_ENCODING_DICT));
+    assert_false(cx_encoding_supported(CX_COLUMN_DBL, CX_ENCODING_DICT));
+    assert_true(cx_encoding_supported(CX_COLUMN_BIT, CX_ENCODING_RLE));
+    assert_true(cx_encoding_supported(CX_COLUMN_I32, CX_ENCODING_RLE));
+    assert_true(cx_encoding_supported(CX_COLUMN_I64, CX_ENCODING_RLE));
+    assert_false(cx_encoding_supported(CX_COLUMN_FLT, CX_ENCODING_RLE));
+    assert_false(cx_encoding_supported(CX_COLUMN_STR, CX_ENCODING_RLE));
+    assert_true(cx_encoding_supported(CX_COLUMN_I64, CX_ENCODING_DELTA));
+    assert_true(
+        cx_encoding_supported(CX_COLUMN_I64, CX_ENCODING_DELTA_OF_DELTA));
+    assert_false(cx_encoding_supported(CX_COLUMN_I32, CX_ENCODING_DELTA));
+    assert_false(
+        cx_encoding_supported(CX_COLUMN_DBL, CX_ENCODING_DELTA_OF_DELTA));
+    assert_true(cx_encoding_supported(CX_COLUMN_I32, CX_ENCODING_BITPACK));
+    assert_true(cx_encoding_supported(CX_COLUMN_I64, CX_ENCODING_BITPACK));
+    assert_false(cx_encoding_supported(CX_COLUMN_BIT, CX_ENCODING_BITPACK));
+    assert_false(cx_encoding_supported(CX_COLUMN_FLT, CX_ENCODING_BITPACK));
+    assert_true(cx_encoding_supported(CX_COLUMN_FLT, CX_ENCODING_XOR));
+    assert_true(cx_encoding_supported(CX_COLUMN_DBL, CX_ENCODING_XOR));
+    assert_false(cx_encoding_supported(CX_COLUMN_I64, CX_ENCODING_XOR));
+    assert_true(
+        cx_encoding_supported(CX_COLUMN_DBL, CX_ENCODING_BYTE_STREAM_SPLIT));
+    assert_false(
+        cx_encoding_supported(CX_COLUMN_I32, CX_ENCODING_BYTE_STREAM_SPLIT));
+    assert_true(cx_encoding_supported(CX_COLUMN_STR, CX_ENCODING_OFFSETS));
+    assert_false(cx_encoding_supported(CX_COLUMN_I64, CX_ENCODING_OFFSETS));
+    assert_true(cx_encoding_supported(CX_COLUMN_STR, CX_ENCODING_FSST));
+    assert_false(cx_encoding_supported(CX_COLUMN_DBL, CX_ENCODING_FSST));
+    assert_true(cx_encoding_supported(CX_COLUMN_BIT, CX_ENCODING_CONSTANT));
+    assert_true(cx_encoding_supported(CX_COLUMN_STR, CX_ENCODING_CONSTANT));
+    assert_true(cx_encoding_supported(CX_COLUMN_DBL, CX_ENCODING_SPARSE));
+    assert_false(cx_encoding_supported(CX_COLUMN_BIT, CX_ENCODING_SPARSE));
+
+    struct cx_column *col = cx_column_new(CX_COLUMN_I32, CX_ENCODING_NONE);
+    assert_not_null(col);
+    assert_true(cx_column_put_i32(col, 1));
+    assert_null(cx_encode(col, CX_ENCODING_DICT, NULL));
+    cx_column_free(col);
+    return MUNIT_OK;
+}
+
+static MunitResult test_dict(const MunitParameter params[], void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    struct cx_column *encoded = cx_encode(col, CX_ENCODING_DICT, NULL);
+    assert_not_null(encoded);
+    assert_int(cx_column_type(encoded), ==, CX_COLUMN_STR);
+    assert_int(cx_column_encoding(encoded), ==, CX_ENCODING_DICT);
+    assert_size(cx_column_count(encoded), ==, COUNT);
+    assert_false(cx_column_put_str(encoded, "foo"));  // encoded
+    assert_null(cx_encode(encoded, CX_ENCODING_DICT, NULL));
+
+    size_t size, encoded_size;
+    cx_column_export(col, &size);
+    cx_column_export(encoded, &encoded_size);
+    assert_size(encoded_size, <, size);
+
+    struct cx_column_cursor *cursor = cx_column_cursor_new(encoded);
+    assert_not_null(cursor);
+
+    // the dictionary is sorted
+    size_t dict_size;
+    const struct cx_string *dict = cx_column_cursor_dict(cursor, &dict_size);
+    assert_size(dict_size, ==, CARDINALITY);
+    char expected[64];
+    for (size_t i = 0; i < dict_size; i++) {
+        sprintf(expected, "cx %zu", i);
+        assert_int(dict[i].len, ==, strlen(expected));
+        assert_string_equal(expected, dict[i].ptr);
+    }
+
+    size_t position, count;
+    size_t starting_positions[] = {0, 1, 8, 13, 64, COUNT - 1, COUNT};
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_str(cursor, position), ==, position);
+        while (cx_column_cursor_valid(cursor)) {
+            const struct cx_string *strings =
+                cx_column_cursor_next_batch_str(cursor, &count);
+            for (size_t j = 0; j < count; j++) {
+                sprintf(expected, "cx %zu", ((j + position) * 3) % CARDINALITY);
+                assert_int(strings[j].len, ==, strlen(expected));
+                assert_string_equal(expected, strings[j].ptr);
+            }
+            position += count;
+        }
+        assert_size(position, ==, COUNT);
+        cx_column_cursor_rewind(cursor);
+    }
+
+    position = 0;
+    while (cx_column_cursor_valid(cursor)) {
+        const int32_t *codes =
+            cx_column_cursor_next_batch_codes(cursor, &count);
+        for (size_t j = 0; j < count; j++) {
+            int32_t expected = ((j + position) * 3) % CARDINALITY;
+            assert_int32(codes[j], ==, expected);
+        }
+        position += count;
+    }
+    assert_size(position, ==, COUNT);
+
+    cx_column_cursor_free(cursor);
+    cx_column_free(encoded);
+    return MUNIT_OK;
+}
+
+static MunitResult test_dict_invalid(const MunitParameter params[],
+                                     void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    struct cx_column *encoded = cx_encode(col, CX_ENCODING_DICT, NULL);
+    assert_not_null(encoded);
+    size_t size;
+    const void *ptr = cx_column_export(encoded, &size);
+
+    // a code outside of the dictionary is rejected
+    void *dest;
+    struct cx_column *copy = cx_column_new_compressed(
+        CX_COLUMN_STR, CX_ENCODING_DICT, &dest, size, COUNT);
+    assert_not_null(copy);
+    memcpy(dest, ptr, size);
+    int32_t *codes = (int32_t *)((char *)dest + size - sizeof(int32_t));
+    *codes = CARDINALITY;
+    assert_null(cx_column_cursor_new(copy));
+    cx_column_free(copy);
+
+    // as is a truncated chunk
+    copy = cx_column_new_compressed(CX_COLUMN_STR, CX_ENCODING_DICT, &dest,
+                                    size - sizeof(int32_t), COUNT);
+    assert_not_null(copy);
+    memcpy(dest, ptr, size - sizeof(int32_t));
+    assert_null(cx_column_cursor_new(copy));
+    cx_column_free(copy);
+
+    cx_column_free(encoded);
+    return MUNIT_OK;
+}
+
+static const char *offsets_text =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+static MunitResult test_offsets(const MunitParameter params[], void *fixture)
+{
+    struct cx_column *col = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(col);
+    char expected[64];
+    for (size_t i = 0; i < COUNT; i++) {
+        // every third string is empty
+        sprintf(expected, "%.*s", (int)(i % 3 ? i % 50 : 0), offsets_text);
+        assert_true(cx_column_put_str(col, expected));
+    }
+    struct cx_column *encoded = cx_encode(col, CX_ENCODING_OFFSETS, NULL);
+    assert_not_null(encoded);
+    assert_int(cx_column_encoding(encoded), ==, CX_ENCODING_OFFSETS);
+    assert_size(cx_column_count(encoded), ==, COUNT);
+
+    size_t size, encoded_size;
+    cx_column_export(col, &size);
+    const uint32_t *offsets = cx_column_export(encoded, &encoded_size);
+    assert_size(encoded_size, ==, size + (COUNT + 1) * sizeof(uint32_t));
+    assert_uint32(offsets[0], ==, 0);
+    assert_uint32(offsets[COUNT], ==, size);
+
+    struct cx_column_cursor *cursor = cx_column_cursor_new(encoded);
+    assert_not_null(cursor);
+    size_t position, count;
+    size_t starting_positions[] = {0, 1, 8, 13, 64, COUNT - 1, COUNT};
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_str(cursor, position), ==, position);
+        while (cx_column_cursor_valid(cursor)) {
+            const struct cx_string *strings =
+                cx_column_cursor_next_batch_str(cursor, &count);
+            for (size_t j = 0; j < count; j++) {
+                size_t i = j + position;
+                sprintf(expected, "%.*s", (int)(i % 3 ? i % 50 : 0),
+                        offsets_text);
+                assert_int(strings[j].len, ==, strlen(expected));
+                assert_string_equal(expected, strings[j].ptr);
+            }
+            position += count;
+        }
+        assert_size(position, ==, COUNT);
+        cx_column_cursor_rewind(cursor);
+    }
+    cx_column_cursor_free(cursor);
+
+    // offsets must point at NUL-terminated strings within the chunk
+    uint32_t chunk[4] = {0, 3, 5, 0};
+    memcpy(&chunk[3], "ab\0c", 4);
+    struct cx_column *invalid = cx_column_new_mmapped(
+        CX_COLUMN_STR, CX_ENCODING_OFFSETS, chunk, sizeof(chunk), 2);
+    assert_not_null(invalid);
+    assert_null(cx_column_cursor_new(invalid));
+    cx_column_free(invalid);
+    chunk[2] = 4;
+    invalid = cx_column_new_mmapped(CX_COLUMN_STR, CX_ENCODING_OFFSETS, chunk,
+                                    sizeof(chunk), 2);
+    assert_not_null(invalid);
+    assert_null(cx_column_cursor_new(invalid));
+    cx_column_free(invalid);
+
+    cx_column_free(encoded);
+    cx_column_free(col);
+    return MUNIT_OK;
+}
+
+static void fsst_url(size_t i, char *buffer)
+{
+    static const char *pages[] = {"profile", "settings", "orders", ""};
+    if (i % 17 == 0)
+        buffer[0] = '\0';  // empty strings compress to nothing
+    else
+        sprintf(buffer, "https://www.example.com/users/%zu/%s?ref=%zx", i * 7,
+                pages[i % 4], i * 2654435761u);
+}
+
+static MunitResult test_fsst(const MunitParameter params[], void *fixture)
+{
+    struct cx_column *col = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(col);
+    char expected[128];
+    for (size_t i = 0; i < COUNT; i++) {
+        fsst_url(i, expected);
+        assert_true(cx_column_put_str(col, expected));
+    }
+    struct cx_column *encoded = cx_encode(col, CX_ENCODING_FSST, NULL);
+    assert_not_null(encoded);
+    assert_int(cx_column_encoding(encoded), ==, CX_ENCODING_FSST);
+    assert_size(cx_column_count(encoded), ==, COUNT);
+
+    size_t size, encoded_size;
+    cx_column_export(col, &size);
+    cx_column_export(encoded, &encoded_size);
+    assert_size(encoded_size, <, size * 2 / 3);
+
+    struct cx_column_cursor *cursor = cx_column_cursor_new(encoded);
+    assert_not_null(cursor);
+    size_t position, count;
+    size_t starting_positions[] = {0, 1, 8, 13, 64, COUNT - 1, COUNT};
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_str(cursor, position), ==, position);
+        while (cx_column_cursor_valid(cursor)) {
+            const struct cx_string *strings =
+                cx_column_cursor_next_batch_str(cursor, &count);
+            assert_not_null(strings);
+            for (size_t j = 0; j < count; j++) {
+                fsst_url(j + position, expected);
+                assert_int(strings[j].len, ==, strlen(expected));
+                assert_string_equal(expected, strings[j].ptr);
+            }
+            position += count;
+        }
+        assert_size(position, ==, COUNT);
+        cx_column_cursor_rewind(cursor);
+    }
+
+    // strings are equal only if their compressed forms are
+    const struct cx_fsst_table *table = cx_column_cursor_symbols(cursor);
+    assert_not_null(table);
+    uint8_t literal[256];
+    fsst_url(42, expected);
+    size_t literal_size =
+        cx_fsst_compress(table, expected, strlen(expected), literal);
+    const struct cx_string *compressed =
+        cx_column_cursor_next_batch_compressed(cursor, &count);
+    assert_size(count, ==, 64);
+    for (size_t i = 0; i < count; i++) {
+        bool equal = compressed[i].len == literal_size &&
+                     !memcmp(compressed[i].ptr, literal, literal_size);
+        assert_int(equal, ==, i == 42);
+    }
+    cx_column_cursor_free(cursor);
+
+    // the chunk must hold an offset for every row, and offsets must be
+    // within the compressed strings
+    uint64_t chunk[4] = {0};
+    struct cx_fsst_header *header = (struct cx_fsst_header *)chunk;
+    uint32_t *offsets = (uint32_t *)&chunk[1];
+    offsets[0] = 0;
+    offsets[1] = 8;
+    struct cx_column *invalid = cx_column_new_mmapped(
+        CX_COLUMN_STR, CX_ENCODING_FSST, chunk, sizeof(chunk), 1);
+    assert_not_null(invalid);
+    assert_null(cx_column_cursor_new(invalid));
+    cx_column_free(invalid);
+    offsets[1] = 16;
+    invalid = cx_column_new_mmapped(CX_COLUMN_STR, CX_ENCODING_FSST, chunk,
+                                    sizeof(chunk), 1);
+    assert_not_null(invalid);
+    cursor = cx_column_cursor_new(invalid);
+    assert_not_null(cursor);
+    cx_column_cursor_free(cursor);
+    cx_column_free(invalid);
+    header->symbol_count = CX_FSST_SYMBOLS + 1;
+    invalid = cx_column_new_mmapped(CX_COLUMN_STR, CX_ENCODING_FSST, chunk,
+                                    sizeof(chunk), 1);
+    assert_not_null(invalid);
+    assert_null(cx_column_cursor_new(invalid));
+    cx_column_free(invalid);
+
+    cx_column_free(encoded);
+    cx_column_free(col);
+    return MUNIT_OK;
+}
+
+static bool rle_bit(size_t i)
+{
+    return (i / 70) % 2;
+}
+
+static int32_t rle_i32(size_t i)
+{
+    return i / 10 - 50;
+}
+
+static int64_t rle_i64(size_t i)
+{
+    return (int64_t)(i / 100) * 10000000000LL;
+}
+
+static struct cx_column *rle_encode(struct cx_column *col)
+{
+    struct cx_column *encoded = cx_encode(col, CX_ENCODING_RLE, NULL);
+    assert_not_null(encoded);
+    assert_int(cx_column_type(encoded), ==, cx_column_type(col));
+    assert_int(cx_column_encoding(encoded), ==, CX_ENCODING_RLE);
+    assert_size(cx_column_count(encoded), ==, COUNT);
+    size_t size, encoded_size;
+    cx_column_export(col, &size);
+    cx_column_export(encoded, &encoded_size);
+    assert_size(encoded_size, <, size);
+    cx_column_free(col);
+    return encoded;
+}
+
+static MunitResult test_rle(const MunitParameter params[], void *fixture)
+{
+    struct cx_column *bit = cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+    struct cx_column *i32 = cx_column_new(CX_COLUMN_I32, CX_ENCODING_NONE);
+    struct cx_column *i64 = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    assert_not_null(bit);
+    assert_not_null(i32);
+    assert_not_null(i64);
+    for (size_t i = 0; i < COUNT; i++) {
+        assert_true(cx_column_put_bit(bit, rle_bit(i)));
+        assert_true(cx_column_put_i32(i32, rle_i32(i)));
+        assert_true(cx_column_put_i64(i64, rle_i64(i)));
+    }
+    bit = rle_encode(bit);
+    i32 = rle_encode(i32);
+    i64 = rle_encode(i64);
+    assert_false(cx_column_put_i32(i32, 1));  // encoded
+
+    struct cx_column_cursor *bit_cursor = cx_column_cursor_new(bit);
+    struct cx_column_cursor *i32_cursor = cx_column_cursor_new(i32);
+    struct cx_column_cursor *i64_cursor = cx_column_cursor_new(i64);
+    assert_not_null(bit_cursor);
+    assert_not_null(i32_cursor);
+    assert_not_null(i64_cursor);
+
+    size_t position, count;
+    size_t starting_positions[] = {0, 64, 128, 640, COUNT - COUNT % 64};
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_bit(bit_cursor, position), ==,
+                    position);
+        assert_size(cx_column_cursor_skip_i32(i32_cursor, position + 1), ==,
+                    position + 1);
+        assert_size(cx_column_cursor_skip_i64(i64_cursor, position + 1), ==,
+                    position + 1);
+        for (size_t i = position; cx_column_cursor_valid(bit_cursor);
+             i += count) {
+            const uint64_t *bitset =
+                cx_column_cursor_next_batch_bit(bit_cursor, &count);
+            for (size_t j = 0; j < count; j++)
+                assert_int((*bitset >> j) & 1, ==, rle_bit(i + j));
+            assert_size(i + count, <=, COUNT);
+        }
+        for (size_t i = position + 1; cx_column_cursor_valid(i32_cursor);
+             i += count) {
+            const int32_t *values =
+                cx_column_cursor_next_batch_i32(i32_cursor, &count);
+            for (size_t j = 0; j < count; j++)
+                assert_int32(values[j], ==, rle_i32(i + j));
+        }
+        for (size_t i = position + 1; cx_column_cursor_valid(i64_cursor);
+             i += count) {
+            const int64_t *values =
+                cx_column_cursor_next_batch_i64(i64_cursor, &count);
+            for (size_t j = 0; j < count; j++)
+                assert_int64(values[j], ==, rle_i64(i + j));
+        }
+        cx_column_cursor_rewind(bit_cursor);
+        cx_column_cursor_rewind(i32_cursor);
+        cx_column_cursor_rewind(i64_cursor);
+    }
+
+    // runs are split at batch boundaries
+    size_t run_count, total = 0;
+    while (cx_column_cursor_valid(i32_cursor)) {
+        const struct cx_run *runs =
+            cx_column_cursor_next_batch_runs(i32_cursor, &run_count, &count);
+        size_t length = 0;
+        for (size_t i = 0; i < run_count; i++) {
+            assert_int32(runs[i].value.i32, ==, rle_i32(total + length));
+            length += runs[i].length;
+        }
+        assert_size(length, ==, count);
+        assert_size(count, <=, 64);
+        total += count;
+    }
+    assert_size(total, ==, COUNT);
+
+    cx_column_cursor_free(bit_cursor);
+    cx_column_cursor_free(i32_cursor);
+    cx_column_cursor_free(i64_cursor);
+    cx_column_free(bit);
+    cx_column_free(i32);
+    cx_column_free(i64);
+    return MUNIT_OK;
+}
+
+static MunitResult test_rle_invalid(const MunitParameter params[],
+                                    void *fixture)
+{
+    struct cx_rle_run32 runs[] = {{1, 10}, {2, 20}, {3, 30}};
+    struct cx_column *col = cx_column_new_mmapped(
+        CX_COLUMN_I32, CX_ENCODING_RLE, runs, sizeof(runs), 60);
+    assert_not_null(col);
+    struct cx_column_cursor *cursor = cx_column_cursor_new(col);
+    assert_not_null(cursor);
+    cx_column_cursor_free(cursor);
+    cx_column_free(col);
+
+    // the run lengths must add up to the row count
+    col = cx_column_new_mmapped(CX_COLUMN_I32, CX_ENCODING_RLE, runs,
+                                sizeof(runs), 61);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+
+    // runs can't be empty
+    runs[1].length = 0;
+    col = cx_column_new_mmapped(CX_COLUMN_I32, CX_ENCODING_RLE, runs,
+                                sizeof(runs), 40);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+    return MUNIT_OK;
+}
+
+static int64_t delta_timestamp(size_t i)
+{
+    return 1500000000000LL + i * 1000;
+}
+
+static int64_t delta_jitter(size_t i)
+{
+    return 1500000000000LL + i * 1000 + (i * 7919) % 13;
+}
+
+static int64_t delta_extremes(size_t i)
+{
+    return i % 3 ? INT64_MIN + i : INT64_MAX - i;
+}
+
+static int64_t delta_random(size_t i)
+{
+    return ((uint64_t)munit_rand_uint32() << 32) | munit_rand_uint32();
+}
+
+static void assert_delta_round_trip(enum cx_encoding_type encoding,
+                                    const struct cx_column *col,
+                                    const int64_t values[],
+                                    size_t max_encoded_size)
+{
+    struct cx_column *encoded = cx_encode(col, encoding, NULL);
+    assert_not_null(encoded);
+    assert_int(cx_column_type(encoded), ==, CX_COLUMN_I64);
+    assert_int(cx_column_encoding(encoded), ==, encoding);
+    assert_size(cx_column_count(encoded), ==, COUNT);
+    size_t size;
+    cx_column_export(encoded, &size);
+    assert_size(size, <=, max_encoded_size);
+
+    struct cx_column_cursor *cursor = cx_column_cursor_new(encoded);
+    assert_not_null(cursor);
+
+    size_t position, count;
+    size_t starting_positions[] = {0, 1, 63, 64, 65, 640, COUNT - 1, COUNT};
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_i64(cursor, position), ==,
+                    position);
+        for (size_t i = position; cx_column_cursor_valid(cursor);
+             i += count) {
+            const int64_t *batch =
+                cx_column_cursor_next_batch_i64(cursor, &count);
+            assert_size(count, >, 0);
+            assert_size(count, <=, 64);
+            assert_size(i + count, <=, COUNT);
+            for (size_t j = 0; j < count; j++)
+                assert_int64(batch[j], ==, values[i + j]);
+        }
+        cx_column_cursor_rewind(cursor);
+    }
+
+    cx_column_cursor_free(cursor);
+    cx_column_free(encoded);
+}
+
+static MunitResult test_delta(const MunitParameter params[], void *fixture)
+{
+    int64_t (*generators[])(size_t) = {delta_timestamp, delta_jitter,
+                                       delta_extremes, delta_random};
+    size_t raw_size = COUNT * sizeof(int64_t);
+    size_t block_count = (COUNT + 63) / 64;
+    size_t headers_size = block_count * sizeof(struct cx_delta_block);
+    int64_t values[COUNT];
+    for (size_t g = 0; g < sizeof(generators) / sizeof(*generators); g++) {
+        struct cx_column *col =
+            cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+        assert_not_null(col);
+        for (size_t i = 0; i < COUNT; i++) {
+            values[i] = generators[g](i);
+            assert_true(cx_column_put_i64(col, values[i]));
+        }
+        // at worst, a block packs a word per row
+        size_t max_size = headers_size + block_count * 64 * sizeof(int64_t);
+        if (generators[g] == delta_timestamp)
+            max_size = headers_size;  // regular intervals pack to zero bits
+        assert_delta_round_trip(CX_ENCODING_DELTA, col, values, max_size);
+        assert_delta_round_trip(CX_ENCODING_DELTA_OF_DELTA, col, values,
+                                max_size);
+        cx_column_free(col);
+    }
+
+    // delta-of-delta packs jittered timestamps tighter than delta
+    struct cx_column *col = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    assert_not_null(col);
+    for (size_t i = 0; i < COUNT; i++)
+        assert_true(cx_column_put_i64(col, delta_jitter(i) + i * i));
+    struct cx_column *delta = cx_encode(col, CX_ENCODING_DELTA, NULL);
+    struct cx_column *delta_of_delta =
+        cx_encode(col, CX_ENCODING_DELTA_OF_DELTA, NULL);
+    assert_not_null(delta);
+    assert_not_null(delta_of_delta);
+    size_t delta_size, delta_of_delta_size;
+    cx_column_export(delta, &delta_size);
+    cx_column_export(delta_of_delta, &delta_of_delta_size);
+    assert_size(delta_of_delta_size, <, delta_size);
+    assert_size(delta_of_delta_size * 5, <, raw_size);
+    cx_column_free(delta);
+    cx_column_free(delta_of_delta);
+    cx_column_free(col);
+    return MUNIT_OK;
+}
+
+static MunitResult test_delta_invalid(const MunitParameter params[],
+                                      void *fixture)
+{
+    uint64_t chunk[sizeof(struct cx_delta_block) / sizeof(uint64_t) + 2];
+    struct cx_delta_block *block = (struct cx_delta_block *)chunk;
+    memset(chunk, 0, sizeof(chunk));
+    block->first = 10;
+    block->reference = 1;
+    block->width = 2;
+    struct cx_column *col = cx_column_new_mmapped(
+        CX_COLUMN_I64, CX_ENCODING_DELTA, chunk, sizeof(chunk), 64);
+    assert_not_null(col);
+    struct cx_column_cursor *cursor = cx_column_cursor_new(col);
+    assert_not_null(cursor);
+    size_t count;
+    const int64_t *values = cx_column_cursor_next_batch_i64(cursor, &count);
+    assert_size(count, ==, 64);
+    for (size_t i = 0; i < count; i++)
+        assert_int64(values[i], ==, 10 + i);
+    cx_column_cursor_free(cursor);
+    cx_column_free(col);
+
+    // packed words must be within the chunk
+    block->offset = 1;
+    col = cx_column_new_mmapped(CX_COLUMN_I64, CX_ENCODING_DELTA, chunk,
+                                sizeof(chunk), 64);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+
+    // as must the block headers
+    block->offset = 0;
+    col = cx_column_new_mmapped(CX_COLUMN_I64, CX_ENCODING_DELTA, chunk,
+                                sizeof(chunk), 65);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+
+    block->width = 65;
+    col = cx_column_new_mmapped(CX_COLUMN_I64, CX_ENCODING_DELTA, chunk,
+                                sizeof(chunk), 64);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+    return MUNIT_OK;
+}
+
+static int32_t bitpack_i32(size_t i, size_t range)
+{
+    return (int32_t)((i * 7919) % range) - 1000;
+}
+
+static int64_t bitpack_i64(size_t i, size_t range)
+{
+    return (int64_t)((i * 104729) % range) + 5000000000LL;
+}
+
+static MunitResult test_bitpack(const MunitParameter params[], void *fixture)
+{
+    size_t ranges[] = {1, 2, 100, 1 << 20};
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(*ranges); r++) {
+        size_t range = ranges[r];
+        struct cx_column *i32 = cx_column_new(CX_COLUMN_I32, CX_ENCODING_NONE);
+        struct cx_column *i64 = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+        assert_not_null(i32);
+        assert_not_null(i64);
+        for (size_t i = 0; i < COUNT; i++) {
+            assert_true(cx_column_put_i32(i32, bitpack_i32(i, range)));
+            assert_true(cx_column_put_i64(i64, bitpack_i64(i, range)));
+        }
+        struct cx_column *i32_encoded =
+            cx_encode(i32, CX_ENCODING_BITPACK, NULL);
+        struct cx_index *index = cx_index_new(i64);
+        assert_not_null(index);
+        struct cx_column *i64_encoded =
+            cx_encode(i64, CX_ENCODING_BITPACK, index);
+        cx_index_free(index);
+        assert_not_null(i32_encoded);
+        assert_not_null(i64_encoded);
+        assert_int(cx_column_encoding(i32_encoded), ==, CX_ENCODING_BITPACK);
+        assert_int(cx_column_encoding(i64_encoded), ==, CX_ENCODING_BITPACK);
+
+        // each row takes as many bits as the range requires
+        size_t width = 1;
+        while (((size_t)1 << width) < range)
+            width++;
+        size_t expected_size = sizeof(struct cx_bitpack_header) +
+                               (COUNT + 63) / 64 * width * sizeof(uint64_t);
+        size_t size;
+        cx_column_export(i32_encoded, &size);
+        assert_size(size, ==, expected_size);
+        cx_column_export(i64_encoded, &size);
+        assert_size(size, ==, expected_size);
+
+        struct cx_column_cursor *i32_cursor = cx_column_cursor_new(i32_encoded);
+        struct cx_column_cursor *i64_cursor = cx_column_cursor_new(i64_encoded);
+        assert_not_null(i32_cursor);
+        assert_not_null(i64_cursor);
+        size_t position, count;
+        size_t starting_positions[] = {0, 1, 64, 100, COUNT - 1, COUNT};
+        CX_FOREACH(starting_positions, position)
+        {
+            assert_size(cx_column_cursor_skip_i32(i32_cursor, position), ==,
+                        position);
+            assert_size(cx_column_cursor_skip_i64(i64_cursor, position), ==,
+                        position);
+            for (size_t i = position; cx_column_cursor_valid(i32_cursor);
+                 i += count) {
+                const int32_t *values =
+                    cx_column_cursor_next_batch_i32(i32_cursor, &count);
+                assert_size(i + count, <=, COUNT);
+                for (size_t j = 0; j < count; j++)
+                    assert_int32(values[j], ==, bitpack_i32(i + j, range));
+            }
+            for (size_t i = position; cx_column_cursor_valid(i64_cursor);
+                 i += count) {
+                const int64_t *values =
+                    cx_column_cursor_next_batch_i64(i64_cursor, &count);
+                assert_size(i + count, <=, COUNT);
+                for (size_t j = 0; j < count; j++)
+                    assert_int64(values[j], ==, bitpack_i64(i + j, range));
+            }
+            cx_column_cursor_rewind(i32_cursor);
+            cx_column_cursor_rewind(i64_cursor);
+        }
+        cx_column_cursor_free(i32_cursor);
+        cx_column_cursor_free(i64_cursor);
+        cx_column_free(i32_encoded);
+        cx_column_free(i64_encoded);
+        cx_column_free(i32);
+        cx_column_free(i64);
+    }
+
+    // the full range of values can be packed
+    struct cx_column *col = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    assert_not_null(col);
+    assert_true(cx_column_put_i64(col, INT64_MIN));
+    assert_true(cx_column_put_i64(col, INT64_MAX));
+    assert_true(cx_column_put_i64(col, -1));
+    struct cx_column *encoded = cx_encode(col, CX_ENCODING_BITPACK, NULL);
+    assert_not_null(encoded);
+    struct cx_column_cursor *cursor = cx_column_cursor_new(encoded);
+    assert_not_null(cursor);
+    size_t count;
+    const int64_t *values = cx_column_cursor_next_batch_i64(cursor, &count);
+    assert_size(count, ==, 3);
+    assert_int64(values[0], ==, INT64_MIN);
+    assert_int64(values[1], ==, INT64_MAX);
+    assert_int64(values[2], ==, -1);
+    cx_column_cursor_free(cursor);
+    cx_column_free(encoded);
+    cx_column_free(col);
+    return MUNIT_OK;
+}
+
+static MunitResult test_bitpack_invalid(const MunitParameter params[],
+                                        void *fixture)
+{
+    uint64_t chunk[sizeof(struct cx_bitpack_header) / sizeof(uint64_t) + 2];
+    struct cx_bitpack_header *header = (struct cx_bitpack_header *)chunk;
+    memset(chunk, 0, sizeof(chunk));
+    header->base = 10;
+    header->width = 1;
+    struct cx_column *col = cx_column_new_mmapped(
+        CX_COLUMN_I32, CX_ENCODING_BITPACK, chunk, sizeof(chunk), 100);
+    assert_not_null(col);
+    struct cx_column_cursor *cursor = cx_column_cursor_new(col);
+    assert_not_null(cursor);
+    cx_column_cursor_free(cursor);
+    cx_column_free(col);
+
+    // the chunk must hold a block of planes for every 64 rows
+    col = cx_column_new_mmapped(CX_COLUMN_I32, CX_ENCODING_BITPACK, chunk,
+                                sizeof(chunk), 129);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+
+    // I32 values can't be wider than 32 bits
+    header->width = 33;
+    col = cx_column_new_mmapped(CX_COLUMN_I32, CX_ENCODING_BITPACK, chunk,
+                                sizeof(chunk) - 2 * sizeof(uint64_t), 0);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+
+    header->width = 0;
+    col = cx_column_new_mmapped(CX_COLUMN_I64, CX_ENCODING_BITPACK, chunk,
+                                sizeof(chunk) - 2 * sizeof(uint64_t), 0);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+    return MUNIT_OK;
+}
+
+static double xor_value(size_t i, size_t pattern)
+{
+    static const double specials[] = {0.0, -0.0, 1.0 / 0.0, -1.0 / 0.0,
+                                      0.0 / 0.0, 1e-310, -1e300, 3.25};
+    switch (pattern) {
+        case 0:  // a slowly changing metric
+            return 20 + (i / 10 % 20) * 0.5;
+        case 1:
+            return specials[(i * 7) % (sizeof(specials) / sizeof(*specials))];
+        default:
+            return (double)((i * 2654435761u) % 1000003) / 7;
+    }
+}
+
+static MunitResult test_xor(const MunitParameter params[], void *fixture)
+{
+    for (size_t pattern = 0; pattern < 3; pattern++) {
+        struct cx_column *flt = cx_column_new(CX_COLUMN_FLT, CX_ENCODING_NONE);
+        struct cx_column *dbl = cx_column_new(CX_COLUMN_DBL, CX_ENCODING_NONE);
+        assert_not_null(flt);
+        assert_not_null(dbl);
+        for (size_t i = 0; i < COUNT; i++) {
+            assert_true(cx_column_put_flt(flt, xor_value(i, pattern)));
+            assert_true(cx_column_put_dbl(dbl, xor_value(i, pattern)));
+        }
+        struct cx_column *flt_encoded = cx_encode(flt, CX_ENCODING_XOR, NULL);
+        struct cx_column *dbl_encoded = cx_encode(dbl, CX_ENCODING_XOR, NULL);
+        assert_not_null(flt_encoded);
+        assert_not_null(dbl_encoded);
+        assert_int(cx_column_encoding(flt_encoded), ==, CX_ENCODING_XOR);
+        assert_int(cx_column_encoding(dbl_encoded), ==, CX_ENCODING_XOR);
+
+        // repeated values take a bit each
+        if (pattern == 0) {
+            size_t size;
+            cx_column_export(flt_encoded, &size);
+            assert_size(size, <, COUNT * sizeof(float) / 4);
+            cx_column_export(dbl_encoded, &size);
+            assert_size(size, <, COUNT * sizeof(double) / 4);
+        }
+
+        struct cx_column_cursor *flt_cursor = cx_column_cursor_new(flt_encoded);
+        struct cx_column_cursor *dbl_cursor = cx_column_cursor_new(dbl_encoded);
+        assert_not_null(flt_cursor);
+        assert_not_null(dbl_cursor);
+        size_t position, count;
+        size_t starting_positions[] = {0, 1, 64, 100, COUNT - 1, COUNT};
+        CX_FOREACH(starting_positions, position)
+        {
+            assert_size(cx_column_cursor_skip_flt(flt_cursor, position), ==,
+                        position);
+            assert_size(cx_column_cursor_skip_dbl(dbl_cursor, position), ==,
+                        position);
+            for (size_t i = position; cx_column_cursor_valid(flt_cursor);
+                 i += count) {
+                const float *values =
+                    cx_column_cursor_next_batch_flt(flt_cursor, &count);
+                assert_size(i + count, <=, COUNT);
+                for (size_t j = 0; j < count; j++) {
+                    float expected = xor_value(i + j, pattern);
+                    assert_memory_equal(sizeof(float), &values[j], &expected);
+                }
+            }
+            for (size_t i = position; cx_column_cursor_valid(dbl_cursor);
+                 i += count) {
+                const double *values =
+                    cx_column_cursor_next_batch_dbl(dbl_cursor, &count);
+                assert_size(i + count, <=, COUNT);
+                for (size_t j = 0; j < count; j++) {
+                    double expected = xor_value(i + j, pattern);
+                    assert_memory_equal(sizeof(double), &values[j], &expected);
+                }
+            }
+            cx_column_cursor_rewind(flt_cursor);
+            cx_column_cursor_rewind(dbl_cursor);
+        }
+        cx_column_cursor_free(flt_cursor);
+        cx_column_cursor_free(dbl_cursor);
+        cx_column_free(flt_encoded);
+        cx_column_free(dbl_encoded);
+        cx_column_free(flt);
+        cx_column_free(dbl);
+    }
+    return MUNIT_OK;
+}
+
+static MunitResult test_xor_invalid(const MunitParameter params[],
+                                    void *fixture)
+{
+    // a stream that's too short decodes to zero bits rather than reading
+    // past the end of the chunk
+    uint64_t chunk[2];
+    struct cx_xor_block *block = (struct cx_xor_block *)chunk;
+    memset(chunk, 0xFF, sizeof(chunk));
+    block->offset = 0;
+    block->size = 1;
+    struct cx_column *col = cx_column_new_mmapped(
+        CX_COLUMN_DBL, CX_ENCODING_XOR, chunk, sizeof(chunk), 64);
+    assert_not_null(col);
+    struct cx_column_cursor *cursor = cx_column_cursor_new(col);
+    assert_not_null(cursor);
+    size_t count;
+    cx_column_cursor_next_batch_dbl(cursor, &count);
+    assert_size(count, ==, 64);
+    assert_false(cx_column_cursor_valid(cursor));
+    cx_column_cursor_free(cursor);
+    cx_column_free(col);
+
+    // blocks must be within the stream
+    block->size = 2;
+    col = cx_column_new_mmapped(CX_COLUMN_DBL, CX_ENCODING_XOR, chunk,
+                                sizeof(chunk), 64);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+
+    // there must be a block for every 64 rows
+    block->size = 1;
+    col = cx_column_new_mmapped(CX_COLUMN_FLT, CX_ENCODING_XOR, chunk,
+                                sizeof(chunk), 65);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+
+    col = cx_column_new_mmapped(CX_COLUMN_I64, CX_ENCODING_XOR, chunk,
+                                sizeof(chunk), 64);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+    return MUNIT_OK;
+}
+
+static MunitResult test_byte_stream_split(const MunitParameter params[],
+                                          void *fixture)
+{
+    struct cx_column *flt = cx_column_new(CX_COLUMN_FLT, CX_ENCODING_NONE);
+    struct cx_column *dbl = cx_column_new(CX_COLUMN_DBL, CX_ENCODING_NONE);
+    assert_not_null(flt);
+    assert_not_null(dbl);
+    for (size_t i = 0; i < COUNT; i++) {
+        assert_true(cx_column_put_flt(flt, xor_value(i, 2)));
+        assert_true(cx_column_put_dbl(dbl, xor_value(i, 2)));
+    }
+    struct cx_column *flt_encoded =
+        cx_encode(flt, CX_ENCODING_BYTE_STREAM_SPLIT, NULL);
+    struct cx_column *dbl_encoded =
+        cx_encode(dbl, CX_ENCODING_BYTE_STREAM_SPLIT, NULL);
+    assert_not_null(flt_encoded);
+    assert_not_null(dbl_encoded);
+    assert_int(cx_column_encoding(dbl_encoded), ==,
+               CX_ENCODING_BYTE_STREAM_SPLIT);
+
+    // stream k holds byte k of each value
+    size_t size;
+    const uint8_t *streams = cx_column_export(dbl_encoded, &size);
+    assert_size(size, ==, COUNT * sizeof(double));
+    double value = xor_value(3, 2);
+    const uint8_t *bytes = (const uint8_t *)&value;
+    for (size_t k = 0; k < sizeof(double); k++)
+        assert_uint8(streams[k * COUNT + 3], ==, bytes[k]);
+
+    struct cx_column_cursor *flt_cursor = cx_column_cursor_new(flt_encoded);
+    struct cx_column_cursor *dbl_cursor = cx_column_cursor_new(dbl_encoded);
+    assert_not_null(flt_cursor);
+    assert_not_null(dbl_cursor);
+    size_t position, count;
+    size_t starting_positions[] = {0, 1, 64, 100, COUNT - 1, COUNT};
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_flt(flt_cursor, position), ==,
+                    position);
+        assert_size(cx_column_cursor_skip_dbl(dbl_cursor, position), ==,
+                    position);
+        for (size_t i = position; cx_column_cursor_valid(flt_cursor);
+             i += count) {
+            const float *values =
+                cx_column_cursor_next_batch_flt(flt_cursor, &count);
+            assert_size(i + count, <=, COUNT);
+            for (size_t j = 0; j < count; j++)
+                assert_float(values[j], ==, (float)xor_value(i + j, 2));
+        }
+        for (size_t i = position; cx_column_cursor_valid(dbl_cursor);
+             i += count) {
+            const double *values =
+                cx_column_cursor_next_batch_dbl(dbl_cursor, &count);
+            assert_size(i + count, <=, COUNT);
+            for (size_t j = 0; j < count; j++)
+                assert_double(values[j], ==, xor_value(i + j, 2));
+        }
+        cx_column_cursor_rewind(flt_cursor);
+        cx_column_cursor_rewind(dbl_cursor);
+    }
+    cx_column_cursor_free(flt_cursor);
+    cx_column_cursor_free(dbl_cursor);
+
+    // the chunk must hold every byte of every value
+    struct cx_column *col =
+        cx_column_new_mmapped(CX_COLUMN_DBL, CX_ENCODING_BYTE_STREAM_SPLIT,
+                              streams, size, COUNT + 1);
+    assert_not_null(col);
+    assert_null(cx_column_cursor_new(col));
+    cx_column_free(col);
+
+    cx_column_free(flt_encoded);
+    cx_column_free(dbl_encoded);
+    cx_column_free(flt);
+    cx_column_free(dbl);
+    return MUNIT_OK;
+}
+
+static MunitResult test_constant(const MunitParameter params[], void *fixture)
+{
+    struct cx_column *bit = cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+    struct cx_column *i64 = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    struct cx_column *dbl = cx_column_new(CX_COLUMN_DBL, CX_ENCODING_NONE);
+    struct cx_column *str = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(bit);
+    assert_not_null(i64);
+    assert_not_null(dbl);
+    assert_not_null(str);
+    for (size_t i = 0; i < COUNT; i++) {
+        assert_true(cx_column_put_bit(bit, true));
+        assert_true(cx_column_put_i64(i64, -42));
+        assert_true(cx_column_put_dbl(dbl, 0.5));
+        assert_true(cx_column_put_str(str, "eu-west-1"));
+    }
+    struct cx_column *columns[] = {bit, i64, dbl, str};
+    size_t sizes[] = {sizeof(uint64_t), sizeof(int64_t), sizeof(double), 10};
+    struct cx_column *encoded[4];
+    for (size_t i = 0; i < 4; i++) {
+        assert_true(cx_column_constant(columns[i]));
+        encoded[i] = cx_encode(columns[i], CX_ENCODING_CONSTANT, NULL);
+        assert_not_null(encoded[i]);
+        assert_int(cx_column_encoding(encoded[i]), ==, CX_ENCODING_CONSTANT);
+        assert_size(cx_column_count(encoded[i]), ==, COUNT);
+        size_t size;
+        cx_column_export(encoded[i], &size);
+        assert_size(size, ==, sizes[i]);
+    }
+
+    struct cx_column_cursor *cursors[4];
+    for (size_t i = 0; i < 4; i++) {
+        cursors[i] = cx_column_cursor_new(encoded[i]);
+        assert_not_null(cursors[i]);
+    }
+    size_t position, count;
+    size_t starting_positions[] = {0, 64, 128, COUNT - COUNT % 64};
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_bit(cursors[0], position), ==,
+                    position);
+        assert_size(cx_column_cursor_skip_i64(cursors[1], position), ==,
+                    position);
+        assert_size(cx_column_cursor_skip_dbl(cursors[2], position), ==,
+                    position);
+        assert_size(cx_column_cursor_skip_str(cursors[3], position), ==,
+                    position);
+        size_t i = position;
+        for (; cx_column_cursor_valid(cursors[0]); i += count) {
+            const uint64_t *bits =
+                cx_column_cursor_next_batch_bit(cursors[0], &count);
+            assert_uint64(*bits, ==, UINT64_MAX);
+            const int64_t *values =
+                cx_column_cursor_next_batch_i64(cursors[1], &count);
+            const double *doubles =
+                cx_column_cursor_next_batch_dbl(cursors[2], &count);
+            const struct cx_string *strings =
+                cx_column_cursor_next_batch_str(cursors[3], &count);
+            assert_size(count, ==, i + 64 > COUNT ? COUNT - i : 64);
+            for (size_t j = 0; j < count; j++) {
+                assert_int64(values[j], ==, -42);
+                assert_double(doubles[j], ==, 0.5);
+                assert_size(strings[j].len, ==, 9);
+                assert_string_equal(strings[j].ptr, "eu-west-1");
+            }
+        }
+        assert_size(i, ==, COUNT);
+        for (size_t j = 0; j < 4; j++) {
+            assert_false(cx_column_cursor_valid(cursors[j]));
+            cx_column_cursor_rewind(cursors[j]);
+        }
+    }
+    for (size_t i = 0; i < 4; i++) {
+        cx_column_cursor_free(cursors[i]);
+        cx_column_free(encoded[i]);
+    }
+
+    // a single differing value (or bit pattern) is enough
+    assert_true(cx_column_put_bit(bit, false));
+    assert_true(cx_column_put_i64(i64, -41));
+    assert_true(cx_column_put_dbl(dbl, -0.5));
+    assert_true(cx_column_put_str(str, "eu-west-10"));
+    for (size_t i = 0; i < 4; i++) {
+        assert_false(cx_column_constant(columns[i]));
+        assert_null(cx_encode(columns[i], CX_ENCODING_CONSTANT, NULL));
+        cx_column_free(columns[i]);
+    }
+    struct cx_column *zero = cx_column_new(CX_COLUMN_FLT, CX_ENCODING_NONE);
+    assert_not_null(zero);
+    assert_true(cx_column_put_flt(zero, 0.0f));
+    assert_true(cx_column_put_flt(zero, -0.0f));
+    assert_false(cx_column_constant(zero));
+    cx_column_free(zero);
+
+    // the chunk must hold a single value
+    uint64_t word = 1;
+    struct cx_column *invalid = cx_column_new_mmapped(
+        CX_COLUMN_BIT, CX_ENCODING_CONSTANT, &word, sizeof(word), COUNT);
+    assert_not_null(invalid);
+    assert_null(cx_column_cursor_new(invalid));
+    cx_column_free(invalid);
+    invalid = cx_column_new_mmapped(CX_COLUMN_I32, CX_ENCODING_CONSTANT, &word,
+                                    sizeof(word), COUNT);
+    assert_not_null(invalid);
+    assert_null(cx_column_cursor_new(invalid));
+    cx_column_free(invalid);
+    invalid = cx_column_new_mmapped(CX_COLUMN_STR, CX_ENCODING_CONSTANT, "a\0b",
+                                    4, COUNT);
+    assert_not_null(invalid);
+    assert_null(cx_column_cursor_new(invalid));
+    cx_column_free(invalid);
+
+    return MUNIT_OK;
+}
+
+static bool sparse_null(size_t i)
+{
+    return i % 20 != 3;
+}
+
+static MunitResult test_sparse(const MunitParameter params[], void *fixture)
+{
+    struct cx_column *nulls = cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+    struct cx_column *i64 = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    struct cx_column *str = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(nulls);
+    assert_not_null(i64);
+    assert_not_null(str);
+    char expected[32];
+    for (size_t i = 0; i < COUNT; i++) {
+        assert_true(cx_column_put_bit(nulls, sparse_null(i)));
+        if (sparse_null(i)) {
+            assert_true(cx_column_put_unit(i64));
+            assert_true(cx_column_put_unit(str));
+        } else {
+            sprintf(expected, "value %zu", i);
+            assert_true(cx_column_put_i64(i64, i * 3));
+            assert_true(cx_column_put_str(str, expected));
+        }
+    }
+    // the null bitmap can't be inferred from the values
+    assert_null(cx_encode(i64, CX_ENCODING_SPARSE, NULL));
+    struct cx_column *i64_encoded = cx_encode_sparse(i64, nulls);
+    struct cx_column *str_encoded = cx_encode_sparse(str, nulls);
+    assert_not_null(i64_encoded);
+    assert_not_null(str_encoded);
+    assert_int(cx_column_encoding(i64_encoded), ==, CX_ENCODING_SPARSE);
+    assert_size(cx_column_count(str_encoded), ==, COUNT);
+    size_t size;
+    const struct cx_sparse_header *header =
+        cx_column_export(i64_encoded, &size);
+    assert_uint32(header->count, ==, COUNT / 20);
+    assert_size(size, ==,
+                sizeof(*header) + COUNT / 20 * (sizeof(uint32_t) + 8));
+
+    struct cx_column_cursor *i64_cursor = cx_column_cursor_new(i64_encoded);
+    struct cx_column_cursor *str_cursor = cx_column_cursor_new(str_encoded);
+    struct cx_column_cursor *nulls_cursor = cx_column_cursor_new(str_encoded);
+    assert_not_null(i64_cursor);
+    assert_not_null(str_cursor);
+    assert_not_null(nulls_cursor);
+    size_t position, count;
+    size_t starting_positions[] = {0, 1, 3, 4, 64, 100, COUNT - 1, COUNT};
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_i64(i64_cursor, position), ==,
+                    position);
+        assert_size(cx_column_cursor_skip_str(str_cursor, position), ==,
+                    position);
+        assert_size(cx_column_cursor_skip_sparse(nulls_cursor, position), ==,
+                    position);
+        size_t i = position;
+        for (; cx_column_cursor_valid(i64_cursor); i += count) {
+            const int64_t *values =
+                cx_column_cursor_next_batch_i64(i64_cursor, &count);
+            const struct cx_string *strings =
+                cx_column_cursor_next_batch_str(str_cursor, &count);
+            const uint64_t *bitset =
+                cx_column_cursor_next_batch_nulls(nulls_cursor, &count);
+            assert_size(i + count, <=, COUNT);
+            for (size_t j = 0; j < count; j++) {
+                bool null = sparse_null(i + j);
+                assert_int(!!(*bitset & ((uint64_t)1 << j)), ==, null);
+                assert_int64(values[j], ==, null ? 0 : (i + j) * 3);
+                if (null)
+                    strcpy(expected, "");
+                else
+                    sprintf(expected, "value %zu", i + j);
+                assert_size(strings[j].len, ==, strlen(expected));
+                assert_string_equal(strings[j].ptr, expected);
+            }
+        }
+        assert_size(i, ==, COUNT);
+        assert_false(cx_column_cursor_valid(str_cursor));
+        assert_false(cx_column_cursor_valid(nulls_cursor));
+        cx_column_cursor_rewind(i64_cursor);
+        cx_column_cursor_rewind(str_cursor);
+        cx_column_cursor_rewind(nulls_cursor);
+    }
+    cx_column_cursor_free(i64_cursor);
+    cx_column_cursor_free(str_cursor);
+    cx_column_cursor_free(nulls_cursor);
+
+    // positions must be ascending and within the chunk, and each must have
+    // a value
+    uint32_t chunk[6] = {2, 0, 4, 1, 0, 0};
+    struct cx_column *invalid = cx_column_new_mmapped(
+        CX_COLUMN_I32, CX_ENCODING_SPARSE, chunk, sizeof(chunk), 8);
+    assert_not_null(invalid);
+    assert_null(cx_column_cursor_new(invalid));
+    cx_column_free(invalid);
+    chunk[3] = 5;
+    invalid = cx_column_new_mmapped(CX_COLUMN_I32, CX_ENCODING_SPARSE, chunk,
+                                    sizeof(chunk), 5);
+    assert_not_null(invalid);
+    assert_null(cx_column_cursor_new(invalid));
+    cx_column_free(invalid);
+    invalid = cx_column_new_mmapped(CX_COLUMN_I32, CX_ENCODING_SPARSE, chunk,
+                                    sizeof(chunk) - 4, 8);
+    assert_not_null(invalid);
+    assert_null(cx_column_cursor_new(invalid));
+    cx_column_free(invalid);
+    invalid = cx_column_new_mmapped(CX_COLUMN_I32, CX_ENCODING_SPARSE, chunk,
+                                    sizeof(chunk), 8);
+    assert_not_null(invalid);
+    struct cx_column_cursor *cursor = cx_column_cursor_new(invalid);
+    assert_not_null(cursor);
+    cx_column_cursor_free(cursor);
+    cx_column_free(invalid);
+    memcpy(&chunk[4], "abcdefgh", 8);
+    invalid = cx_column_new_mmapped(CX_COLUMN_STR, CX_ENCODING_SPARSE, chunk,
+                                    sizeof(chunk), 8);
+    assert_not_null(invalid);
+    assert_null(cx_column_cursor_new(invalid));
+    cx_column_free(invalid);
+
+    cx_column_free(i64_encoded);
+    cx_column_free(str_encoded);
+    cx_column_free(i64);
+    cx_column_free(str);
+    cx_column_free(nulls);
+    return MUNIT_OK;
+}
+
+static MunitResult test_batched(const MunitParameter params[], void *fixture)
+{
+    size_t count = 5000;
+    struct cx_column *i64 = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    struct cx_column *dbl = cx_column_new(CX_COLUMN_DBL, CX_ENCODING_NONE);
+    struct cx_column *str = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(i64);
+    assert_not_null(dbl);
+    assert_not_null(str);
+    char buffer[64];
+    // runs of 37 equal values from a small range
+    for (size_t i = 0; i < count; i++) {
+        assert_true(cx_column_put_i64(i64, i / 37 * 7919 % 9973));
+        assert_true(cx_column_put_dbl(dbl, (double)(i / 37 % 100) / 4));
+        sprintf(buffer, "cx %zu", i / 37 % CARDINALITY);
+        assert_true(cx_column_put_str(str, buffer));
+    }
+
+    enum cx_encoding_type i64_encodings[] = {
+        CX_ENCODING_NONE, CX_ENCODING_RLE, CX_ENCODING_DELTA,
+        CX_ENCODING_DELTA_OF_DELTA, CX_ENCODING_BITPACK};
+    enum cx_encoding_type dbl_encodings[] = {
+        CX_ENCODING_NONE, CX_ENCODING_XOR, CX_ENCODING_BYTE_STREAM_SPLIT};
+    enum cx_encoding_type str_encodings[] = {CX_ENCODING_NONE,
+                                             CX_ENCODING_DICT,
+                                             CX_ENCODING_FSST};
+    size_t batch_sizes[] = {64, 1024, CX_BATCH_SIZE_MAX}, batch_size;
+    CX_FOREACH(batch_sizes, batch_size)
+    {
+        for (size_t e = 0; e < sizeof(i64_encodings) / sizeof(*i64_encodings);
+             e++) {
+            struct cx_column *encoded = i64;
+            if (i64_encodings[e] != CX_ENCODING_NONE)
+                encoded = cx_encode(i64, i64_encodings[e], NULL);
+            assert_not_null(encoded);
+            struct cx_column_cursor *cursor =
+                cx_column_cursor_new_batched(encoded, batch_size);
+            assert_not_null(cursor);
+            size_t position = 0, available;
+            while (cx_column_cursor_valid(cursor)) {
+                const int64_t *values =
+                    cx_column_cursor_next_batch_i64(cursor, &available);
+                assert_not_null(values);
+                assert_size(available, <=, batch_size);
+                for (size_t i = 0; i < available; i++, position++) {
+                    int64_t expected = position / 37 * 7919 % 9973;
+                    assert_int64(values[i], ==, expected);
+                }
+            }
+            assert_size(position, ==, count);
+            cx_column_cursor_free(cursor);
+            if (encoded != i64)
+                cx_column_free(encoded);
+        }
+        for (size_t e = 0; e < sizeof(dbl_encodings) / sizeof(*dbl_encodings);
+             e++) {
+            struct cx_column *encoded = dbl;
+            if (dbl_encodings[e] != CX_ENCODING_NONE)
+                encoded = cx_encode(dbl, dbl_encodings[e], NULL);
+            assert_not_null(encoded);
+            struct cx_column_cursor *cursor =
+                cx_column_cursor_new_batched(encoded, batch_size);
+            assert_not_null(cursor);
+            size_t position = 0, available;
+            while (cx_column_cursor_valid(cursor)) {
+                const double *values =
+                    cx_column_cursor_next_batch_dbl(cursor, &available);
+                assert_not_null(values);
+                assert_size(available, <=, batch_size);
+                for (size_t i = 0; i < available; i++, position++) {
+                    double expected = (double)(position / 37 % 100) / 4;
+                    assert_double(values[i], ==, expected);
+                }
+            }
+            assert_size(position, ==, count);
+            cx_column_cursor_free(cursor);
+            if (encoded != dbl)
+                cx_column_free(encoded);
+        }
+        for (size_t e = 0; e < sizeof(str_encodings) / sizeof(*str_encodings);
+             e++) {
+            struct cx_column *encoded = str;
+            if (str_encodings[e] != CX_ENCODING_NONE)
+                encoded = cx_encode(str, str_encodings[e], NULL);
+            assert_not_null(encoded);
+            struct cx_column_cursor *cursor =
+                cx_column_cursor_new_batched(encoded, batch_size);
+            assert_not_null(cursor);
+            size_t position = 0, available;
+            while (cx_column_cursor_valid(cursor)) {
+                const struct cx_string *values =
+                    cx_column_cursor_next_batch_str(cursor, &available);
+                assert_not_null(values);
+                assert_size(available, <=, batch_size);
+                for (size_t i = 0; i < available; i++, position++) {
+                    sprintf(buffer, "cx %zu", position / 37 % CARDINALITY);
+                    assert_string_equal(values[i].ptr, buffer);
+                }
+            }
+            assert_size(position, ==, count);
+            cx_column_cursor_free(cursor);
+            if (encoded != str)
+                cx_column_free(encoded);
+        }
+    }
+
+    assert_null(cx_column_cursor_new_batched(i64, 0));
+    assert_null(cx_column_cursor_new_batched(i64, 100));
+    assert_null(cx_column_cursor_new_batched(i64, CX_BATCH_SIZE_MAX * 2));
+
+    cx_column_free(i64);
+    cx_column_free(dbl);
+    cx_column_free(str);
+    return MUNIT_OK;
+}
+
+MunitTest encode_tests[] = {
+    {"/supported", test_supported, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/dict", test_dict, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/dict-invalid", test_dict_invalid, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/offsets", test_offsets, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/fsst", test_fsst, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/rle", test_rle, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/rle-invalid", test_rle_invalid, NULL, NULL, MUNIT_TEST_OPTION_NONE,
+     NULL},
+    {"/delta", test_delta, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/delta-invalid", test_delta_invalid, NULL, NULL, MUNIT_TEST_OPTION_NONE,
+     NULL},
+    {"/bitpack", test_bitpack, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/bitpack-invalid", test_bitpack_invalid, NULL, NULL,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/xor", test_xor, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/xor-invalid", test_xor_invalid, NULL, NULL, MUNIT_TEST_OPTION_NONE,
+     NULL},
+    {"/byte-stream-split", test_byte_stream_split, NULL, NULL,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/constant", test_constant, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/sparse", test_sparse, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/batched", test_batched, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
@@ -1,5 +1,6 @@
 #define _BSD_SOURCE
 #include <stdio.h>
+#include <sys/stat.h>
 
 #include "helpers.h"
 #include "reader.h"
@@ -381,6 +382,1773 @@ static MunitResult test_empty_columns(const MunitParameter params[], void *ptr)
     return MUNIT_OK;
 }
 
+static size_t count_matching(const char *path, struct cx_predicate *predicate)
+{
+    assert_not_null(predicate);
+    struct cx_reader *reader = cx_reader_new_matching(path, predicate);
+    assert_not_null(reader);
+    size_t count = 0;
+    while (cx_reader_next(reader))
+        count++;
+    assert_false(cx_reader_error(reader));
+    assert_size(cx_reader_row_count(reader), ==, count);
+    cx_reader_free(reader);  // frees the predicate
+    return count;
+}
+
+static MunitResult test_dict_encoding(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const char *fruits[] = {"apple crumble", "banana bread", "cherry pie",
+                            "mango sorbet"};
+    char buffer[64];
+
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, ROWS_PER_ROW_GROUP);
+    assert_not_null(writer);
+    assert_false(cx_writer_add_column(writer, "id", CX_COLUMN_I32,
+                                      CX_ENCODING_DICT, CX_COMPRESSION_NONE,
+                                      0));  // unsupported
+    assert_true(cx_writer_add_column(writer, "fruit", CX_COLUMN_STR,
+                                     CX_ENCODING_DICT, CX_COMPRESSION_NONE, 0));
+    assert_true(cx_writer_add_column(writer, "unique", CX_COLUMN_STR,
+                                     CX_ENCODING_DICT, CX_COMPRESSION_LZ4, 0));
+    for (size_t i = 0; i < ROW_COUNT; i++) {
+        if (i % 10 == 0)
+            assert_true(cx_writer_put_null(writer, 0));
+        else
+            assert_true(cx_writer_put_str(writer, 0, fruits[i % 4]));
+        sprintf(buffer, "unique %zu", i);
+        assert_true(cx_writer_put_str(writer, 1, buffer));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    // chunks are only encoded if it reduces their size
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    for (size_t i = 0; i < 2; i++)
+        assert_int(cx_row_group_reader_column_encoding(row_group_reader, i), ==,
+                   CX_ENCODING_DICT);
+    for (size_t i = 0; i < ROW_GROUP_COUNT; i++) {
+        struct cx_row_group *row_group =
+            cx_row_group_reader_get(row_group_reader, i);
+        assert_not_null(row_group);
+        assert_int(cx_row_group_column_encoding(row_group, 0), ==,
+                   CX_ENCODING_DICT);
+        assert_int(cx_row_group_column_encoding(row_group, 1), ==,
+                   CX_ENCODING_NONE);
+        cx_row_group_free(row_group);
+    }
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        cx_value_t value;
+        assert_true(cx_reader_get_null(reader, 0, &value.bit));
+        if (position % 10 == 0) {
+            assert_true(value.bit);
+        } else {
+            assert_false(value.bit);
+            assert_true(cx_reader_get_str(reader, 0, &value.str));
+            const char *fruit = fruits[position % 4];
+            assert_string_equal(value.str.ptr, fruit);
+            assert_size(value.str.len, ==, strlen(fruit));
+        }
+        assert_true(cx_reader_get_str(reader, 1, &value.str));
+        sprintf(buffer, "unique %zu", position);
+        assert_string_equal(value.str.ptr, buffer);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, ROW_COUNT);
+    cx_reader_free(reader);
+
+    // of the 100 rows, 10 are null and the remaining 90 are split between
+    // apple (20), banana (25), cherry (20) and mango (25)
+    size_t count = count_matching(
+        fixture->temp_file, cx_predicate_new_str_eq(0, "cherry pie", true));
+    assert_size(count, ==, 20);
+    count = count_matching(fixture->temp_file,
+                           cx_predicate_new_str_lt(0, "c", true));
+    assert_size(count, ==, 20 + 25 + 10);  // nulls are stored as ""
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_str_contains(0, "an", true, CX_STR_LOCATION_ANY));
+    assert_size(count, ==, 25 + 25);
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_negate(cx_predicate_new_str_contains(
+            0, "AN", false, CX_STR_LOCATION_ANY)));
+    assert_size(count, ==, 20 + 20 + 10);
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_and(2, cx_predicate_new_str_gt(0, "b", true),
+                             cx_predicate_new_str_lt(0, "d", true)));
+    assert_size(count, ==, 25 + 20);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_offsets_encoding(const MunitParameter params[],
+                                         void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const size_t row_group_size = 1000, row_count = 2500;
+    char buffer[64];
+
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "name", CX_COLUMN_STR,
+                                     CX_ENCODING_OFFSETS, CX_COMPRESSION_ZSTD,
+                                     0));
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE,
+                                     0));
+    for (size_t i = 0; i < row_count; i++) {
+        sprintf(buffer, i % 7 ? "user %zu" : "", i);
+        assert_true(cx_writer_put_str(writer, 0, buffer));
+        assert_true(cx_writer_put_i64(writer, 1, i));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    // chunks are encoded even though the offsets add to their size
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 0);
+    assert_not_null(row_group);
+    assert_int(cx_row_group_column_encoding(row_group, 0), ==,
+               CX_ENCODING_OFFSETS);
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        struct cx_string value;
+        assert_true(cx_reader_get_str(reader, 0, &value));
+        sprintf(buffer, position % 7 ? "user %zu" : "", position);
+        assert_string_equal(value.ptr, buffer);
+        assert_size(value.len, ==, strlen(buffer));
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+    size_t count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_and(2, cx_predicate_new_i64_gt(1, 2000),
+                             cx_predicate_new_str_contains(
+                                 0, "user 24", true, CX_STR_LOCATION_START)));
+    assert_size(count, ==, 85);
+    count = count_matching(fixture->temp_file,
+                           cx_predicate_new_str_eq(0, "", true));
+    assert_size(count, ==, 358);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_fsst_encoding(const MunitParameter params[],
+                                      void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const char *agents[] = {"Mozilla/5.0 (X11; Linux x86_64) Firefox/115.0",
+                            "Mozilla/5.0 (Macintosh; Intel Mac OS X 13_4)",
+                            "curl/7.88.1"};
+    const size_t row_group_size = 1000, row_count = 2500;
+    char buffer[128];
+
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "url", CX_COLUMN_STR,
+                                     CX_ENCODING_FSST, CX_COMPRESSION_NONE,
+                                     0));
+    assert_true(cx_writer_add_column(writer, "agent", CX_COLUMN_STR,
+                                     CX_ENCODING_FSST, CX_COMPRESSION_LZ4, 0));
+    for (size_t i = 0; i < row_count; i++) {
+        sprintf(buffer, "https://example.com/item/%zu", i % 500);
+        assert_true(cx_writer_put_str(writer, 0, buffer));
+        assert_true(cx_writer_put_str(writer, 1, agents[i % 3]));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 0);
+    assert_not_null(row_group);
+    assert_int(cx_row_group_column_encoding(row_group, 0), ==,
+               CX_ENCODING_FSST);
+    assert_int(cx_row_group_column_encoding(row_group, 1), ==,
+               CX_ENCODING_FSST);
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        struct cx_string value;
+        assert_true(cx_reader_get_str(reader, 0, &value));
+        sprintf(buffer, "https://example.com/item/%zu", position % 500);
+        assert_string_equal(value.ptr, buffer);
+        assert_size(value.len, ==, strlen(buffer));
+        const char *agent = agents[position % 3];
+        assert_true(cx_reader_get_str(reader, 1, &value));
+        assert_string_equal(value.ptr, agent);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+    // equality is matched against the compressed strings, and everything
+    // else against the decompressed strings
+    size_t count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_str_eq(0, "https://example.com/item/42", true));
+    assert_size(count, ==, 5);
+    count = count_matching(fixture->temp_file,
+                           cx_predicate_new_str_eq(1, "curl/7.88.1", true));
+    assert_size(count, ==, 833);
+    count = count_matching(fixture->temp_file,
+                           cx_predicate_new_str_eq(1, "CURL/7.88.1", false));
+    assert_size(count, ==, 833);
+    count = count_matching(fixture->temp_file,
+                           cx_predicate_new_str_eq(1, "curl/7.88", true));
+    assert_size(count, ==, 0);
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_and(
+            2,
+            cx_predicate_new_str_contains(0, "/item/49", true,
+                                          CX_STR_LOCATION_ANY),
+            cx_predicate_negate(cx_predicate_new_str_contains(
+                1, "Linux", true, CX_STR_LOCATION_ANY))));
+    assert_size(count, ==, 36);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_rle_encoding(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const size_t row_group_size = 1000, row_count = 4000;
+
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_false(cx_writer_add_column(writer, "flt", CX_COLUMN_FLT,
+                                      CX_ENCODING_RLE, CX_COMPRESSION_NONE,
+                                      0));  // unsupported
+    assert_true(cx_writer_add_column(writer, "tenant", CX_COLUMN_I32,
+                                     CX_ENCODING_RLE, CX_COMPRESSION_NONE, 0));
+    assert_true(cx_writer_add_column(writer, "timestamp", CX_COLUMN_I64,
+                                     CX_ENCODING_RLE, CX_COMPRESSION_ZSTD, 0));
+    assert_true(cx_writer_add_column(writer, "flag", CX_COLUMN_BIT,
+                                     CX_ENCODING_RLE, CX_COMPRESSION_NONE, 0));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i32(writer, 0, i / 300));
+        assert_true(cx_writer_put_i64(writer, 1, i));  // no runs
+        if (i >= 3500)
+            assert_true(cx_writer_put_null(writer, 2));
+        else
+            assert_true(cx_writer_put_bit(writer, 2, (i / 100) % 2));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    for (size_t i = 0; i < row_count / row_group_size; i++) {
+        struct cx_row_group *row_group =
+            cx_row_group_reader_get(row_group_reader, i);
+        assert_not_null(row_group);
+        assert_int(cx_row_group_column_encoding(row_group, 0), ==,
+                   CX_ENCODING_RLE);
+        assert_int(cx_row_group_column_encoding(row_group, 1), ==,
+                   CX_ENCODING_NONE);
+        assert_int(cx_row_group_column_encoding(row_group, 2), ==,
+                   CX_ENCODING_RLE);
+        cx_row_group_free(row_group);
+    }
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        cx_value_t value;
+        assert_true(cx_reader_get_i32(reader, 0, &value.i32));
+        assert_int32(value.i32, ==, position / 300);
+        assert_true(cx_reader_get_i64(reader, 1, &value.i64));
+        assert_int64(value.i64, ==, position);
+        assert_true(cx_reader_get_null(reader, 2, &value.bit));
+        if (position >= 3500) {
+            assert_true(value.bit);
+        } else {
+            assert_false(value.bit);
+            bool expected = (position / 100) % 2;
+            assert_true(cx_reader_get_bit(reader, 2, &value.bit));
+            assert_int(value.bit, ==, expected);
+        }
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+    size_t count = count_matching(fixture->temp_file,
+                                  cx_predicate_new_i32_eq(0, 3));
+    assert_size(count, ==, 300);
+    count = count_matching(fixture->temp_file, cx_predicate_new_i32_gt(0, 10));
+    assert_size(count, ==, row_count - 11 * 300);
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_negate(cx_predicate_new_i32_lt(0, 12)));
+    assert_size(count, ==, row_count - 12 * 300);
+    count = count_matching(fixture->temp_file,
+                           cx_predicate_new_bit_eq(2, true));
+    assert_size(count, ==, 1700);
+    count = count_matching(fixture->temp_file, cx_predicate_new_null(2));
+    assert_size(count, ==, 500);
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_and(2, cx_predicate_new_i32_eq(0, 1),
+                             cx_predicate_new_bit_eq(2, false)));
+    assert_size(count, ==, 100);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_delta_encoding(const MunitParameter params[],
+                                       void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const size_t row_group_size = 1000, row_count = 2500;
+    const int64_t start = 1500000000000LL;
+
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_false(cx_writer_add_column(writer, "i32", CX_COLUMN_I32,
+                                      CX_ENCODING_DELTA, CX_COMPRESSION_NONE,
+                                      0));  // unsupported
+    assert_true(cx_writer_add_column(writer, "timestamp", CX_COLUMN_I64,
+                                     CX_ENCODING_DELTA_OF_DELTA,
+                                     CX_COMPRESSION_ZSTD, 0));
+    assert_true(cx_writer_add_column(writer, "counter", CX_COLUMN_I64,
+                                     CX_ENCODING_DELTA, CX_COMPRESSION_NONE,
+                                     0));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, start + i * 1000 + i % 3));
+        if (i % 10 == 9)
+            assert_true(cx_writer_put_null(writer, 1));
+        else
+            assert_true(cx_writer_put_i64(writer, 1, i * i));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 0);
+    assert_not_null(row_group);
+    assert_int(cx_row_group_column_encoding(row_group, 0), ==,
+               CX_ENCODING_DELTA_OF_DELTA);
+    assert_int(cx_row_group_column_encoding(row_group, 1), ==,
+               CX_ENCODING_DELTA);
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        int64_t value, expected = start + position * 1000 + position % 3;
+        assert_true(cx_reader_get_i64(reader, 0, &value));
+        assert_int64(value, ==, expected);
+        bool null, expected_null = position % 10 == 9;
+        assert_true(cx_reader_get_null(reader, 1, &null));
+        assert_int(null, ==, expected_null);
+        if (!null) {
+            assert_true(cx_reader_get_i64(reader, 1, &value));
+            assert_int64(value, ==, position * position);
+        }
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+    size_t count = count_matching(
+        fixture->temp_file, cx_predicate_new_i64_lt(0, start + 1500 * 1000));
+    assert_size(count, ==, 1500);
+    count = count_matching(fixture->temp_file,
+                           cx_predicate_new_i64_gt(1, 2000 * 2000));
+    assert_size(count, ==, 449);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_bitpack_encoding(const MunitParameter params[],
+                                         void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const size_t row_group_size = 1000, row_count = 2500;
+
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "tenant", CX_COLUMN_I32,
+                                     CX_ENCODING_BITPACK, CX_COMPRESSION_LZ4,
+                                     0));
+    assert_true(cx_writer_add_column(writer, "counter", CX_COLUMN_I64,
+                                     CX_ENCODING_BITPACK, CX_COMPRESSION_NONE,
+                                     0));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i32(writer, 0, -(int32_t)(i % 37)));
+        assert_true(cx_writer_put_i64(writer, 1, 1000000000000LL + i % 500));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 0);
+    assert_not_null(row_group);
+    assert_int(cx_row_group_column_encoding(row_group, 0), ==,
+               CX_ENCODING_BITPACK);
+    assert_int(cx_row_group_column_encoding(row_group, 1), ==,
+               CX_ENCODING_BITPACK);
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        int32_t i32, expected_i32 = -(int32_t)(position % 37);
+        int64_t i64, expected_i64 = 1000000000000LL + position % 500;
+        assert_true(cx_reader_get_i32(reader, 0, &i32));
+        assert_int32(i32, ==, expected_i32);
+        assert_true(cx_reader_get_i64(reader, 1, &i64));
+        assert_int64(i64, ==, expected_i64);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+    size_t count =
+        count_matching(fixture->temp_file, cx_predicate_new_i32_eq(0, -36));
+    assert_size(count, ==, 67);
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_i64_lt(1, 1000000000000LL + 100));
+    assert_size(count, ==, 500);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_xor_encoding(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const size_t row_group_size = 1000, row_count = 2500;
+
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "load", CX_COLUMN_FLT,
+                                     CX_ENCODING_XOR, CX_COMPRESSION_NONE, 0));
+    assert_true(cx_writer_add_column(writer, "temperature", CX_COLUMN_DBL,
+                                     CX_ENCODING_XOR, CX_COMPRESSION_ZSTD, 0));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_flt(writer, 0, (float)(i % 13) * 0.5f));
+        assert_true(cx_writer_put_dbl(writer, 1, 20 + (i % 40) * 0.25));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 0);
+    assert_not_null(row_group);
+    assert_int(cx_row_group_column_encoding(row_group, 0), ==,
+               CX_ENCODING_XOR);
+    assert_int(cx_row_group_column_encoding(row_group, 1), ==,
+               CX_ENCODING_XOR);
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        float flt, expected_flt = (float)(position % 13) * 0.5f;
+        double dbl, expected_dbl = 20 + (position % 40) * 0.25;
+        assert_true(cx_reader_get_flt(reader, 0, &flt));
+        assert_float(flt, ==, expected_flt);
+        assert_true(cx_reader_get_dbl(reader, 1, &dbl));
+        assert_double(dbl, ==, expected_dbl);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+    size_t count =
+        count_matching(fixture->temp_file, cx_predicate_new_flt_eq(0, 6));
+    assert_size(count, ==, 192);
+    count =
+        count_matching(fixture->temp_file, cx_predicate_new_dbl_gt(1, 29));
+    assert_size(count, ==, 186);
+
+    return MUNIT_OK;
+}
+
+static size_t write_metric(const char *path, enum cx_encoding_type encoding,
+                           size_t row_count)
+{
+    struct cx_writer *writer = cx_writer_new(path, row_count);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "metric", CX_COLUMN_DBL, encoding,
+                                     CX_COMPRESSION_ZSTD, 0));
+    for (size_t i = 0; i < row_count; i++)
+        assert_true(cx_writer_put_dbl(writer, 0, 100 + i * 0.001));
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+    struct stat st;
+    assert_int(stat(path, &st), ==, 0);
+    return st.st_size;
+}
+
+static MunitResult test_byte_stream_split_encoding(
+    const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const size_t row_count = 10000;
+
+    size_t plain_size =
+        write_metric(fixture->temp_file, CX_ENCODING_NONE, row_count);
+    size_t split_size = write_metric(
+        fixture->temp_file, CX_ENCODING_BYTE_STREAM_SPLIT, row_count);
+    assert_size(split_size, <, plain_size);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 0);
+    assert_not_null(row_group);
+    assert_int(cx_row_group_column_encoding(row_group, 0), ==,
+               CX_ENCODING_BYTE_STREAM_SPLIT);
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        double value;
+        assert_true(cx_reader_get_dbl(reader, 0, &value));
+        assert_double(value, ==, 100 + position * 0.001);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+    size_t count = count_matching(fixture->temp_file,
+                                  cx_predicate_new_dbl_gt(0, 105.0005));
+    assert_size(count, ==, 4999);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_constant_encoding(const MunitParameter params[],
+                                          void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const size_t row_group_size = 1000, row_count = 2500;
+
+    // constant chunks are elided whatever the requested encoding
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "tenant", CX_COLUMN_I64,
+                                     CX_ENCODING_BITPACK, CX_COMPRESSION_LZ4,
+                                     0));
+    assert_true(cx_writer_add_column(writer, "region", CX_COLUMN_STR,
+                                     CX_ENCODING_DICT, CX_COMPRESSION_ZSTD,
+                                     0));
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE,
+                                     0));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, i < 1000 ? 7 : 8));
+        assert_true(cx_writer_put_str(writer, 1, "eu-west-1"));
+        assert_true(cx_writer_put_i64(writer, 2, i));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 2);
+    assert_not_null(row_group);
+    assert_int(cx_row_group_column_encoding(row_group, 0), ==,
+               CX_ENCODING_CONSTANT);
+    assert_int(cx_row_group_column_encoding(row_group, 1), ==,
+               CX_ENCODING_CONSTANT);
+    assert_int(cx_row_group_column_encoding(row_group, 2), ==,
+               CX_ENCODING_NONE);
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        int64_t tenant;
+        struct cx_string region;
+        assert_true(cx_reader_get_i64(reader, 0, &tenant));
+        assert_int64(tenant, ==, position < 1000 ? 7 : 8);
+        assert_true(cx_reader_get_str(reader, 1, &region));
+        assert_string_equal(region.ptr, "eu-west-1");
+        assert_size(region.len, ==, 9);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+    size_t count =
+        count_matching(fixture->temp_file, cx_predicate_new_i64_eq(0, 8));
+    assert_size(count, ==, 1500);
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_and(2, cx_predicate_new_i64_lt(2, 100),
+                             cx_predicate_new_str_eq(1, "eu-west-1", true)));
+    assert_size(count, ==, 100);
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_str_contains(1, "WEST", false, CX_STR_LOCATION_ANY));
+    assert_size(count, ==, row_count);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_requested_constant_encoding(
+    const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const size_t row_group_size = 8192, row_count = 16384;
+    char buffer[32];
+
+    // chunks that don't hold a single value fall back to the plain layout
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "tenant", CX_COLUMN_I64,
+                                     CX_ENCODING_CONSTANT,
+                                     CX_COMPRESSION_LZ4, 0));
+    assert_true(cx_writer_add_column_paged(writer, "region", CX_COLUMN_STR,
+                                           CX_ENCODING_CONSTANT,
+                                           CX_COMPRESSION_ZSTD, 0, 4096));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, i < 8192 ? 7 : i));
+        if (i < 8192)
+            strcpy(buffer, "eu-west-1");
+        else
+            sprintf(buffer, "region %zu", i % 10);
+        assert_true(cx_writer_put_str(writer, 1, buffer));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    assert_size(cx_row_group_reader_row_group_count(row_group_reader), ==,
+                2);
+    for (size_t i = 0; i < 2; i++) {
+        struct cx_row_group *row_group =
+            cx_row_group_reader_get(row_group_reader, i);
+        assert_not_null(row_group);
+        enum cx_encoding_type expected =
+            i ? CX_ENCODING_NONE : CX_ENCODING_CONSTANT;
+        assert_int(cx_row_group_column_encoding(row_group, 0), ==, expected);
+        assert_int(cx_row_group_column_encoding(row_group, 1), ==, expected);
+        cx_row_group_free(row_group);
+    }
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        int64_t tenant, expected = position < 8192 ? 7 : position;
+        struct cx_string region;
+        assert_true(cx_reader_get_i64(reader, 0, &tenant));
+        assert_int64(tenant, ==, expected);
+        if (position < 8192)
+            strcpy(buffer, "eu-west-1");
+        else
+            sprintf(buffer, "region %zu", position % 10);
+        assert_true(cx_reader_get_str(reader, 1, &region));
+        assert_string_equal(region.ptr, buffer);
+        assert_size(region.len, ==, strlen(buffer));
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_sparse_encoding(const MunitParameter params[],
+                                        void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const size_t row_group_size = 1000, row_count = 2500;
+    char buffer[32];
+
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE,
+                                     0));
+    assert_true(cx_writer_add_column(writer, "note", CX_COLUMN_STR,
+                                     CX_ENCODING_SPARSE, CX_COMPRESSION_ZSTD,
+                                     0));
+    assert_true(cx_writer_add_column(writer, "score", CX_COLUMN_DBL,
+                                     CX_ENCODING_SPARSE, CX_COMPRESSION_NONE,
+                                     0));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, i));
+        if (i % 25) {
+            assert_true(cx_writer_put_null(writer, 1));
+        } else {
+            sprintf(buffer, "note %zu", i);
+            assert_true(cx_writer_put_str(writer, 1, buffer));
+        }
+        if (i % 10)
+            assert_true(cx_writer_put_null(writer, 2));
+        else
+            assert_true(cx_writer_put_dbl(writer, 2, i * 0.5));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 0);
+    assert_not_null(row_group);
+    assert_int(cx_row_group_column_encoding(row_group, 1), ==,
+               CX_ENCODING_SPARSE);
+    assert_int(cx_row_group_column_encoding(row_group, 2), ==,
+               CX_ENCODING_SPARSE);
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        bool null, expected = position % 25 != 0;
+        assert_true(cx_reader_get_null(reader, 1, &null));
+        assert_int(null, ==, expected);
+        if (!null) {
+            struct cx_string note;
+            assert_true(cx_reader_get_str(reader, 1, &note));
+            sprintf(buffer, "note %zu", position);
+            assert_string_equal(note.ptr, buffer);
+        }
+        expected = position % 10 != 0;
+        assert_true(cx_reader_get_null(reader, 2, &null));
+        assert_int(null, ==, expected);
+        double score;
+        assert_true(cx_reader_get_dbl(reader, 2, &score));
+        assert_double(score, ==, null ? 0 : position * 0.5);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+    size_t count =
+        count_matching(fixture->temp_file, cx_predicate_new_null(1));
+    assert_size(count, ==, row_count - row_count / 25);
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_and(2, cx_predicate_negate(cx_predicate_new_null(2)),
+                             cx_predicate_new_i64_lt(0, 1234)));
+    assert_size(count, ==, 124);
+    count = count_matching(fixture->temp_file,
+                           cx_predicate_new_dbl_gt(2, 1000));
+    assert_size(count, ==, 49);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_paged_columns(const MunitParameter params[],
+                                      void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const char *fruits[] = {"apple", "banana", "cherry", "mango"};
+    const size_t row_group_size = 20000, row_count = 30000;
+    const size_t batch_sizes[] = {64, 1024, 4096};
+    char buffer[32];
+
+    // pages must hold a whole number of the largest batches
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_false(cx_writer_add_column_paged(writer, "id", CX_COLUMN_I64,
+                                            CX_ENCODING_NONE,
+                                            CX_COMPRESSION_LZ4, 0, 1000));
+    assert_false(cx_writer_add_column_paged(writer, "id", CX_COLUMN_I64,
+                                            CX_ENCODING_NONE,
+                                            CX_COMPRESSION_LZ4, 0, 4160));
+    assert_true(cx_writer_add_column_paged(writer, "id", CX_COLUMN_I64,
+                                           CX_ENCODING_NONE,
+                                           CX_COMPRESSION_LZ4, 0, 4096));
+    assert_true(cx_writer_add_column_paged(writer, "fruit", CX_COLUMN_STR,
+                                           CX_ENCODING_DICT,
+                                           CX_COMPRESSION_ZSTD, 0, 8192));
+    assert_true(cx_writer_add_column_paged(writer, "note", CX_COLUMN_STR,
+                                           CX_ENCODING_SPARSE,
+                                           CX_COMPRESSION_ZSTD, 0, 4096));
+    assert_true(cx_writer_add_column_paged(writer, "flag", CX_COLUMN_BIT,
+                                           CX_ENCODING_RLE,
+                                           CX_COMPRESSION_NONE, 0, 4096));
+    assert_true(cx_writer_add_column_paged(writer, "score", CX_COLUMN_DBL,
+                                           CX_ENCODING_NONE,
+                                           CX_COMPRESSION_AUTO,
+                                           CX_AUTO_FASTEST, 4096));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, i));
+        if (i % 7)
+            assert_true(cx_writer_put_str(writer, 1, fruits[i / 10 % 4]));
+        else
+            assert_true(cx_writer_put_null(writer, 1));
+        if (i % 50) {
+            assert_true(cx_writer_put_null(writer, 2));
+        } else {
+            sprintf(buffer, "note %zu", i);
+            assert_true(cx_writer_put_str(writer, 2, buffer));
+        }
+        assert_true(cx_writer_put_bit(writer, 3, i / 1000 % 2));
+        assert_true(cx_writer_put_dbl(writer, 4, i * 0.25));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 0);
+    assert_not_null(row_group);
+    assert_size(cx_row_group_column_page_size(row_group, 0), ==, 4096);
+    assert_size(cx_row_group_column_page_size(row_group, 1), ==, 8192);
+    assert_null(cx_row_group_column(row_group, 0));
+    size_t start, count;
+    const struct cx_column *page =
+        cx_row_group_column_page(row_group, 0, 5000, &start, &count);
+    assert_not_null(page);
+    assert_size(start, ==, 4096);
+    assert_size(count, ==, 4096);
+    assert_size(cx_column_count(page), ==, 4096);
+    page = cx_row_group_column_page(row_group, 0, 19999, &start, &count);
+    assert_not_null(page);
+    assert_size(start, ==, 16384);
+    assert_size(count, ==, row_group_size - 16384);
+    assert_null(cx_row_group_column_page(row_group, 0, 20000, &start, &count));
+    const struct cx_index *index =
+        cx_row_group_column_page_index(row_group, 0, 5000);
+    assert_not_null(index);
+    assert_int64(index->min.i64, ==, 4096);
+    assert_int64(index->max.i64, ==, 8191);
+    assert_int(cx_row_group_column_encoding(row_group, 1), ==,
+               CX_ENCODING_DICT);
+
+    // a batch can't straddle two pages
+    struct cx_row_group_cursor *cursor =
+        cx_row_group_cursor_new_batched(row_group, 192);
+    assert_null(cursor);
+
+    // page indexes narrow down what the row group index can't
+    struct cx_predicate *predicate = cx_predicate_new_i64_lt(0, 5000);
+    assert_not_null(predicate);
+    assert_int(cx_index_match_indexes(predicate, row_group), ==,
+               CX_INDEX_MATCH_UNKNOWN);
+    assert_int(cx_index_match_page_indexes(predicate, row_group, 0), ==,
+               CX_INDEX_MATCH_ALL);
+    assert_int(cx_index_match_page_indexes(predicate, row_group, 4096), ==,
+               CX_INDEX_MATCH_UNKNOWN);
+    assert_int(cx_index_match_page_indexes(predicate, row_group, 8192), ==,
+               CX_INDEX_MATCH_NONE);
+    cx_predicate_free(predicate);
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
+
+    for (size_t i = 0; i < sizeof(batch_sizes) / sizeof(*batch_sizes); i++) {
+        struct cx_reader *reader =
+            cx_reader_new_batched(fixture->temp_file, NULL, batch_sizes[i]);
+        assert_not_null(reader);
+        size_t position = 0;
+        for (; cx_reader_next(reader); position++) {
+            int64_t id;
+            assert_true(cx_reader_get_i64(reader, 0, &id));
+            assert_int64(id, ==, position);
+            bool null;
+            assert_true(cx_reader_get_null(reader, 1, &null));
+            bool expected_null = position % 7 == 0;
+            assert_int(null, ==, expected_null);
+            struct cx_string string;
+            if (!null) {
+                assert_true(cx_reader_get_str(reader, 1, &string));
+                const char *fruit = fruits[position / 10 % 4];
+                assert_string_equal(string.ptr, fruit);
+            }
+            assert_true(cx_reader_get_null(reader, 2, &null));
+            expected_null = position % 50 != 0;
+            assert_int(null, ==, expected_null);
+            if (!null) {
+                assert_true(cx_reader_get_str(reader, 2, &string));
+                sprintf(buffer, "note %zu", position);
+                assert_string_equal(string.ptr, buffer);
+            }
+            bool flag, expected_flag = position / 1000 % 2;
+            assert_true(cx_reader_get_bit(reader, 3, &flag));
+            assert_int(flag, ==, expected_flag);
+            double score;
+            assert_true(cx_reader_get_dbl(reader, 4, &score));
+            assert_double(score, ==, position * 0.25);
+        }
+        assert_false(cx_reader_error(reader));
+        assert_size(position, ==, row_count);
+        cx_reader_free(reader);
+    }
+
+    count =
+        count_matching(fixture->temp_file, cx_predicate_new_i64_lt(0, 5000));
+    assert_size(count, ==, 5000);
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_and(2, cx_predicate_new_i64_gt(0, 24999),
+                             cx_predicate_new_bit_eq(3, true)));
+    assert_size(count, ==, 3000);
+    count = count_matching(fixture->temp_file,
+                           cx_predicate_new_str_eq(1, "cherry", true));
+    assert_size(count, ==, 6428);
+    count = count_matching(fixture->temp_file,
+                           cx_predicate_negate(cx_predicate_new_null(2)));
+    assert_size(count, ==, row_count / 50);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_streamed_columns(const MunitParameter params[],
+                                         void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    // the first row group has chunks large enough to be streamed, while
+    // the second is decompressed up front
+    const size_t row_group_size = 300000, row_count = 400000;
+    const size_t batch_sizes[] = {64, 4096};
+
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_ZSTD,
+                                     1));
+    assert_true(cx_writer_add_column(writer, "bucket", CX_COLUMN_I32,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_ZSTD,
+                                     1));
+    assert_true(cx_writer_add_column(writer, "score", CX_COLUMN_DBL,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_ZSTD,
+                                     1));
+    assert_true(cx_writer_add_column(writer, "flag", CX_COLUMN_BIT,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_ZSTD,
+                                     1));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, i));
+        assert_true(cx_writer_put_i32(writer, 1, i / 100));
+        assert_true(cx_writer_put_dbl(writer, 2, i * 0.5));
+        assert_true(cx_writer_put_bit(writer, 3, i % 3 == 0));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    // bit columns are always decompressed up front
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    for (size_t i = 0; i < 2; i++) {
+        struct cx_row_group *row_group =
+            cx_row_group_reader_get(row_group_reader, i);
+        assert_not_null(row_group);
+        for (size_t j = 0; j < 4; j++) {
+            bool expected = !i && j < 3;
+            assert_int(cx_row_group_column_streamed(row_group, j), ==,
+                       expected);
+        }
+        cx_row_group_free(row_group);
+    }
+    cx_row_group_reader_free(row_group_reader);
+
+    for (size_t i = 0; i < sizeof(batch_sizes) / sizeof(*batch_sizes); i++) {
+        struct cx_reader *reader =
+            cx_reader_new_batched(fixture->temp_file, NULL, batch_sizes[i]);
+        assert_not_null(reader);
+        size_t position = 0;
+        for (; cx_reader_next(reader); position++) {
+            int64_t id;
+            assert_true(cx_reader_get_i64(reader, 0, &id));
+            assert_int64(id, ==, position);
+            int32_t bucket;
+            assert_true(cx_reader_get_i32(reader, 1, &bucket));
+            assert_int32(bucket, ==, position / 100);
+            double score;
+            assert_true(cx_reader_get_dbl(reader, 2, &score));
+            assert_double(score, ==, position * 0.5);
+            bool flag, expected_flag = position % 3 == 0;
+            assert_true(cx_reader_get_bit(reader, 3, &flag));
+            assert_int(flag, ==, expected_flag);
+        }
+        assert_false(cx_reader_error(reader));
+        assert_size(position, ==, row_count);
+        cx_reader_free(reader);
+    }
+
+    // columns that are only read for matching batches skip the rest by
+    // decompressing them
+    struct cx_reader *reader = cx_reader_new_matching(
+        fixture->temp_file, cx_predicate_new_i32_gt(1, 2500));
+    assert_not_null(reader);
+    size_t count = 0;
+    for (; cx_reader_next(reader); count++) {
+        int64_t id;
+        assert_true(cx_reader_get_i64(reader, 0, &id));
+        double score;
+        assert_true(cx_reader_get_dbl(reader, 2, &score));
+        assert_double(score, ==, id * 0.5);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(count, ==, row_count - 250100);
+    cx_reader_free(reader);
+
+    count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_and(2, cx_predicate_new_i64_lt(0, 1000),
+                             cx_predicate_new_bit_eq(3, true)));
+    assert_size(count, ==, 334);
+
+    return MUNIT_OK;
+}
+
+static off_t write_events(const char *path, size_t dictionary_size)
+{
+    const size_t row_group_size = 50, row_count = 8000;
+    static const char *actions[] = {"view", "click", "scroll", "purchase"};
+    char buffer[128];
+
+    struct cx_writer *writer = cx_writer_new(path, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_LZ4,
+                                     0));
+    assert_true(cx_writer_add_column(writer, "event", CX_COLUMN_STR,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_ZSTD,
+                                     3));
+    if (dictionary_size)
+        assert_true(cx_writer_train_dictionaries(writer, dictionary_size));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, i));
+        if (i % 10 == 0) {
+            assert_true(cx_writer_put_null(writer, 1));
+            continue;
+        }
+        size_t hash = i * 2654435761u;
+        sprintf(buffer,
+                "{\"action\":\"%s\",\"page\":\"/products/%zu\","
+                "\"referrer\":\"https://www.example.com/search\"}",
+                actions[hash % 4], hash % 1000);
+        assert_true(cx_writer_put_str(writer, 1, buffer));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct stat st;
+    assert_int(stat(path, &st), ==, 0);
+    return st.st_size;
+}
+
+static MunitResult test_zstd_dictionaries(const MunitParameter params[],
+                                          void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+    const size_t row_count = 8000;
+    static const char *actions[] = {"view", "click", "scroll", "purchase"};
+    char buffer[128];
+
+    off_t plain_size = write_events(fixture->temp_file, 0);
+    off_t size = write_events(fixture->temp_file, 4096);
+    assert_int64(size, <, plain_size);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        int64_t id;
+        assert_true(cx_reader_get_i64(reader, 0, &id));
+        assert_int64(id, ==, position);
+        struct cx_string event;
+        assert_true(cx_reader_get_str(reader, 1, &event));
+        if (position % 10 == 0) {
+            assert_size(event.len, ==, 0);
+            continue;
+        }
+        size_t hash = position * 2654435761u;
+        sprintf(buffer,
+                "{\"action\":\"%s\",\"page\":\"/products/%zu\","
+                "\"referrer\":\"https://www.example.com/search\"}",
+                actions[hash % 4], hash % 1000);
+        assert_string_equal(event.ptr, buffer);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+    size_t count = count_matching(
+        fixture->temp_file,
+        cx_predicate_new_str_contains(1, "\"purchase\"", true,
+                                      CX_STR_LOCATION_ANY));
+    assert_size(count, ==, 2000);
+
+    // dictionaries can't be enabled once the file header has been written
+    struct cx_row_group_writer *row_group_writer =
+        cx_row_group_writer_new(fixture->temp_file);
+    assert_not_null(row_group_writer);
+    assert_false(cx_row_group_writer_train_dictionaries(row_group_writer, 0));
+    assert_true(cx_row_group_writer_finish(row_group_writer, true));
+    assert_false(
+        cx_row_group_writer_train_dictionaries(row_group_writer, 4096));
+    cx_row_group_writer_free(row_group_writer);
+
+    return MUNIT_OK;
+}
+
+static char *read_file(const char *path, long *size)
+{
+    FILE *file = fopen(path, "rb");
+    assert_not_null(file);
+    assert_int(fseek(file, 0, SEEK_END), ==, 0);
+    *size = ftell(file);
+    rewind(file);
+    char *contents = malloc(*size);
+    assert_not_null(contents);
+    assert_size(fread(contents, 1, *size, file), ==, *size);
+    fclose(file);
+    return contents;
+}
+
+static void write_parallel(const char *path, int thread_count)
+{
+    const size_t row_group_size = 10000, row_count = 25000;
+    char buffer[32];
+
+    struct cx_writer *writer = cx_writer_new(path, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_DELTA, CX_COMPRESSION_ZSTD,
+                                     9));
+    assert_true(cx_writer_add_column_paged(writer, "bucket", CX_COLUMN_I32,
+                                           CX_ENCODING_NONE,
+                                           CX_COMPRESSION_LZ4, 0, 4096));
+    assert_true(cx_writer_add_column(writer, "score", CX_COLUMN_DBL,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_AUTO,
+                                     50));
+    assert_true(cx_writer_add_column(writer, "name", CX_COLUMN_STR,
+                                     CX_ENCODING_DICT, CX_COMPRESSION_ZSTD,
+                                     3));
+    assert_true(cx_writer_set_threads(writer, thread_count));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, i * 3));
+        assert_true(cx_writer_put_i32(writer, 1, i / 7));
+        assert_true(cx_writer_put_dbl(writer, 2, (i % 1000) * 0.25));
+        if (i % 5 == 0) {
+            assert_true(cx_writer_put_null(writer, 3));
+        } else {
+            sprintf(buffer, "name %zu", i % 300);
+            assert_true(cx_writer_put_str(writer, 3, buffer));
+        }
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+}
+
+static MunitResult test_parallel_writes(const MunitParameter params[],
+                                        void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+    const int thread_counts[] = {2, 4, 16};
+
+    write_parallel(fixture->temp_file, 1);
+    long size;
+    char *expected = read_file(fixture->temp_file, &size);
+
+    // the file is the same whatever the number of threads
+    char *path = cx_temp_file_new();
+    assert_not_null(path);
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(*thread_counts);
+         i++) {
+        write_parallel(path, thread_counts[i]);
+        long actual_size;
+        char *actual = read_file(path, &actual_size);
+        assert_long(actual_size, ==, size);
+        assert_memory_equal(size, actual, expected);
+        free(actual);
+    }
+    free(expected);
+
+    struct cx_reader *reader = cx_reader_new(path);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        int64_t id;
+        assert_true(cx_reader_get_i64(reader, 0, &id));
+        assert_int64(id, ==, position * 3);
+        int32_t bucket;
+        assert_true(cx_reader_get_i32(reader, 1, &bucket));
+        assert_int32(bucket, ==, position / 7);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, 25000);
+    cx_reader_free(reader);
+    cx_temp_file_free(path);
+
+    struct cx_writer *writer = cx_writer_new(fixture->temp_file, 100);
+    assert_not_null(writer);
+    assert_false(cx_writer_set_threads(writer, 0));
+    cx_writer_free(writer);
+
+    return MUNIT_OK;
+}
+
+static bool write_async(const char *path, size_t in_flight, int thread_count,
+                        size_t row_count)
+{
+    struct cx_writer *writer = cx_writer_new(path, 1000);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE,
+                                     0));
+    assert_true(cx_writer_add_column(writer, "bucket", CX_COLUMN_I32,
+                                     CX_ENCODING_RLE, CX_COMPRESSION_ZSTD,
+                                     1));
+    assert_true(cx_writer_set_async(writer, in_flight));
+    assert_true(cx_writer_set_threads(writer, thread_count));
+    bool ok = true;
+    for (size_t i = 0; ok && i < row_count; i++) {
+        ok = cx_writer_put_i64(writer, 0, i);
+        if (ok && i % 4 == 0)
+            ok = cx_writer_put_null(writer, 1);
+        else if (ok)
+            ok = cx_writer_put_i32(writer, 1, i / 100);
+    }
+    if (ok)
+        ok = cx_writer_finish(writer, false);
+    cx_writer_free(writer);
+    return ok;
+}
+
+static MunitResult test_async_writes(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+    const size_t row_count = 10500;
+    const size_t in_flight[] = {1, 3};
+
+    assert_true(write_async(fixture->temp_file, 0, 1, row_count));
+    long size;
+    char *expected = read_file(fixture->temp_file, &size);
+
+    // row groups are written in order whatever the number in flight
+    for (size_t i = 0; i < sizeof(in_flight) / sizeof(*in_flight); i++) {
+        assert_true(
+            write_async(fixture->temp_file, in_flight[i], i + 1, row_count));
+        long actual_size;
+        char *actual = read_file(fixture->temp_file, &actual_size);
+        assert_long(actual_size, ==, size);
+        assert_memory_equal(size, actual, expected);
+        free(actual);
+    }
+    free(expected);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        int64_t id;
+        assert_true(cx_reader_get_i64(reader, 0, &id));
+        assert_int64(id, ==, position);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, row_count);
+    cx_reader_free(reader);
+
+#ifdef __linux__
+    // a row group that fails to flush fails the puts that follow
+    assert_false(write_async("/dev/full", 2, 1, 100000));
+#endif
+
+    return MUNIT_OK;
+}
+
+static bool write_direct(const char *path, bool direct, size_t in_flight)
+{
+    const size_t row_group_size = 200000, row_count = 450000;
+    struct cx_writer *writer = cx_writer_new(path, row_group_size);
+    assert_not_null(writer);
+    // the uncompressed chunks are larger than the write buffer
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE,
+                                     0));
+    assert_true(cx_writer_add_column_paged(writer, "bucket", CX_COLUMN_I32,
+                                           CX_ENCODING_NONE,
+                                           CX_COMPRESSION_LZ4, 0, 8192));
+    assert_true(cx_writer_metadata(writer, "direct"));
+    assert_true(cx_writer_set_async(writer, in_flight));
+    if (direct && !cx_writer_set_direct(writer, true)) {
+        // the file system doesn't support direct IO
+        cx_writer_free(writer);
+        return false;
+    }
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, i));
+        if (i % 3 == 0)
+            assert_true(cx_writer_put_null(writer, 1));
+        else
+            assert_true(cx_writer_put_i32(writer, 1, i / 1000));
+        if (i == row_group_size)
+            assert_false(cx_writer_set_direct(writer, !direct));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+    return true;
+}
+
+static MunitResult test_direct_writes(const MunitParameter params[],
+                                      void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    assert_true(write_direct(fixture->temp_file, false, 0));
+    long size;
+    char *expected = read_file(fixture->temp_file, &size);
+
+    // the file is the same whether or not it bypasses the page cache
+    const size_t in_flight[] = {0, 2};
+    for (size_t i = 0; i < sizeof(in_flight) / sizeof(*in_flight); i++) {
+        if (!write_direct(fixture->temp_file, true, in_flight[i]))
+            break;
+        long actual_size;
+        char *actual = read_file(fixture->temp_file, &actual_size);
+        assert_long(actual_size, ==, size);
+        assert_memory_equal(size, actual, expected);
+        free(actual);
+    }
+    free(expected);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    const char *metadata;
+    assert_true(cx_reader_metadata(reader, &metadata));
+    assert_string_equal(metadata, "direct");
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        int64_t id;
+        assert_true(cx_reader_get_i64(reader, 0, &id));
+        assert_int64(id, ==, position);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, 450000);
+    cx_reader_free(reader);
+
+    return MUNIT_OK;
+}
+
+#define ARRAY_ROWS 5200
+
+static void write_arrays(const char *path, size_t batch_size,
+                         size_t in_flight)
+{
+    static uint64_t bits[ARRAY_ROWS / 64 + 1], nulls[ARRAY_ROWS / 64 + 1];
+    static int32_t i32s[ARRAY_ROWS];
+    static int64_t i64s[ARRAY_ROWS];
+    static float flts[ARRAY_ROWS];
+    static double dbls[ARRAY_ROWS];
+    static uint32_t offsets[ARRAY_ROWS + 1];
+    static char data[ARRAY_ROWS * 16];
+    char buffer[16];
+
+    struct cx_writer *writer = cx_writer_new(path, 1000);
+    assert_not_null(writer);
+    const enum cx_column_type types[] = {CX_COLUMN_BIT, CX_COLUMN_I32,
+                                         CX_COLUMN_I64, CX_COLUMN_FLT,
+                                         CX_COLUMN_DBL, CX_COLUMN_STR};
+    for (size_t i = 0; i < sizeof(types) / sizeof(*types); i++)
+        assert_true(cx_writer_add_column(writer, "column", types[i],
+                                         CX_ENCODING_NONE,
+                                         CX_COMPRESSION_LZ4, 0));
+    assert_true(cx_writer_set_async(writer, in_flight));
+
+    // batch_size 0 puts each row on its own
+    if (!batch_size) {
+        for (size_t i = 0; i < ARRAY_ROWS; i++) {
+            if (i % 7 == 0) {
+                for (size_t j = 0; j < 6; j++)
+                    assert_true(cx_writer_put_null(writer, j));
+                continue;
+            }
+            sprintf(buffer, "row %zu", i);
+            assert_true(cx_writer_put_bit(writer, 0, i % 3 == 0));
+            assert_true(cx_writer_put_i32(writer, 1, i));
+            assert_true(cx_writer_put_i64(writer, 2, i * 1000));
+            assert_true(cx_writer_put_flt(writer, 3, i * 0.5));
+            assert_true(cx_writer_put_dbl(writer, 4, i * 0.25));
+            assert_true(cx_writer_put_str(writer, 5, buffer));
+        }
+        assert_true(cx_writer_finish(writer, true));
+        cx_writer_free(writer);
+        return;
+    }
+
+    for (size_t start = 0; start < ARRAY_ROWS; start += batch_size) {
+        size_t count = ARRAY_ROWS - start;
+        if (count > batch_size)
+            count = batch_size;
+        memset(bits, 0, sizeof(bits));
+        memset(nulls, 0, sizeof(nulls));
+        offsets[0] = 0;
+        for (size_t j = 0; j < count; j++) {
+            size_t i = start + j;
+            if (i % 3 == 0)
+                bits[j / 64] |= (uint64_t)1 << (j % 64);
+            if (i % 7 == 0)
+                nulls[j / 64] |= (uint64_t)1 << (j % 64);
+            i32s[j] = i;
+            i64s[j] = i * 1000;
+            flts[j] = i * 0.5;
+            dbls[j] = i * 0.25;
+            sprintf(buffer, "row %zu", i);
+            memcpy(data + offsets[j], buffer, strlen(buffer));
+            offsets[j + 1] = offsets[j] + strlen(buffer);
+        }
+        assert_true(cx_writer_put_bit_array(writer, 0, bits, nulls, count));
+        assert_true(cx_writer_put_i32_array(writer, 1, i32s, nulls, count));
+        assert_true(cx_writer_put_i64_array(writer, 2, i64s, nulls, count));
+        assert_true(cx_writer_put_flt_array(writer, 3, flts, nulls, count));
+        assert_true(cx_writer_put_dbl_array(writer, 4, dbls, nulls, count));
+        assert_true(
+            cx_writer_put_str_array(writer, 5, offsets, data, nulls, count));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+}
+
+static MunitResult test_array_writes(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+    // batches that end part way through a row group, that fill it exactly,
+    // and that span several row groups
+    const size_t batch_sizes[] = {1, 64, 700, 1000, 3500, ARRAY_ROWS};
+    const size_t in_flight[] = {0, 2};
+
+    write_arrays(fixture->temp_file, 0, 0);
+    long size;
+    char *expected = read_file(fixture->temp_file, &size);
+
+    // the file is the same as one written a row at a time
+    for (size_t i = 0; i < sizeof(batch_sizes) / sizeof(*batch_sizes); i++) {
+        for (size_t j = 0; j < sizeof(in_flight) / sizeof(*in_flight); j++) {
+            write_arrays(fixture->temp_file, batch_sizes[i], in_flight[j]);
+            long actual_size;
+            char *actual = read_file(fixture->temp_file, &actual_size);
+            assert_long(actual_size, ==, size);
+            assert_memory_equal(size, actual, expected);
+            free(actual);
+        }
+    }
+    free(expected);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    assert_size(cx_reader_row_count(reader), ==, ARRAY_ROWS);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        int64_t value;
+        struct cx_string string;
+        char buffer[16];
+        assert_true(cx_reader_get_i64(reader, 2, &value));
+        assert_true(cx_reader_get_str(reader, 5, &string));
+        bool null;
+        assert_true(cx_reader_get_null(reader, 2, &null));
+        assert_true(null == (position % 7 == 0));
+        if (null) {
+            assert_int64(value, ==, 0);
+            assert_string_equal(string.ptr, "");
+            continue;
+        }
+        assert_int64(value, ==, position * 1000);
+        sprintf(buffer, "row %zu", position);
+        assert_string_equal(string.ptr, buffer);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, ARRAY_ROWS);
+    cx_reader_free(reader);
+
+    struct cx_writer *writer = cx_writer_new(fixture->temp_file, 100);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "bit", CX_COLUMN_BIT,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE,
+                                     0));
+    assert_false(cx_writer_put_bit_array(writer, 0, NULL, NULL, 1));
+    const uint64_t bits = 1;
+    assert_false(cx_writer_put_bit_array(writer, 1, &bits, NULL, 1));
+    assert_false(cx_writer_put_i32_array(writer, 0, NULL, NULL, 1));
+    assert_true(cx_writer_add_column(writer, "str", CX_COLUMN_STR,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE,
+                                     0));
+    const uint32_t offsets[] = {0, 5};
+    assert_false(cx_writer_put_str_array(writer, 1, offsets, "ab\0cd", NULL,
+                                         1));
+    cx_writer_free(writer);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_no_nulls(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const size_t row_group_size = 100, row_count = 250;
+
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE,
+                                     0));
+    assert_true(cx_writer_add_column(writer, "score", CX_COLUMN_I32,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_LZ4,
+                                     0));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, i));
+        // only the first row group has nulls
+        if (i < 50 && i % 2)
+            assert_true(cx_writer_put_null(writer, 1));
+        else
+            assert_true(cx_writer_put_i32(writer, 1, i));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    for (size_t i = 0; i < 3; i++) {
+        struct cx_row_group *row_group =
+            cx_row_group_reader_get(row_group_reader, i);
+        assert_not_null(row_group);
+        struct cx_row_group_cursor *cursor =
+            cx_row_group_cursor_new(row_group);
+        assert_not_null(cursor);
+        size_t position = i * row_group_size, count;
+        while (cx_row_group_cursor_next(cursor)) {
+            // columns without nulls share a zero bitmap
+            const uint64_t *id_nulls =
+                cx_row_group_cursor_batch_nulls(cursor, 0, &count);
+            assert_not_null(id_nulls);
+            assert_uint64(*id_nulls, ==, 0);
+            const uint64_t *score_nulls =
+                cx_row_group_cursor_batch_nulls(cursor, 1, &count);
+            assert_not_null(score_nulls);
+            if (i)
+                assert_ptr_equal(score_nulls, id_nulls);
+            else
+                assert_ptr_not_equal(score_nulls, id_nulls);
+            for (size_t j = 0; j < count; j++) {
+                bool expected = position + j < 50 && (position + j) % 2;
+                assert_int(!!(*score_nulls & ((uint64_t)1 << j)), ==,
+                           expected);
+            }
+            position += count;
+        }
+        cx_row_group_cursor_free(cursor);
+
+        // the missing null bitmap can still be read as a column
+        const struct cx_column *nulls = cx_row_group_nulls(row_group, 0);
+        assert_not_null(nulls);
+        assert_size(cx_column_count(nulls), ==, i < 2 ? 100 : 50);
+        struct cx_index *index = cx_index_new(nulls);
+        assert_not_null(index);
+        assert_false(index->max.bit);
+        cx_index_free(index);
+        cx_row_group_free(row_group);
+    }
+    cx_row_group_reader_free(row_group_reader);
+
+    size_t count =
+        count_matching(fixture->temp_file, cx_predicate_new_null(1));
+    assert_size(count, ==, 25);
+    count = count_matching(fixture->temp_file,
+                           cx_predicate_negate(cx_predicate_new_null(0)));
+    assert_size(count, ==, row_count);
+
+    return MUNIT_OK;
+}
+
+static int64_t auto_compression_value(size_t row)
+{
+    // timestamps in the first row group, noise (splitmix64) in the second
+    if (row < 10000)
+        return 1500000000000 + (int64_t)row * 1000;
+    uint64_t value = row * 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return (int64_t)(value ^ (value >> 31));
+}
+
+static off_t write_auto_compression(const char *path, int weight)
+{
+    const size_t row_group_size = 10000, row_count = 20000;
+    char buffer[32];
+
+    struct cx_writer *writer = cx_writer_new(path, row_group_size);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "timestamp", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_AUTO,
+                                     weight));
+    assert_true(cx_writer_add_column(writer, "note", CX_COLUMN_STR,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_AUTO,
+                                     weight));
+    for (size_t i = 0; i < row_count; i++) {
+        assert_true(
+            cx_writer_put_i64(writer, 0, auto_compression_value(i)));
+        if (i % 100) {
+            assert_true(cx_writer_put_null(writer, 1));
+        } else {
+            sprintf(buffer, "note %zu", i);
+            assert_true(cx_writer_put_str(writer, 1, buffer));
+        }
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct stat st;
+    assert_int(stat(path, &st), ==, 0);
+    return st.st_size;
+}
+
+static MunitResult test_auto_compression(const MunitParameter params[],
+                                         void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    char buffer[32];
+
+    // the weight given to decode speed must be a percentage
+    struct cx_writer *writer = cx_writer_new(fixture->temp_file, 100);
+    assert_not_null(writer);
+    assert_false(cx_writer_add_column(writer, "a", CX_COLUMN_I64,
+                                      CX_ENCODING_NONE, CX_COMPRESSION_AUTO,
+                                      101));
+    assert_false(cx_writer_add_column(writer, "a", CX_COLUMN_I64,
+                                      CX_ENCODING_NONE, CX_COMPRESSION_AUTO,
+                                      -1));
+    cx_writer_free(writer);
+
+    off_t fastest_size =
+        write_auto_compression(fixture->temp_file, CX_AUTO_FASTEST);
+    off_t smallest_size =
+        write_auto_compression(fixture->temp_file, CX_AUTO_SMALLEST);
+    assert_true(smallest_size <= fastest_size);
+
+    // the choice is made (and recorded) per chunk
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 0);
+    assert_not_null(row_group);
+    enum cx_encoding_type encoding =
+        cx_row_group_column_encoding(row_group, 0);
+    assert_true(encoding == CX_ENCODING_DELTA ||
+                encoding == CX_ENCODING_DELTA_OF_DELTA);
+    cx_row_group_free(row_group);
+    row_group = cx_row_group_reader_get(row_group_reader, 1);
+    assert_not_null(row_group);
+    assert_int(cx_row_group_column_encoding(row_group, 0), ==,
+               CX_ENCODING_NONE);
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        int64_t value;
+        assert_true(cx_reader_get_i64(reader, 0, &value));
+        assert_int64(value, ==, auto_compression_value(position));
+        bool null, expected_null = position % 100 != 0;
+        assert_true(cx_reader_get_null(reader, 1, &null));
+        assert_int(null, ==, expected_null);
+        if (!null) {
+            struct cx_string note;
+            assert_true(cx_reader_get_str(reader, 1, &note));
+            sprintf(buffer, "note %zu", position);
+            assert_string_equal(note.ptr, buffer);
+        }
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, 20000);
+    cx_reader_free(reader);
+
+    return MUNIT_OK;
+}
+
 static MunitResult test_metadata(const MunitParameter params[], void *ptr)
 {
     struct cx_file_fixture *fixture = ptr;
@@ -425,4 +2193,43 @@ MunitTest file_tests[] = {
     {"/empty-columns", test_empty_columns, setup, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/metadata", test_metadata, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/no-nulls", test_no_nulls, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/dict-encoding", test_dict_encoding, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/offsets-encoding", test_offsets_encoding, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/fsst-encoding", test_fsst_encoding, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/rle-encoding", test_rle_encoding, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/delta-encoding", test_delta_encoding, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/bitpack-encoding", test_bitpack_encoding, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/xor-encoding", test_xor_encoding, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/byte-stream-split-encoding", test_byte_stream_split_encoding, setup,
+     teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/constant-encoding", test_constant_encoding, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/requested-constant-encoding", test_requested_constant_encoding, setup,
+     teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/sparse-encoding", test_sparse_encoding, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/auto-compression", test_auto_compression, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/paged-columns", test_paged_columns, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/streamed-columns", test_streamed_columns, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/zstd-dictionaries", test_zstd_dictionaries, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/parallel-writes", test_parallel_writes, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/async-writes", test_async_writes, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/array-writes", test_array_writes, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/direct-writes", test_direct_writes, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
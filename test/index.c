@@ -1,8 +1,10 @@
 #define __STDC_LIMIT_MACROS
 #include "index.h"
 
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "helpers.h"
 
@@ -242,9 +244,235 @@ static MunitResult test_str_index(const MunitParameter params[], void *fixture)
     return MUNIT_OK;
 }
 
+static MunitResult test_negative_index(const MunitParameter params[],
+                                       void *fixture)
+{
+    struct cx_column *i32 = cx_column_new(CX_COLUMN_I32, CX_ENCODING_NONE);
+    struct cx_column *i64 = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    struct cx_column *dbl = cx_column_new(CX_COLUMN_DBL, CX_ENCODING_NONE);
+    assert_not_null(i32);
+    assert_not_null(i64);
+    assert_not_null(dbl);
+    assert_true(cx_column_put_i32(i32, -20));
+    assert_true(cx_column_put_i32(i32, -10));
+    assert_true(cx_column_put_i64(i64, -20));
+    assert_true(cx_column_put_i64(i64, -10));
+    assert_true(cx_column_put_dbl(dbl, -2.5));
+    assert_true(cx_column_put_dbl(dbl, -1.5));
+
+    struct cx_index *index = cx_index_new(i32);
+    assert_int32(index->min.i32, ==, -20);
+    assert_int32(index->max.i32, ==, -10);
+    cx_index_free(index);
+    index = cx_index_new(i64);
+    assert_int64(index->min.i64, ==, -20);
+    assert_int64(index->max.i64, ==, -10);
+    cx_index_free(index);
+    index = cx_index_new(dbl);
+    assert_double(index->min.dbl, ==, -2.5);
+    assert_double(index->max.dbl, ==, -1.5);
+    cx_index_free(index);
+
+    cx_column_free(i32);
+    cx_column_free(i64);
+    cx_column_free(dbl);
+    return MUNIT_OK;
+}
+
+static void assert_index_scanned(const struct cx_column *column)
+{
+    const struct cx_index *stats = cx_column_index(column);
+    assert_not_null(stats);
+    // a column over the same buffer has its index built by a scan
+    size_t size;
+    const void *buffer = cx_column_export(column, &size);
+    struct cx_column *copy =
+        cx_column_new_mmapped(cx_column_type(column), CX_ENCODING_NONE,
+                              buffer, size, cx_column_count(column));
+    assert_not_null(copy);
+    assert_null(cx_column_index(copy));
+    struct cx_index *index = cx_index_new(copy);
+    assert_not_null(index);
+    assert_memory_equal(sizeof(*index), index, stats);
+    cx_index_free(index);
+    cx_column_free(copy);
+}
+
+static MunitResult test_incremental_index(const MunitParameter params[],
+                                          void *fixture)
+{
+    const uint64_t bits[] = {UINT64_MAX, UINT64_MAX, 0x5};
+    const uint64_t nulls[] = {0, 0x8000000000000000ULL, 0x2};
+    const int32_t i32s[] = {-5, 10, 300, -400, 7};
+    const float flts[] = {1.5, -2.5, 1000, 0.25};
+    const uint32_t offsets[] = {0, 3, 3, 10};
+    const char data[] = "abcdefghij";
+
+    struct cx_column *bit = cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+    struct cx_column *i32 = cx_column_new(CX_COLUMN_I32, CX_ENCODING_NONE);
+    struct cx_column *flt = cx_column_new(CX_COLUMN_FLT, CX_ENCODING_NONE);
+    struct cx_column *str = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_true(bit && i32 && flt && str);
+    assert_index_scanned(bit);
+    assert_index_scanned(str);
+
+    assert_true(cx_column_put_bit(bit, true));
+    assert_true(cx_column_put_bit_array(bit, bits, NULL, 130));
+    assert_index_scanned(bit);
+    assert_true(cx_column_put_bit_array(bit, bits, nulls, 130));
+    assert_index_scanned(bit);
+    assert_true(cx_column_put_unit(bit));
+    assert_index_scanned(bit);
+
+    assert_true(cx_column_put_i32(i32, 20));
+    assert_true(cx_column_put_i32_array(i32, i32s, NULL, 5));
+    assert_index_scanned(i32);
+    assert_true(cx_column_put_i32_array(i32, i32s, nulls + 2, 5));
+    assert_index_scanned(i32);
+
+    assert_true(cx_column_put_flt_array(flt, flts, NULL, 4));
+    assert_true(cx_column_put_flt(flt, -1000));
+    assert_index_scanned(flt);
+
+    assert_true(cx_column_put_str(str, "abcd"));
+    assert_true(cx_column_put_str_array(str, offsets, data, NULL, 3));
+    assert_index_scanned(str);
+    assert_true(cx_column_put_str_array(str, offsets, data, nulls + 2, 3));
+    assert_index_scanned(str);
+
+    // the values that move keep their statistics, those left are rescanned
+    struct cx_column *rest = cx_column_new(CX_COLUMN_I32, CX_ENCODING_NONE);
+    assert_not_null(rest);
+    assert_true(cx_column_split(i32, 3, rest));
+    assert_null(cx_column_index(i32));
+    assert_index_scanned(rest);
+    struct cx_index *index = cx_index_new(i32);
+    assert_not_null(index);
+    assert_uint64(index->count, ==, 3);
+    assert_int32(index->min.i32, ==, -5);
+    assert_int32(index->max.i32, ==, 20);
+    cx_index_free(index);
+    assert_true(cx_column_split(rest, 0, i32));
+    assert_index_scanned(rest);
+    assert_uint64(cx_column_index(rest)->count, ==, 0);
+
+    cx_column_reset(i32);
+    assert_index_scanned(i32);
+    assert_true(cx_column_put_i32(i32, 1));
+    assert_index_scanned(i32);
+
+    cx_column_free(bit);
+    cx_column_free(i32);
+    cx_column_free(flt);
+    cx_column_free(str);
+    cx_column_free(rest);
+    return MUNIT_OK;
+}
+
+static MunitResult test_update_kernels(const MunitParameter params[],
+                                       void *fixture)
+{
+    int32_t i32s[1000];
+    int64_t i64s[1000];
+    float flts[1000];
+    double dbls[1000];
+    uint64_t bits[16];
+    for (size_t i = 0; i < 1000; i++) {
+        i32s[i] = munit_rand_uint32();
+        i64s[i] = (int64_t)((uint64_t)munit_rand_uint32() << 32 |
+                            munit_rand_uint32());
+        flts[i] = munit_rand_double() * 2000 - 1000;
+        dbls[i] = munit_rand_double() * 2000 - 1000;
+    }
+    // NaN is skipped by the comparisons
+    flts[100] = dbls[100] = NAN;
+    flts[0] = dbls[0] = NAN;
+
+    // every length, so that the vectorized loops end at every lane
+    for (size_t count = 0; count <= 300; count++) {
+        struct cx_index index, expected;
+        cx_index_init(&index, CX_COLUMN_I32);
+        cx_index_init(&expected, CX_COLUMN_I32);
+        cx_index_update_i32(&index, i32s + 700, count);
+        for (size_t i = 0; i < count; i++) {
+            if (i32s[700 + i] < expected.min.i32)
+                expected.min.i32 = i32s[700 + i];
+            if (i32s[700 + i] > expected.max.i32)
+                expected.max.i32 = i32s[700 + i];
+        }
+        assert_uint64(index.count, ==, count);
+        assert_int32(index.min.i32, ==, expected.min.i32);
+        assert_int32(index.max.i32, ==, expected.max.i32);
+
+        cx_index_init(&index, CX_COLUMN_I64);
+        cx_index_init(&expected, CX_COLUMN_I64);
+        cx_index_update_i64(&index, i64s + 700, count);
+        for (size_t i = 0; i < count; i++) {
+            if (i64s[700 + i] < expected.min.i64)
+                expected.min.i64 = i64s[700 + i];
+            if (i64s[700 + i] > expected.max.i64)
+                expected.max.i64 = i64s[700 + i];
+        }
+        assert_int64(index.min.i64, ==, expected.min.i64);
+        assert_int64(index.max.i64, ==, expected.max.i64);
+
+        cx_index_init(&index, CX_COLUMN_FLT);
+        cx_index_init(&expected, CX_COLUMN_FLT);
+        cx_index_update_flt(&index, flts, count);
+        for (size_t i = 0; i < count; i++) {
+            if (flts[i] < expected.min.flt)
+                expected.min.flt = flts[i];
+            if (flts[i] > expected.max.flt)
+                expected.max.flt = flts[i];
+        }
+        assert_true(index.min.flt == expected.min.flt);
+        assert_true(index.max.flt == expected.max.flt);
+
+        cx_index_init(&index, CX_COLUMN_DBL);
+        cx_index_init(&expected, CX_COLUMN_DBL);
+        cx_index_update_dbl(&index, dbls, count);
+        for (size_t i = 0; i < count; i++) {
+            if (dbls[i] < expected.min.dbl)
+                expected.min.dbl = dbls[i];
+            if (dbls[i] > expected.max.dbl)
+                expected.max.dbl = dbls[i];
+        }
+        assert_true(index.min.dbl == expected.min.dbl);
+        assert_true(index.max.dbl == expected.max.dbl);
+    }
+
+    // bitsets are reduced a word at a time, with the last word masked
+    struct cx_index index;
+    memset(bits, 0xff, sizeof(bits));
+    bits[15] = 0x1;
+    cx_index_init(&index, CX_COLUMN_BIT);
+    cx_index_update_bit(&index, bits, 961);
+    assert_true(index.min.bit && index.max.bit);
+    cx_index_update_bit(&index, bits, 962);
+    assert_false(index.min.bit);
+    assert_true(index.max.bit);
+    memset(bits, 0, sizeof(bits));
+    bits[15] = 0x2;
+    cx_index_init(&index, CX_COLUMN_BIT);
+    cx_index_update_bit(&index, bits, 961);
+    assert_false(index.min.bit || index.max.bit);
+    cx_index_update_bit(&index, bits, 962);
+    assert_false(index.min.bit);
+    assert_true(index.max.bit);
+    assert_uint64(index.count, ==, 961 + 962);
+
+    return MUNIT_OK;
+}
+
 MunitTest index_tests[] = {
     {"/bit-index", test_bit_index, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/i32-index", test_i32_index, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/i64-index", test_i64_index, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/str-index", test_str_index, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/negative-index", test_negative_index, NULL, NULL,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/incremental-index", test_incremental_index, NULL, NULL,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/update-kernels", test_update_kernels, NULL, NULL,
+     MUNIT_TEST_OPTION_NONE, NULL},
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
@@ -8,6 +8,7 @@ extern MunitTest predicate_tests[];
 extern MunitTest row_tests[];
 extern MunitTest compress_tests[];
 extern MunitTest file_tests[];
+extern MunitTest encode_tests[];
 
 MunitSuite suites[] = {
     {"/column", column_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
@@ -18,6 +19,7 @@ MunitSuite suites[] = {
     {"/row", row_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
     {"/compress", compress_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
     {"/file", file_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
+    {"/encode", encode_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
     {NULL, NULL, NULL, 1, MUNIT_SUITE_OPTION_NONE}};
 
 static const MunitSuite combined_suite = {"cx", NULL, suites, 1,
@@ -1,5 +1,6 @@
 #include "match.h"
 
+#include "bitpack.h"
 #include "helpers.h"
 
 #define RAND_MOD 512
@@ -170,10 +171,95 @@ static MunitResult test_str(const MunitParameter params[], void *fixture)
     return MUNIT_OK;
 }
 
+static MunitResult test_packed(const MunitParameter params[], void *fixture)
+{
+    uint64_t values[64], planes[64];
+    for (size_t i = 0; i < ITERATIONS; i++) {
+        unsigned width = munit_rand_int_range(1, 64);
+        uint64_t max = width == 64 ? (uint64_t)-1 : ((uint64_t)1 << width) - 1;
+        // draw from a small range so that there are equal values
+        uint64_t base = ((uint64_t)munit_rand_uint32() << 32 |
+                         munit_rand_uint32()) & max;
+        for (size_t j = 0; j < 64; j++) {
+            values[j] = base + munit_rand_int_range(0, RAND_MOD);
+            if (values[j] > max || values[j] < base)
+                values[j] = max;
+        }
+        cx_bitpack_pack(64, values, width, planes);
+        uint64_t cmps[] = {values[munit_rand_int_range(0, 63)], 0, max,
+                           base + RAND_MOD / 2};
+        uint64_t cmp;
+        CX_FOREACH(cmps, cmp)
+        {
+            if (cmp > max)
+                cmp = max;
+            uint64_t eq = 0, lt = 0, gt = 0;
+            for (size_t j = 0; j < 64; j++) {
+                if (values[j] == cmp)
+                    eq |= (uint64_t)1 << j;
+                if (values[j] < cmp)
+                    lt |= (uint64_t)1 << j;
+                if (values[j] > cmp)
+                    gt |= (uint64_t)1 << j;
+            }
+            assert_uint64(cx_match_packed_eq(width, planes, cmp), ==, eq);
+            assert_uint64(cx_match_packed_lt(width, planes, cmp), ==, lt);
+            assert_uint64(cx_match_packed_gt(width, planes, cmp), ==, gt);
+        }
+    }
+    return MUNIT_OK;
+}
+
+static MunitResult test_bitmap(const MunitParameter params[], void *fixture)
+{
+    int32_t i32[CX_BATCH_SIZE_MAX];
+    int64_t i64[CX_BATCH_SIZE_MAX];
+    float flt[CX_BATCH_SIZE_MAX];
+    double dbl[CX_BATCH_SIZE_MAX];
+    uint64_t matches[CX_BATCH_SIZE_MAX / 64];
+    for (size_t i = 0; i < CX_BATCH_SIZE_MAX; i++) {
+        i32[i] = i64[i] = random_i32();
+        flt[i] = dbl[i] = random_flt();
+    }
+    size_t counts[] = {1, 64, 100, 1024, CX_BATCH_SIZE_MAX}, count;
+    CX_FOREACH(counts, count)
+    {
+        int32_t cmp = random_i32();
+        float flt_cmp = random_flt();
+        cx_match_i32_lt_bitmap(count, i32, cmp, matches);
+        for (size_t i = 0; i < count; i += 64) {
+            size_t size = count - i < 64 ? count - i : 64;
+            assert_uint64(matches[i / 64], ==,
+                          cx_match_i32_lt(size, &i32[i], cmp));
+        }
+        cx_match_i64_eq_bitmap(count, i64, cmp, matches);
+        for (size_t i = 0; i < count; i += 64) {
+            size_t size = count - i < 64 ? count - i : 64;
+            assert_uint64(matches[i / 64], ==,
+                          cx_match_i64_eq(size, &i64[i], cmp));
+        }
+        cx_match_flt_gt_bitmap(count, flt, flt_cmp, matches);
+        for (size_t i = 0; i < count; i += 64) {
+            size_t size = count - i < 64 ? count - i : 64;
+            assert_uint64(matches[i / 64], ==,
+                          cx_match_flt_gt(size, &flt[i], flt_cmp));
+        }
+        cx_match_dbl_lt_bitmap(count, dbl, flt_cmp, matches);
+        for (size_t i = 0; i < count; i += 64) {
+            size_t size = count - i < 64 ? count - i : 64;
+            assert_uint64(matches[i / 64], ==,
+                          cx_match_dbl_lt(size, &dbl[i], flt_cmp));
+        }
+    }
+    return MUNIT_OK;
+}
+
 MunitTest match_tests[] = {
     {"/i32", test_i32, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/i64", test_i64, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/flt", test_flt, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/dbl", test_dbl, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/str", test_str, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/packed", test_packed, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/bitmap", test_bitmap, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
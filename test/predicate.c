@@ -2,6 +2,7 @@
 
 #include <stdio.h>
 
+#include "encode.h"
 #include "helpers.h"
 
 #define COLUMN_COUNT 14
@@ -26,7 +27,7 @@ struct cx_predicate_row_test_case {
     uint64_t expected;
 };
 
-static void *setup(const MunitParameter params[], void *data)
+static void *setup_encoding(enum cx_encoding_type encoding)
 {
     struct cx_predicate_fixture *fixture = malloc(sizeof(*fixture));
     assert_not_null(fixture);
@@ -76,6 +77,21 @@ static void *setup(const MunitParameter params[], void *data)
             assert_true(cx_column_put_bit(fixture->nulls[j], false));
     }
 
+    // encode each column that supports the encoding
+    for (size_t i = 0; encoding && i < COLUMN_COUNT; i++) {
+        struct cx_column **columns[] = {&fixture->columns[i],
+                                        &fixture->nulls[i]};
+        for (size_t j = 0; j < 2; j++) {
+            struct cx_column *column = *columns[j];
+            if (!cx_encoding_supported(cx_column_type(column), encoding))
+                continue;
+            struct cx_column *encoded = cx_encode(column, encoding, NULL);
+            assert_not_null(encoded);
+            cx_column_free(column);
+            *columns[j] = encoded;
+        }
+    }
+
     for (size_t i = 0; i < COLUMN_COUNT; i++)
         assert_true(cx_row_group_add_column(
             fixture->row_group, fixture->columns[i], fixture->nulls[i]));
@@ -86,6 +102,26 @@ static void *setup(const MunitParameter params[], void *data)
     return fixture;
 }
 
+static void *setup(const MunitParameter params[], void *data)
+{
+    return setup_encoding(CX_ENCODING_NONE);
+}
+
+static void *setup_dict(const MunitParameter params[], void *data)
+{
+    return setup_encoding(CX_ENCODING_DICT);
+}
+
+static void *setup_rle(const MunitParameter params[], void *data)
+{
+    return setup_encoding(CX_ENCODING_RLE);
+}
+
+static void *setup_bitpack(const MunitParameter params[], void *data)
+{
+    return setup_encoding(CX_ENCODING_BITPACK);
+}
+
 static void teardown(void *ptr)
 {
     struct cx_predicate_fixture *fixture = ptr;
@@ -699,6 +735,24 @@ MunitTest predicate_tests[] = {
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/str-match-rows", test_str_match_rows, setup, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
+    {"/str-dict-match-index", test_str_match_index, setup_dict, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/str-dict-match-rows", test_str_match_rows, setup_dict, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/bit-rle-match-rows", test_bit_match_rows, setup_rle, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i32-rle-match-rows", test_i32_match_rows, setup_rle, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i64-rle-match-rows", test_i64_match_rows, setup_rle, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/null-rle-match-rows", test_null_match_rows, setup_rle, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/custom-rle-match-rows", test_custom_match_rows, setup_rle, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i32-bitpack-match-rows", test_i32_match_rows, setup_bitpack, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i64-bitpack-match-rows", test_i64_match_rows, setup_bitpack, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
     {"/null-match-index", test_null_match_index, setup, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/null-match-rows", test_null_match_rows, setup, teardown,
@@ -230,6 +230,59 @@ static MunitResult test_empty_row_group(const MunitParameter params[],
     return MUNIT_OK;
 }
 
+static MunitResult test_batched(const MunitParameter params[], void *ptr)
+{
+    struct cx_row_fixture *fixture = ptr;
+
+    struct cx_predicate *predicate = cx_predicate_new_or(
+        3, cx_predicate_new_i32_lt(0, 3),
+        cx_predicate_new_and(2, cx_predicate_new_i64_gt(1, 600),
+                             cx_predicate_new_bit_eq(2, true)),
+        cx_predicate_new_str_contains(3, "7", false, CX_STR_LOCATION_END));
+    assert_not_null(predicate);
+
+    size_t batch_sizes[] = {64, 128, 1024, CX_BATCH_SIZE_MAX}, batch_size;
+    CX_FOREACH(batch_sizes, batch_size)
+    {
+        struct cx_row_cursor *cursor = cx_row_cursor_new_batched(
+            fixture->row_group, fixture->predicate, batch_size);
+        assert_not_null(cursor);
+        size_t position;
+        for (position = 0; cx_row_cursor_next(cursor); position++)
+            test_cursor_position(cursor, position);
+        assert_size(position, ==, ROW_COUNT);
+        assert_false(cx_row_cursor_error(cursor));
+        cx_row_cursor_free(cursor);
+
+        cursor = cx_row_cursor_new_batched(fixture->row_group, predicate,
+                                           batch_size);
+        assert_not_null(cursor);
+        size_t expected = 0;
+        for (position = 0; position < ROW_COUNT; position++) {
+            if (position >= 3 && !(position > 60 && position % 3 == 0) &&
+                position % 10 != 7)
+                continue;
+            assert_true(cx_row_cursor_next(cursor));
+            test_cursor_position(cursor, position);
+            expected++;
+        }
+        assert_false(cx_row_cursor_next(cursor));
+        assert_false(cx_row_cursor_error(cursor));
+        assert_size(cx_row_cursor_count(cursor), ==, expected);
+        cx_row_cursor_free(cursor);
+    }
+
+    size_t invalid[] = {0, 100, CX_BATCH_SIZE_MAX * 2};
+    CX_FOREACH(invalid, batch_size)
+    {
+        assert_null(cx_row_cursor_new_batched(fixture->row_group,
+                                              fixture->predicate, batch_size));
+    }
+
+    cx_predicate_free(predicate);
+    return MUNIT_OK;
+}
+
 MunitTest row_tests[] = {
     {"/cursor", test_cursor, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
     {"/count", test_count, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
@@ -239,4 +292,5 @@ MunitTest row_tests[] = {
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/empty-row-group", test_empty_row_group, setup, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
+    {"/batched", test_batched, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};